@@ -38,6 +38,7 @@ THE SOFTWARE.
 #include "OgreShaderFFPFog.h"
 #include "OgreShaderExPerPixelLighting.h"
 #include "OgreShaderExNormalMapLighting.h"
+#include "OgreShaderExClusteredLighting.h"
 #include "OgreShaderExIntegratedPSSM3.h"
 #include "OgreShaderExLayeredBlending.h"
 #include "OgreShaderExHardwareSkinning.h"
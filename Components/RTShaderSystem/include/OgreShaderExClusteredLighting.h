@@ -0,0 +1,172 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _ShaderExClusteredLighting_
+#define _ShaderExClusteredLighting_
+
+#include "OgreShaderPrerequisites.h"
+#ifdef RTSHADER_SYSTEM_BUILD_EXT_SHADERS
+#include "OgreShaderExPerPixelLighting.h"
+
+namespace Ogre {
+namespace RTShader {
+
+/** \addtogroup Optional
+*  @{
+*/
+/** \addtogroup RTShader
+*  @{
+*/
+
+#define SGX_LIB_CLUSTEREDLIGHTING                   "SGXLib_ClusteredLighting"
+#define SGX_FUNC_LIGHT_CLUSTERED_DIFFUSE            "SGX_Light_Clustered_Diffuse"
+#define SGX_FUNC_LIGHT_CLUSTERED_DIFFUSESPECULAR    "SGX_Light_Clustered_DiffuseSpecular"
+
+/** Clustered forward lighting sub render state implementation.
+@remarks
+    Lights each pixel with the directional lights and the lights of its cluster, as
+    binned by the LightClusters of the scene manager, in a single pass. The light
+    lists of the renderable are not used, so the number of lights is only limited
+    by LightClusters::setMaxLightsPerCluster.
+@par
+    Requires SceneManager::setLightClustersEnabled to be called on the active scene
+    manager before the shaders are generated, since the pass samples the LightClusters
+    textures. Only GLSL is supported; otherwise, for passes with iterative lighting and
+    when clustering is disabled, the pass falls back to PerPixelLighting.
+@par
+    Enabled from material scripts with "lighting_stage clustered".
+*/
+class _OgreRTSSExport ClusteredLighting : public PerPixelLighting
+{
+// Interface.
+public:
+    /** Class default constructor */
+    ClusteredLighting();
+
+    /**
+    @see SubRenderState::getType.
+    */
+    virtual const String& getType() const;
+
+    /**
+    @see SubRenderState::updateGpuProgramsParams.
+    */
+    virtual void updateGpuProgramsParams(Renderable* rend, Pass* pass, const AutoParamDataSource* source, const LightList* pLightList);
+
+    /**
+    @see SubRenderState::preAddToRenderState.
+    */
+    virtual bool preAddToRenderState(const RenderState* renderState, Pass* srcPass, Pass* dstPass);
+
+    static String Type;
+
+// Protected methods
+protected:
+    /**
+    Resolves the cluster parameters, there are no per light parameters.
+    */
+    virtual bool resolvePerLightParameters(ProgramSet* programSet);
+
+    /**
+    @see SubRenderState::resolveDependencies.
+    */
+    virtual bool resolveDependencies(ProgramSet* programSet);
+
+    /**
+    @see SubRenderState::addFunctionInvocations.
+    */
+    virtual bool addFunctionInvocations(ProgramSet* programSet);
+
+    /**
+    Internal method that adds the clustered lights illumination function invocation.
+    */
+    bool addPSClusteredIlluminationInvocation(Function* psMain, const int groupOrder);
+
+// Attributes.
+protected:
+    // Depth slice parameters, see LightClusters::getDepthParams.
+    UniformParameterPtr mDepthParams;
+    // Tile projection parameters, see LightClusters::getProjectionParams.
+    UniformParameterPtr mProjectionParams;
+    // Grid parameters, see LightClusters::getGridParams.
+    UniformParameterPtr mGridParams;
+    // Texture size parameters, see LightClusters::getTextureParams.
+    UniformParameterPtr mTextureParams;
+    // Light data, cluster and light index samplers.
+    UniformParameterPtr mLightSampler;
+    UniformParameterPtr mClusterSampler;
+    UniformParameterPtr mIndexSampler;
+    // Texture unit indices of the samplers.
+    ushort mLightSamplerIndex;
+    ushort mClusterSamplerIndex;
+    ushort mIndexSamplerIndex;
+    // Whether the pass is lit by PerPixelLighting instead.
+    bool mFallback;
+};
+
+
+/**
+A factory that enables creation of ClusteredLighting instances.
+@remarks Sub class of SubRenderStateFactory
+*/
+class _OgreRTSSExport ClusteredLightingFactory : public SubRenderStateFactory
+{
+public:
+
+    /**
+    @see SubRenderStateFactory::getType.
+    */
+    virtual const String& getType() const;
+
+    /**
+    @see SubRenderStateFactory::createInstance.
+    */
+    virtual SubRenderState* createInstance(ScriptCompiler* compiler, PropertyAbstractNode* prop, Pass* pass, SGScriptTranslator* translator);
+
+    /**
+    @see SubRenderStateFactory::writeInstance.
+    */
+    virtual void writeInstance(MaterialSerializer* ser, SubRenderState* subRenderState, Pass* srcPass, Pass* dstPass);
+
+
+protected:
+
+    /**
+    @see SubRenderStateFactory::createInstanceImpl.
+    */
+    virtual SubRenderState* createInstanceImpl();
+
+
+};
+
+/** @} */
+/** @} */
+
+}
+}
+
+#endif
+#endif
@@ -44,13 +44,19 @@ namespace RTShader {
 /** Transform sub render state implementation of the Fixed Function Pipeline.
 @see http://msdn.microsoft.com/en-us/library/bb206269.aspx
 Derives from SubRenderState class.
+@remarks
+    While auto instancing is enabled for the active SceneManager, the generated vertex program
+    first moves the position (and the normal, if the pass is lit or environment mapped) to world
+    space with the per-instance matrix rows in the last 3 texture coordinate sets.
+    @see SceneManager::setAutoInstancingEnabled
 */
 class _OgreRTSSExport FFPTransform : public SubRenderState
 {
 
 // Interface.
 public:
-    
+    FFPTransform() : mSetPointSize(false), mInstanced(false), mInstancedNormal(false) {}
+
     /** 
     @see SubRenderState::getType.
     */
@@ -76,6 +82,10 @@ public:
     static String Type;
 protected:
     bool mSetPointSize;
+    /// Move the vertices to world space with the auto instancing matrices first
+    bool mInstanced;
+    /// Whether the normal must be moved to world space as well
+    bool mInstancedNormal;
 };
 
 
@@ -980,6 +980,8 @@ protected:
     SubRenderStateFactoryMap mSubRenderStateExFactories;
     // True if active view port use a valid SGScheme.
     bool mActiveViewportValid;
+    // Whether auto instancing was enabled when the shaders were generated, see FFPTransform.
+    bool mAutoInstancing;
     // Light count per light type.
     int mLightCount[3];
     // Vertex shader outputs compact policy.
@@ -171,6 +171,16 @@ public:
     */
     bool getSkeletalAnimationIncluded() const { return mSkeletalAnimation; }
 
+    /** Sets whether a vertex program builds the world matrix from per-instance data,
+        as required for auto instancing.
+        @see SceneManager::setAutoInstancingEnabled
+    */
+    void setInstancingIncluded(bool value) { mInstancing = value; }
+
+    /** Returns whether a vertex program builds the world matrix from per-instance data.
+    */
+    bool getInstancingIncluded() const { return mInstancing; }
+
     /** Tells Ogre whether auto-bound matrices should be sent in column or row-major order.
     @remarks
         This method has the same effect as column_major_matrices option used when declaring manually written hlsl program.
@@ -228,6 +238,8 @@ protected:
     StringVector mDependencies;
     // Skeletal animation calculation
     bool mSkeletalAnimation;
+    // Instanced world transform
+    bool mInstancing;
     // Whether to pass matrices as column-major.
     bool mColumnMajorMatrices;
 private:
@@ -0,0 +1,329 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreShaderPrecompiledHeaders.h"
+#ifdef RTSHADER_SYSTEM_BUILD_EXT_SHADERS
+#include "OgreLightClusters.h"
+
+namespace Ogre {
+namespace RTShader {
+
+/************************************************************************/
+/*                                                                      */
+/************************************************************************/
+String ClusteredLighting::Type = "SGX_ClusteredLighting";
+
+//-----------------------------------------------------------------------
+ClusteredLighting::ClusteredLighting()
+{
+    mLightSamplerIndex              = 0;
+    mClusterSamplerIndex            = 0;
+    mIndexSamplerIndex              = 0;
+    mFallback                       = false;
+}
+
+//-----------------------------------------------------------------------
+const String& ClusteredLighting::getType() const
+{
+    return Type;
+}
+
+//-----------------------------------------------------------------------
+void ClusteredLighting::updateGpuProgramsParams(Renderable* rend, Pass* pass, const AutoParamDataSource* source,
+    const LightList* pLightList)
+{
+    if (mFallback)
+    {
+        PerPixelLighting::updateGpuProgramsParams(rend, pass, source, pLightList);
+        return;
+    }
+
+    SceneManager* sceneMgr = ShaderGenerator::getSingleton().getActiveSceneManager();
+    const LightClusters* clusters = sceneMgr ? sceneMgr->getLightClusters() : NULL;
+
+    if (clusters == NULL || !clusters->getLightTexture())
+    {
+        // No tiles -> the shader skips the clustered lights.
+        mGridParams->setGpuParameter(Vector4::ZERO);
+        return;
+    }
+
+    // Materials can be shared by scene managers, each with its own textures
+    const TexturePtr* textures[3] = {
+        &clusters->getLightTexture(), &clusters->getClusterTexture(), &clusters->getIndexTexture() };
+    ushort samplerIndices[3] = { mLightSamplerIndex, mClusterSamplerIndex, mIndexSamplerIndex };
+    for (int i = 0; i < 3; ++i)
+    {
+        TextureUnitState* tex = pass->getTextureUnitState(samplerIndices[i]);
+        if (tex->_getTexturePtr() != *textures[i])
+            tex->setTexture(*textures[i]);
+    }
+
+    mDepthParams->setGpuParameter(clusters->getDepthParams());
+    mProjectionParams->setGpuParameter(clusters->getProjectionParams());
+    mGridParams->setGpuParameter(clusters->getGridParams());
+    mTextureParams->setGpuParameter(clusters->getTextureParams());
+}
+
+//-----------------------------------------------------------------------
+bool ClusteredLighting::resolvePerLightParameters(ProgramSet* programSet)
+{
+    if (mFallback)
+        return PerPixelLighting::resolvePerLightParameters(programSet);
+
+    Program* vsProgram = programSet->getCpuProgram(GPT_VERTEX_PROGRAM);
+    Program* psProgram = programSet->getCpuProgram(GPT_FRAGMENT_PROGRAM);
+    Function* vsMain = vsProgram->getEntryPointFunction();
+    Function* psMain = psProgram->getEntryPointFunction();
+    bool hasError = false;
+
+    // Point and spot lights need the view space position.
+    mWorldViewMatrix = vsProgram->resolveAutoParameterInt(GpuProgramParameters::ACT_WORLDVIEW_MATRIX, 0);
+    mVSInPosition = vsMain->resolveInputParameter(Parameter::SPS_POSITION, 0, Parameter::SPC_POSITION_OBJECT_SPACE, GCT_FLOAT4);
+
+    if (mVSOutViewPos.get() == NULL)
+    {
+        mVSOutViewPos = vsMain->resolveOutputParameter(Parameter::SPS_TEXTURE_COORDINATES, -1, Parameter::SPC_POSITION_VIEW_SPACE, GCT_FLOAT3);
+
+        mPSInViewPos = psMain->resolveInputParameter(Parameter::SPS_TEXTURE_COORDINATES,
+            mVSOutViewPos->getIndex(),
+            mVSOutViewPos->getContent(),
+            GCT_FLOAT3);
+    }
+
+    mDepthParams = psProgram->resolveParameter(GCT_FLOAT4, -1, (uint16)GPV_GLOBAL, "cluster_depth_params");
+    mProjectionParams = psProgram->resolveParameter(GCT_FLOAT4, -1, (uint16)GPV_GLOBAL, "cluster_projection_params");
+    mGridParams = psProgram->resolveParameter(GCT_FLOAT4, -1, (uint16)GPV_GLOBAL, "cluster_grid_params");
+    mTextureParams = psProgram->resolveParameter(GCT_FLOAT4, -1, (uint16)GPV_GLOBAL, "cluster_texture_params");
+
+    mLightSampler = psProgram->resolveParameter(GCT_SAMPLER2D, mLightSamplerIndex, (uint16)GPV_GLOBAL, "gClusterLightSampler");
+    mClusterSampler = psProgram->resolveParameter(GCT_SAMPLER2D, mClusterSamplerIndex, (uint16)GPV_GLOBAL, "gClusterSampler");
+    mIndexSampler = psProgram->resolveParameter(GCT_SAMPLER2D, mIndexSamplerIndex, (uint16)GPV_GLOBAL, "gClusterIndexSampler");
+
+    hasError |= !(mWorldViewMatrix.get()) || !(mVSInPosition.get()) || !(mVSOutViewPos.get()) || !(mPSInViewPos.get()) ||
+        !(mDepthParams.get()) || !(mProjectionParams.get()) || !(mGridParams.get()) || !(mTextureParams.get()) ||
+        !(mLightSampler.get()) || !(mClusterSampler.get()) || !(mIndexSampler.get());
+
+    if (hasError)
+    {
+        OGRE_EXCEPT( Exception::ERR_INTERNAL_ERROR,
+                "Not all parameters could be constructed for the sub-render state.",
+                "ClusteredLighting::resolvePerLightParameters" );
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------
+bool ClusteredLighting::resolveDependencies(ProgramSet* programSet)
+{
+    if (mFallback)
+        return PerPixelLighting::resolveDependencies(programSet);
+
+    Program* vsProgram = programSet->getCpuProgram(GPT_VERTEX_PROGRAM);
+    Program* psProgram = programSet->getCpuProgram(GPT_FRAGMENT_PROGRAM);
+
+    vsProgram->addDependency(FFP_LIB_COMMON);
+    vsProgram->addDependency(SGX_LIB_PERPIXELLIGHTING);
+
+    psProgram->addDependency(FFP_LIB_COMMON);
+    psProgram->addDependency(SGX_LIB_CLUSTEREDLIGHTING);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------
+bool ClusteredLighting::addFunctionInvocations(ProgramSet* programSet)
+{
+    if (mFallback)
+        return PerPixelLighting::addFunctionInvocations(programSet);
+
+    Program* vsProgram = programSet->getCpuProgram(GPT_VERTEX_PROGRAM);
+    Function* vsMain = vsProgram->getEntryPointFunction();
+    Program* psProgram = programSet->getCpuProgram(GPT_FRAGMENT_PROGRAM);
+    Function* psMain = psProgram->getEntryPointFunction();
+
+    // Add the global illumination functions.
+    if (false == addVSInvocation(vsMain, FFP_VS_LIGHTING))
+        return false;
+
+    // Add the global illumination functions.
+    if (false == addPSGlobalIlluminationInvocation(psMain, FFP_PS_COLOUR_BEGIN + 1))
+        return false;
+
+    // Add the lights of the cluster.
+    if (false == addPSClusteredIlluminationInvocation(psMain, FFP_PS_COLOUR_BEGIN + 1))
+        return false;
+
+    // Assign back temporary variables to the ps diffuse and specular components.
+    if (false == addPSFinalAssignmentInvocation(psMain, FFP_PS_COLOUR_BEGIN + 1))
+        return false;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------
+bool ClusteredLighting::addPSClusteredIlluminationInvocation(Function* psMain, const int groupOrder)
+{
+    FunctionInvocation* curFuncInvocation = NULL;
+
+    if (mSpecularEnable)
+        curFuncInvocation = OGRE_NEW FunctionInvocation(SGX_FUNC_LIGHT_CLUSTERED_DIFFUSESPECULAR, groupOrder);
+    else
+        curFuncInvocation = OGRE_NEW FunctionInvocation(SGX_FUNC_LIGHT_CLUSTERED_DIFFUSE, groupOrder);
+
+    curFuncInvocation->pushOperand(mPSInNormal, Operand::OPS_IN);
+    curFuncInvocation->pushOperand(mPSInViewPos, Operand::OPS_IN);
+    curFuncInvocation->pushOperand(mDepthParams, Operand::OPS_IN);
+    curFuncInvocation->pushOperand(mProjectionParams, Operand::OPS_IN);
+    curFuncInvocation->pushOperand(mGridParams, Operand::OPS_IN);
+    curFuncInvocation->pushOperand(mTextureParams, Operand::OPS_IN);
+    curFuncInvocation->pushOperand(mLightSampler, Operand::OPS_IN);
+    curFuncInvocation->pushOperand(mClusterSampler, Operand::OPS_IN);
+    curFuncInvocation->pushOperand(mIndexSampler, Operand::OPS_IN);
+
+    // Light colours are modulated by the vertex colour when tracked, like the per pixel lighting.
+    if (mTrackVertexColourType & TVC_DIFFUSE)
+        curFuncInvocation->pushOperand(mPSDiffuse, Operand::OPS_IN, Operand::OPM_XYZ);
+    else
+        curFuncInvocation->pushOperand(mSurfaceDiffuseColour, Operand::OPS_IN, Operand::OPM_XYZ);
+
+    if (mSpecularEnable)
+    {
+        if (mTrackVertexColourType & TVC_SPECULAR)
+            curFuncInvocation->pushOperand(mPSDiffuse, Operand::OPS_IN, Operand::OPM_XYZ);
+        else
+            curFuncInvocation->pushOperand(mSurfaceSpecularColour, Operand::OPS_IN, Operand::OPM_XYZ);
+        curFuncInvocation->pushOperand(mSurfaceShininess, Operand::OPS_IN);
+    }
+
+    curFuncInvocation->pushOperand(mPSTempDiffuseColour, Operand::OPS_IN, Operand::OPM_XYZ);
+    if (mSpecularEnable)
+        curFuncInvocation->pushOperand(mPSTempSpecularColour, Operand::OPS_IN, Operand::OPM_XYZ);
+    curFuncInvocation->pushOperand(mPSTempDiffuseColour, Operand::OPS_OUT, Operand::OPM_XYZ);
+    if (mSpecularEnable)
+        curFuncInvocation->pushOperand(mPSTempSpecularColour, Operand::OPS_OUT, Operand::OPM_XYZ);
+    psMain->addAtomInstance(curFuncInvocation);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------
+bool ClusteredLighting::preAddToRenderState(const RenderState* renderState, Pass* srcPass, Pass* dstPass)
+{
+    if (srcPass->getLightingEnabled() == false)
+        return false;
+
+    // The light lookups are only implemented in GLSL and the textures exist once clustering
+    // has been enabled on the scene manager. Otherwise light the pass per pixel as usual.
+    SceneManager* sceneMgr = ShaderGenerator::getSingleton().getActiveSceneManager();
+    const LightClusters* clusters = sceneMgr ? sceneMgr->getLightClusters() : NULL;
+    mFallback = srcPass->getIteratePerLight() || !clusters || !clusters->getLightTexture() ||
+                ShaderGenerator::getSingleton().getTargetLanguage() != "glsl";
+    if (mFallback)
+    {
+        LogManager::getSingleton().logMessage(
+            "RTShader::ClusteredLighting: using per pixel lighting for a pass of '" +
+            srcPass->getParent()->getParent()->getName() + "', clustering is unavailable");
+        return PerPixelLighting::preAddToRenderState(renderState, srcPass, dstPass);
+    }
+
+    setTrackVertexColourType(srcPass->getVertexColourTracking());
+
+    if (srcPass->getShininess() > 0.0 &&
+        srcPass->getSpecular() != ColourValue::Black)
+    {
+        setSpecularEnable(true);
+    }
+    else
+    {
+        setSpecularEnable(false);
+    }
+
+    const TexturePtr* textures[3] = {
+        &clusters->getLightTexture(), &clusters->getClusterTexture(), &clusters->getIndexTexture() };
+    ushort* samplerIndices[3] = { &mLightSamplerIndex, &mClusterSamplerIndex, &mIndexSamplerIndex };
+    for (int i = 0; i < 3; ++i)
+    {
+        TextureUnitState* tex = dstPass->createTextureUnitState();
+        tex->setTexture(*textures[i]);
+        tex->setTextureFiltering(TFO_NONE);
+        tex->setTextureAddressingMode(TextureUnitState::TAM_CLAMP);
+        *samplerIndices[i] = dstPass->getNumTextureUnitStates() - 1;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------
+const String& ClusteredLightingFactory::getType() const
+{
+    return ClusteredLighting::Type;
+}
+
+//-----------------------------------------------------------------------
+SubRenderState* ClusteredLightingFactory::createInstance(ScriptCompiler* compiler,
+                                                         PropertyAbstractNode* prop, Pass* pass, SGScriptTranslator* translator)
+{
+    if (prop->name == "lighting_stage")
+    {
+        if(prop->values.size() == 1)
+        {
+            String modelType;
+
+            if(false == SGScriptTranslator::getString(prop->values.front(), &modelType))
+            {
+                compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line);
+                return NULL;
+            }
+
+            if (modelType == "clustered")
+            {
+                return createOrRetrieveInstance(translator);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+//-----------------------------------------------------------------------
+void ClusteredLightingFactory::writeInstance(MaterialSerializer* ser, SubRenderState* subRenderState,
+                                             Pass* srcPass, Pass* dstPass)
+{
+    ser->writeAttribute(4, "lighting_stage");
+    ser->writeValue("clustered");
+}
+
+//-----------------------------------------------------------------------
+SubRenderState* ClusteredLightingFactory::createInstanceImpl()
+{
+    return OGRE_NEW ClusteredLighting;
+}
+
+}
+}
+
+#endif
@@ -51,6 +51,23 @@ int FFPTransform::getExecutionOrder() const
 bool FFPTransform::preAddToRenderState(const RenderState* renderState, Pass* srcPass, Pass* dstPass)
 {
     mSetPointSize = srcPass->getPointSize() != 1.0f || srcPass->isPointAttenuationEnabled();
+
+    SceneManager* sceneMgr = ShaderGenerator::getSingleton().getActiveSceneManager();
+    RenderSystem* rs = Root::getSingleton().getRenderSystem();
+    mInstanced = sceneMgr && sceneMgr->isAutoInstancingEnabled() && rs &&
+                 rs->getCapabilities()->hasCapability(RSC_VERTEX_BUFFER_INSTANCE_DATA);
+    mInstancedNormal = srcPass->getLightingEnabled();
+
+    for (unsigned short i = 0; mInstanced && i < srcPass->getNumTextureUnitStates(); ++i)
+    {
+        const TextureUnitState* tus = srcPass->getTextureUnitState(i);
+        // the instance data owns these sets
+        if (tus->getTextureCoordSet() >= OGRE_MAX_TEXTURE_COORD_SETS - 3)
+            mInstanced = false;
+        if (tus->getEffects().find(TextureUnitState::ET_ENVIRONMENT_MAP) != tus->getEffects().end())
+            mInstancedNormal = true;
+    }
+
     return true;
 }
 
@@ -80,6 +97,38 @@ bool FFPTransform::createCpuSubPrograms(ProgramSet* programSet)
     // Add dependency.
     vsProgram->addDependency(FFP_LIB_TRANSFORM);
 
+    if (mInstanced)
+    {
+        // The world matrices are identity during instanced draws, so moving the vertex data
+        // to world space here keeps every later stage consistent
+        FunctionInvocation* instanceFunc = OGRE_NEW FunctionInvocation("FFP_InstanceTransform", FFP_VS_PRE_PROCESS);
+        // Normals need the inverse transpose, or non uniform scales would skew them
+        FunctionInvocation* normalFunc = mInstancedNormal ? OGRE_NEW FunctionInvocation("FFP_InstanceTransformNormal", FFP_VS_PRE_PROCESS) : NULL;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            int index = OGRE_MAX_TEXTURE_COORD_SETS - 3 + i;
+            ParameterPtr matrixRow = vsEntry->resolveInputParameter(
+                Parameter::SPS_TEXTURE_COORDINATES, index,
+                Parameter::Content(Parameter::SPC_TEXTURE_COORDINATE0 + index), GCT_FLOAT4);
+            instanceFunc->pushOperand(matrixRow, Operand::OPS_IN);
+            if (normalFunc)
+                normalFunc->pushOperand(matrixRow, Operand::OPS_IN);
+        }
+
+        instanceFunc->pushOperand(positionIn, Operand::OPS_INOUT);
+        vsEntry->addAtomInstance(instanceFunc);
+
+        if (normalFunc)
+        {
+            ParameterPtr normalIn = vsEntry->resolveInputParameter(Parameter::SPS_NORMAL, 0, Parameter::SPC_NORMAL_OBJECT_SPACE, GCT_FLOAT3);
+            normalFunc->pushOperand(normalIn, Operand::OPS_INOUT);
+            vsEntry->addAtomInstance(normalFunc);
+        }
+
+        vsProgram->setInstancingIncluded(true);
+    }
+
     FunctionInvocation* transformFunc = OGRE_NEW FunctionInvocation(FFP_FUNC_TRANSFORM,  FFP_VS_TRANSFORM);
 
     transformFunc->pushOperand(wvpMatrix, Operand::OPS_IN);
@@ -114,6 +163,8 @@ void FFPTransform::copyFrom(const SubRenderState& rhs)
 {
     const FFPTransform& rhsTransform = static_cast<const FFPTransform&>(rhs);
     mSetPointSize = rhsTransform.mSetPointSize;
+    mInstanced = rhsTransform.mInstanced;
+    mInstancedNormal = rhsTransform.mInstancedNormal;
 }
 
 //-----------------------------------------------------------------------
@@ -55,7 +55,7 @@ ShaderGenerator& ShaderGenerator::getSingleton()
 ShaderGenerator::ShaderGenerator() :
     mActiveSceneMgr(NULL), mRenderObjectListener(NULL), mSceneManagerListener(NULL), mScriptTranslatorManager(NULL),
     mMaterialSerializerListener(NULL), mShaderLanguage(""), mProgramManager(NULL), mProgramWriterManager(NULL),
-    mFSLayer(0), mFFPRenderStateBuilder(NULL),mActiveViewportValid(false), mVSOutputCompactPolicy(VSOCP_LOW),
+    mFSLayer(0), mFFPRenderStateBuilder(NULL),mActiveViewportValid(false), mAutoInstancing(false), mVSOutputCompactPolicy(VSOCP_LOW),
     mCreateShaderOverProgrammablePass(false), mIsFinalizing(false)
 {
     mLightCount[0]              = 0;
@@ -176,6 +176,10 @@ void ShaderGenerator::createSubRenderStateExFactories()
         addSubRenderStateFactory(curFactory);
         mSubRenderStateExFactories[curFactory->getType()] = (curFactory);
 
+        curFactory = OGRE_NEW ClusteredLightingFactory;
+        addSubRenderStateFactory(curFactory);
+        mSubRenderStateExFactories[curFactory->getType()] = (curFactory);
+
         curFactory = OGRE_NEW IntegratedPSSM3Factory;   
         addSubRenderStateFactory(curFactory);
         mSubRenderStateExFactories[curFactory->getType()] = (curFactory);
@@ -1070,6 +1074,16 @@ void ShaderGenerator::preFindVisibleObjects(SceneManager* source,
     const String& curMaterialScheme = v->getMaterialScheme();
         
     mActiveSceneMgr      = source;
+
+    // The transform stage reads the world matrix from the instance data only while
+    // auto instancing is enabled, so toggling it needs new shaders
+    if (source->isAutoInstancingEnabled() != mAutoInstancing)
+    {
+        mAutoInstancing = source->isAutoInstancingEnabled();
+        for (SGSchemeIterator itScheme = mSchemeEntriesMap.begin(); itScheme != mSchemeEntriesMap.end(); ++itScheme)
+            itScheme->second->invalidate();
+    }
+
     mActiveViewportValid = validateScheme(curMaterialScheme);
 }
 
@@ -36,6 +36,7 @@ Program::Program(GpuProgramType type)
     mType               = type;
     mEntryPointFunction = NULL;
     mSkeletalAnimation  = false;
+    mInstancing         = false;
     mColumnMajorMatrices = true;
 }
 
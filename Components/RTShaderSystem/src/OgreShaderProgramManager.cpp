@@ -324,6 +324,8 @@ bool ProgramManager::createGpuPrograms(ProgramSet* programSet)
     //update flags
     programSet->getGpuProgram(GPT_VERTEX_PROGRAM)->setSkeletalAnimationIncluded(
         programSet->getCpuProgram(GPT_VERTEX_PROGRAM)->getSkeletalAnimationIncluded());
+    programSet->getGpuProgram(GPT_VERTEX_PROGRAM)->setInstancingIncluded(
+        programSet->getCpuProgram(GPT_VERTEX_PROGRAM)->getInstancingIncluded());
 
     // Call the post creation of GPU programs method.
     return programProcessor->postCreateGpuPrograms(programSet);
@@ -275,6 +275,8 @@ namespace Ogre
         static const uint16 TERRAIN_CHUNK_VERSION;
         static const uint16 TERRAIN_MAX_BATCH_SIZE;
         static const uint64 TERRAIN_GENERATE_MATERIAL_INTERVAL_MS;
+        /// Width in quads of the smallest tiles rayIntersects skips at once
+        static const uint16 HEIGHT_BOUNDS_TILE_SIZE;
 
         static const uint32 TERRAINLAYERDECLARATION_CHUNK_ID;
         static const uint16 TERRAINLAYERDECLARATION_CHUNK_VERSION;
@@ -1657,6 +1659,24 @@ namespace Ogre
         void calculateCurrentLod(Viewport* vp);
         /// Test a single quad of the terrain for ray intersection.
         std::pair<bool, Vector3> checkQuadIntersection(int x, int y, const Ray& ray); //const;
+        /** Test the quads a ray in local vertex space crosses between two distances along it,
+            skipping the tiles of the height bounds pyramid it passes above or below.
+        */
+        std::pair<bool, Vector3> rayMarchHeightBounds(const Ray& localRay, Real start, Real end); //const;
+        /// Test a tile of a level of the height bounds pyramid, and the tiles below it, between two distances
+        std::pair<bool, Vector3> rayMarchTile(const Ray& localRay, int level, long tx, long tz, Real start, Real end);
+        /// Test the quads of a rectangle a ray crosses between two distances, in order
+        std::pair<bool, Vector3> rayMarchQuads(const Ray& localRay, long left, long top, long right, long bottom,
+            Real start, Real end);
+        /// Update the height bounds pyramid for a changed rectangle of vertices
+        void updateHeightBounds(const Rect& rect);
+
+        /// Calculate the normals of a range of the rows of a calculateNormals job
+        void calculateNormalRows(void* job, long begin, long end);
+        /// Find the shadow heights of a range of the edge texels of a calculateLightmap job
+        void calculateLightmapEdges(void* job, long begin, long end);
+        /// Cast a ray from every texel of a range of the rows of a calculateLightmap job
+        void calculateLightmapRows(void* job, long begin, long end);
 
         /// Delete blend maps for all layers >= lowIndex
         void deleteBlendMaps(uint8 lowIndex);
@@ -1700,6 +1720,21 @@ namespace Ogre
         float* mHeightData;
         /// The delta information defining how a vertex moves before it is removed at a lower LOD
         float* mDeltaData;
+
+        /// Square tiles of quads of the height data and their minimum and maximum heights
+        struct HeightBoundsLevel
+        {
+            /// Tiles per side
+            long size;
+            /// Minimum and maximum height of every tile, row by row
+            std::vector<float> bounds;
+        };
+        typedef std::vector<HeightBoundsLevel> HeightBoundsPyramid;
+        /** Height bounds for ray queries. The tiles of the first level are
+            HEIGHT_BOUNDS_TILE_SIZE quads wide, those of every further level twice as wide
+            as the previous, up to a single tile.
+        */
+        HeightBoundsPyramid mHeightBounds;
         Alignment mAlign;
         Real mWorldSize;
         uint16 mSize;
@@ -1896,6 +1931,7 @@ namespace Ogre
         Real mCompositeMapDistance;
         String mResourceGroup;
         bool mUseVertexCompressionWhenAvailable;
+        bool mQuantiseSavedHeights;
 
     public:
         TerrainGlobalOptions();
@@ -2076,6 +2112,21 @@ namespace Ogre
          */
         void setUseVertexCompressionWhenAvailable(bool enable) { mUseVertexCompressionWhenAvailable = enable; }
 
+        /** Get whether Terrain::save stores heights as 16 bit steps over their range.
+        */
+        bool getQuantiseSavedHeights() const { return mQuantiseSavedHeights; }
+
+        /** Set whether Terrain::save stores heights as 16 bit steps over their range.
+         @remarks
+            Every tile of 64 by 64 vertices gets its own range in every LOD level, and
+            consecutive samples are stored as differences, which compresses far better than
+            the floats, for smaller pages which load faster. The heights lose precision down
+            to 1/65535 of the range of their tile, so this is meant for shipping data rather
+            than for editing.
+            Files of either kind load regardless of this setting. The default is false.
+         */
+        void setQuantiseSavedHeights(bool quantise) { mQuantiseSavedHeights = quantise; }
+
         /// @copydoc Singleton::getSingleton()
         static TerrainGlobalOptions& getSingleton(void);
         /// @copydoc Singleton::getSingleton()
@@ -416,6 +416,18 @@ namespace Ogre
          the terrain data occurs.
          */
         RayResult rayIntersects(const Ray& ray, Real distanceLimit = 0) const; 
+
+        /** Test a batch of rays for intersection with the terrains in the group, for
+         instance for line of sight queries.
+         @param rays The rays to test for intersection
+         @param results Gets the result of every ray, in the same order
+         @param distanceLimit The distance from the ray origins at which we will stop looking,
+            0 indicates no limit
+         @remarks The rays are split between worker threads, if threading is enabled. The
+         terrain data must not be written while this runs.
+         */
+        void rayIntersects(const std::vector<Ray>& rays, std::vector<RayResult>& results,
+            Real distanceLimit = 0) const;
         
         typedef std::vector<Terrain*> TerrainList; 
         /** Test intersection of a box with the terrain. 
@@ -100,6 +100,19 @@ namespace Ogre
         void updateToLodLevel(int lodLevel, bool synchronous = false);
         /// Save each LOD level separately compressed so seek is possible
         static void saveLodData(StreamSerialiser& stream, Terrain* terrain);
+        /** Write the chunk of a LOD level
+          @param data The heights of the level as separateData stores them, followed by its deltas
+          @param size Dimension of the terrain
+          @param quantise Whether to store 16 bit steps over the range of each tile of the
+                terrain (version 2), rather than the plain floats (version 1)
+          */
+        static void writeLodLevel(StreamSerialiser& stream, const float* data, uint16 size,
+                                  uint16 numLodLevels, uint16 lodLevel, bool quantise);
+        /** Read the chunk of a LOD level of either version into data, laid out as for
+            writeLodLevel
+          */
+        static void readLodLevel(StreamSerialiser& stream, float* data, uint16 size,
+                                 uint16 numLodLevels, uint16 lodLevel);
 
         /** Copy geometry data from buffer to mHeightData/mDeltaData
           @param lodLevel A LOD level to work with
@@ -49,6 +49,11 @@ THE SOFTWARE.
 #include "OgreTimer.h"
 #include "OgreTerrainMaterialGeneratorA.h"
 #include "OgreFileSystemLayer.h"
+#include "OgrePlatformInformation.h"
+
+#if __OGRE_HAVE_SSE
+#include <xmmintrin.h>
+#endif
 
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
 // we do lots of conversions here, casting them all is tedious & cluttered, we know what we're doing
@@ -56,6 +61,58 @@ THE SOFTWARE.
 #endif
 namespace Ogre
 {
+    namespace
+    {
+        /// Normals calculateNormals is working on
+        struct NormalsJob
+        {
+            Rect rect;
+            uint8* data;
+        };
+
+        /// Lightmap calculateLightmap is working on
+        struct LightmapJob
+        {
+            Rect rect;
+            uint8* data;
+            Vector3 lightVec;
+            Real heightPad;
+            /// Terrain height at every texel of the rect
+            std::vector<float> heights;
+            /// Lowest height the light reaches at every texel of the rect
+            std::vector<float> shadowHeights;
+            /// Texels whose shadow height does not follow from other texels of the rect
+            std::vector<long> edges;
+        };
+
+        /// Vertex offsets of the triangle fan calculateNormals sums the normals of
+        const long NORMAL_FAN_X[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+        const long NORMAL_FAN_Y[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+        /// Encode a normal as RGB
+        inline void storeNormal(const Vector3& normal, uint8* pStore)
+        {
+            *pStore++ = static_cast<uint8>((normal.x + 1.0f) * 0.5f * 255.0f);
+            *pStore++ = static_cast<uint8>((normal.y + 1.0f) * 0.5f * 255.0f);
+            *pStore++ = static_cast<uint8>((normal.z + 1.0f) * 0.5f * 255.0f);
+        }
+
+#if __OGRE_HAVE_SSE
+        /// Same as Vector3::normalise for four vectors
+        inline void normaliseSSE(__m128* v)
+        {
+            __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(v[0], v[0]), _mm_mul_ps(v[1], v[1])),
+                                                _mm_mul_ps(v[2], v[2])));
+            __m128 nonZero = _mm_cmpgt_ps(len, _mm_setzero_ps());
+            __m128 invLen = _mm_div_ps(_mm_set1_ps(1.0f), len);
+            for (int k = 0; k < 3; ++k)
+            {
+                v[k] = _mm_or_ps(_mm_and_ps(nonZero, _mm_mul_ps(v[k], invLen)),
+                                 _mm_andnot_ps(nonZero, v[k]));
+            }
+        }
+#endif
+    }
     //---------------------------------------------------------------------
     const uint32 Terrain::TERRAIN_CHUNK_ID = StreamSerialiser::makeIdentifier("TERR");
     const uint16 Terrain::TERRAIN_CHUNK_VERSION = 2;
@@ -75,6 +132,7 @@ namespace Ogre
     const uint16 Terrain::TERRAIN_MAX_BATCH_SIZE = 129; 
     const uint16 Terrain::WORKQUEUE_DERIVED_DATA_REQUEST = 1;
     const uint64 Terrain::TERRAIN_GENERATE_MATERIAL_INTERVAL_MS = 400;
+    const uint16 Terrain::HEIGHT_BOUNDS_TILE_SIZE = 4;
     const uint16 Terrain::WORKQUEUE_GENERATE_MATERIAL_REQUEST = 2;
     const size_t Terrain::LOD_MORPH_CUSTOM_PARAM = 1001;
     const uint8 Terrain::DERIVED_DATA_DELTAS = 1;
@@ -114,6 +172,7 @@ namespace Ogre
         , mCompositeMapDistance(4000)
         , mResourceGroup(ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME)
         , mUseVertexCompressionWhenAvailable(true)
+        , mQuantiseSavedHeights(false)
     {
     }
     //---------------------------------------------------------------------
@@ -797,6 +856,10 @@ namespace Ogre
 
         stream.readChunkEnd(TERRAIN_CHUNK_ID);
 
+        // height data streamed in later by LOD dirties the terrain, which updates these
+        Rect rect(0, 0, mSize, mSize);
+        updateHeightBounds(rect);
+
         mModified = false;
         mHeightDataModified = false;
 
@@ -931,6 +994,7 @@ namespace Ogre
         rect.left = 0; rect.right = mSize;
         calculateHeightDeltas(rect);
         finaliseHeightDeltas(rect, true);
+        updateHeightBounds(rect);
 
         distributeVertexData();
 
@@ -1882,6 +1946,8 @@ namespace Ogre
     //---------------------------------------------------------------------
     void Terrain::dirtyRect(const Rect& rect)
     {
+        updateHeightBounds(rect);
+
         mDirtyGeometryRect.merge(rect);
         mDirtyGeometryRectForNeighbours.merge(rect);
         mDirtyDerivedDataRect.merge(rect);
@@ -2012,6 +2078,8 @@ namespace Ogre
         OGRE_FREE(mDeltaData, MEMCATEGORY_GEOMETRY);
         mDeltaData = 0;
 
+        mHeightBounds.clear();
+
         OGRE_DELETE mQuadTree;
         mQuadTree = 0;
 
@@ -2408,48 +2476,18 @@ namespace Ogre
             }
             return Result(false, Vector3());
         }
-        // get intersection point and move inside
-        Vector3 cur = localRay.getPoint(aabbTest.second);
-
-        // now check every quad the ray touches
-        int quadX = std::min(std::max(static_cast<int>(cur.x), 0), (int)mSize-2);
-        int quadZ = std::min(std::max(static_cast<int>(cur.z), 0), (int)mSize-2);
-        int flipX = (rayDirection.x < 0 ? 0 : 1);
-        int flipZ = (rayDirection.z < 0 ? 0 : 1);
-        int xDir = (rayDirection.x < 0 ? -1 : 1);
-        int zDir = (rayDirection.z < 0 ? -1 : 1);
-
-        Result result(true, Vector3::ZERO);
-        Real dummyHighValue = (Real)mSize * 10000.0f;
-
-
-        while (cur.y >= (minHeight - 1e-3) && cur.y <= (maxHeight + 1e-3))
+        // find where the ray leaves the bounds again
+        Real exitDist = std::numeric_limits<Real>::max();
+        for (int i = 0; i < 3; ++i)
         {
-            if (quadX < 0 || quadX >= (int)mSize-1 || quadZ < 0 || quadZ >= (int)mSize-1)
-                break;
-
-            result = checkQuadIntersection(quadX, quadZ, localRay);
-            if (result.first)
-                break;
-
-            // determine next quad to test
-            Real xDist = Math::RealEqual(rayDirection.x, 0.0) ? dummyHighValue : 
-                (quadX - cur.x + flipX) / rayDirection.x;
-            Real zDist = Math::RealEqual(rayDirection.z, 0.0) ? dummyHighValue : 
-                (quadZ - cur.z + flipZ) / rayDirection.z;
-            if (xDist < zDist)
-            {
-                quadX += xDir;
-                cur += rayDirection * xDist;
-            }
-            else
-            {
-                quadZ += zDir;
-                cur += rayDirection * zDist;
-            }
-
+            if (rayDirection[i] > 0)
+                exitDist = std::min(exitDist, (aabb.getMaximum()[i] - rayOrigin[i]) / rayDirection[i]);
+            else if (rayDirection[i] < 0)
+                exitDist = std::min(exitDist, (aabb.getMinimum()[i] - rayOrigin[i]) / rayDirection[i]);
         }
 
+        Result result = rayMarchHeightBounds(localRay, aabbTest.second, exitDist);
+
         if (result.first)
         {
             // transform the point of intersection back to world space
@@ -2484,6 +2522,197 @@ namespace Ogre
         return result;
     }
     //---------------------------------------------------------------------
+    std::pair<bool, Vector3> Terrain::rayMarchHeightBounds(const Ray& ray, Real start, Real end)
+    {
+        // the top level is a single tile covering all quads
+        return rayMarchTile(ray, static_cast<int>(mHeightBounds.size()) - 1, 0, 0, start, end);
+    }
+    //---------------------------------------------------------------------
+    std::pair<bool, Vector3> Terrain::rayMarchTile(const Ray& ray, int level, long tx, long tz,
+        Real start, Real end)
+    {
+        const Vector3& origin = ray.getOrigin();
+        const Vector3& dir = ray.getDirection();
+        const HeightBoundsLevel& bounds = mHeightBounds[level];
+
+        // skip the tile if the ray passes above or below it
+        const float* minMax = &bounds.bounds[(tz * bounds.size + tx) * 2];
+        Real y0 = origin.y + dir.y * start;
+        Real y1 = origin.y + dir.y * end;
+        if (std::max(y0, y1) < minMax[0] - 1e-3 || std::min(y0, y1) > minMax[1] + 1e-3)
+            return std::pair<bool, Vector3>(false, Vector3::ZERO);
+
+        long tileSize = HEIGHT_BOUNDS_TILE_SIZE << level;
+        if (level == 0)
+        {
+            const long numQuads = mSize - 1;
+            return rayMarchQuads(ray, tx * tileSize, tz * tileSize,
+                std::min((tx + 1) * tileSize, numQuads), std::min((tz + 1) * tileSize, numQuads),
+                start, end);
+        }
+
+        // Visit the (up to) four tiles below in the order the ray crosses them. Which
+        // one comes next follows from the distances to the middle lines, not from a
+        // position along the ray, so every tile is left after a fixed number of steps.
+        const HeightBoundsLevel& below = mHeightBounds[level - 1];
+        long half = tileSize / 2;
+        Real splitX = dir.x != 0 ? ((tx * 2 + 1) * half - origin.x) / dir.x : std::numeric_limits<Real>::max();
+        Real splitZ = dir.z != 0 ? ((tz * 2 + 1) * half - origin.z) / dir.z : std::numeric_limits<Real>::max();
+        long cx = dir.x != 0 ? ((start < splitX) == (dir.x > 0) ? 0 : 1) : (origin.x < (tx * 2 + 1) * half ? 0 : 1);
+        long cz = dir.z != 0 ? ((start < splitZ) == (dir.z > 0) ? 0 : 1) : (origin.z < (tz * 2 + 1) * half ? 0 : 1);
+        bool crossX = splitX > start && splitX < end;
+        bool crossZ = splitZ > start && splitZ < end;
+
+        Real segStart = start;
+        for (int step = 0; step < 3; ++step)
+        {
+            // the next middle line crossed, if any
+            bool stepX = crossX && (!crossZ || splitX <= splitZ);
+            bool stepZ = crossZ && !stepX;
+            Real segEnd = stepX ? splitX : (stepZ ? splitZ : end);
+
+            long childX = tx * 2 + cx;
+            long childZ = tz * 2 + cz;
+            if (childX < below.size && childZ < below.size)
+            {
+                std::pair<bool, Vector3> result = rayMarchTile(ray, level - 1, childX, childZ, segStart, segEnd);
+                if (result.first)
+                    return result;
+            }
+
+            if (stepX)
+            {
+                crossX = false;
+                cx = 1 - cx;
+            }
+            else if (stepZ)
+            {
+                crossZ = false;
+                cz = 1 - cz;
+            }
+            else
+                break;
+            segStart = segEnd;
+        }
+
+        return std::pair<bool, Vector3>(false, Vector3::ZERO);
+    }
+    //---------------------------------------------------------------------
+    std::pair<bool, Vector3> Terrain::rayMarchQuads(const Ray& ray, long left, long top,
+        long right, long bottom, Real start, Real end)
+    {
+        const Vector3& origin = ray.getOrigin();
+        const Vector3& dir = ray.getDirection();
+
+        // 2D DDA over the quads, stepping the quad indices
+        Vector3 pos = ray.getPoint(start);
+        long quadX = Math::Clamp(static_cast<long>(Math::Floor(pos.x)), left, right - 1);
+        long quadZ = Math::Clamp(static_cast<long>(Math::Floor(pos.z)), top, bottom - 1);
+        long stepX = dir.x > 0 ? 1 : -1;
+        long stepZ = dir.z > 0 ? 1 : -1;
+
+        while (quadX >= left && quadX < right && quadZ >= top && quadZ < bottom)
+        {
+            std::pair<bool, Vector3> result = checkQuadIntersection(quadX, quadZ, ray);
+            if (result.first)
+                return result;
+
+            Real nextX = dir.x != 0 ? (quadX + (stepX > 0 ? 1 : 0) - origin.x) / dir.x
+                                    : std::numeric_limits<Real>::max();
+            Real nextZ = dir.z != 0 ? (quadZ + (stepZ > 0 ? 1 : 0) - origin.z) / dir.z
+                                    : std::numeric_limits<Real>::max();
+            if (std::min(nextX, nextZ) >= end)
+                break;
+            if (nextX < nextZ)
+                quadX += stepX;
+            else
+                quadZ += stepZ;
+        }
+
+        return std::pair<bool, Vector3>(false, Vector3::ZERO);
+    }
+    //---------------------------------------------------------------------
+    void Terrain::updateHeightBounds(const Rect& rect)
+    {
+        const long numQuads = mSize - 1;
+        const long numTiles = (numQuads + HEIGHT_BOUNDS_TILE_SIZE - 1) / HEIGHT_BOUNDS_TILE_SIZE;
+        // the quads using the vertices of the rect
+        Rect quadRect(std::max(rect.left - 1, 0L), std::max(rect.top - 1, 0L),
+            std::min(rect.right, numQuads), std::min(rect.bottom, numQuads));
+
+        if (mHeightBounds.empty() || mHeightBounds[0].size != numTiles)
+        {
+            mHeightBounds.clear();
+            for (long size = numTiles; ; size = (size + 1) / 2)
+            {
+                mHeightBounds.push_back(HeightBoundsLevel());
+                mHeightBounds.back().size = size;
+                mHeightBounds.back().bounds.resize(size * size * 2);
+                if (size == 1)
+                    break;
+            }
+            quadRect = Rect(0, 0, numQuads, numQuads);
+        }
+        if (quadRect.left >= quadRect.right || quadRect.top >= quadRect.bottom)
+            return;
+
+        // tiles of the first level from the heights of their vertices
+        Rect tileRect(quadRect.left / HEIGHT_BOUNDS_TILE_SIZE, quadRect.top / HEIGHT_BOUNDS_TILE_SIZE,
+            (quadRect.right - 1) / HEIGHT_BOUNDS_TILE_SIZE + 1, (quadRect.bottom - 1) / HEIGHT_BOUNDS_TILE_SIZE + 1);
+        HeightBoundsLevel& firstLevel = mHeightBounds[0];
+        for (long tz = tileRect.top; tz < tileRect.bottom; ++tz)
+        {
+            long top = tz * HEIGHT_BOUNDS_TILE_SIZE;
+            long bottom = std::min(top + HEIGHT_BOUNDS_TILE_SIZE, numQuads);
+            for (long tx = tileRect.left; tx < tileRect.right; ++tx)
+            {
+                long left = tx * HEIGHT_BOUNDS_TILE_SIZE;
+                long right = std::min(left + HEIGHT_BOUNDS_TILE_SIZE, numQuads);
+                float minHeight = *getHeightData(left, top);
+                float maxHeight = minHeight;
+                for (long y = top; y <= bottom; ++y)
+                {
+                    const float* pHeight = getHeightData(left, y);
+                    for (long x = left; x <= right; ++x, ++pHeight)
+                    {
+                        minHeight = std::min(minHeight, *pHeight);
+                        maxHeight = std::max(maxHeight, *pHeight);
+                    }
+                }
+                float* minMax = &firstLevel.bounds[(tz * firstLevel.size + tx) * 2];
+                minMax[0] = minHeight;
+                minMax[1] = maxHeight;
+            }
+        }
+
+        // further levels from the tiles below
+        for (size_t level = 1; level < mHeightBounds.size(); ++level)
+        {
+            const HeightBoundsLevel& below = mHeightBounds[level - 1];
+            HeightBoundsLevel& bounds = mHeightBounds[level];
+            tileRect = Rect(tileRect.left / 2, tileRect.top / 2,
+                (tileRect.right - 1) / 2 + 1, (tileRect.bottom - 1) / 2 + 1);
+            for (long tz = tileRect.top; tz < tileRect.bottom; ++tz)
+            {
+                for (long tx = tileRect.left; tx < tileRect.right; ++tx)
+                {
+                    float* minMax = &bounds.bounds[(tz * bounds.size + tx) * 2];
+                    minMax[0] = std::numeric_limits<float>::max();
+                    minMax[1] = -std::numeric_limits<float>::max();
+                    for (long z = tz * 2; z < std::min(tz * 2 + 2, below.size); ++z)
+                    {
+                        for (long x = tx * 2; x < std::min(tx * 2 + 2, below.size); ++x)
+                        {
+                            const float* child = &below.bounds[(z * below.size + x) * 2];
+                            minMax[0] = std::min(minMax[0], child[0]);
+                            minMax[1] = std::max(minMax[1], child[1]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
     std::pair<bool, Vector3> Terrain::checkQuadIntersection(int x, int z, const Ray& ray)
     {
         // build the two planes belonging to the quad's triangles
@@ -3353,6 +3582,25 @@ namespace Ogre
         PixelBox* pixbox = OGRE_NEW PixelBox(static_cast<uint32>(widenedRect.width()),
                                              static_cast<uint32>(widenedRect.height()), 1, PF_BYTE_RGB, pData);
 
+        // rows don't depend on each other. Derived data is calculated inside a request
+        // of the Root WorkQueue, whose threads share the rows.
+        NormalsJob job;
+        job.rect = widenedRect;
+        job.data = pData;
+        WorkQueue::parallelForDefault(widenedRect.height(), [this, &job](size_t row) {
+            calculateNormalRows(&job, (long)row, (long)row + 1);
+        });
+
+        finalRect = widenedRect;
+
+        return pixbox;
+    }
+    //---------------------------------------------------------------------
+    void Terrain::calculateNormalRows(void* jobData, long begin, long end)
+    {
+        const NormalsJob& job = *static_cast<NormalsJob*>(jobData);
+        const Rect& rect = job.rect;
+
         // Evaluate normal like this
         //  3---2---1
         //  | \ | / |
@@ -3361,24 +3609,88 @@ namespace Ogre
         //  5---6---7
 
         Plane plane;
-        for (long y = widenedRect.top; y < widenedRect.bottom; ++y)
+        for (long y = rect.top + begin; y < rect.top + end; ++y)
         {
-            for (long x = widenedRect.left; x < widenedRect.right; ++x)
+            // invert the Y to deal with image space
+            uint8* pRow = job.data + (rect.bottom - y - 1) * rect.width() * 3;
+
+            long x = rect.left;
+            while (x < rect.right)
             {
+                if (y > 0 && y < mSize - 1 && x > 0 && x < mSize - 1)
+                {
+                    // Inner vertices don't need neighbours, take their heights directly.
+                    // The fan is the same for all, so work in terrain axes and convert
+                    // the sum, which the alignment only permutes.
+                    long innerEnd = std::min(rect.right, (long)mSize - 1);
+                    const float* rows[3] = {
+                        getHeightData(0, y - 1), getHeightData(0, y), getHeightData(0, y + 1) };
+                    Vector3 fanEdges[8];
+                    for (int i = 0; i < 8; ++i)
+                        fanEdges[i] = Vector3(NORMAL_FAN_X[i] * mScale, NORMAL_FAN_Y[i] * mScale, 0);
+#if __OGRE_HAVE_SSE
+                    for (; x + 4 <= innerEnd; x += 4)
+                    {
+                        const __m128 centre = _mm_loadu_ps(rows[1] + x);
+                        __m128 heights[8];
+                        for (int i = 0; i < 8; ++i)
+                            heights[i] = _mm_sub_ps(_mm_loadu_ps(rows[NORMAL_FAN_Y[i] + 1] + x + NORMAL_FAN_X[i]), centre);
+
+                        __m128 sum[3] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+                        for (int i = 0; i < 8; ++i)
+                        {
+                            int j = (i + 1) % 8;
+                            const Vector3& e0 = fanEdges[i];
+                            const Vector3& e1 = fanEdges[j];
+                            // e0 x e1, with the heights in z
+                            __m128 n[3];
+                            n[0] = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(e0.y), heights[j]),
+                                              _mm_mul_ps(heights[i], _mm_set1_ps(e1.y)));
+                            n[1] = _mm_sub_ps(_mm_mul_ps(heights[i], _mm_set1_ps(e1.x)),
+                                              _mm_mul_ps(_mm_set1_ps(e0.x), heights[j]));
+                            n[2] = _mm_set1_ps(e0.x * e1.y - e0.y * e1.x);
+                            normaliseSSE(n);
+                            for (int k = 0; k < 3; ++k)
+                                sum[k] = _mm_add_ps(sum[k], n[k]);
+                        }
+                        normaliseSSE(sum);
+
+                        float normals[3][4];
+                        for (int k = 0; k < 3; ++k)
+                            _mm_storeu_ps(normals[k], sum[k]);
+                        for (int v = 0; v < 4; ++v)
+                        {
+                            Vector3 normal = convertTerrainToWorldAxes(
+                                Vector3(normals[0][v], normals[1][v], normals[2][v]));
+                            storeNormal(normal, pRow + (x + v - rect.left) * 3);
+                        }
+                    }
+#endif
+                    for (; x < innerEnd; ++x)
+                    {
+                        Vector3 cumulativeNormal = Vector3::ZERO;
+                        Vector3 edges[8];
+                        for (int i = 0; i < 8; ++i)
+                        {
+                            edges[i] = fanEdges[i];
+                            edges[i].z = rows[NORMAL_FAN_Y[i] + 1][x + NORMAL_FAN_X[i]] - rows[1][x];
+                        }
+                        for (int i = 0; i < 8; ++i)
+                            cumulativeNormal += edges[i].crossProduct(edges[(i+1)%8]).normalisedCopy();
+                        cumulativeNormal.normalise();
+                        storeNormal(convertTerrainToWorldAxes(cumulativeNormal), pRow + (x - rect.left) * 3);
+                    }
+                    continue;
+                }
+
                 Vector3 cumulativeNormal = Vector3::ZERO;
 
                 // Build points to sample
                 Vector3 centrePoint;
                 Vector3 adjacentPoints[8];
-                getPointFromSelfOrNeighbour(x  , y,   &centrePoint);
-                getPointFromSelfOrNeighbour(x+1, y,   &adjacentPoints[0]);
-                getPointFromSelfOrNeighbour(x+1, y+1, &adjacentPoints[1]);
-                getPointFromSelfOrNeighbour(x,   y+1, &adjacentPoints[2]);
-                getPointFromSelfOrNeighbour(x-1, y+1, &adjacentPoints[3]);
-                getPointFromSelfOrNeighbour(x-1, y,   &adjacentPoints[4]);
-                getPointFromSelfOrNeighbour(x-1, y-1, &adjacentPoints[5]);
-                getPointFromSelfOrNeighbour(x,   y-1, &adjacentPoints[6]);
-                getPointFromSelfOrNeighbour(x+1, y-1, &adjacentPoints[7]);
+                getPointFromSelfOrNeighbour(x, y, &centrePoint);
+                for (int i = 0; i < 8; ++i)
+                    getPointFromSelfOrNeighbour(x + NORMAL_FAN_X[i], y + NORMAL_FAN_Y[i], &adjacentPoints[i]);
 
                 for (int i = 0; i < 8; ++i)
                 {
@@ -3390,22 +3702,10 @@ namespace Ogre
                 cumulativeNormal.normalise();
 
                 // encode as RGB, object space
-                // invert the Y to deal with image space
-                long storeX = x - widenedRect.left;
-                long storeY = widenedRect.bottom - y - 1;
-
-                uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX) * 3;
-                *pStore++ = static_cast<uint8>((cumulativeNormal.x + 1.0f) * 0.5f * 255.0f);
-                *pStore++ = static_cast<uint8>((cumulativeNormal.y + 1.0f) * 0.5f * 255.0f);
-                *pStore++ = static_cast<uint8>((cumulativeNormal.z + 1.0f) * 0.5f * 255.0f);
-
-
+                storeNormal(cumulativeNormal, pRow + (x - rect.left) * 3);
+                ++x;
             }
         }
-
-        finalRect = widenedRect;
-
-        return pixbox;
     }
     //---------------------------------------------------------------------
     void Terrain::finaliseNormals(const Ogre::Rect &rect, Ogre::PixelBox *normalsBox)
@@ -3537,11 +3837,172 @@ namespace Ogre
         PixelBox* pixbox = OGRE_NEW PixelBox(static_cast<uint32>(widenedRect.width()),
                                              static_cast<uint32>(widenedRect.height()), 1, PF_L8, pData);
 
-        Real heightPad = (getMaxHeight() - getMinHeight()) * 1.0e-3f;
+        LightmapJob job;
+        job.rect = widenedRect;
+        job.data = pData;
+        job.lightVec = lightVec;
+        job.heightPad = (getMaxHeight() - getMinHeight()) * 1.0e-3f;
+
+        long width = widenedRect.width();
+        long height = widenedRect.height();
+        if (width <= 0 || height <= 0)
+            return pixbox;
+
+        Vector3 toLight = convertWorldToTerrainAxes(-lightVec);
+        Real horizontal = Math::Sqrt(toLight.x * toLight.x + toLight.y * toLight.y);
+        if (horizontal < toLight.length() * 1.0e-3f)
+        {
+            // light from straight above or below, nothing to sweep along
+            WorkQueue::parallelForDefault(height, [this, &job](size_t row) {
+                calculateLightmapRows(&job, (long)row, (long)row + 1);
+            });
+            return pixbox;
+        }
+
+        // Sweep the rect towards the light: the shadow height of a texel, the lowest
+        // height the light reaches there, follows from the height and shadow height of the
+        // texel one step towards the light. That makes the cost linear instead of casting
+        // a ray per texel. Only the texels whose step leaves the rect cast rays, to pick up
+        // shadows from the rest of this terrain and its neighbours. A step is one texel
+        // along the major axis, and a fraction of one along the minor axis.
+        bool alongY = Math::Abs(toLight.y) >= Math::Abs(toLight.x);
+        Real major = alongY ? toLight.y : toLight.x;
+        Real minorStep = (alongY ? toLight.x : toLight.y) / Math::Abs(major);
+        long majorDir = major > 0 ? 1 : -1;
+        Real texelWorldSize = mWorldSize / (mLightmapSizeActual - 1);
+        Real rise = toLight.z / horizontal * Math::Sqrt(1 + minorStep * minorStep) * texelWorldSize;
+
+        long majorBegin = alongY ? widenedRect.top : widenedRect.left;
+        long majorEnd = alongY ? widenedRect.bottom : widenedRect.right;
+        long minorBegin = alongY ? widenedRect.left : widenedRect.top;
+        long minorEnd = alongY ? widenedRect.right : widenedRect.bottom;
+        long majorStride = alongY ? width : 1;
+        long minorStride = alongY ? 1 : width;
+
+        job.heights.resize(width * height);
+        job.shadowHeights.resize(width * height);
+        for (long y = widenedRect.top; y < widenedRect.bottom; ++y)
+        {
+            for (long x = widenedRect.left; x < widenedRect.right; ++x)
+            {
+                long i = (y - widenedRect.top) * width + x - widenedRect.left;
+                job.heights[i] = getHeightAtTerrainPosition(
+                    (float)x / (float)(mLightmapSizeActual-1), (float)y / (float)(mLightmapSizeActual-1));
+
+                long ma = alongY ? y : x;
+                Real mi = (alongY ? x : y) + minorStep;
+                if (ma + majorDir < majorBegin || ma + majorDir >= majorEnd ||
+                    mi < minorBegin || mi > minorEnd - 1)
+                    job.edges.push_back(i);
+            }
+        }
+        WorkQueue::parallelForDefault(job.edges.size(), [this, &job](size_t e) {
+            calculateLightmapEdges(&job, (long)e, (long)e + 1);
+        });
+
+        std::vector<long>::const_iterator edge = job.edges.begin();
+        std::vector<bool> isEdge(width * height, false);
+        for (; edge != job.edges.end(); ++edge)
+            isEdge[*edge] = true;
+
+        // lines closest to the light first
+        for (long ma = majorDir > 0 ? majorEnd - 1 : majorBegin; ma >= majorBegin && ma < majorEnd; ma -= majorDir)
+        {
+            for (long mi = minorBegin; mi < minorEnd; ++mi)
+            {
+                long i = (ma - majorBegin) * majorStride + (mi - minorBegin) * minorStride;
+                if (isEdge[i])
+                    continue;
+
+                Real pos = mi + minorStep;
+                long floorPos = static_cast<long>(Math::Floor(pos));
+                Real frac = pos - floorPos;
+                long up0 = (ma + majorDir - majorBegin) * majorStride + (floorPos - minorBegin) * minorStride;
+                long up1 = frac > 0 ? up0 + minorStride : up0;
+                // what blocks the light at the two texels towards it
+                Real block0 = std::max(job.heights[up0], job.shadowHeights[up0]);
+                Real block1 = std::max(job.heights[up1], job.shadowHeights[up1]);
+                job.shadowHeights[i] = static_cast<float>(block0 + (block1 - block0) * frac - rise);
+            }
+        }
 
         for (long y = widenedRect.top; y < widenedRect.bottom; ++y)
         {
             for (long x = widenedRect.left; x < widenedRect.right; ++x)
+            {
+                long i = (y - widenedRect.top) * width + x - widenedRect.left;
+                bool lit = job.shadowHeights[i] <= job.heights[i] + job.heightPad;
+
+                // encode as L8
+                // invert the Y to deal with image space
+                long storeX = x - widenedRect.left;
+                long storeY = widenedRect.bottom - y - 1;
+
+                uint8* pStore = pData + ((storeY * width) + storeX);
+                *pStore = lit ? 255 : 0;
+            }
+        }
+
+        return pixbox;
+    }
+    //---------------------------------------------------------------------
+    void Terrain::calculateLightmapEdges(void* jobData, long begin, long end)
+    {
+        LightmapJob& job = *static_cast<LightmapJob*>(jobData);
+        const Rect& rect = job.rect;
+        Real searchStep = std::max((getMaxHeight() - getMinHeight()) * 0.05f, 1.0f);
+
+        for (long e = begin; e < end; ++e)
+        {
+            long i = job.edges[e];
+            float Tx = (float)(rect.left + i % rect.width()) / (float)(mLightmapSizeActual-1);
+            float Ty = (float)(rect.top + i / rect.width()) / (float)(mLightmapSizeActual-1);
+
+            // Cascade into neighbours when casting, but don't travel further
+            // than world size
+            Vector3 wpos = Vector3::ZERO;
+            Real lowest = job.heights[i] + job.heightPad;
+            getPosition(Tx, Ty, lowest, &wpos);
+            if (!rayIntersects(Ray(wpos + getPosition(), -job.lightVec), true, mWorldSize).first)
+            {
+                // lit from its own height, whatever is lower does not matter
+                job.shadowHeights[i] = -std::numeric_limits<float>::max();
+                continue;
+            }
+
+            // find a lit height above, then narrow down the lowest one
+            Real step = searchStep;
+            Real highest = lowest + step;
+            for (int n = 0; n < 16; ++n)
+            {
+                getPosition(Tx, Ty, highest, &wpos);
+                if (!rayIntersects(Ray(wpos + getPosition(), -job.lightVec), true, mWorldSize).first)
+                    break;
+                lowest = highest;
+                step *= 2;
+                highest += step;
+            }
+            for (int n = 0; n < 8; ++n)
+            {
+                Real middle = (lowest + highest) * 0.5f;
+                getPosition(Tx, Ty, middle, &wpos);
+                if (rayIntersects(Ray(wpos + getPosition(), -job.lightVec), true, mWorldSize).first)
+                    lowest = middle;
+                else
+                    highest = middle;
+            }
+            job.shadowHeights[i] = static_cast<float>(highest);
+        }
+    }
+    //---------------------------------------------------------------------
+    void Terrain::calculateLightmapRows(void* jobData, long begin, long end)
+    {
+        const LightmapJob& job = *static_cast<LightmapJob*>(jobData);
+        const Rect& rect = job.rect;
+
+        for (long y = rect.top + begin; y < rect.top + end; ++y)
+        {
+            for (long x = rect.left; x < rect.right; ++x)
             {
                 float litVal = 1.0f;
 
@@ -3552,10 +4013,10 @@ namespace Ogre
                 // get world space point
                 // add a little height padding to stop shadowing self
                 Vector3 wpos = Vector3::ZERO;
-                getPosition(Tx, Ty, getHeightAtTerrainPosition(Tx, Ty) + heightPad, &wpos);
+                getPosition(Tx, Ty, getHeightAtTerrainPosition(Tx, Ty) + job.heightPad, &wpos);
                 wpos += getPosition();
                 // build ray, cast backwards along light direction
-                Ray ray(wpos, -lightVec);
+                Ray ray(wpos, -job.lightVec);
 
                 // Cascade into neighbours when casting, but don't travel further
                 // than world size
@@ -3566,18 +4027,13 @@ namespace Ogre
 
                 // encode as L8
                 // invert the Y to deal with image space
-                long storeX = x - widenedRect.left;
-                long storeY = widenedRect.bottom - y - 1;
+                long storeX = x - rect.left;
+                long storeY = rect.bottom - y - 1;
 
-                uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX);
+                uint8* pStore = job.data + ((storeY * rect.width()) + storeX);
                 *pStore = (unsigned char)(litVal * 255.0);
-
             }
         }
-
-        return pixbox;
-
-
     }
     //---------------------------------------------------------------------
     void Terrain::finaliseLightmap(const Rect& rect, PixelBox* lightmapBox)
@@ -583,6 +583,15 @@ namespace Ogre
 
     }
     //---------------------------------------------------------------------
+    void TerrainGroup::rayIntersects(const std::vector<Ray>& rays, std::vector<RayResult>& results,
+        Real distanceLimit /* = 0*/) const
+    {
+        results.assign(rays.size(), RayResult(false, 0, Vector3::ZERO));
+        WorkQueue::parallelForDefault(rays.size(), [this, &rays, &results, distanceLimit](size_t i) {
+            results[i] = rayIntersects(rays[i], distanceLimit);
+        });
+    }
+    //---------------------------------------------------------------------
     void TerrainGroup::boxIntersects(const AxisAlignedBox& box, TerrainList* resultList) const
     {
         resultList->clear();
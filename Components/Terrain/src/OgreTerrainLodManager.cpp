@@ -36,7 +36,97 @@ namespace Ogre
 {
     const uint16 TerrainLodManager::WORKQUEUE_LOAD_LOD_DATA_REQUEST = 1;
     const uint32 TerrainLodManager::TERRAINLODDATA_CHUNK_ID = StreamSerialiser::makeIdentifier("TLDA");
-    const uint16 TerrainLodManager::TERRAINLODDATA_CHUNK_VERSION = 1;
+    const uint16 TerrainLodManager::TERRAINLODDATA_CHUNK_VERSION = 2;
+
+    namespace
+    {
+        /// Side of the squares of vertices which share a quantisation range
+        const uint16 QUANTISE_TILE_SIZE = 64;
+
+        /** Finds the tile of every sample of a LOD level, in the order separateData
+            stores them.
+        @return The number of tiles
+        */
+        size_t getSampleTiles(uint16 size, uint16 numLodLevels, uint16 lodLevel, std::vector<uint16>& tiles)
+        {
+            uint16 tilesPerSide = static_cast<uint16>(std::max(1, (size - 1) / QUANTISE_TILE_SIZE));
+            unsigned int inc = 1 << lodLevel;
+            unsigned int prev = 1 << (lodLevel + 1);
+            bool lowest = lodLevel == numLodLevels - 1;
+
+            tiles.clear();
+            for (uint16 y = 0; y < size; y += inc)
+            {
+                uint16 row = std::min<uint16>(y / QUANTISE_TILE_SIZE, tilesPerSide - 1) * tilesPerSide;
+                for (uint16 x = 0; x < size-1; x += inc)
+                    if (lowest || (x % prev != 0) || (y % prev != 0))
+                        tiles.push_back(row + std::min<uint16>(x / QUANTISE_TILE_SIZE, tilesPerSide - 1));
+                if (lowest || (y % prev) != 0)
+                    tiles.push_back(row + tilesPerSide - 1);
+                if (y+inc > size)
+                    break;
+            }
+            return static_cast<size_t>(tilesPerSide) * tilesPerSide;
+        }
+
+        /** Writes values as 16 bit steps over the range of their tile, each as the
+            difference to the previous one, so that neighbouring samples of smooth
+            terrain come out as small numbers which deflate well.
+        */
+        void writeQuantised(StreamSerialiser& stream, const float* data,
+                            const std::vector<uint16>& tiles, size_t numTiles)
+        {
+            std::vector<float> minVals(numTiles, std::numeric_limits<float>::max());
+            std::vector<float> maxVals(numTiles, -std::numeric_limits<float>::max());
+            for (size_t i = 0; i < tiles.size(); ++i)
+            {
+                minVals[tiles[i]] = std::min(minVals[tiles[i]], data[i]);
+                maxVals[tiles[i]] = std::max(maxVals[tiles[i]], data[i]);
+            }
+            std::vector<float> steps(numTiles, 1.0f);
+            for (size_t t = 0; t < numTiles; ++t)
+            {
+                // tiles without samples at this level
+                if (minVals[t] > maxVals[t])
+                    minVals[t] = maxVals[t] = 0;
+                float step = (maxVals[t] - minVals[t]) / 65535.0f;
+                if (step > 0)
+                    steps[t] = step;
+            }
+            stream.write(&minVals[0], numTiles);
+            stream.write(&steps[0], numTiles);
+
+            std::vector<uint16> residuals(tiles.size());
+            uint16 prev = 0;
+            for (size_t i = 0; i < tiles.size(); ++i)
+            {
+                float q = (data[i] - minVals[tiles[i]]) / steps[tiles[i]] + 0.5f;
+                uint16 quantised = static_cast<uint16>(Math::Clamp(q, 0.0f, 65535.0f));
+                residuals[i] = static_cast<uint16>(quantised - prev);
+                prev = quantised;
+            }
+            if (!residuals.empty())
+                stream.write(&residuals[0], residuals.size());
+        }
+
+        void readQuantised(StreamSerialiser& stream, float* data,
+                           const std::vector<uint16>& tiles, size_t numTiles)
+        {
+            std::vector<float> minVals(numTiles), steps(numTiles);
+            stream.read(&minVals[0], numTiles);
+            stream.read(&steps[0], numTiles);
+
+            std::vector<uint16> residuals(tiles.size());
+            if (!residuals.empty())
+                stream.read(&residuals[0], residuals.size());
+            uint16 q = 0;
+            for (size_t i = 0; i < tiles.size(); ++i)
+            {
+                q = static_cast<uint16>(q + residuals[i]);
+                data[i] = minVals[tiles[i]] + q * steps[tiles[i]];
+            }
+        }
+    }
 
     TerrainLodManager::TerrainLodManager(Terrain* t, DataStreamPtr& stream)
         : mTerrain(t)
@@ -307,19 +397,55 @@ namespace Ogre
     void TerrainLodManager::saveLodData(StreamSerialiser& stream, Terrain* terrain)
     {
         uint16 numLodLevels = terrain->getNumLodLevels();
+        bool quantise = TerrainGlobalOptions::getSingleton().getQuantiseSavedHeights();
 
         LodsData lods;
         separateData(terrain->mHeightData, terrain->getSize(), numLodLevels, lods);
         separateData(terrain->mDeltaData, terrain->getSize(), numLodLevels, lods);
 
         for (int level = numLodLevels - 1; level >=0; level--)
+            writeLodLevel(stream, &(lods[level][0]), terrain->getSize(), numLodLevels, level, quantise);
+    }
+
+    void TerrainLodManager::writeLodLevel(StreamSerialiser& stream, const float* data, uint16 size,
+                                          uint16 numLodLevels, uint16 lodLevel, bool quantise)
+    {
+        std::vector<uint16> tiles;
+        size_t numTiles = getSampleTiles(size, numLodLevels, lodLevel, tiles);
+
+        // version 1 holds the plain floats
+        stream.writeChunkBegin(TERRAINLODDATA_CHUNK_ID, quantise ? TERRAINLODDATA_CHUNK_VERSION : 1);
+        stream.startDeflate();
+        if (quantise)
+        {
+            // heights, then deltas, each with their own ranges
+            writeQuantised(stream, data, tiles, numTiles);
+            writeQuantised(stream, data + tiles.size(), tiles, numTiles);
+        }
+        else
+            stream.write(data, 2 * tiles.size());
+        stream.stopDeflate();
+        stream.writeChunkEnd(TERRAINLODDATA_CHUNK_ID);
+    }
+
+    void TerrainLodManager::readLodLevel(StreamSerialiser& stream, float* data, uint16 size,
+                                         uint16 numLodLevels, uint16 lodLevel)
+    {
+        std::vector<uint16> tiles;
+        size_t numTiles = getSampleTiles(size, numLodLevels, lodLevel, tiles);
+
+        const StreamSerialiser::Chunk *c = stream.readChunkBegin(TERRAINLODDATA_CHUNK_ID,
+                TERRAINLODDATA_CHUNK_VERSION);
+        stream.startDeflate(c->length);
+        if (c->version > 1)
         {
-            stream.writeChunkBegin(TERRAINLODDATA_CHUNK_ID, TERRAINLODDATA_CHUNK_VERSION);
-            stream.startDeflate();
-            stream.write(&(lods[level][0]), lods[level].size());
-            stream.stopDeflate();
-            stream.writeChunkEnd(TERRAINLODDATA_CHUNK_ID);
+            readQuantised(stream, data, tiles, numTiles);
+            readQuantised(stream, data + tiles.size(), tiles, numTiles);
         }
+        else
+            stream.read(data, 2 * tiles.size());
+        stream.stopDeflate();
+        stream.readChunkEnd(TERRAINLODDATA_CHUNK_ID);
     }
 
     void TerrainLodManager::readLodData(uint16 lowerLodBound, uint16 higherLodBound)
@@ -356,12 +482,7 @@ namespace Ogre
                 uint dataSize = 2 * mTerrain->getGeoDataSizeAtLod(level);
 
                 // reach and read the target lod data
-                const StreamSerialiser::Chunk *c = stream.readChunkBegin(TERRAINLODDATA_CHUNK_ID,
-                        TERRAINLODDATA_CHUNK_VERSION);
-                stream.startDeflate(c->length);
-                stream.read(lodData, dataSize);
-                stream.stopDeflate();
-                stream.readChunkEnd(TERRAINLODDATA_CHUNK_ID);
+                readLodLevel(stream, lodData, mTerrain->getSize(), numLodLevels, level);
 
                 fillBufferAtLod(level, lodData, dataSize);
             }
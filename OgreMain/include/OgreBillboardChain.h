@@ -300,7 +300,7 @@ namespace Ogre {
         mutable bool mBoundsDirty;
         /// Is the index buffer dirty?
         bool mIndexContentDirty;
-        /// Is the vertex buffer dirty?
+        /// Is the whole vertex buffer dirty? Single chains are tracked by ChainSegment::vertexDirty
         bool mVertexContentDirty;
         /// AABB
         mutable AxisAlignedBox mAABB;
@@ -314,6 +314,10 @@ namespace Ogre {
         Real mOtherTexCoordRange[2];
         /// Camera last used to build the vertex buffer
         Camera *mVertexCameraUsed;
+        /// Camera position in local space last used to build the vertex buffer
+        Vector3 mVertexEyePosition;
+        /// Copy of the vertex buffer in which dirty chains are rebuilt before it is uploaded
+        std::vector<char> mVertexCopy;
         /// When true, the billboards always face the camera
         bool mFaceCamera;
         /// Used when mFaceCamera == false; determines the billboard's "normal". i.e.
@@ -340,6 +344,8 @@ namespace Ogre {
             size_t head;
             /// The 'tail' of the chain, relative to start
             size_t tail;
+            /// Whether the vertices of this chain need rebuilding
+            bool vertexDirty;
         };
         typedef std::vector<ChainSegment> ChainSegmentList;
         ChainSegmentList mChainSegmentList;
@@ -352,6 +358,16 @@ namespace Ogre {
         virtual void setupBuffers(void);
         /// Update the contents of the vertex buffer
         virtual void updateVertexBuffer(Camera* cam);
+        /** Generate the vertices of a single chain.
+        @param pSegmentBase Pointer to the first vertex of the chain's subset of the buffer
+        @param seg The chain to generate
+        @param eyePos Camera position in local space
+        @param colourType Packed colour format of the render system
+        */
+        void updateSegmentVertices(char* pSegmentBase, const ChainSegment& seg,
+            const Vector3& eyePos, VertexElementType colourType);
+        /// Flag a single chain's vertices for rebuilding
+        void _markChainDirty(size_t chainIndex) { mChainSegmentList[chainIndex].vertexDirty = true; }
         /// Update the contents of the index buffer
         virtual void updateIndexBuffer(void);
         virtual void updateBoundingBox(void) const;
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreParticleSystemRenderer.h"
 #include "OgreBillboardSet.h"
+#include "OgreBillboard.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre {
@@ -54,6 +55,10 @@ namespace Ogre {
     protected:
         /// The billboard set that's doing the rendering
         BillboardSet* mBillboardSet;
+
+        typedef std::vector<Billboard> BillboardList;
+        /// Per-frame billboard data, kept to avoid reallocation
+        BillboardList mBillboards;
     public:
         BillboardParticleRenderer();
         ~BillboardParticleRenderer();
@@ -255,6 +260,37 @@ namespace Ogre {
         /// @copydoc FactoryObj::destroyInstance
         void destroyInstance(ParticleSystemRenderer* ptr);
     };
+
+    /** Specialisation of BillboardParticleRenderer which expands particles on the GPU.
+    @remarks
+        Rather than generating 4 vertices per particle, one compact record per particle
+        is uploaded and the quads are expanded by the vertex program using hardware
+        instancing. The material must therefore use a vertex program consuming the
+        layout described in BillboardSet::setInstancingEnabled, like the
+        Ogre/InstancedBillboard programs of the sample media. Otherwise, or if the render
+        system cannot source per-instance vertex data, particles are expanded on the CPU
+        as with BillboardParticleRenderer.
+    */
+    class _OgreExport InstancedBillboardParticleRenderer : public BillboardParticleRenderer
+    {
+    public:
+        InstancedBillboardParticleRenderer();
+
+        /// @copydoc ParticleSystemRenderer::getType
+        const String& getType(void) const;
+    };
+
+    /** Factory class for InstancedBillboardParticleRenderer */
+    class _OgreExport InstancedBillboardParticleRendererFactory : public ParticleSystemRendererFactory
+    {
+    public:
+        /// @copydoc FactoryObj::getType
+        const String& getType() const;
+        /// @copydoc FactoryObj::createInstance
+        ParticleSystemRenderer* createInstance( const String& name );
+        /// @copydoc FactoryObj::destroyInstance
+        void destroyInstance(ParticleSystemRenderer* ptr);
+    };
     /** @} */
     /** @} */
 
@@ -248,6 +248,22 @@ namespace Ogre {
         */
         void genVertices(const Vector3* const offsets, const Billboard& pBillboard);
 
+        /** Internal method for generating the vertex data of a batch of billboards.
+        @remarks
+            Used when all billboards share the same axes, are not culled individually
+            and are not rotated, so that the 4 corners of each billboard can be written
+            to the locked buffer as one contiguous span.
+        */
+        void genVerticesBatch(const Billboard* bbs, size_t count);
+
+        /** Internal method for packing the per-instance records of a batch of billboards.
+        @remarks
+            Used when instancing is enabled, writes a single record per billboard to the
+            locked instance buffer instead of 4 vertices. The colour and the texture
+            rectangle are converted with SSE2 where available.
+        */
+        void genInstanceData(const Billboard* bbs, size_t count);
+
         /** Internal method generates vertex offsets.
         @remarks
             Takes in parametric offsets as generated from getParametericOffsets, width and height values
@@ -280,10 +296,21 @@ namespace Ogre {
             float operator()(Billboard* bill) const;
         };
 
-        static RadixSort<ActiveBillboardList, Billboard*, float> mRadixSorter;
+        typedef std::vector<Billboard*> SortedBillboardList;
+        static RadixSort<SortedBillboardList, Billboard*, float> mRadixSorter;
+        /// Contiguous scratch copy of mActiveBillboards used for sorting
+        SortedBillboardList mSortedBillboards;
 
         /// Use point rendering?
         bool mPointRendering;
+        /// Use hardware instancing?
+        bool mInstancing;
+        /// Were the current buffers created for instancing?
+        bool mInstancingActive;
+        /// Colour format of the current buffers
+        VertexElementType mColourType;
+        /// Shared quad corners and camera axes, when instancing
+        HardwareVertexBufferSharedPtr mCornerBuf;
 
 
 
@@ -302,6 +329,16 @@ namespace Ogre {
         /** Internal method creates vertex and index buffers.
         */
         void _createBuffers(void);
+        /** Internal method creates the shared quad and instance buffers.
+        */
+        void _createInstancedBuffers(void);
+        /** Internal method writing the camera axes and origin offsets to the shared quad.
+        */
+        void _updateInstancedCorners(void);
+        /** Internal method checking whether instancing can be used with the current
+            settings, material and render system.
+        */
+        bool _canUseInstancing(void) const;
         /** Internal method destroys vertex and index buffers.
         */
         void _destroyBuffers(void);
@@ -546,6 +583,16 @@ namespace Ogre {
         void beginBillboards(size_t numBillboards = 0);
         /** Define a billboard. */
         void injectBillboard(const Billboard& bb);
+        /** Define a contiguous range of billboards.
+        @remarks
+            Equivalent to calling injectBillboard for each element, but when the
+            billboards share their axes (i.e. not self oriented, no accurate facing),
+            are not individually culled and are not rotated, the vertices are
+            generated in a single pass over the array.
+        @param bbs Pointer to the first billboard
+        @param count Number of billboards in the array
+        */
+        void injectBillboards(const Billboard* bbs, size_t count);
         /** Finish defining billboards. */
         void endBillboards(void);
         /** Set the bounds of the BillboardSet.
@@ -705,7 +752,13 @@ namespace Ogre {
             more expensive, but more accurate version.
         @param acc True to use the slower but more accurate model. Default is false.
         */
-        virtual void setUseAccurateFacing(bool acc) { mAccurateFacing = acc; }
+        virtual void setUseAccurateFacing(bool acc)
+        {
+            mAccurateFacing = acc;
+            // Per billboard axes need the CPU path
+            if (mInstancing)
+                _destroyBuffers();
+        }
         /** Gets whether or not billboards use an 'accurate' facing model
             based on the vector from each billboard to the camera, rather than 
             an optimised version using just the camera direction.
@@ -829,6 +882,39 @@ namespace Ogre {
         /** Returns whether point rendering is enabled. */
         virtual bool isPointRenderingEnabled(void) const
         { return mPointRendering; }
+
+        /** Set whether billboards are expanded on the GPU using hardware instancing.
+        @remarks
+            Instead of generating 4 vertices per billboard on the CPU, a single
+            compact record is uploaded per billboard and a shared quad is drawn
+            once per billboard, so the expansion to corners happens in the vertex
+            program. The vertex layout is:
+            \li buffer 0 (per vertex): VES_TEXTURE_COORDINATES 0 VET_FLOAT4 holding the
+                corner in [0, 1] ((0, 0) being the left-top corner) and its parametric
+                offsets from the origin, VES_TEXTURE_COORDINATES 3 and 4 VET_FLOAT3 holding
+                the camera X and Y axes in billboard space, the same for all 4 corners
+            \li buffer 1 (per instance): VES_POSITION VET_FLOAT3 billboard position,
+                VES_DIFFUSE colour, VES_TEXTURE_COORDINATES 1 VET_FLOAT3 holding width,
+                height and rotation in radians, and VES_TEXTURE_COORDINATES 2
+                VET_USHORT4_NORM holding the texture rectangle (left, top, right, bottom)
+        @par
+            The corner of a vertex is then position + axisX * offset.x * width +
+            axisY * offset.y * height, with the offsets rotated by the rotation. The
+            Ogre/InstancedBillboard programs of the sample media do this.
+        @par
+            The billboards are expanded on the CPU as usual, whatever this option, if the
+            first supported technique of the material in the default scheme lacks a vertex
+            program for any of its passes,
+            if the render system does not support instance data in vertex buffers, with
+            point rendering, with accurate facing, and with BBT_ORIENTED_SELF and
+            BBT_PERPENDICULAR_SELF, since the axes are shared by all billboards.
+        @param enabled True to enable instancing, false otherwise
+        */
+        virtual void setInstancingEnabled(bool enabled);
+
+        /** Returns whether hardware instancing is enabled. */
+        virtual bool isInstancingEnabled(void) const
+        { return mInstancing; }
         
         /// Override to return specific type flag
         uint32 getTypeFlags(void) const;
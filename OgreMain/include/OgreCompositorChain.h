@@ -184,6 +184,30 @@ namespace Ogre {
 
         /** Clear compiled state */
         void clearCompiledState();
+
+        /// First and last step of the chain at which transient textures are used
+        typedef std::map<std::pair<CompositorInstance*, String>, std::pair<size_t, size_t> > TextureLifetimeMap;
+        /// Render textures of transient textures in use at the output operation
+        std::vector<TexturePtr> mTransientTextures;
+
+        /** Assign render textures to the transient textures of the enabled instances,
+            aliasing those whose lifetimes don't overlap.
+        @see CompositorManager::setTextureAliasing
+        */
+        void aliasTransientTextures(CompositorInstance* lastComposition);
+        /// Release the render textures of transient textures
+        void releaseTransientTextures(void);
+        /** Collect the texture lifetimes of the target operations of an instance, in the
+            order _compileTargetOperations adds them, starting at step.
+        @return
+            The step after the last target operation
+        */
+        size_t collectTextureLifetimes(CompositorInstance* inst, size_t step, TextureLifetimeMap& lifetimes);
+        /// Collect the texture lifetimes of the output operation of an instance, at step
+        void collectOutputTextureLifetimes(CompositorInstance* inst, size_t step, TextureLifetimeMap& lifetimes);
+        /// Record the texture uses of a target pass of an instance at step
+        void collectTargetPassLifetimes(CompositorInstance* inst, CompositionTargetPass* target,
+            bool output, size_t step, TextureLifetimeMap& lifetimes);
         
         /** Prepare a viewport, the camera and the scene for a rendering operation
         */
@@ -122,7 +122,8 @@ namespace Ogre {
                 target(inTarget), currentQueueGroupID(0), visibilityMask(0xFFFFFFFF),
                 lodBias(1.0f),
                 onlyInitial(false), hasBeenRendered(false), findVisibleObjects(false), 
-                materialScheme(MaterialManager::DEFAULT_SCHEME_NAME), shadowsEnabled(true)
+                materialScheme(MaterialManager::DEFAULT_SCHEME_NAME), shadowsEnabled(true),
+                originalScene(false)
             { 
             }
             /// Target
@@ -164,6 +165,10 @@ namespace Ogre {
             String materialScheme;
             /** Whether shadows will be enabled */
             bool shadowsEnabled;
+            /** Whether this op renders the original scene, so the visibility mask and
+                shadows of the chain's viewport apply on top of the above
+            */
+            bool originalScene;
         };
         typedef std::vector<TargetOperation> CompiledState;
         
@@ -342,6 +347,16 @@ namespace Ogre {
         
         /// Previous instance (set by chain).
         CompositorInstance *mPreviousInstance;
+
+        typedef std::set<String> TextureNameSet;
+        /** Local textures which are written before they are read within a frame, so
+            their contents need not persist. With texture aliasing, they are not created
+            by createResources but assigned by the chain when it compiles.
+        */
+        TextureNameSet mTransientTextures;
+        typedef std::set<CompositionTargetPass*> TargetPassSet;
+        /// Target passes whose output is never read, skipped with texture aliasing
+        TargetPassSet mCulledTargetPasses;
         
         /** Collect rendering passes. Here, passes are converted into render target operations
             and queued with queueRenderSystemOp.
@@ -386,6 +401,17 @@ namespace Ogre {
         */
         void deriveTextureRenderTargetOptions(const String& texname, 
             bool *hwGammaWrite, uint *fsaa, String* fsaaHint);
+        /// Determine the size and render target options of a local texture
+        void deriveTextureOptions(const CompositionTechnique::TextureDefinition* def,
+            size_t& width, size_t& height, bool& hwGammaWrite, uint& fsaa, String& fsaaHint);
+        /// Set up the viewport of a local render target, unless it has one already
+        void initialiseRenderTarget(RenderTarget* target, uint16 depthBufferId);
+        /** Find the transient textures and the unused target passes of the technique,
+            if texture aliasing is enabled.
+        */
+        void analyseTextureUsage();
+        /// Collect the local textures a target pass reads
+        void getTargetPassInputs(CompositionTargetPass* target, TextureNameSet& inputs) const;
 
         /// Notify this instance that the primary viewport's camera has changed.
         void notifyCameraChanged(Camera* camera);
@@ -152,6 +152,36 @@ namespace Ogre {
         */
         void freePooledTextures(bool onlyIfUnreferenced = true);
 
+        /** Sets whether compositor chains alias the memory of their transient textures.
+        @remarks
+            A local scope texture which is not pooled nor an MRT is transient when its
+            compositor writes it before reading it within a frame. With aliasing, chains
+            compute the lifetimes of these over the passes they execute, and textures
+            whose lifetimes don't overlap share the same render texture. Textures which
+            are dead by the time the chain renders to its viewport also share render
+            textures with the chains of other viewports. Target passes writing local
+            textures that are never read are skipped.
+        @par
+            Compositors with a compositor logic or custom passes are left alone, as they
+            may use their textures in ways the chain can't see. Otherwise the textures
+            must only be used by the compositor passes and their materials: transient
+            textures are only assigned when the chain compiles, and may change whenever
+            it recompiles. Changing this recreates the resources of all compositors.
+            Disabled by default.
+        */
+        void setTextureAliasing(bool enabled);
+        /// Gets whether compositor chains alias the memory of their transient textures
+        bool getTextureAliasing(void) const { return mTextureAliasing; }
+
+        /** Internal method getting a render texture shared by the transient textures of
+            all chains, which must be dead by the time the chain renders its viewport.
+        @param index
+            Which of the textures matching the other parameters to get, those which
+            don't exist yet are created
+        */
+        TexturePtr _getTransientTexture(size_t index, size_t w, size_t h, PixelFormat f,
+            uint aa, const String& aaHint, bool srgb, uint16 depthBufferId);
+
         /** Register a compositor logic for listening in to expecting composition
             techniques.
         */
@@ -279,6 +309,21 @@ namespace Ogre {
         
         ChainTexturesByDef mChainTexturesByDef;
 
+        bool mTextureAliasing;
+        struct TransientTexture
+        {
+            TextureDef def;
+            uint16 depthBufferId;
+            TexturePtr texture;
+            TransientTexture(const TextureDef& d, uint16 depthId, const TexturePtr& tex)
+                : def(d), depthBufferId(depthId), texture(tex)
+            {
+            }
+        };
+        typedef std::vector<TransientTexture> TransientTextureList;
+        /// Render textures shared by the transient textures of all chains
+        TransientTextureList mTransientTextures;
+
         bool isInputPreviousTarget(CompositorInstance* inst, const Ogre::String& localName);
         bool isInputPreviousTarget(CompositorInstance* inst, TexturePtr tex);
         bool isInputToOutputTarget(CompositorInstance* inst, const Ogre::String& localName);
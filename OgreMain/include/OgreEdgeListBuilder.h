@@ -230,17 +230,43 @@ namespace Ogre {
                 return a.indexSet < b.indexSet;
             }
         };
-        /** Comparator for unique vertex list */
-        struct vectorLess {
-            bool operator()(const Vector3& a, const Vector3& b) const
+        /** Hash for unique vertex list, positions are welded on exact equality */
+        struct vectorHash {
+            size_t operator()(const Vector3& v) const
             {
-                if (a.x < b.x) return true;
-                if (a.x > b.x) return false;
-                if (a.y < b.y) return true;
-                if (a.y > b.y) return false;
-                return a.z < b.z;
+                std::hash<Real> hasher;
+                size_t seed = 0;
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    // Fold -0 onto +0, they compare equal
+                    Real r = v[i] == 0 ? 0 : v[i];
+                    seed ^= hasher(r) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                }
+                return seed;
             }
         };
+        /** Hash for a pair of shared vertex indices */
+        struct edgeHash {
+            size_t operator()(const std::pair<size_t, size_t>& e) const
+            {
+                size_t seed = e.first;
+                seed ^= e.second + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                return seed;
+            }
+        };
+        /** An edge waiting for its second triangle. Edges sharing the same vertex
+            pair are chained so they are connected in creation order.
+        */
+        struct PendingEdge {
+            size_t vertexSet;   /// The edge group the edge belongs to
+            size_t edgeIndex;   /// Place of the edge in the edge group
+            size_t next;        /// Next pending edge on the same vertex pair, or ~0
+        };
+        /** First and last pending edge on a vertex pair */
+        struct PendingEdgeChain {
+            size_t head;
+            size_t tail;
+        };
 
         typedef std::vector<const VertexData*> VertexDataList;
         typedef std::vector<Geometry> GeometryList;
@@ -251,13 +277,16 @@ namespace Ogre {
         CommonVertexList mVertices;
         EdgeData* mEdgeData;
         /// Map for identifying common vertices
-        typedef std::map<Vector3, size_t, vectorLess> CommonVertexMap;
+        typedef OGRE_HashMap<Vector3, size_t, vectorHash> CommonVertexMap;
         CommonVertexMap mCommonVertexMap;
         /** Edge map, used to connect edges. Note we allow many triangles on an edge,
         after connected an existing edge, we will remove it and never used again.
         */
-        typedef std::multimap< std::pair<size_t, size_t>, std::pair<size_t, size_t> > EdgeMap;
+        typedef OGRE_HashMap<std::pair<size_t, size_t>, PendingEdgeChain, edgeHash> EdgeMap;
         EdgeMap mEdgeMap;
+        typedef std::vector<PendingEdge> PendingEdgeList;
+        /// Storage for the edge chains referenced by mEdgeMap
+        PendingEdgeList mPendingEdges;
 
         void buildTrianglesEdges(const Geometry &geometry);
 
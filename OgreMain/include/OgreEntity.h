@@ -140,6 +140,10 @@ namespace Ogre {
         bool mVertexProgramInUse : 1;
         /// Has this entity been initialised yet?
         bool mInitialised : 1;
+        /// Flag indicating whether sub entities draw only the meshlets visible to the camera.
+        bool mMeshletCulling : 1;
+        /// The camera meshlets are culled against, set by _notifyCurrentCamera
+        const Camera* mMeshletCamera;
 
         /** Internal method - given vertex data which could be from the Mesh or
             any submesh, finds the temporary blend copy.
@@ -612,6 +616,16 @@ namespace Ogre {
         /** @copydoc MovableObject::getWorldBoundingSphere */
         const Sphere& getWorldBoundingSphere(bool derive = false) const;
 
+        /** Intersects a world space ray with the triangles of this entity.
+        @remarks
+            Uses the triangle hierarchy of the mesh, see Mesh::getTriangleBVH. While
+            the skeleton is animated, the bind pose triangles don't match, so the ray is
+            tested against the bounds of the vertices of each bone in its current pose
+            instead. Vertex (morph and pose) animation is not followed.
+        @return Whether the ray hits, and the distance along it
+        */
+        std::pair<bool, Real> intersectsTriangles(const Ray& ray);
+
         /** @copydoc ShadowCaster::getEdgeList */
         EdgeData* getEdgeList(void);
         /** @copydoc ShadowCaster::hasEdgeList */
@@ -873,6 +887,25 @@ namespace Ogre {
             return mAlwaysUpdateMainSkeleton;
         }
 
+        /** Sets whether each sub entity only draws the meshlets visible to the camera.
+        @remarks
+            Meshlets (see SubMesh::meshlets) are tested against the camera frustum and, when
+            every pass culls clockwise faces, against the camera position for back facing.
+            Only the highest LOD level of meshes without skeletal or vertex animation is
+            culled this way. When visible meshlets are not contiguous in the index buffer, they
+            are copied to a per sub entity index buffer if the mesh index buffer has a shadow
+            copy or is in system memory, otherwise the range spanning them all is drawn. The
+            copy is only made again when the visible meshlets change. Sub entities which are not
+            queued for rendering are not culled.
+        */
+        void setMeshletCullingEnabled(bool enabled);
+
+        /** Gets whether each sub entity only draws the meshlets visible to the camera.
+        */
+        bool isMeshletCullingEnabled() const {
+            return mMeshletCulling;
+        }
+
         /** If true, the skeleton of the entity will be used to update the bounding box for culling.
             Useful if you have skeletal animations that move the bones away from the root.  Otherwise, the
             bounding box of the mesh in the binding pose will be used.
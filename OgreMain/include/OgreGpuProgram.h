@@ -107,6 +107,12 @@ namespace Ogre {
         String doGet(const void* target) const;
         void doSet(void* target, const String& val);
     };
+    class _OgreExport CmdInstancing : public ParamCommand
+    {
+    public:
+        String doGet(const void* target) const;
+        void doSet(void* target, const String& val);
+    };
     class _OgreExport CmdManualNamedConstsFile : public ParamCommand
     {
     public:
@@ -132,6 +138,7 @@ namespace Ogre {
     static CmdMorph msMorphCmd;
     static CmdPose msPoseCmd;
     static CmdVTF msVTFCmd;
+    static CmdInstancing msInstancingCmd;
     static CmdManualNamedConstsFile msManNamedConstsFileCmd;
     static CmdAdjacency msAdjacencyCmd;
     static CmdComputeGroupDims msComputeGroupDimsCmd;
@@ -153,6 +160,8 @@ namespace Ogre {
     ushort mPoseAnimation;
     /// Does this (vertex) program require support for vertex texture fetch?
     bool mVertexTextureFetch;
+    /// Does this (vertex) program read the world matrix from per-instance vertex data?
+    bool mInstancing;
     /// Does this (geometry) program require adjacency information?
     bool mNeedsAdjacencyInfo;
     /// The number of process groups dispatched by this (compute) program.
@@ -326,6 +335,19 @@ namespace Ogre {
     */
     virtual bool isVertexTextureFetchRequired(void) const { return mVertexTextureFetch; }
 
+    /** Sets whether a vertex program reads the world matrix of each instance from
+        per-instance vertex data instead of the world matrix parameters.
+        @remarks
+        If this is set to true and the SceneManager has auto instancing enabled, identical
+        renderables using this program may be drawn with a single instanced call.
+        @see SceneManager::setAutoInstancingEnabled
+    */
+    virtual void setInstancingIncluded(bool included) { mInstancing = included; }
+    /** Returns whether a vertex program reads the world matrix of each instance from
+        per-instance vertex data.
+    */
+    virtual bool isInstancingIncluded(void) const { return mInstancing; }
+
     /** Sets whether this geometry program requires adjacency information
         from the input primitives.
     */
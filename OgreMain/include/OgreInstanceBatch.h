@@ -325,7 +325,7 @@ namespace Ogre
         void _markTransformSharingDirty() { mTransformSharingDirty = true; }
 
         /** @see InstancedEntity::setCustomParam */
-        void _setCustomParam( InstancedEntity *instancedEntity, unsigned char idx, const Vector4 &newParam );
+        virtual void _setCustomParam( InstancedEntity *instancedEntity, unsigned char idx, const Vector4 &newParam );
 
         /** @see InstancedEntity::getCustomParam */
         const Vector4& _getCustomParam( InstancedEntity *instancedEntity, unsigned char idx );
@@ -61,6 +61,17 @@ namespace Ogre
     class _OgreExport InstanceBatchHW : public InstanceBatch
     {
         bool    mKeepStatic;
+        /// Set when transforms or custom params changed since the instance buffer was last written
+        bool    mInstanceDataDirty;
+
+        /// Bounding spheres of the cull candidates in SoA layout (all x, then y, z and radii)
+        std::vector<Real>   mCullSpheres;
+        /// Indices into mInstancedEntities of the instances that are in scene and visible
+        std::vector<uint32> mCullCandidates;
+        /// Indices of the instances that passed culling this time, in buffer order
+        std::vector<uint32> mVisibleInstances;
+        /// Indices of the instances whose data is currently in the instance buffer, in buffer order
+        std::vector<uint32> mUploadedInstances;
 
         void setupVertices( const SubMesh* baseSubMesh );
         void setupIndices( const SubMesh* baseSubMesh );
@@ -68,6 +79,19 @@ namespace Ogre
         void removeBlendData();
         virtual bool checkSubMeshCompatibility( const SubMesh* baseSubMesh );
 
+        /** Fills mVisibleInstances with the instances whose bounding sphere intersects the
+            camera's frustum. Spheres are gathered first and then tested four at a time.
+        @param currentCamera
+            Camera to cull against. When null, every in-scene visible instance passes.
+        */
+        void cullInstances( const Camera *currentCamera );
+
+        /** Culls the instances and writes the visible ones contiguously to the instance buffer.
+            The upload is skipped when the buffer already holds the same instances and none of
+            them changed since.
+        @return
+            Number of instances to draw.
+        */
         size_t updateVertexBuffer( Camera *currentCamera );
 
     public:
@@ -88,6 +112,9 @@ namespace Ogre
         */
         void _boundsDirty(void);
 
+        /** @see InstanceBatch::_setCustomParam. Overloaded to mark the instance buffer for upload */
+        void _setCustomParam( InstancedEntity *instancedEntity, unsigned char idx, const Vector4 &newParam );
+
         /** @see InstanceBatch::setStaticAndUpdate. While this flag is true, no individual per-entity
             cull check is made. This means if the camera is looking at only one instance, all instances
             are sent to the vertex shader (unlike when this flag is false). This saves a lot of CPU
@@ -0,0 +1,221 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreLightClusters_H_
+#define _OgreLightClusters_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreCommon.h"
+#include "OgreMatrix4.h"
+#include "OgrePixelFormat.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+    /** Bins lights into the clusters (froxels) of a camera frustum, for clustered
+        forward shading.
+    @remarks
+        The frustum is split into tilesX by tilesY screen tiles and into depth slices,
+        which are spaced exponentially between the near clip distance and the cluster
+        far distance. Every point and spot light is added to the clusters its range
+        sphere overlaps; directional lights apply everywhere and are listed first.
+    @par
+        build() only needs a camera and the lights, so it works without a render
+        system. upload() copies the results into three floating point textures that
+        shaders look the lights up in, see RTShader::ClusteredLighting. Their names
+        start with "Ogre/LightClusters/" and the name passed to the constructor:
+        - getLightTexture: LIGHT_TEXELS texels per light and row, in view space:
+            (position or direction towards the light, range), (diffuse colour, type),
+            (specular colour, spot falloff), (attenuation constant, linear, quadratic,
+            cos of half the outer spot angle), (direction towards the light, cos of
+            half the inner spot angle).
+        - getClusterTexture: one texel per cluster, x = tile, y = slice:
+            (offset into the light indices, light count, 0, 0).
+        - getIndexTexture: the light indices of all clusters, INDEX_TEXTURE_WIDTH
+            per row.
+    @par
+        A SceneManager with clustered lighting enabled rebuilds and uploads these for
+        each camera it renders, see SceneManager::setLightClustersEnabled.
+    */
+    class _OgreExport LightClusters : public SceneCtlAllocatedObject
+    {
+    public:
+        /// Number of RGBA texels per light in the light texture
+        static const size_t LIGHT_TEXELS = 5;
+        /// Width of the light index texture
+        static const size_t INDEX_TEXTURE_WIDTH = 1024;
+        /// Upper limit of setMaxLightsPerCluster, matching the shader loop
+        static const size_t MAX_LIGHTS_PER_CLUSTER = 256;
+
+        /** Constructor.
+        @param name Makes the texture names unique, e.g. the name of the SceneManager
+        */
+        explicit LightClusters(const String& name = BLANKSTRING);
+        ~LightClusters();
+
+        /** Sets the number of clusters the frustum is split into.
+        @param tilesX Horizontal screen tiles
+        @param tilesY Vertical screen tiles
+        @param slices Depth slices
+        */
+        void setDimensions(uint16 tilesX, uint16 tilesY, uint16 slices);
+        uint16 getTilesX(void) const { return mTilesX; }
+        uint16 getTilesY(void) const { return mTilesY; }
+        uint16 getSlices(void) const { return mSlices; }
+
+        /** Sets the distance of the far end of the last depth slice.
+        @remarks
+            Lights beyond it are not binned. 0 (the default) uses the far clip distance
+            of the camera, or the furthest light if that is infinite.
+        */
+        void setFarDistance(Real distance) { mFarDistance = distance; }
+        Real getFarDistance(void) const { return mFarDistance; }
+
+        /** Sets the maximum number of lights per cluster, further lights are dropped
+            from the cluster. Clamped to MAX_LIGHTS_PER_CLUSTER.
+        */
+        void setMaxLightsPerCluster(size_t count);
+        size_t getMaxLightsPerCluster(void) const { return mMaxLightsPerCluster; }
+
+        /** Bins the lights into the clusters of the camera frustum.
+        @remarks
+            Spot lights are binned by their range sphere. The lights are binned with
+            WorkQueue::parallelFor, the results only depend on their order, not on
+            the number of threads.
+        */
+        void build(const Camera* camera, const LightList& lights);
+
+        /** Copies the results of the last build into the textures, creating or
+            growing them as needed. Requires a render system.
+        */
+        void upload(void);
+
+        /// Releases the textures
+        void destroyTextures(void);
+
+        /// Light data texture, null before the first upload
+        const TexturePtr& getLightTexture(void) const { return mLightTexture; }
+        /// Cluster texture, null before the first upload
+        const TexturePtr& getClusterTexture(void) const { return mClusterTexture; }
+        /// Light index texture, null before the first upload
+        const TexturePtr& getIndexTexture(void) const { return mIndexTexture; }
+
+        /// Packed view space light data, LIGHT_TEXELS * 4 floats per light
+        const std::vector<float>& getLightData(void) const { return mLightData; }
+        /// Number of lights in the light data
+        size_t getNumLights(void) const { return mLightData.size() / (LIGHT_TEXELS * 4); }
+        /// Number of directional lights, which come first in the light data
+        size_t getNumDirectionalLights(void) const { return mNumDirectionalLights; }
+        /// Offset and count into getLightIndices for each cluster
+        const std::vector<uint32>& getClusters(void) const { return mClusters; }
+        /// Indices into the light data, grouped by cluster
+        const std::vector<uint32>& getLightIndices(void) const { return mLightIndices; }
+        /// Index of a cluster in getClusters
+        size_t getClusterIndex(size_t tileX, size_t tileY, size_t slice) const
+        {
+            return (slice * mTilesY + tileY) * mTilesX + tileX;
+        }
+
+        /** Shader parameters of the last build: (near distance, slices / log(far / near),
+            slices, 1 for perspective and 0 for orthographic projection).
+        @remarks
+            The slice of a view space depth d is floor(log(d / near) * y).
+        */
+        const Vector4& getDepthParams(void) const { return mDepthParams; }
+        /** Shader parameters of the last build: (x scale, y scale, x offset, y offset)
+            mapping view space x and y, divided by the depth for perspective projection,
+            to normalised device coordinates.
+        */
+        const Vector4& getProjectionParams(void) const { return mProjectionParams; }
+        /** Shader parameters: (tiles x, tiles y, directional lights, light texture height).
+        */
+        const Vector4& getGridParams(void) const { return mGridParams; }
+        /** Shader parameters: (cluster texture width, cluster texture height, index
+            texture width, index texture height).
+        */
+        const Vector4& getTextureParams(void) const { return mTextureParams; }
+
+    private:
+        /// Bins lights [begin, end) of the light data into cluster / light pair lists
+        void binLights(size_t begin, size_t end, std::vector<uint32>& clusters,
+                       std::vector<uint32>& lights) const;
+        /// Appends the light texels of a light to mLightData
+        void packLight(const Light* light);
+        /// Adds the tiles a view space range at depths [nearDepth, farDepth] covers
+        bool getTileRange(Real minimum, Real maximum, Real nearDepth, Real farDepth,
+                          Real scale, Real offset, int tiles, int& first, int& last) const;
+        /// Creates the texture, or resizes it if it is too small
+        void prepareTexture(TexturePtr& texture, const String& name, PixelFormat format,
+                            uint32 width, uint32 height);
+
+        String mName;
+        uint16 mTilesX;
+        uint16 mTilesY;
+        uint16 mSlices;
+        Real mFarDistance;
+        size_t mMaxLightsPerCluster;
+
+        /// State of the current build
+        Affine3 mViewMatrix;
+        Real mNear;
+        Real mFar;
+        Real mSliceScale;
+        bool mPerspective;
+        /// View space centre and radius of every light, zero for directional lights
+        std::vector<Vector4> mSpheres;
+
+        std::vector<float> mLightData;
+        std::vector<uint32> mClusters;
+        std::vector<uint32> mLightIndices;
+        size_t mNumDirectionalLights;
+
+        Vector4 mDepthParams;
+        Vector4 mProjectionParams;
+        Vector4 mGridParams;
+        Vector4 mTextureParams;
+
+        TexturePtr mLightTexture;
+        TexturePtr mClusterTexture;
+        TexturePtr mIndexTexture;
+        /// Staging memory for the cluster and index textures
+        std::vector<float> mUploadBuffer;
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
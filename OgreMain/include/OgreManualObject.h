@@ -158,6 +158,11 @@ namespace Ogre
 
         /** Use before defining geometry to indicate that you intend to update the
             geometry regularly and want the internal structure to reflect that.
+        @remarks
+            Dynamic objects also keep the system memory areas used while defining
+            geometry from one end() to the next begin() or beginUpdate(), and grow
+            updated buffers geometrically, so once the sizes have settled updating
+            the sections every frame does not allocate memory. clear() releases them.
         */
         virtual void setDynamic(bool dyn) { mDynamic = dyn; }
         /** Gets whether this object is marked as dynamic */
@@ -265,6 +270,24 @@ namespace Ogre
         */
         virtual void quad(uint32 i1, uint32 i2, uint32 i3, uint32 i4);
 
+        /** Add a block of vertices in one go, rather than one element at a time.
+        @remarks
+            The data must follow the vertex declaration of the current section,
+            see ManualObjectSection::getRenderOperation. That is only known once
+            the first vertex of a section has been defined element by element, so
+            this can be used after beginUpdate(), or after the first vertex following
+            begin(). The positions are merged into the bounds.
+        @param pData The vertex data
+        @param count The number of vertices in pData
+        */
+        virtual void appendVertices(const void* pData, size_t count);
+        /** Add a block of vertex indices in one go; equivalent to calling index()
+            for each of them.
+        @param pIndices The vertex indices
+        @param count The number of indices in pIndices
+        */
+        virtual void appendIndices(const uint32* pIndices, size_t count);
+
         /// Get the number of vertices in the section currently being defined (returns 0 if no section is in progress).
         virtual size_t getCurrentVertexCount() const;
 
@@ -538,6 +561,8 @@ namespace Ogre
 
         /// Delete temp buffers and reset init counts
         virtual void resetTempAreas(void);
+        /// Get the index data of the current section, creating it if necessary
+        IndexData* getCurrentIndexData(void);
         /// Resize the temp vertex buffer?
         virtual void resizeTempVertexBufferIfNeeded(size_t numVerts);
         /// Resize the temp index buffer?
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreVertexBoneAssignment.h"
 #include "OgreAnimation.h"
 #include "OgreAnimationTrack.h"
+#include "OgreVertexIndexData.h"
 #include "OgreHeaderPrefix.h"
 #include "OgreSharedPtr.h"
 
@@ -51,6 +52,7 @@ namespace Ogre {
 
     struct MeshLodUsage;
     class LodStrategy;
+    class MeshBVH;
 
     /** Resource holding data about 3D mesh.
     @remarks
@@ -176,6 +178,8 @@ namespace Ogre {
         bool mPreparedForShadowVolumes;
         bool mEdgeListsBuilt;
         bool mAutoBuildEdgeLists;
+        /// Triangle hierarchy for queries, built on demand
+        MeshBVH* mTriangleBVH;
 
         /// Storage of morph animations, lookup by name
         typedef std::map<String, Animation*> AnimationList;
@@ -730,6 +734,52 @@ namespace Ogre {
         /** Destroys and frees the edge lists this mesh has built. */
         void freeEdgeList(void);
 
+        /** Reorders the triangles of every triangle list submesh, including
+            generated LOD levels, to make better use of the post-transform vertex cache.
+        @remarks
+            LOD levels which share their index buffer with another level (compressed
+            LOD) are left in their original order.
+        @see IndexData::optimiseVertexCacheTriList
+        */
+        void optimiseVertexCache(void);
+
+        /** Reorders clusters of triangles of every triangle list submesh, including
+            generated LOD levels, so that outward facing ones are drawn first.
+        @remarks
+            Call this after optimiseVertexCache, the clusters keep its triangle order.
+            LOD levels which share their index buffer with another level are left alone.
+        @see IndexData::optimiseOverdrawTriList
+        */
+        void optimiseOverdraw(Real threshold = 1.05f);
+
+        /** Reorders the vertices of each vertex data set in the order the index
+            data first references them, so vertex fetches walk memory linearly.
+        @remarks
+            Index buffers, bone assignments and edge lists are updated to match, so
+            this is best called after optimiseVertexCache. Meshes with pose or morph
+            animation are left untouched since their keyframes address vertices by
+            index.
+        */
+        void optimiseVertexFetch(void);
+
+        /** Splits every triangle list submesh into meshlets which can be culled individually.
+        @remarks
+            Edge lists are rebuilt if they were built, since the triangle order changes.
+        @see SubMesh::buildMeshlets
+        */
+        void buildMeshlets(size_t maxTrianglesPerMeshlet = 64);
+
+        /** Stores the vertex data of this mesh in compact formats, see VertexData::quantise.
+        @remarks
+            Positions and directions of skeletally or vertex animated meshes are left as
+            floats since animation is applied to them on the CPU. Quantising positions frees
+            the edge lists and turns off building them, so no stencil shadows are cast.
+            Call this after any other processing of the vertex data.
+        @return The accumulated report of all vertex data sets, which is also logged
+        */
+        VertexData::QuantisationReport quantiseVertexData(bool positions = true,
+            bool directions = true, bool texCoords = true);
+
         /** This method prepares the mesh for generating a renderable shadow volume. 
         @remarks
             Preparing a mesh to generate a shadow volume involves firstly ensuring that the 
@@ -775,6 +825,23 @@ namespace Ogre {
         /** Returns whether this mesh has an attached edge list. */
         bool isEdgeListBuilt(void) const { return mEdgeListsBuilt; }
 
+        /** Gets the bounding volume hierarchy over the triangles of this mesh, building
+            it on first use. Entities of this mesh share it.
+        @remarks
+            Call freeTriangleBVH after changing the geometry yourself; the Mesh methods
+            which reorder triangles already do.
+        @par
+            Building happens under the lock of the mesh, so queries may start from
+            several threads. Freeing must not happen while any of them runs.
+        @see MeshBVH
+        */
+        MeshBVH* getTriangleBVH(void);
+        /** Builds the triangle hierarchy now (e.g. right after loading), rather than
+            on the first query. */
+        void buildTriangleBVH(void);
+        /** Destroys the triangle hierarchy, if built. */
+        void freeTriangleBVH(void);
+
         /** Prepare matrices for software indexed vertex blend.
         @remarks
             This function organise bone indexed matrices to blend indexed matrices,
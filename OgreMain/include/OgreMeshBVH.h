@@ -0,0 +1,140 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreMeshBVH_H_
+#define _OgreMeshBVH_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreAxisAlignedBox.h"
+#include "OgreRenderOperation.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Math
+    *  @{
+    */
+    /** Bounding volume hierarchy over the triangles of a mesh, for triangle
+        accurate ray and sphere queries.
+    @remarks
+        The triangles of every triangle list, strip and fan submesh are gathered in
+        mesh space, from the full detail (LOD 0) index data. Positions may be floats
+        or quantised by VertexData::quantise.
+    @par
+        For skeletal meshes the triangles are in the bind pose. The bounds of the
+        vertices each bone influences are kept too; transformed by the bone's offset
+        transform they follow the animation, see getBoneBounds.
+    @par
+        Building reads the vertex and index buffers, so on render systems which
+        can't read back from the GPU the mesh needs shadow buffers.
+    @see Mesh::getTriangleBVH
+    */
+    class _OgreExport MeshBVH : public GeometryAllocatedObject
+    {
+    public:
+        /// A triangle found by a query
+        struct TriangleHit
+        {
+            /// Distance along the ray, in units of the ray direction (ray queries only)
+            Real distance;
+            /// Index of the submesh the triangle belongs to
+            unsigned short subMesh;
+            /// Index of the triangle in the LOD 0 index data of that submesh
+            uint32 triangle;
+        };
+        typedef std::vector<TriangleHit> TriangleHitList;
+        typedef std::vector<AxisAlignedBox> BoneBoundsList;
+
+        /// Builds the hierarchy of the given mesh
+        explicit MeshBVH(const Mesh* mesh);
+
+        /** Finds the nearest triangle hit by a ray in mesh space.
+        @param ray The ray, in mesh space
+        @param hit Receives the nearest triangle hit
+        @param positiveSide Whether triangles facing the ray origin are hit
+        @param negativeSide Whether triangles facing away from the ray origin are hit
+        @return Whether any triangle was hit
+        */
+        bool raycast(const Ray& ray, TriangleHit& hit,
+            bool positiveSide = true, bool negativeSide = true) const;
+
+        /** Finds all the triangles touching a sphere in mesh space.
+        @param sphere The sphere, in mesh space
+        @param hits The triangles found are appended to this, without distances
+        */
+        void sphereQuery(const Sphere& sphere, TriangleHitList& hits) const;
+
+        /** Gets the mesh space bounds of the bind pose vertices each bone influences,
+            indexed by bone handle. Bones influencing no vertices have null boxes.
+        */
+        const BoneBoundsList& getBoneBounds(void) const { return mBoneBounds; }
+
+        /// Gets the number of triangles in the hierarchy
+        size_t getTriangleCount(void) const { return mTriangles.size(); }
+
+        /// Gets the bounds of all the triangles
+        const AxisAlignedBox& getBounds(void) const { return mBounds; }
+
+    private:
+        struct Triangle
+        {
+            Vector3 v[3];
+            unsigned short subMesh;
+            uint32 index;
+        };
+        /// Flattened node, the children of an inner node are at first and first + 1
+        struct Node
+        {
+            Vector3 minimum;
+            Vector3 maximum;
+            /// First triangle of a leaf, or first child of an inner node
+            uint32 first;
+            /// Number of triangles of a leaf, 0 for inner nodes
+            uint32 count;
+        };
+
+        std::vector<Triangle> mTriangles;
+        std::vector<Node> mNodes;
+        BoneBoundsList mBoneBounds;
+        AxisAlignedBox mBounds;
+
+        void addTriangles(const IndexData* indexData, RenderOperation::OperationType opType,
+            unsigned short subMesh, const std::vector<Vector3>& positions);
+        void buildNodes(void);
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
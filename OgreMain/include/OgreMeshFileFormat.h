@@ -208,6 +208,19 @@ namespace Ogre {
             // unsigned short submesh_index;
             // float extremes [n_extremes][3];
 
+            // Optional submesh meshlet table chunk
+            M_TABLE_MESHLETS = 0xF000,
+            // unsigned short submesh_index;
+            // unsigned int meshletCount;
+            // repeat by meshletCount:
+                // unsigned int indexStart, indexCount;
+                // float centre[3], radius, coneAxis[3], coneCutoff;
+
+            // Optional position decode chunk, one per quantised vertex data
+            M_TABLE_POSITION_DECODE = 0xF100,
+            // unsigned short submesh_index; (0xFFFF for the shared vertex data)
+            // float offset[3], scale;
+
     /* Version 1.2 of the .mesh format (deprecated)
     enum MeshChunkID {
         M_HEADER                = 0x1000,
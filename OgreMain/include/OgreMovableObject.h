@@ -127,6 +127,8 @@ namespace Ogre {
         bool mRenderQueuePrioritySet : 1;
         /// Does rendering this object disabled by listener?
         bool mRenderingDisabled : 1;
+        /// Is this object hinted to be a static shadow caster?
+        bool mStaticShadowCaster : 1;
         /// The render queue to use when rendering this object
         uint8 mRenderQueueID;
         /// The render queue group to use when rendering this object
@@ -530,6 +532,16 @@ namespace Ogre {
         void setCastShadows(bool enabled) { mCastShadows = enabled; }
         /** Returns whether shadow casting is enabled for this object. */
         bool getCastShadows(void) const { return mCastShadows; }
+        /** Hints that this object, as a shadow caster, does not move or change.
+        @remarks
+            Static casters may be kept in a cached shadow texture instead of being
+            rendered every frame (see SceneManager::setShadowTextureCaching). Moving
+            them is still fine, but throws away what was cached for them. Objects are
+            dynamic casters by default.
+        */
+        void setStaticShadowCaster(bool isStatic) { mStaticShadowCaster = isStatic; }
+        /** Returns whether this object is hinted to be a static shadow caster. */
+        bool isStaticShadowCaster(void) const { return mStaticShadowCaster; }
         /** Returns whether the Material of any Renderable that this MovableObject will add to 
             the render queue will receive shadows. 
         */
@@ -484,6 +484,16 @@ namespace Ogre {
         */
         static Real getDefaultNonVisibleUpdateTimeout(void) { return msDefaultNonvisibleTimeout; }
 
+        /** Gets the current detail factor of this system, in [0, 1].
+        @remarks
+            The factor combines the distance to the closest camera and the budgets
+            set on ParticleSystemManager, and moves smoothly towards its target over
+            time. It scales the emission rate and the effective quota, and may lower
+            the update rate.
+        @see ParticleSystemManager::setLodDistances, ParticleSystemManager::setParticleBudget
+        */
+        Real getLodFactor(void) const { return mLodFactor; }
+
         /** Overridden from MovableObject */
         const String& getMovableType(void) const;
 
@@ -695,6 +705,18 @@ namespace Ogre {
         Real mTimeSinceLastVisible;
         /// Last frame in which known to be visible
         unsigned long mLastVisibleFrame;
+        /// Current detail factor
+        Real mLodFactor;
+        /// Distance based detail factor of the closest camera
+        Real mDistanceLodFactor;
+        /// Last frame statistics were reported to the ParticleSystemManager
+        unsigned long mLastStatsFrame;
+        /// Emissions requested before the detail factor since the last report
+        Real mRequestedSinceStats;
+        /// Time updated since the last report
+        Real mTimeSinceStats;
+        /// Running average of the time to live of emitted particles
+        Real mMeanTimeToLive;
         /// Controller for time update
         Controller<Real>* mTimeController;
         /// Indication whether the emitted emitter pool (= pool with particle emitters that are emitted) is initialised
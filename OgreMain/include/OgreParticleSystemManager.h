@@ -99,6 +99,30 @@ namespace Ogre {
         // Factory instance
         ParticleSystemFactory* mFactory;
 
+        /// Maximum number of particles alive across all systems (0 for no limit)
+        size_t mParticleBudget;
+        /// Maximum time spent updating all systems per frame, in ms (0 for no limit)
+        Real mUpdateTimeBudget;
+        /// Distance at which systems start to lose detail
+        Real mLodStartDistance;
+        /// Distance at which systems reach the minimum detail
+        Real mLodEndDistance;
+        /// Detail factor at and beyond mLodEndDistance
+        Real mMinimumLodFactor;
+        /// Longest iteration interval systems are slowed down to at zero detail
+        Real mMaxLodIterationInterval;
+        /// Global detail factor derived from the budgets
+        Real mBudgetFactor;
+        /// Frame the following statistics are being gathered for
+        unsigned long mStatsFrame;
+        /// Particles that would be alive this frame without the budget factor
+        Real mFrameParticleDemand;
+        /// Time updating systems would take this frame without the budget factor, in ms
+        Real mFrameUpdateDemand;
+
+        /// Adjusts mBudgetFactor from the statistics of the frame just finished
+        void updateBudgetFactor(void);
+
         /// Internal implementation of createSystem
         ParticleSystem* createSystemImpl(const String& name, size_t quota, 
             const String& resourceGroup);
@@ -326,6 +350,73 @@ namespace Ogre {
                 mSystemTemplates.begin(), mSystemTemplates.end());
         } 
 
+        /** Sets the maximum number of particles that may be alive across all
+            particle systems.
+        @remarks
+            When the systems would keep more particles alive than this budget, judged
+            from their emission rates and particle lifetimes, the detail of all systems
+            is lowered gradually: they emit less and their effective quota shrinks, so
+            existing particles expire naturally rather than being removed. Detail is
+            restored gradually once the demand drops again.
+        @param maxParticles The budget, or 0 for no limit (the default)
+        */
+        void setParticleBudget(size_t maxParticles) { mParticleBudget = maxParticles; }
+        /** Gets the maximum number of particles alive across all systems. */
+        size_t getParticleBudget(void) const { return mParticleBudget; }
+
+        /** Sets the time that may be spent updating all particle systems each frame.
+        @remarks
+            Works like setParticleBudget, but based on the measured update time.
+        @param milliseconds The budget, or 0 for no limit (the default)
+        */
+        void setUpdateTimeBudget(Real milliseconds) { mUpdateTimeBudget = milliseconds; }
+        /** Gets the time that may be spent updating all particle systems each frame. */
+        Real getUpdateTimeBudget(void) const { return mUpdateTimeBudget; }
+
+        /** Sets the camera distance range over which particle systems lose detail.
+        @remarks
+            Systems closer than startDistance run at full detail, the detail then
+            decreases linearly until it reaches the minimum detail factor at
+            endDistance. A lower detail scales emission rate and effective quota
+            down and, if setMaxLodIterationInterval is used, lowers the update rate.
+            Setting both distances to 0 (the default) disables distance based detail.
+        */
+        void setLodDistances(Real startDistance, Real endDistance);
+        /** Gets the distance at which particle systems start to lose detail. */
+        Real getLodStartDistance(void) const { return mLodStartDistance; }
+        /** Gets the distance at which particle systems reach the minimum detail. */
+        Real getLodEndDistance(void) const { return mLodEndDistance; }
+
+        /** Sets the detail factor, in [0, 1], of systems at or beyond the LOD end distance. */
+        void setMinimumLodFactor(Real factor);
+        /** Gets the detail factor of systems at or beyond the LOD end distance. */
+        Real getMinimumLodFactor(void) const { return mMinimumLodFactor; }
+
+        /** Sets the iteration interval systems are slowed down to as their detail reaches 0.
+        @remarks
+            The effective interval is ParticleSystem::getIterationInterval, raised towards this
+            value as the detail lowers. 0 (the default) never changes the update rate.
+        */
+        void setMaxLodIterationInterval(Real interval) { mMaxLodIterationInterval = interval; }
+        /** Gets the iteration interval systems are slowed down to as their detail reaches 0. */
+        Real getMaxLodIterationInterval(void) const { return mMaxLodIterationInterval; }
+
+        /** Gets the global detail factor currently applied because of the budgets. */
+        Real getBudgetFactor(void) const { return mBudgetFactor; }
+
+        /** Computes the distance based detail factor for a system (internal use).
+        @remarks
+            The budget factor is not included, it is applied by the system itself.
+        */
+        Real _getLodFactor(Real distance) const;
+
+        /** Internal callback from ParticleSystem::_update, gathering per-frame statistics.
+        @param particleDemand Particles the system would keep alive without the budget factor
+        @param milliseconds Time the update took
+        @param budgetFactor The part of the budget factor the system ran at
+        */
+        void _notifyParticleSystemUpdated(Real particleDemand, Real milliseconds, Real budgetFactor);
+
         /** Get an instance of ParticleSystemFactory (internal use). */
         ParticleSystemFactory* _getFactory(void) { return mFactory; }
         
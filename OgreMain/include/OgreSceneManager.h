@@ -71,6 +71,7 @@ namespace Ogre {
     class InstancedGeometry;
     class Rectangle2D;
     class LodListener;
+    class LightClusters;
     struct MovableObjectLodChangedEvent;
     struct EntityMeshLodChangedEvent;
     struct EntityMaterialLodChangedEvent;
@@ -570,6 +571,33 @@ namespace Ogre {
         LightInfoList mTestLightInfos; // potentially new list
         ulong mLightsDirtyCounter;
 
+        /** Uniform grid over the positional lights affecting the frustum, so that
+            _populateLightList only tests the lights near the query sphere.
+        */
+        struct LightGrid
+        {
+            Vector3 origin;
+            Vector3 invCellSize;
+            int dims[3];
+            /// Offset of the lights of each cell in lightIndices, plus an end offset
+            std::vector<uint32> cellStart;
+            /// Indices into mLightsAffectingFrustum, grouped by cell
+            std::vector<uint32> lightIndices;
+            /// Lights tested by every query (directional and very large lights)
+            std::vector<uint32> globalLights;
+            /// Query stamp per light, used to skip lights found in several cells
+            std::vector<uint32> stamps;
+            std::vector<uint32> candidates;
+            uint32 stamp;
+            /// Value of mLightsDirtyCounter the grid was built for
+            ulong dirtyCounter;
+        };
+        LightGrid mLightGrid;
+        size_t mLightGridThreshold;
+
+        /// Rebuilds mLightGrid from mLightsAffectingFrustum
+        void buildLightGrid(void);
+
         typedef std::map<String, MovableObject*> MovableObjectMap;
         /// Simple structure to hold MovableObject map and a mutex to go with it.
         struct MovableObjectCollection
@@ -625,6 +653,8 @@ namespace Ogre {
             HardwareIndexBufferSharedPtr mShadowIndexBuffer;
             size_t mShadowIndexBufferSize;
             size_t mShadowIndexBufferUsedSize;
+            /// Builds the shadow volumes of all the casters of a light together
+            ShadowVolumeBatch mShadowVolumeBatch;
             GpuProgramParametersSharedPtr mInfiniteExtrusionParams;
             GpuProgramParametersSharedPtr mFiniteExtrusionParams;
 
@@ -670,6 +700,79 @@ namespace Ogre {
             /// default shadow camera setup
             ShadowCameraSetupPtr mDefaultShadowCameraSetup;
 
+            /// Culling planes of a shadow camera, as seen by the shared caster culling pass
+            struct CasterCullingFrustum
+            {
+                Plane planes[6];
+                bool infiniteFar;
+            };
+            /// Object found by the shared caster culling pass, or a node bounding box if object is null
+            struct CulledShadowCaster
+            {
+                MovableObject* object;
+                SceneNode* node;
+                /// Bit i is set if the entry is visible to mCulledCameras[i]
+                uint64 cameraMask;
+            };
+            typedef std::vector<CulledShadowCaster> CulledShadowCasterList;
+
+            bool mSharedCasterCulling;
+            /// Whether the bounds of a node enclose its children, so that they can be culled together
+            bool mCullChildrenByParent;
+            CameraList mCulledCameras;
+            std::vector<CasterCullingFrustum> mCulledFrustums;
+            CulledShadowCasterList mCulledCasters;
+
+            /// Which of the culled objects queueCulledShadowCasters passes on
+            enum CasterFilter
+            {
+                CF_ALL,
+                CF_STATIC,
+                CF_DYNAMIC
+            };
+            /// State a static caster was rendered to a shadow texture cache with
+            struct CachedShadowCaster
+            {
+                const MovableObject* object;
+                Affine3 transform;
+                AxisAlignedBox bounds;
+                /// Mesh LOD of entities, 0 otherwise
+                ushort lodIndex;
+                /// Technique of each renderable, following material and material LOD,
+                /// null for hidden sub entities
+                std::vector<const Technique*> techniques;
+
+                bool operator==(const CachedShadowCaster& rhs) const
+                {
+                    return object == rhs.object && transform == rhs.transform &&
+                           bounds == rhs.bounds && lodIndex == rhs.lodIndex &&
+                           techniques == rhs.techniques;
+                }
+            };
+            /// Static casters of a shadow texture, kept in their own texture
+            struct ShadowTextureCache
+            {
+                ShadowTextureCache() : valid(false), minDistance(0), maxDistance(0) {}
+
+                TexturePtr texture;
+                bool valid;
+                Affine3 viewMatrix;
+                Matrix4 projMatrix;
+                ColourValue shadowColour;
+                /** Depth range shared by the static and the dynamic casters, dynamic
+                    casters only invalidate the cache when they leave it */
+                Real minDistance;
+                Real maxDistance;
+                std::vector<CachedShadowCaster> casters;
+            };
+
+            bool mShadowTextureCaching;
+            CasterFilter mCasterFilter;
+            /// Cache whose depth range applies while mCasterFilter is not CF_ALL
+            const ShadowTextureCache* mFilteredCache;
+            /// Caches for mShadowTextures, by index
+            std::vector<ShadowTextureCache> mShadowTextureCaches;
+
             void setShadowTechnique(ShadowTechnique technique);
 
             /// Internal method for creating shadow textures (texture-based shadows)
@@ -678,6 +781,47 @@ namespace Ogre {
             /// Internal method for destroying shadow textures (texture-based shadows)
             void destroyShadowTextures(void);
 
+            /** Finds the objects visible to all given shadow cameras in one pass over the scene graph.
+            @remarks
+                The scene graph is split by the children of the root node and walked with
+                WorkQueue::parallelFor, each node being tested against all cameras still
+                seeing its parent. The results are consumed by queueCulledShadowCasters.
+            */
+            void cullShadowCasters(const CameraList& cameras);
+            /// Clears the bits of the culled cameras which cannot see the box, same test as Frustum::isVisible
+            uint64 cullCasterBox(const AxisAlignedBox& box, uint64 mask) const;
+            /** Adds the objects of a node to the cameras seeing its bounds.
+            @return The cameras to test the children of the node against
+            */
+            uint64 collectCasters(SceneNode* node, uint64 mask, CulledShadowCasterList& casters) const;
+            /// Adds the objects of a node and all its descendants to the cameras seeing them
+            void collectSubtreeCasters(SceneNode* node, uint64 mask, CulledShadowCasterList& casters) const;
+            /** Queues the objects found by cullShadowCasters for the given camera.
+            @return false if the camera was not part of the pass or has changed since,
+                in which case the caller has to find the visible objects itself
+            */
+            bool queueCulledShadowCasters(Camera* cam, VisibleObjectsBoundsInfo* visibleBounds);
+
+            /** Renders a shadow texture from its static caster cache plus the dynamic casters.
+            @return false if the texture cannot be cached, in which case it has to be
+                rendered as usual
+            */
+            bool renderCachedShadowTexture(size_t index, Camera* texCam, const Viewport* vp);
+            /** Compares the static casters of a shadow texture with the state its cache was rendered with.
+            @param cache The cache, updated to the current state if it no longer matches
+            @param texCam The shadow camera
+            @param c Index of the shadow camera in mCulledCameras
+            @param bounds Receives the depth range of all the casters of the camera
+            @param dynamicCasters Receives whether the camera sees dynamic casters
+            @return true if the cache still holds
+            */
+            bool checkShadowTextureCache(ShadowTextureCache& cache, Camera* texCam, size_t c,
+                                         VisibleObjectsBoundsInfo& bounds, bool& dynamicCasters);
+            /// Index of the camera in mCulledCameras, or its size if the camera is not culled
+            size_t getCulledCameraIndex(const Camera* cam) const;
+            /// Releases the static caster caches
+            void destroyShadowTextureCaches();
+
             /** Internal method for turning a regular pass into a shadow caster pass.
             @remarks
                 This is only used for texture shadows, basically we're trying to
@@ -737,6 +881,17 @@ namespace Ogre {
             void renderShadowVolumesToStencil(const Light* light, const Camera* cam,
                 bool calcScissor);
 
+            /// The shadow volume of one caster, as rendered by renderShadowVolume
+            struct ShadowVolume
+            {
+                ShadowCaster::ShadowRenderableListIterator renderables;
+                unsigned long flags;
+                bool zfail;
+            };
+            /** Internal method rendering the shadow volume of one caster into the stencil buffer. */
+            void renderShadowVolume(const ShadowVolume& volume, const LightList& lightList,
+                bool stencil2sided);
+
             /** Internal utility method for setting stencil state for rendering shadow volumes.
             @param secondpass Is this the second pass?
             @param zfail Should we be using the zfail method?
@@ -861,6 +1016,62 @@ namespace Ogre {
         void renderSingleObject(Renderable* rend, const Pass* pass,
             bool lightScissoringClipping, bool doLightIteration, const LightList* manualLightList = 0);
 
+        /** Internal method for rendering the renderables of a pass group with auto instancing.
+        @remarks
+            Renderables sharing the same vertex and index data (and lights) are issued as
+            a single instanced draw through the global instance vertex buffer, using the
+            first one of each run for all per-object state. Everything else goes through
+            renderSingleObject as usual.
+            The parameters are the same as in renderSingleObject.
+        */
+        void renderAutoInstancedObjects(const RenderableList& rs, const Pass* pass,
+            bool lightScissoringClipping, bool doLightIteration, const LightList* manualLightList);
+
+        /// Lights binned into clusters for each camera, if enabled
+        std::unique_ptr<LightClusters> mLightClusters;
+
+        /// Whether identical renderables should be merged into instanced draws
+        bool mAutoInstancing;
+        /// A renderable and its render operation, gathered while looking for instancing runs
+        struct AutoInstancingEntry
+        {
+            Renderable* rend;
+            RenderOperation op;
+            /// World transform, valid if canInstance()
+            Matrix4 xform;
+            /// Whether the world transform mirrors, which flips the culling
+            bool negativeScale;
+
+            /// Orders entries so that those sharing geometry (and mirroring) end up next to each other
+            bool operator<(const AutoInstancingEntry& rhs) const;
+            /// Whether this entry has the same geometry and mirroring as another one
+            bool sharesRun(const AutoInstancingEntry& rhs) const;
+            /// Whether the renderable can be drawn as an instance of a run
+            bool canInstance() const;
+        };
+        typedef std::vector<AutoInstancingEntry> AutoInstancingEntryList;
+        /// Scratch list reused by renderAutoInstancedObjects
+        AutoInstancingEntryList mAutoInstancingEntries;
+        /// Per-instance world matrices (3 float4 rows each) of the run being drawn
+        HardwareVertexBufferSharedPtr mAutoInstancingBuffer;
+        /// Instance declaration binding the matrix rows to the last 3 texture coordinate sets
+        VertexDeclaration* mAutoInstancingDeclaration;
+        /// Set while an instanced run is issued, so the world matrix parameters are identity
+        bool mAutoInstancingRun;
+        /// Whether any instance of the run being issued is scaled, for normalising normals
+        bool mAutoInstancingRunScaled;
+        /// Whether the instances of the run being issued mirror, for flipping the culling
+        bool mAutoInstancingRunNegativeScale;
+        /// Single identity instance, bound for draws with instanced programs outside of runs
+        HardwareVertexBufferSharedPtr mAutoInstancingIdentityBuffer;
+
+        /// Returns mAutoInstancingDeclaration, creating it on first use
+        VertexDeclaration* getAutoInstancingDeclaration();
+        /** Binds the identity instance if the pass' vertex program reads the world matrix from
+            the instance data but nothing is bound. Returns whether it did.
+        */
+        bool bindAutoInstancingIdentity(const Pass* pass);
+
         /** Internal method for creating the AutoParamDataSource instance. */
         AutoParamDataSource* createAutoParamDataSource(void) const
         {
@@ -1257,6 +1468,18 @@ namespace Ogre {
         */
         ulong _getLightsDirtyCounter(void) const { return mLightsDirtyCounter; }
 
+        /** Sets the number of lights affecting the frustum from which _populateLightList
+            looks lights up in a uniform grid instead of testing each of them.
+        @remarks
+            The grid is rebuilt whenever the lights affecting the frustum change (see
+            _getLightsDirtyCounter), which also covers scene managers that find those
+            lights with their own spatial structures. Results are identical either way.
+        @param count Minimum number of lights, 0 to always test every light. The default is 16.
+        */
+        void setLightGridThreshold(size_t count) { mLightGridThreshold = count; }
+        /// Gets the number of lights from which lights are looked up in a grid
+        size_t getLightGridThreshold(void) const { return mLightGridThreshold; }
+
         /** Get the list of lights which could be affecting the frustum.
         @remarks
             Note that default implementation of this method returns a cached light list,
@@ -2873,6 +3096,58 @@ namespace Ogre {
         /// Gets whether or not texture shadows attempt to self-shadow.
         bool getShadowTextureSelfShadow(void) const
         { return mShadowTextureSelfShadow; }
+        /** Sets whether the shadow casters of all shadow textures are found in one shared pass.
+        @remarks
+            By default each shadow texture walks the scene graph again from its own camera,
+            so e.g. 3 PSSM splits for 2 lights cost 6 culling passes. With this option, which
+            is enabled by default, the scene graph is walked once per frame for all the shadow
+            cameras, in parallel if threading is available. A camera changed afterwards, for
+            instance by a Listener::shadowTextureCasterPreViewProj callback, falls back to the
+            regular _findVisibleObjects.
+        @note
+            This relies on the scene graph to find the visible objects. Scene managers which
+            add objects of their own in _findVisibleObjects should disable it.
+        */
+        void setShadowTextureSharedCasterCulling(bool shared)
+        { mShadowRenderer.mSharedCasterCulling = shared; }
+
+        /// Gets whether the shadow casters of all shadow textures are found in one shared pass.
+        bool getShadowTextureSharedCasterCulling(void) const
+        { return mShadowRenderer.mSharedCasterCulling; }
+
+        /** Sets whether texture shadows keep the static casters of each texture cached.
+        @remarks
+            With caching, the casters marked with MovableObject::setStaticShadowCaster are rendered
+            into a texture of their own per shadow texture, i.e. per light and cascade,
+            which is only rendered again when the shadow camera, the shadow colour or
+            the transform, bounds, visibility, mesh LOD or material technique of one of
+            these casters change. Each frame the cache is copied into the shadow texture
+            and only the dynamic casters are rendered on top, with a minimum blend so the
+            nearest (or darkest) value is kept.
+        @par
+            Static and dynamic casters share the depth range of the cache, which covers
+            all the casters at the time it was rendered. Dynamic casters only cause the
+            cache to be rendered again when they move out of that range.
+        @par
+            This needs the shared caster culling to be enabled and the shadow textures
+            to use a colour format without FSAA. The minimum blend assumes the casters
+            write the shadow colour (modulative shadows) or a single value growing with
+            the depth, so with other techniques only single channel floating point formats
+            are cached. Depth packed into an RGBA texture would be mixed up channel by
+            channel. It pays off for lights whose shadow camera does not follow the view,
+            e.g. point and spot lights or directional lights with a fixed shadow camera setup.
+        @note
+            Changes the cache cannot see, like editing the passes of a material in
+            place, require a call to invalidateShadowTextureCache.
+        */
+        void setShadowTextureCaching(bool enabled);
+
+        /// Gets whether texture shadows keep the static casters of each texture cached.
+        bool getShadowTextureCaching(void) const
+        { return mShadowRenderer.mShadowTextureCaching; }
+
+        /// Forces the static casters of all shadow textures to be rendered again.
+        void invalidateShadowTextureCache();
         /** Sets the default material to use for rendering shadow casters.
         @remarks
             By default shadow casters are rendered into the shadow texture using
@@ -3031,6 +3306,57 @@ namespace Ogre {
             @see setLateMaterialResolving */
         bool isLateMaterialResolving() const { return mLateMaterialResolving; }
 
+        /** Sets whether identical renderables should be drawn with hardware instancing.
+        @remarks
+            When enabled, renderables of an opaque pass group that share vertex data, index data
+            and lights are drawn with a single instanced call, provided the pass has a vertex
+            program flagged with 'includes_instancing true' and the render system supports
+            RSC_VERTEX_BUFFER_INSTANCE_DATA. Typically these are the SubEntities of Entities
+            created from the same mesh. The RTSS generates such programs on its own while
+            auto instancing is enabled for its active SceneManager.
+        @par
+            The world matrices are uploaded as 3 float4 rows per instance, bound to the last 3
+            texture coordinate sets (OGRE_MAX_TEXTURE_COORD_SETS - 3 onwards). The vertex program
+            must move the vertices to world space with them, and normals with their inverse
+            transpose. While a run is drawn the world matrix parameters are identity, so e.g.
+            worldviewproj_matrix becomes the view-projection matrix. Every other draw with such a
+            program (transparent or single renderables, whatever the scene manager setting) gets
+            a single identity instance bound, so the usual world matrix applies. Meshes already
+            using these texture coordinate sets must not be drawn with such programs.
+        @par
+            Mirrored and non mirrored instances form separate runs, so the culling can be
+            flipped. Every renderable of a run has its preRender and postRender methods and the
+            RenderObjectListeners called, but the remaining per-object state (custom parameters,
+            lights) is taken from the renderable that is drawn for the run - the custom parameters
+            of every other instance are dropped. Renderables with more than one world matrix
+            (hardware skinning) are never instanced, so programs skinning their vertices should
+            not include instancing. Nothing happens while a global instance vertex buffer has
+            been set manually.
+        @par
+            The RTSS regenerates its shaders when it notices that this setting changed.
+        */
+        void setAutoInstancingEnabled(bool enabled) { mAutoInstancing = enabled; }
+
+        /** Gets whether identical renderables are drawn with hardware instancing.
+            @see setAutoInstancingEnabled */
+        bool isAutoInstancingEnabled() const { return mAutoInstancing; }
+
+        /** Sets whether the lights affecting the frustum are binned into clusters for
+            clustered forward shading.
+        @remarks
+            When enabled, the lights are binned with LightClusters and uploaded to its
+            textures for every camera rendered, after the lights affecting the frustum
+            have been found. Shaders such as the RTShader::ClusteredLighting sub render
+            state then light each fragment with the lights of its cluster, in a single
+            pass regardless of the per object light lists.
+        */
+        void setLightClustersEnabled(bool enabled);
+
+        /** Gets the light clusters, to configure them or read the last results.
+        @return NULL unless enabled with setLightClustersEnabled
+        */
+        LightClusters* getLightClusters() const { return mLightClusters.get(); }
+
         /** Gets the active compositor chain of the current scene being rendered */
         CompositorChain* _getActiveCompositorChain() const { return mActiveCompositorChain; }
 
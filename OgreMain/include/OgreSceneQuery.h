@@ -372,9 +372,17 @@ namespace Ogre {
     protected:
         Ray mRay;
         bool mSortByDistance;
+        bool mTriangleAccurate;
         ushort mMaxResults;
         RaySceneQueryResult mResult;
 
+        /** Refines a bounding volume hit against the triangles of the object, if enabled.
+        @param obj The object whose bounds the ray intersects
+        @param distance Distance of the bounds hit, replaced by the distance of the triangle hit
+        @return false if the ray misses the triangles, true otherwise
+        */
+        bool intersectsTriangles(MovableObject* obj, Real& distance);
+
     public:
         RaySceneQuery(SceneManager* mgr);
         virtual ~RaySceneQuery();
@@ -406,6 +414,17 @@ namespace Ogre {
         /** Gets the maximum number of results returned from the query (only relevant if 
         results are being sorted) */
         virtual ushort getMaxResults(void) const;
+        /** Sets whether Entity results are tested against their triangles.
+        @remarks
+            By default results are based on bounding volumes only. If enabled, Entities
+            whose bounds are hit are also tested against their mesh triangles (see
+            Entity::intersectsTriangles), are dropped when the ray misses them and report
+            the distance of the nearest triangle. The triangle hierarchy of each mesh is
+            built on first use, see Mesh::buildTriangleBVH.
+        */
+        void setTriangleAccurate(bool accurate) { mTriangleAccurate = accurate; }
+        /** Gets whether Entity results are tested against their triangles. */
+        bool getTriangleAccurate(void) const { return mTriangleAccurate; }
         /** Executes the query, returning the results back in one list.
         @remarks
             This method executes the scene query as configured, gathers the results
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreRenderable.h"
 #include "OgreRenderOperation.h"
+#include "OgreVector4.h"
 #include "OgreHeaderPrefix.h"
 
 
@@ -246,6 +247,78 @@ namespace Ogre {
 
 
     };
+
+    /** Builds the shadow volumes of several casters for one light together.
+    @remarks
+        While a batch is active, ShadowCaster::updateEdgeListLightFacing calculates the
+        light facing triangles into storage of the batch and ShadowCaster::generateShadowVolume
+        only records the volume. end then extracts the silhouettes and writes the volume
+        indexes of all the casters with WorkQueue::parallelFor, into a single locked range
+        of the shadow index buffer in which each caster gets a preallocated part.
+    @par
+        The volumes are only built by end, so the casters must not reuse their renderables
+        in between. This rules out software extrusion, which writes position buffers
+        possibly shared by several casters; batches are meant for vertex program extrusion.
+        Recording happens on the rendering thread only.
+    */
+    class _OgreExport ShadowVolumeBatch : public ShadowDataAlloc
+    {
+    public:
+        ShadowVolumeBatch();
+        ~ShadowVolumeBatch();
+
+        /// Starts recording shadow volumes, making this batch the active one
+        void begin();
+        /** Builds the shadow volumes recorded since begin and deactivates the batch.
+        @param indexBuffer
+            The buffer to build into, grown through the current SceneManager if too small
+        @param indexBufferUsedSize
+            As for ShadowCaster::generateShadowVolume
+        */
+        void end(const HardwareIndexBufferSharedPtr& indexBuffer, size_t& indexBufferUsedSize);
+        /// Drops the recorded shadow volumes and deactivates the batch
+        void cancel();
+
+        /// The batch currently recording, if any
+        static ShadowVolumeBatch* getActive(void) { return msActive; }
+
+        /// Internal method calculating the light facing triangles of ShadowCaster::updateEdgeListLightFacing
+        void _setLightPosition(const EdgeData* edgeData, const Vector4& lightPos);
+        /** Internal method recording a shadow volume instead of building it.
+        @return
+            false if the light facing for the edge data was not calculated, in which case
+            the volume has to be built right away
+        */
+        bool _add(const EdgeData* edgeData, const Light* light, bool useMcGuire,
+            ShadowCaster::ShadowRenderableList& shadowRenderables, unsigned long flags);
+
+    private:
+        struct Volume
+        {
+            const EdgeData* edgeData;
+            const Light* light;
+            ShadowCaster::ShadowRenderableList* renderables;
+            bool useMcGuire;
+            unsigned long flags;
+            std::vector<char> lightFacings;
+            size_t indexStart;
+            size_t indexCount;
+        };
+        /// Recorded volumes, the first mVolumeCount are in use
+        std::vector<Volume> mVolumes;
+        size_t mVolumeCount;
+        const EdgeData* mPendingEdgeData;
+        std::vector<char> mPendingLightFacings;
+        unsigned short* mIndexes;
+        size_t mIndexBase;
+
+        /// Counts the indexes of a volume
+        void prepareVolume(size_t v);
+        /// Writes the indexes of a volume into its range
+        void writeVolume(size_t v);
+
+        static ShadowVolumeBatch* msActive;
+    };
     /** @} */
     /** @} */
 } // namespace Ogre
@@ -154,10 +154,15 @@ namespace Ogre {
         };
         typedef std::vector<SubMeshLodGeometryLink> SubMeshLodGeometryLinkList;
         typedef std::map<SubMesh*, SubMeshLodGeometryLinkList*> SubMeshGeometryLookup;
+        class Region;
         /// Structure recording a queued submesh for the build
         struct QueuedSubMesh : public BatchedGeometryAlloc
         {
             SubMesh* submesh;
+            /// Entity this was queued from, only compared against in removeEntity
+            const Entity* entity;
+            /// Region this was assigned to by the last build, 0 if not built yet
+            Region* region;
             /// Link to LOD list of geometry, potentially optimised
             SubMeshLodGeometryLinkList* geometryLodList;
             String materialName;
@@ -181,7 +186,8 @@ namespace Ogre {
         // forward declarations
         class LODBucket;
         class MaterialBucket;
-        class Region;
+        /// Source buffers locked once up front for a threaded build
+        typedef std::map<HardwareBuffer*, const uchar*> SourceLockMap;
 
         /** A GeometryBucket is a the lowest level bucket where geometry with 
             the same vertex & index format is stored. It also acts as the 
@@ -206,6 +212,9 @@ namespace Ogre {
             HardwareIndexBuffer::IndexType mIndexType;
             /// Maximum vertex indexable
             size_t mMaxVertexIndex;
+            /// Destination locks held between _beginBuild and _endBuild
+            void* mIndexLock;
+            std::vector<uchar*> mVertexLocks;
 
             template<typename T>
             void copyIndexes(const T* src, T* dst, size_t count, size_t indexOffset)
@@ -246,6 +255,19 @@ namespace Ogre {
             bool assign(QueuedGeometry* qsm);
             /// Build
             void build(bool stencilShadows);
+            /// Create and lock the destination buffers; not thread safe
+            void _beginBuild(bool stencilShadows);
+            /** Transform the queued geometry into the locked buffers.
+            @remarks
+                Only touches memory owned by this bucket, so several buckets may
+                do this concurrently provided their sources are locked in advance.
+            @param sourceLocks Pre-locked source buffers, or null to lock them here
+            */
+            void _copyGeometry(const SourceLockMap* sourceLocks);
+            /// Unlock the destination buffers and finish shadow data; not thread safe
+            void _endBuild(bool stencilShadows);
+            /// Add the source buffers this bucket reads to the list
+            void _getSourceBuffers(std::vector<HardwareBuffer*>& buffers) const;
             /// Dump contents for diagnostics
             void dump(std::ofstream& of) const;
         };
@@ -284,6 +306,10 @@ namespace Ogre {
             void assign(QueuedGeometry* qsm);
             /// Build
             void build(bool stencilShadows);
+            /// First half of build, loads the material and creates the geometry buffers
+            void _beginBuild(bool stencilShadows);
+            /// Second half of build, to be called once the geometry is filled
+            void _endBuild(bool stencilShadows);
             /// Add children to the render queue
             void addRenderables(RenderQueue* queue, uint8 group, 
                 Real lodValue);
@@ -361,6 +387,10 @@ namespace Ogre {
             void assign(QueuedSubMesh* qsm, ushort atLod);
             /// Build
             void build(bool stencilShadows);
+            /// First half of build, creates the geometry buffers but does not fill them
+            void _beginBuild(bool stencilShadows);
+            /// Second half of build, to be called once the geometry is filled
+            void _endBuild(bool stencilShadows);
             /// Add children to the render queue
             void addRenderables(RenderQueue* queue, uint8 group, 
                 Real lodValue);
@@ -441,6 +471,14 @@ namespace Ogre {
             void assign(QueuedSubMesh* qmesh);
             /// Build this region
             void build(bool stencilShadows);
+            /// First half of build, creates the geometry buffers but does not fill them
+            void _beginBuild(bool stencilShadows);
+            /// Second half of build, to be called once the geometry is filled
+            void _endBuild(bool stencilShadows);
+            /// Destroy the built state and forget the assigned meshes, ready to assign again
+            void _clear(void);
+            /// Add the geometry buckets of all LODs to the list
+            void _getGeometryBuckets(std::vector<GeometryBucket*>& buckets);
             /// Get the region ID of this region
             uint32 getID(void) const { return mRegionID; }
             /// Get the centre point of the region
@@ -506,6 +544,8 @@ namespace Ogre {
         uint32 mVisibilityFlags;
 
         QueuedSubMeshList mQueuedSubMeshes;
+        /// Regions which lost geometry since the last build
+        std::set<Region*> mDirtyRegions;
 
         /// List of geometry which has been optimised for SubMesh use
         /// This is the primary storage used for cleaning up later
@@ -556,6 +596,9 @@ namespace Ogre {
         /** Split some shared geometry into dedicated geometry. */
         void splitGeometry(VertexData* vd, IndexData* id, 
             SubMeshLodGeometryLink* targetGeomLink);
+        /** Build a set of regions which already have their submeshes assigned,
+            filling the geometry buckets on worker threads. */
+        void buildRegions(const std::vector<Region*>& regions);
 
         typedef std::map<size_t, size_t> IndexRemap;
         /** Method for figuring out which vertices are used by an index buffer
@@ -607,7 +650,8 @@ namespace Ogre {
             completely safely, and destroy the Entity before destroying 
             this StaticGeometry if you like. The Entity passed in is simply 
             used as a definition.
-        @note Must be called before 'build'.
+        @note If called after 'build', the entity is only added to the batches
+            by the next call to build or rebuildDirtyRegions.
         @param ent The Entity to use as a definition (the Mesh and Materials 
             referenced will be recorded for the build call).
         @param position The world position at which to add this Entity
@@ -632,24 +676,44 @@ namespace Ogre {
             of rendering <i>both</i> the original objects and their new static
             versions! We don't do this for you incase you are preparing this 
             in advance and so don't want the originals detached yet. 
-        @note Must be called before 'build'.
+        @note If called after 'build', the entities are only added to the
+            batches by the next call to build or rebuildDirtyRegions.
         @param node Pointer to the node to use to provide a set of Entity 
             templates
         */
         virtual void addSceneNode(const SceneNode* node);
 
+        /** Removes everything that was queued from the given Entity.
+        @remarks
+            The Entity is only used as a key, it may already have been destroyed.
+            If the geometry was built, the regions it was part of are rebuilt
+            by the next call to rebuildDirtyRegions.
+        */
+        virtual void removeEntity(const Entity* ent);
+
         /** Build the geometry. 
         @remarks
             Based on all the entities which have been added, and the batching 
             options which have been set, this method constructs the batched 
             geometry structures required. The batches are added to the scene 
             and will be rendered unless you specifically hide them.
+        @par
+            Independent geometry buckets are filled on the worker threads of the
+            Root WorkQueue, see WorkQueue::parallelFor.
         @note
-            Once you have called this method, you can no longer add any more 
-            entities.
+            To change a few entities after this has been called, use addEntity
+            and removeEntity followed by rebuildDirtyRegions rather than
+            rebuilding everything.
         */
         virtual void build(void);
 
+        /** Rebuilds only the regions affected by addEntity, addSceneNode or
+            removeEntity since the last build.
+        @remarks
+            Falls back to a full build if nothing has been built yet.
+        */
+        virtual void rebuildDirtyRegions(void);
+
         /** Destroys all the built geometry state (reverse of build). 
         @remarks
             You can call build() again after this and it will pick up all the
@@ -122,6 +122,27 @@ namespace Ogre {
         mutable Real mCachedCameraDist;
         /// The camera for which the cached distance is valid
         mutable const Camera *mCachedCamera;
+        /// Index data covering only the meshlets visible to the last camera
+        std::unique_ptr<IndexData> mVisibleMeshletIndexData;
+        /// Buffer the visible meshlets are compacted into when they aren't contiguous
+        HardwareIndexBufferSharedPtr mVisibleMeshletIndexBuffer;
+        /// Visible meshlet ranges as (start, end) pairs, relative to the submesh index start
+        std::vector<std::pair<uint32, uint32> > mVisibleMeshletRanges;
+        /// The ranges mVisibleMeshletIndexBuffer holds, copied from mCompactedMeshletSource
+        std::vector<std::pair<uint32, uint32> > mCompactedMeshletRanges;
+        /// The index buffer mCompactedMeshletRanges refer to
+        const HardwareIndexBuffer* mCompactedMeshletSource;
+        /// Whether mVisibleMeshletIndexData replaces the submesh index data
+        bool mUseVisibleMeshlets;
+
+        /** Internal method for restricting the index data to the meshlets visible from a camera.
+        @param cam
+            Camera to cull against, or null to draw all the index data again.
+        */
+        void updateVisibleMeshlets(const Camera* cam);
+        /// Returns true if meshlet culling left nothing to draw
+        bool areAllMeshletsCulled() const
+        { return mUseVisibleMeshlets && mVisibleMeshletIndexData->indexCount == 0; }
 
         /** Internal method for preparing this Entity for use in animation. */
         void prepareTempBlendBuffers(void);
@@ -132,6 +132,36 @@ namespace Ogre {
          */
         std::vector<Vector3> extremityPoints;
 
+        /** A run of triangles of the index buffer which can be culled on its own.
+            @see buildMeshlets
+        */
+        struct Meshlet
+        {
+            /// First index of the meshlet, relative to indexData->indexStart
+            uint32 indexStart;
+            /// Number of indices in the meshlet
+            uint32 indexCount;
+            /// Centre of the bounding sphere, in mesh space
+            Vector3 centre;
+            /// Radius of the bounding sphere
+            Real radius;
+            /// Average facing of the triangles
+            Vector3 coneAxis;
+            /** All triangles face away from a viewpoint p if
+                (centre - p).dotProduct(coneAxis) >= coneCutoff * (centre - p).length() + radius.
+                1 when the triangles face too many directions for this test to ever succeed.
+            */
+            Real coneCutoff;
+        };
+        typedef std::vector<Meshlet> MeshletList;
+
+        /** Meshlets partitioning the index data (LOD 0 only), in index buffer order (optional).
+            @remarks
+                Built with buildMeshlets or loaded from the .mesh file. An Entity with
+                meshlet culling enabled draws only the meshlets its camera can see.
+        */
+        MeshletList meshlets;
+
         /// Reference to parent Mesh (not a smart pointer so child does not keep parent alive).
         Mesh* parent;
 
@@ -248,6 +278,19 @@ namespace Ogre {
         */
         void generateExtremes(size_t count);
 
+        /** Splits the triangle list into meshlets (@see meshlets).
+        @remarks
+            Triangles are grown into spatially coherent groups over shared vertices, and the
+            index buffer is rewritten so that each meshlet is a contiguous range of it.
+            Since this changes the triangle order, prefer Mesh::buildMeshlets which also keeps
+            the edge lists in sync.
+            Nothing is done for non triangle list submeshes, or if a LOD level shares the
+            index buffer.
+        @param maxTriangles
+            Maximum number of triangles in a meshlet.
+        */
+        void buildMeshlets(size_t maxTriangles = 64);
+
         /** Returns true(by default) if the submesh should be included in the mesh EdgeList, otherwise returns false.
         */      
         bool isBuildEdgesEnabled(void) const { return mBuildEdgesEnabled; }
@@ -44,6 +44,10 @@ namespace Ogre
     *  @{
     */
     /** Class for calculating a tangent space basis.
+    @remarks
+        The vertex data must already contain normals, they are not generated here.
+        The per face and per vertex passes use WorkQueue::parallelFor, the result
+        is the same as for a serial build.
     */
     class _OgreExport TangentSpaceCalc
     {
@@ -158,6 +162,11 @@ namespace Ogre
             Only indexed triangle lists are allowed. Strips and fans cannot be
             supported because it may be necessary to split the geometry up to 
             respect deviances in the tangent space basis better.
+        @par
+            Faces and vertices are processed with WorkQueue::parallelFor, except the
+            accumulation into split vertices (see setSplitMirrored and
+            setSplitRotated), which has to visit the faces in order. Results do not
+            depend on the number of threads.
         @param targetSemantic The semantic to store the tangents in. Defaults to 
             the explicit tangent binding, but note that this is only usable on more
             modern hardware (Shader Model 2), so if you need portability with older
@@ -209,6 +218,28 @@ namespace Ogre
         typedef std::vector<VertexInfo> VertexInfoArray;
         VertexInfoArray mVertexArray;
 
+        /// Vertex indexes of the triangles of all index sets, strip winding already corrected
+        std::vector<uint32> mFaceVertices;
+        /// First triangle of each index set in mFaceVertices, plus the total
+        std::vector<size_t> mIndexSetFaceStart;
+
+        /// Tangent space of a triangle
+        struct FaceInfo
+        {
+            Vector3 tsU;
+            Vector3 tsV;
+            Vector3 norm;
+            /// Angle of the face at each of its vertices
+            Real angleWeight[3];
+        };
+        typedef std::vector<FaceInfo> FaceInfoArray;
+        FaceInfoArray mFaceArray;
+        /// Triangle at mFaceArray[0]
+        size_t mFaceArrayStart;
+        /// Faces referencing each vertex, as face * 3 + corner, indexed by mVertexFaceStart
+        std::vector<uint32> mVertexFaces;
+        std::vector<uint32> mVertexFaceStart;
+
         void extendBuffers(VertexSplits& splits);
         void insertTangents(Result& res,
             VertexElementSemantic targetSemantic, 
@@ -216,12 +247,18 @@ namespace Ogre
 
         void populateVertexArray(unsigned short sourceTexCoordSet);
         void processFaces(Result& result);
+        void populateFaceVertices();
+        /// Calculate the tangent space of faces [begin, end)
+        void calculateFaces(size_t begin, size_t end);
+        /// Sum up the tangent spaces of the faces around a vertex
+        void accumulateVertex(size_t v);
         /// Calculate face tangent space, U and V are weighted by UV area, N is normalised
         void calculateFaceTangentSpace(const size_t* vertInd, Vector3& tsU, Vector3& tsV, Vector3& tsN);
         Real calculateAngleWeight(size_t v0, size_t v1, size_t v2);
         int calculateParity(const Vector3& u, const Vector3& v, const Vector3& n);
         void addFaceTangentSpaceToVertices(size_t indexSet, size_t faceIndex, size_t *localVertInd, 
-            const Vector3& faceTsU, const Vector3& faceTsV, const Vector3& faceNorm, Result& result);
+            const Vector3& faceTsU, const Vector3& faceTsV, const Vector3& faceNorm,
+            const Real* angleWeights, Result& result);
         void normaliseVertices();
         void remapIndexes(Result& res);
         template <typename T>
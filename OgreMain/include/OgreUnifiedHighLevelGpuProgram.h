@@ -139,6 +139,7 @@ namespace Ogre {
         ushort getNumberOfPosesIncluded(void) const;
 
         bool isVertexTextureFetchRequired(void) const;
+        bool isInstancingIncluded(void) const;
         GpuProgramParametersSharedPtr getDefaultParameters(void);
         bool hasDefaultParameters(void) const;
         bool getPassSurfaceAndLightStates(void) const;
@@ -31,6 +31,8 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreHardwareVertexBuffer.h"
 #include "OgreHardwareIndexBuffer.h"
+#include "OgreVector4.h"
+#include "OgreMath.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre {
@@ -234,6 +236,64 @@ namespace Ogre {
         */
         ushort allocateHardwareAnimationElements(ushort count, bool animateNormals);
 
+        /** Offset (xyz) and uniform scale (w) restoring positions stored by quantise().
+        @remarks
+            The object space position is pos * positionDecode.w + positionDecode.xyz, where
+            pos is the normalised VET_SHORT4_NORM value. Renderables fold this into their
+            world transform. It is (0, 0, 0, 1) when the positions are not quantised.
+        */
+        Vector4 positionDecode;
+
+        /// Sizes and worst case errors of a quantise() call
+        struct QuantisationReport
+        {
+            /// Size of the affected vertex buffers before quantisation, in bytes
+            size_t bytesBefore;
+            /// Size of the affected vertex buffers after quantisation, in bytes
+            size_t bytesAfter;
+            /// Largest distance between an original and a decoded position
+            Real maxPositionError;
+            /// Largest angle between an original and a decoded normal, tangent or binormal
+            Radian maxDirectionError;
+            /// Largest difference between an original and a decoded texture coordinate
+            Real maxTexCoordError;
+
+            QuantisationReport()
+                : bytesBefore(0), bytesAfter(0), maxPositionError(0), maxDirectionError(0),
+                  maxTexCoordError(0) {}
+        };
+
+        /** Stores vertex elements in more compact formats, decoded by the vertex fetch.
+        @remarks
+            VET_FLOAT3 positions become VET_SHORT4_NORM relative to their bounding box,
+            see positionDecode. VET_FLOAT3 and VET_FLOAT4 normals, tangents and binormals
+            become VET_SHORT4_NORM, keeping the sign of a fourth (parity) component.
+            VET_FLOAT2 texture coordinates within [0, 1] become VET_USHORT2_NORM, those
+            within [-1, 1] VET_SHORT2_NORM, and others are left alone. New vertex buffers
+            are created, with the usage and shadow buffer settings of the old ones.
+        @par
+            Code reading positions on the CPU (software animation, shadow volumes, edge lists)
+            expects VET_FLOAT3, so this should be the last step applied to the data. StaticGeometry
+            and InstanceManager reject meshes with quantised positions or directions.
+        @note
+            Normalised positions and texture coordinates can only be read by vertex programs.
+            The fixed function pipelines of D3D9 and GL do not normalise them, and GL throws
+            when asked to draw quantised texture coordinates without a vertex program.
+        @param positions Whether to quantise positions
+        @param directions Whether to quantise normals, tangents and binormals
+        @param texCoords Whether to quantise 2D texture coordinates
+        @param report The buffer sizes and errors are accumulated into this
+        */
+        void quantise(bool positions, bool directions, bool texCoords, QuantisationReport& report);
+
+        /** Reads the object space positions, starting at vertexStart.
+        @remarks
+            Quantised positions are decoded with positionDecode.
+        @param positions Receives vertexCount positions, or none without a position element
+        @exception Exception::ERR_INVALIDPARAMS if positions are neither VET_FLOAT3
+            nor VET_SHORT4_NORM
+        */
+        void readPositions(std::vector<Vector3>& positions) const;
 
 
     };
@@ -272,8 +332,30 @@ namespace Ogre {
             Can only be used for index data which consists of triangle lists.
             It would in fact be pointless to use it on triangle strips or fans
             in any case.
+        @par
+            Triangles are reordered greedily against a simulated 32 entry
+            post-transform cache (Forsyth's linear-speed algorithm), which runs
+            in roughly linear time and is not tied to a particular cache size.
+            The winding of each triangle is preserved.
         */
         void optimiseVertexCacheTriList(void);
+
+        /** Re-order clusters of triangles so that outward facing ones are drawn
+            first, which reduces overdraw from most view directions.
+        @remarks
+            Can only be used for index data which consists of triangle lists, and is
+            meant to run after optimiseVertexCacheTriList. Following Sander et al.,
+            "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", the
+            triangle sequence is split into clusters where restarting the vertex cache
+            costs little, then the clusters are sorted by how far their area weighted
+            normal points away from the centre of the mesh. The order depends on the
+            geometry only, not on a view point.
+        @param vertexData The vertices the indexes refer to
+        @param threshold How much the vertex cache efficiency may degrade, 1.05
+            allows ACMR to grow by 5%. Higher values give more, smaller clusters. If
+            the reordered list misses the cache more than that, it is left as it was.
+        */
+        void optimiseOverdrawTriList(const VertexData* vertexData, Real threshold = 1.05f);
     
     };
 
@@ -297,6 +379,9 @@ namespace Ogre {
             }
 
             void profile(const HardwareIndexBufferSharedPtr& indexBuffer);
+            /// Profiles the indexes of a range of the buffer only
+            void profile(const HardwareIndexBufferSharedPtr& indexBuffer, size_t indexStart,
+                         size_t indexCount);
             void reset() { hit = 0; miss = 0; tail = 0; buffersize = 0; }
             void flush() { tail = 0; buffersize = 0; }
 
@@ -0,0 +1,288 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreVirtualShadowMap_H_
+#define _OgreVirtualShadowMap_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreCommon.h"
+#include "OgreMatrix4.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+    /** A shadow map of very high virtual resolution, of which only the pages the
+        receivers need are rendered, into a physical atlas of fixed size.
+    @remarks
+        The virtual map covers the whole light projection, for instance an orthographic
+        projection of the world for the sun instead of a set of PSSM splits. It has a mip
+        chain of page levels: level 0 has getPagesPerSide() pages per side, every further
+        level half as many, down to a single page. Distant receivers use coarser levels.
+    @par
+        Every frame, between beginFrame() and update(), the receivers request the pages
+        they need, analytically from their bounds (requestReceiver) and / or from a low
+        resolution readback of the camera depth (requestFromDepth). A requested page also
+        requests its coarser ancestors, so lookups can always fall back to a coarser level.
+        update() keeps requested pages that are resident and clean, allocates atlas slots
+        for the missing ones, coarsest first, evicting the least recently used pages which
+        were not requested, and lists the pages that have to be rendered: the new ones and
+        the dirty ones. Pages get dirty through invalidate, when casters change, or all of
+        them when the light matrices change.
+    @par
+        The page table logic does not need a render system. renderPages() renders the
+        listed pages through a viewport into the atlas, and uploadPageTable() copies the
+        page table into a texture for receivers to look their atlas coordinates up in.
+    */
+    class _OgreExport VirtualShadowMap : public ShadowDataAlloc
+    {
+    public:
+        /// A page of the virtual map
+        struct PageId
+        {
+            uint16 level;
+            uint16 x;
+            uint16 y;
+        };
+        /// A page which has to be rendered, and the atlas slot to render it into
+        struct PageRender
+        {
+            PageId page;
+            uint32 slot;
+        };
+        typedef std::vector<PageRender> PageRenderList;
+
+        /** Constructor.
+        @param name
+            Prefix of the page table texture name
+        */
+        VirtualShadowMap(const String& name);
+        ~VirtualShadowMap();
+
+        const String& getName(void) const { return mName; }
+
+        /** Sets the sizes of the map, dropping all resident pages.
+        @param virtualSize
+            Texels per side of the virtual map at level 0, a power of two
+        @param pageSize
+            Texels per side of a page, a power of two no larger than either of the others
+        @param atlasSize
+            Texels per side of the physical atlas, a power of two
+        */
+        void setSizes(uint32 virtualSize, uint32 pageSize, uint32 atlasSize);
+        uint32 getVirtualSize(void) const { return mVirtualSize; }
+        uint32 getPageSize(void) const { return mPageSize; }
+        uint32 getAtlasSize(void) const { return mAtlasSize; }
+        /// Pages per side of the virtual map at level 0
+        uint32 getPagesPerSide(void) const { return mVirtualSize / mPageSize; }
+        /// Number of page levels
+        uint16 getNumLevels(void) const { return static_cast<uint16>(mPageTables.size()); }
+        /// Number of pages the atlas holds
+        uint32 getNumSlots(void) const { return static_cast<uint32>(mSlots.size()); }
+
+        /** Sets the light view and projection matrices the virtual map covers.
+        @remarks
+            All resident pages get dirty if these differ from the previous ones, so
+            directional lights should use a projection which does not follow the camera,
+            or only moves in steps of whole pages.
+        */
+        void setLightMatrices(const Affine3& viewMatrix, const Matrix4& projectionMatrix);
+        const Affine3& getLightViewMatrix(void) const { return mViewMatrix; }
+        const Matrix4& getLightProjectionMatrix(void) const { return mProjectionMatrix; }
+
+        /** Sets a factor on the requested shadow texel sizes.
+        @remarks
+            Above 1 requests coarser pages than the screen resolution needs, below 1
+            finer ones. The default is 1.
+        */
+        void setTexelSizeFactor(Real factor) { mTexelSizeFactor = factor; }
+        Real getTexelSizeFactor(void) const { return mTexelSizeFactor; }
+
+        /// Starts a new frame of page requests
+        void beginFrame(void);
+
+        /** Requests the pages covering world space bounds, at the level giving shadow
+            texels of at most the given world space size.
+        */
+        void requestBounds(const AxisAlignedBox& bounds, Real worldTexelSize);
+        /** Requests the pages covering the bounds of a receiver, at the resolution it
+            needs on screen.
+        @remarks
+            The texel size is taken at the point of the bounds closest to the camera,
+            so large receivers like terrain should rather be requested in parts or
+            through requestFromDepth.
+        @param bounds
+            World space bounds of the receiver
+        @param camera
+            The camera the receiver is seen through
+        @param viewportHeight
+            Height of the viewport in pixels
+        */
+        void requestReceiver(const AxisAlignedBox& bounds, const Camera* camera,
+                             Real viewportHeight);
+        /** Requests the pages needed by the visible pixels of a camera.
+        @param depth
+            PF_FLOAT32_R view space depths, that is distances along the view direction,
+            of a low resolution rendering of the camera. 0 or less for no receiver.
+        @param camera
+            The camera the depths were rendered with
+        @param viewportHeight
+            Height of the full resolution viewport in pixels
+        */
+        void requestFromDepth(const PixelBox& depth, const Camera* camera, Real viewportHeight);
+        /// Requests a single page, and its ancestors
+        void requestPage(const PageId& page);
+
+        /// Marks the resident pages overlapping world space bounds as dirty
+        void invalidate(const AxisAlignedBox& bounds);
+        /// Marks all resident pages as dirty
+        void invalidateAll(void);
+        /// Drops all resident pages
+        void clear(void);
+
+        /** Allocates the pages requested since beginFrame and lists those to render.
+        @return
+            The pages to render, as getPagesToRender()
+        */
+        const PageRenderList& update(void);
+
+        /// The pages to render since the last update
+        const PageRenderList& getPagesToRender(void) const { return mPagesToRender; }
+        /// Number of pages requested in the last frame, ancestors included
+        size_t getNumRequestedPages(void) const { return mRequests.size(); }
+        /// Number of requested pages the last update found no slot for
+        size_t getNumDroppedPages(void) const { return mNumDroppedPages; }
+        /// Number of pages in the atlas
+        size_t getNumResidentPages(void) const { return mSlots.size() - mFreeSlots.size(); }
+
+        /** Atlas slot of a page, or -1 if the page is not resident.
+        @param fallback
+            Whether to return the slot of the closest resident ancestor instead
+        @param resolvedLevel
+            Optional, gets the level of the returned slot
+        */
+        int32 getSlot(const PageId& page, bool fallback = false, uint16* resolvedLevel = 0) const;
+        /// Area of an atlas slot in normalised coordinates, origin at the top left as for viewports
+        RealRect getSlotRect(uint32 slot) const;
+        /// Area of a page in normalised virtual map coordinates, origin at the top left
+        RealRect getPageRect(const PageId& page) const;
+        /// Light projection matrix cropped to a page, to render it with
+        Matrix4 getPageProjectionMatrix(const PageId& page) const;
+
+        /** Renders the pages of the last update into the atlas.
+        @remarks
+            Sets the dimensions of the viewport to each slot in turn, and the light
+            matrices of the page onto its camera, then updates it. The dimensions and
+            the custom matrices, if any, are restored afterwards. The viewport should
+            clear for every frame, which only clears the slot, and use a material
+            scheme rendering depth.
+        @param viewport
+            A viewport of the atlas render target
+        */
+        void renderPages(Viewport* viewport);
+
+        /** Copies the page table into a PF_FLOAT32_RGBA texture of getPagesPerSide()
+            texels per side, with a mipmap per level.
+        @remarks
+            The texel of a page holds the top left atlas coordinates of its closest
+            resident ancestor, its pages per side and 1, or all 0 if there is none. The
+            atlas coordinates of virtual map coordinates uv are then
+            texel.xy + fract(uv * texel.z) * getPageSize() / getAtlasSize().
+        */
+        void uploadPageTable(void);
+        /// The page table texture, once uploaded
+        const TexturePtr& getPageTableTexture(void) const { return mPageTableTexture; }
+        /// Releases the page table texture
+        void destroyPageTableTexture(void);
+
+    private:
+        struct Slot
+        {
+            PageId page;
+            /// Frame the page was last requested in
+            uint32 lastUsedFrame;
+            bool used;
+            bool dirty;
+        };
+        /// Orders slots by eviction preference
+        struct EvictionOrder;
+
+        /// Projects world space bounds to a virtual map area, false if not possible
+        bool projectBounds(const AxisAlignedBox& bounds, RealRect& rect, Real& w) const;
+        /// Level whose texels are at most a world space size at light clip space w
+        uint16 getLevel(Real worldTexelSize, Real w) const;
+        /// Requests the pages of a level overlapping a virtual map area
+        void requestRect(uint16 level, const RealRect& rect);
+        /// Size in world units of a screen pixel at a view depth
+        Real getPixelSize(const Camera* camera, Real depth, Real viewportHeight) const;
+        size_t getPageIndex(const PageId& page) const
+        {
+            return static_cast<size_t>(page.y) * (getPagesPerSide() >> page.level) + page.x;
+        }
+        void evict(uint32 slot);
+
+        String mName;
+        uint32 mVirtualSize;
+        uint32 mPageSize;
+        uint32 mAtlasSize;
+        Real mTexelSizeFactor;
+
+        Affine3 mViewMatrix;
+        Matrix4 mProjectionMatrix;
+        Matrix4 mViewProjMatrix;
+
+        /// Per level, slot + 1 of every page, 0 if not resident
+        std::vector<std::vector<uint32> > mPageTables;
+        /// Per level, whether every page is requested in the current frame
+        std::vector<std::vector<bool> > mRequested;
+        std::vector<PageId> mRequests;
+
+        std::vector<Slot> mSlots;
+        std::vector<uint32> mFreeSlots;
+        uint32 mFrame;
+
+        PageRenderList mPagesToRender;
+        size_t mNumDroppedPages;
+
+        TexturePtr mPageTableTexture;
+        /// Staging memory for the page table texture
+        std::vector<float> mUploadBuffer;
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
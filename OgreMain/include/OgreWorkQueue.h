@@ -363,6 +363,30 @@ namespace Ogre
         */
         virtual uint16 getChannel(const String& channelName);
 
+        /** Call a function for every index of a range, sharing the calls out
+            between the worker threads and the calling thread.
+        @remarks
+            Returns once func has been called for every index in [0, count). The
+            calling thread keeps taking indices until none are left, so this is
+            safe to call from inside a request handler even when all workers are
+            busy. Indices are handed out in batches, so func can be as small as
+            the work on a single item. The order of the calls is not defined;
+            write to per index storage and merge it afterwards when the result
+            has to be deterministic. If func throws, the first exception is rethrown here
+            after all calls have returned.
+            The default implementation makes the calls on the calling thread.
+        @param count Number of indices
+        @param func Function to call for each index
+        */
+        virtual void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+        /** Call parallelFor on the work queue of Root.
+        @remarks
+            Without a Root, e.g. in command line tools, the calls are made on the
+            calling thread.
+        */
+        static void parallelForDefault(size_t count, const std::function<void(size_t)>& func);
+
     };
 
     /** Base for a general purpose request / response style background work queue.
@@ -467,6 +491,8 @@ namespace Ogre
         virtual unsigned long getResponseProcessingTimeLimit() const { return mResposeTimeLimitMS; }
         /// @copydoc WorkQueue::setResponseProcessingTimeLimit
         virtual void setResponseProcessingTimeLimit(unsigned long ms) { mResposeTimeLimitMS = ms; }
+        /// @copydoc WorkQueue::parallelFor
+        virtual void parallelFor(size_t count, const std::function<void(size_t)>& func);
     protected:
         String mName;
         size_t mWorkerThreadCount;
@@ -579,7 +605,16 @@ namespace Ogre
         RequestQueue mIdleRequestQueue; // Guarded by mIdleMutex
         bool mIdleThreadRunning; // Guarded by mIdleMutex
         Request* mIdleProcessed; // Guarded by mProcessMutex
-        
+
+        /// Runs the helper requests issued by parallelFor
+        class ParallelForHandler : public RequestHandler
+        {
+        public:
+            Response* handleRequest(const Request* req, const WorkQueue* srcQ);
+        };
+        ParallelForHandler mParallelForHandler;
+        uint16 mParallelForChannel;
+
 
         bool processIdleRequests();
     };
@@ -71,6 +71,7 @@ namespace Ogre {
         mRadius(0.0f),
         mTexCoordDir(TCD_U),
         mVertexCameraUsed(0),
+        mVertexEyePosition(Vector3::ZERO),
         mFaceCamera(true),
         mNormalBase(Vector3::UNIT_X)
     {
@@ -105,6 +106,7 @@ namespace Ogre {
             ChainSegment& seg = mChainSegmentList[i];
             seg.start = i * mMaxElementsPerChain;
             seg.tail = seg.head = SEGMENT_EMPTY;
+            seg.vertexDirty = true;
 
         }
 
@@ -265,7 +267,7 @@ namespace Ogre {
         // Set the details
         mChainElementList[seg.start + seg.head] = dtls;
 
-        mVertexContentDirty = true;
+        seg.vertexDirty = true;
         mIndexContentDirty = true;
         mBoundsDirty = true;
         // tell parent node to update bounds
@@ -302,7 +304,7 @@ namespace Ogre {
         }
 
         // we removed an entry so indexes need updating
-        mVertexContentDirty = true;
+        seg.vertexDirty = true;
         mIndexContentDirty = true;
         mBoundsDirty = true;
         // tell parent node to update bounds
@@ -325,7 +327,7 @@ namespace Ogre {
         seg.tail = seg.head = SEGMENT_EMPTY;
 
         // we removed an entry so indexes need updating
-        mVertexContentDirty = true;
+        seg.vertexDirty = true;
         mIndexContentDirty = true;
         mBoundsDirty = true;
         // tell parent node to update bounds
@@ -373,7 +375,7 @@ namespace Ogre {
 
         mChainElementList[idx] = dtls;
 
-        mVertexContentDirty = true;
+        seg.vertexDirty = true;
         mBoundsDirty = true;
         // tell parent node to update bounds
         if (mParentNode)
@@ -484,159 +486,175 @@ namespace Ogre {
     void BillboardChain::updateVertexBuffer(Camera* cam)
     {
         setupBuffers();
-        
-        // The contents of the vertex buffer are correct if they are not dirty
-        // and the camera used to build the vertex buffer is still the current 
-        // camera.
-        if (!mVertexContentDirty && mVertexCameraUsed == cam)
-            return;
 
         HardwareVertexBufferSharedPtr pBuffer =
             mVertexData->vertexBufferBinding->getBuffer(0);
-        void* pBufferStart = pBuffer->lock(HardwareBuffer::HBL_DISCARD);
+        size_t vertexSize = pBuffer->getVertexSize();
 
         const Vector3& camPos = cam->getDerivedPosition();
         Vector3 eyePos = mParentNode->convertWorldToLocalPosition(camPos);
+        VertexElementType colourType = Root::getSingleton().getRenderSystem()->getColourVertexElementType();
 
-        Vector3 chainTangent;
+        // Camera facing vertices depend on the eye position, so any camera move
+        // invalidates every chain. Otherwise only the chains that changed are rebuilt.
+        bool fullUpdate = mVertexContentDirty ||
+            (mFaceCamera && (mVertexCameraUsed != cam || mVertexEyePosition != eyePos));
+        if (mVertexCopy.size() != pBuffer->getSizeInBytes())
+        {
+            mVertexCopy.resize(pBuffer->getSizeInBytes());
+            fullUpdate = true;
+        }
+
+        // Rebuild into the system memory copy, so that the buffer can always be
+        // replaced as a whole instead of stalling on partial locks
+        bool changed = false;
         for (ChainSegmentList::iterator segi = mChainSegmentList.begin();
             segi != mChainSegmentList.end(); ++segi)
         {
-            ChainSegment& seg = *segi;
-
-            // Skip 0 or 1 element segment counts
-            if (seg.head != SEGMENT_EMPTY && seg.head != seg.tail)
-            {
-                size_t laste = seg.head;
-                for (size_t e = seg.head; ; ++e) // until break
-                {
-                    // Wrap forwards
-                    if (e == mMaxElementsPerChain)
-                        e = 0;
-
-                    Element& elem = mChainElementList[e + seg.start];
-                    assert (((e + seg.start) * 2) < 65536 && "Too many elements!");
-                    uint16 baseIdx = static_cast<uint16>((e + seg.start) * 2);
+            if (!fullUpdate && !segi->vertexDirty)
+                continue;
+            updateSegmentVertices(&mVertexCopy[segi->start * 2 * vertexSize], *segi, eyePos, colourType);
+            segi->vertexDirty = false;
+            changed = true;
+        }
+        if (changed)
+            pBuffer->writeData(0, mVertexCopy.size(), &mVertexCopy[0], true);
 
-                    // Determine base pointer to vertex #1
-                    void* pBase = static_cast<void*>(
-                        static_cast<char*>(pBufferStart) +
-                            pBuffer->getVertexSize() * baseIdx);
+        mVertexCameraUsed = cam;
+        mVertexEyePosition = eyePos;
+        mVertexContentDirty = false;
 
-                    // Get index of next item
-                    size_t nexte = e + 1;
-                    if (nexte == mMaxElementsPerChain)
-                        nexte = 0;
+    }
+    //-----------------------------------------------------------------------
+    void BillboardChain::updateSegmentVertices(char* pSegmentBase, const ChainSegment& seg,
+        const Vector3& eyePos, VertexElementType colourType)
+    {
+        // Skip 0 or 1 element segment counts
+        if (seg.head == SEGMENT_EMPTY || seg.head == seg.tail)
+            return;
 
-                    if (e == seg.head)
-                    {
-                        // No laste, use next item
-                        chainTangent = mChainElementList[nexte + seg.start].position - elem.position;
-                    }
-                    else if (e == seg.tail)
-                    {
-                        // No nexte, use only last item
-                        chainTangent = elem.position - mChainElementList[laste + seg.start].position;
-                    }
-                    else
-                    {
-                        // A mid position, use tangent across both prev and next
-                        chainTangent = mChainElementList[nexte + seg.start].position - mChainElementList[laste + seg.start].position;
+        size_t vertexSize = mVertexData->vertexDeclaration->getVertexSize(0);
+        Vector3 chainTangent;
+        size_t laste = seg.head;
+        for (size_t e = seg.head; ; ++e) // until break
+        {
+            // Wrap forwards
+            if (e == mMaxElementsPerChain)
+                e = 0;
 
-                    }
+            Element& elem = mChainElementList[e + seg.start];
+            assert (((e + seg.start) * 2) < 65536 && "Too many elements!");
 
-                    Vector3 vP1ToEye;
+            // Determine base pointer to vertex #1
+            void* pBase = static_cast<void*>(pSegmentBase + vertexSize * e * 2);
 
-                    if( mFaceCamera )
-                        vP1ToEye = eyePos - elem.position;
-                    else
-                        vP1ToEye = elem.orientation * mNormalBase;
+            // Get index of next item
+            size_t nexte = e + 1;
+            if (nexte == mMaxElementsPerChain)
+                nexte = 0;
 
-                    Vector3 vPerpendicular = chainTangent.crossProduct(vP1ToEye);
-                    vPerpendicular.normalise();
-                    vPerpendicular *= (elem.width * 0.5f);
+            if (e == seg.head)
+            {
+                // No laste, use next item
+                chainTangent = mChainElementList[nexte + seg.start].position - elem.position;
+            }
+            else if (e == seg.tail)
+            {
+                // No nexte, use only last item
+                chainTangent = elem.position - mChainElementList[laste + seg.start].position;
+            }
+            else
+            {
+                // A mid position, use tangent across both prev and next
+                chainTangent = mChainElementList[nexte + seg.start].position - mChainElementList[laste + seg.start].position;
 
-                    Vector3 pos0 = elem.position - vPerpendicular;
-                    Vector3 pos1 = elem.position + vPerpendicular;
+            }
 
-                    float* pFloat = static_cast<float*>(pBase);
-                    // pos1
-                    *pFloat++ = pos0.x;
-                    *pFloat++ = pos0.y;
-                    *pFloat++ = pos0.z;
+            Vector3 vP1ToEye;
 
-                    pBase = static_cast<void*>(pFloat);
+            if( mFaceCamera )
+                vP1ToEye = eyePos - elem.position;
+            else
+                vP1ToEye = elem.orientation * mNormalBase;
 
-                    if (mUseVertexColour)
-                    {
-                        RGBA* pCol = static_cast<RGBA*>(pBase);
-                        Root::getSingleton().convertColourValue(elem.colour, pCol);
-                        pCol++;
-                        pBase = static_cast<void*>(pCol);
-                    }
+            Vector3 vPerpendicular = chainTangent.crossProduct(vP1ToEye);
+            vPerpendicular.normalise();
+            vPerpendicular *= (elem.width * 0.5f);
 
-                    if (mUseTexCoords)
-                    {
-                        pFloat = static_cast<float*>(pBase);
-                        if (mTexCoordDir == TCD_U)
-                        {
-                            *pFloat++ = elem.texCoord;
-                            *pFloat++ = mOtherTexCoordRange[0];
-                        }
-                        else
-                        {
-                            *pFloat++ = mOtherTexCoordRange[0];
-                            *pFloat++ = elem.texCoord;
-                        }
-                        pBase = static_cast<void*>(pFloat);
-                    }
+            Vector3 pos0 = elem.position - vPerpendicular;
+            Vector3 pos1 = elem.position + vPerpendicular;
 
-                    // pos2
-                    pFloat = static_cast<float*>(pBase);
-                    *pFloat++ = pos1.x;
-                    *pFloat++ = pos1.y;
-                    *pFloat++ = pos1.z;
-                    pBase = static_cast<void*>(pFloat);
+            // Both vertices share the colour, convert it once
+            RGBA colour = 0;
+            if (mUseVertexColour)
+                colour = VertexElement::convertColourValue(elem.colour, colourType);
 
-                    if (mUseVertexColour)
-                    {
-                        RGBA* pCol = static_cast<RGBA*>(pBase);
-                        Root::getSingleton().convertColourValue(elem.colour, pCol);
-                        pCol++;
-                        pBase = static_cast<void*>(pCol);
-                    }
+            float* pFloat = static_cast<float*>(pBase);
+            // pos1
+            *pFloat++ = pos0.x;
+            *pFloat++ = pos0.y;
+            *pFloat++ = pos0.z;
 
-                    if (mUseTexCoords)
-                    {
-                        pFloat = static_cast<float*>(pBase);
-                        if (mTexCoordDir == TCD_U)
-                        {
-                            *pFloat++ = elem.texCoord;
-                            *pFloat++ = mOtherTexCoordRange[1];
-                        }
-                        else
-                        {
-                            *pFloat++ = mOtherTexCoordRange[1];
-                            *pFloat++ = elem.texCoord;
-                        }
-                    }
+            pBase = static_cast<void*>(pFloat);
 
-                    if (e == seg.tail)
-                        break; // last one
+            if (mUseVertexColour)
+            {
+                RGBA* pCol = static_cast<RGBA*>(pBase);
+                *pCol++ = colour;
+                pBase = static_cast<void*>(pCol);
+            }
 
-                    laste = e;
+            if (mUseTexCoords)
+            {
+                pFloat = static_cast<float*>(pBase);
+                if (mTexCoordDir == TCD_U)
+                {
+                    *pFloat++ = elem.texCoord;
+                    *pFloat++ = mOtherTexCoordRange[0];
+                }
+                else
+                {
+                    *pFloat++ = mOtherTexCoordRange[0];
+                    *pFloat++ = elem.texCoord;
+                }
+                pBase = static_cast<void*>(pFloat);
+            }
 
-                } // element
-            } // segment valid?
+            // pos2
+            pFloat = static_cast<float*>(pBase);
+            *pFloat++ = pos1.x;
+            *pFloat++ = pos1.y;
+            *pFloat++ = pos1.z;
+            pBase = static_cast<void*>(pFloat);
 
-        } // each segment
+            if (mUseVertexColour)
+            {
+                RGBA* pCol = static_cast<RGBA*>(pBase);
+                *pCol++ = colour;
+                pBase = static_cast<void*>(pCol);
+            }
 
+            if (mUseTexCoords)
+            {
+                pFloat = static_cast<float*>(pBase);
+                if (mTexCoordDir == TCD_U)
+                {
+                    *pFloat++ = elem.texCoord;
+                    *pFloat++ = mOtherTexCoordRange[1];
+                }
+                else
+                {
+                    *pFloat++ = mOtherTexCoordRange[1];
+                    *pFloat++ = elem.texCoord;
+                }
+            }
 
+            if (e == seg.tail)
+                break; // last one
 
-        pBuffer->unlock();
-        mVertexCameraUsed = cam;
-        mVertexContentDirty = false;
+            laste = e;
 
+        } // element
     }
     //-----------------------------------------------------------------------
     void BillboardChain::updateIndexBuffer(void)
@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 namespace Ogre {
     String rendererTypeName = "billboard";
+    String instancedRendererTypeName = "instanced_billboard";
 
     //-----------------------------------------------------------------------
     BillboardParticleRenderer::CmdBillboardType BillboardParticleRenderer::msBillboardTypeCmd;
@@ -133,7 +134,9 @@ namespace Ogre {
         Vector3 bboxMax = Math::NEG_INFINITY * Vector3::UNIT_SCALE;
         Real radius = 0.0f;
         mBillboardSet->beginBillboards(currentParticles.size());
-        Billboard bb;
+        // Gather into a contiguous array so the set can expand them in one pass
+        mBillboards.resize(currentParticles.size());
+        BillboardList::iterator bbi = mBillboards.begin();
         Affine3 invWorld;
 
         if (mBillboardSet->getBillboardsInWorldSpace() && mBillboardSet->getParentSceneNode())
@@ -143,6 +146,7 @@ namespace Ogre {
             i != currentParticles.end(); ++i)
         {
             Particle* p = *i;
+            Billboard& bb = *bbi++;
             bb.mPosition = p->mPosition;
             Vector3 pos = p->mPosition;
 
@@ -168,10 +172,11 @@ namespace Ogre {
                 bb.mWidth = p->mWidth;
                 bb.mHeight = p->mHeight;
             }
-            mBillboardSet->injectBillboard(bb);
-
         }
 
+        if (!mBillboards.empty())
+            mBillboardSet->injectBillboards(&mBillboards[0], mBillboards.size());
+
         // Only set bounds if there are any active particles
         if(currentParticles.size())
             mBillboardSet->setBounds( AxisAlignedBox( bboxMin, bboxMax ), radius );
@@ -324,6 +329,33 @@ namespace Ogre {
         OGRE_DELETE  inst;
     }
     //-----------------------------------------------------------------------
+    InstancedBillboardParticleRenderer::InstancedBillboardParticleRenderer()
+    {
+        mBillboardSet->setInstancingEnabled(true);
+    }
+    //-----------------------------------------------------------------------
+    const String& InstancedBillboardParticleRenderer::getType(void) const
+    {
+        return instancedRendererTypeName;
+    }
+    //-----------------------------------------------------------------------
+    const String& InstancedBillboardParticleRendererFactory::getType() const
+    {
+        return instancedRendererTypeName;
+    }
+    //-----------------------------------------------------------------------
+    ParticleSystemRenderer* InstancedBillboardParticleRendererFactory::createInstance( 
+        const String& name )
+    {
+        return OGRE_NEW InstancedBillboardParticleRenderer();
+    }
+    //-----------------------------------------------------------------------
+    void InstancedBillboardParticleRendererFactory::destroyInstance( 
+        ParticleSystemRenderer* inst)
+    {
+        OGRE_DELETE  inst;
+    }
+    //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     String BillboardParticleRenderer::CmdBillboardType::doGet(const void* target) const
     {
@@ -32,9 +32,17 @@ THE SOFTWARE.
 
 #include <algorithm>
 
+#if __OGRE_HAVE_SSE && OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
+// SSE2 is part of every x86-64 CPU
+#   define OGRE_BILLBOARD_SSE2 1
+#   include <emmintrin.h>
+#else
+#   define OGRE_BILLBOARD_SSE2 0
+#endif
+
 namespace Ogre {
     // Init statics
-    RadixSort<BillboardSet::ActiveBillboardList, Billboard*, float> BillboardSet::mRadixSorter;
+    RadixSort<BillboardSet::SortedBillboardList, Billboard*, float> BillboardSet::mRadixSorter;
 
     //-----------------------------------------------------------------------
     BillboardSet::BillboardSet() :
@@ -52,6 +60,9 @@ namespace Ogre {
         mCommonDirection(Ogre::Vector3::UNIT_Z),
         mCommonUpVector(Vector3::UNIT_Y),
         mPointRendering(false),
+        mInstancing(false),
+        mInstancingActive(false),
+        mColourType(VET_COLOUR),
         mBuffersCreated(false),
         mPoolSize(0),
         mExternalData(false),
@@ -85,6 +96,9 @@ namespace Ogre {
         mCommonDirection(Ogre::Vector3::UNIT_Z),
         mCommonUpVector(Vector3::UNIT_Y),
         mPointRendering(false),
+        mInstancing(false),
+        mInstancingActive(false),
+        mColourType(VET_COLOUR),
         mBuffersCreated(false),
         mPoolSize(poolSize),
         mExternalData(externalData),
@@ -300,6 +314,9 @@ namespace Ogre {
            already loaded anyway)
         */
         mMaterial->load();
+        // Its programs decide whether instancing is possible
+        if (mInstancing)
+            _destroyBuffers();
     }
 
     //-----------------------------------------------------------------------
@@ -311,15 +328,23 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void BillboardSet::_sortBillboards( Camera* cam)
     {
+        // Sort a contiguous copy of the active list. Sorting the list directly
+        // makes the sorter build a temporary std::list (one allocation per node)
+        // every time, whereas the vector storage is reused between frames.
+        mSortedBillboards.assign(mActiveBillboards.begin(), mActiveBillboards.end());
+
         switch (_getSortMode())
         {
         case SM_DIRECTION:
-            mRadixSorter.sort(mActiveBillboards, SortByDirectionFunctor(-mCamDir));
+            mRadixSorter.sort(mSortedBillboards, SortByDirectionFunctor(-mCamDir));
             break;
         case SM_DISTANCE:
-            mRadixSorter.sort(mActiveBillboards, SortByDistanceFunctor(mCamPos));
+            mRadixSorter.sort(mSortedBillboards, SortByDistanceFunctor(mCamPos));
             break;
         }
+
+        // Write the order back in place, no list nodes are reallocated
+        std::copy(mSortedBillboards.begin(), mSortedBillboards.end(), mActiveBillboards.begin());
     }
     BillboardSet::SortByDirectionFunctor::SortByDirectionFunctor(const Vector3& dir)
         : sortDir(dir)
@@ -424,6 +449,9 @@ namespace Ogre {
                     mDefaultWidth, mDefaultHeight, mCamX, mCamY, mVOffset);
 
             }
+
+            if (mInstancingActive)
+                _updateInstancedCorners();
         }
 
         // Init num visible
@@ -436,9 +464,9 @@ namespace Ogre {
             numBillboards = std::min(mPoolSize, numBillboards);
 
             size_t billboardSize;
-            if (mPointRendering)
+            if (mPointRendering || mInstancingActive)
             {
-                // just one vertex per billboard (this also excludes texcoords)
+                // just one vertex (or instance record) per billboard
                 billboardSize = mMainBuf->getVertexSize();
             }
             else
@@ -468,6 +496,14 @@ namespace Ogre {
         // Skip if not visible (NB always true if not bounds checking individual billboards)
         if (!billboardVisible(mCurrentCamera, bb)) return;
 
+        if (mInstancingActive)
+        {
+            // Corners are generated on the GPU
+            genInstanceData(&bb, 1);
+            mNumVisibleBillboards++;
+            return;
+        }
+
         if (!mPointRendering &&
             (mBillboardType == BBT_ORIENTED_SELF ||
             mBillboardType == BBT_PERPENDICULAR_SELF ||
@@ -519,6 +555,33 @@ namespace Ogre {
         mNumVisibleBillboards++;
     }
     //-----------------------------------------------------------------------
+    void BillboardSet::injectBillboards(const Billboard* bbs, size_t count)
+    {
+        // Don't accept injections beyond pool size
+        count = std::min(count, mPoolSize - mNumVisibleBillboards);
+
+        if (mInstancingActive && !mCullIndividual)
+        {
+            genInstanceData(bbs, count);
+            mNumVisibleBillboards += count;
+            return;
+        }
+
+        if (mPointRendering || mCullIndividual ||
+            mBillboardType == BBT_ORIENTED_SELF ||
+            mBillboardType == BBT_PERPENDICULAR_SELF ||
+            (mAccurateFacing && mBillboardType != BBT_PERPENDICULAR_COMMON))
+        {
+            // Per-billboard visibility or axes, take the generic path
+            for (size_t i = 0; i < count; ++i)
+                injectBillboard(bbs[i]);
+            return;
+        }
+
+        genVerticesBatch(bbs, count);
+        mNumVisibleBillboards += count;
+    }
+    //-----------------------------------------------------------------------
     void BillboardSet::endBillboards(void)
     {
         mMainBuf->unlock();
@@ -643,6 +706,9 @@ namespace Ogre {
 
         // Ensure new material loaded (will not load again if already loaded)
         mMaterial->load();
+        // Its programs decide whether instancing is possible
+        if (mInstancing)
+            _destroyBuffers();
     }
 
     //-----------------------------------------------------------------------
@@ -659,6 +725,20 @@ namespace Ogre {
             op.indexData = 0;
             op.vertexData->vertexCount = mNumVisibleBillboards;
         }
+        else if (mInstancingActive)
+        {
+            // One shared quad, drawn once per visible billboard
+            op.operationType = RenderOperation::OT_TRIANGLE_LIST;
+            op.useIndexes = true;
+            op.useGlobalInstancingVertexBufferIsAvailable = false;
+            op.numberOfInstances = mNumVisibleBillboards;
+
+            op.vertexData->vertexCount = 4;
+
+            op.indexData = mIndexData.get();
+            op.indexData->indexCount = 6;
+            op.indexData->indexStart = 0;
+        }
         else
         {
             op.operationType = RenderOperation::OT_TRIANGLE_LIST;
@@ -759,6 +839,16 @@ namespace Ogre {
                 "expect.");
         }
 
+        mInstancingActive = mInstancing && _canUseInstancing();
+        if (mInstancing && !mInstancingActive)
+        {
+            LogManager::getSingleton().logMessage("BillboardSet " +
+                mName + " has instancing enabled, but it is not available with "
+                "its settings, material or render system. The billboards will "
+                "be expanded on the CPU instead.");
+        }
+        mColourType = VertexElement::getBestColourVertexElementType();
+
         mVertexData.reset(new VertexData());
         if (mPointRendering)
             mVertexData->vertexCount = mPoolSize;
@@ -771,6 +861,13 @@ namespace Ogre {
         VertexDeclaration* decl = mVertexData->vertexDeclaration;
         VertexBufferBinding* binding = mVertexData->vertexBufferBinding;
 
+        if (mInstancingActive)
+        {
+            _createInstancedBuffers();
+            mBuffersCreated = true;
+            return;
+        }
+
         size_t offset = 0;
         decl->addElement(0, offset, VET_FLOAT3, VES_POSITION);
         offset += VertexElement::getTypeSize(VET_FLOAT3);
@@ -843,11 +940,116 @@ namespace Ogre {
         mBuffersCreated = true;
     }
     //-----------------------------------------------------------------------
+    void BillboardSet::_createInstancedBuffers(void)
+    {
+        VertexDeclaration* decl = mVertexData->vertexDeclaration;
+        VertexBufferBinding* binding = mVertexData->vertexBufferBinding;
+        mVertexData->vertexCount = 4;
+
+        // Buffer 0: the shared quad, as corners with their offsets, and the camera axes
+        // (rewritten by _updateInstancedCorners)
+        size_t offset = 0;
+        offset += decl->addElement(0, offset, VET_FLOAT4, VES_TEXTURE_COORDINATES, 0).getSize();
+        offset += decl->addElement(0, offset, VET_FLOAT3, VES_TEXTURE_COORDINATES, 3).getSize();
+        decl->addElement(0, offset, VET_FLOAT3, VES_TEXTURE_COORDINATES, 4);
+        mCornerBuf =
+            HardwareBufferManager::getSingleton().createVertexBuffer(
+                decl->getVertexSize(0), 4, HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+        binding->setBinding(0, mCornerBuf);
+
+        // Buffer 1: one compact record per billboard
+        offset = 0;
+        offset += decl->addElement(1, offset, VET_FLOAT3, VES_POSITION).getSize();
+        offset += decl->addElement(1, offset, VET_COLOUR, VES_DIFFUSE).getSize();
+        offset += decl->addElement(1, offset, VET_FLOAT3, VES_TEXTURE_COORDINATES, 1).getSize();
+        decl->addElement(1, offset, VET_USHORT4_NORM, VES_TEXTURE_COORDINATES, 2);
+
+        mMainBuf =
+            HardwareBufferManager::getSingleton().createVertexBuffer(
+                decl->getVertexSize(1),
+                mPoolSize,
+                mAutoUpdate ? HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE :
+                HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        mMainBuf->setIsInstanceData(true);
+        mMainBuf->setInstanceDataStepRate(1);
+        binding->setBinding(1, mMainBuf);
+
+        // Same winding as the non instanced quads
+        mIndexData.reset(new IndexData());
+        mIndexData->indexStart = 0;
+        mIndexData->indexCount = 6;
+        mIndexData->indexBuffer = HardwareBufferManager::getSingleton().
+            createIndexBuffer(HardwareIndexBuffer::IT_16BIT,
+                mIndexData->indexCount,
+                HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        const uint16 indices[6] = { 0, 2, 1, 1, 2, 3 };
+        mIndexData->indexBuffer->writeData(0, sizeof(indices), indices, true);
+    }
+    //-----------------------------------------------------------------------
+    void BillboardSet::_updateInstancedCorners(void)
+    {
+        float data[4 * 10];
+        float* pFloat = data;
+        // Corners in genVertOffsets order: left-top, right-top, left-bottom, right-bottom
+        for (int c = 0; c < 4; ++c)
+        {
+            int u = c & 1;
+            int v = c >> 1;
+            *pFloat++ = static_cast<float>(u);
+            *pFloat++ = static_cast<float>(v);
+            *pFloat++ = u ? mRightOff : mLeftOff;
+            *pFloat++ = v ? mBottomOff : mTopOff;
+            *pFloat++ = mCamX.x;
+            *pFloat++ = mCamX.y;
+            *pFloat++ = mCamX.z;
+            *pFloat++ = mCamY.x;
+            *pFloat++ = mCamY.y;
+            *pFloat++ = mCamY.z;
+        }
+        mCornerBuf->writeData(0, mCornerBuf->getSizeInBytes(), data, true);
+    }
+    //-----------------------------------------------------------------------
+    bool BillboardSet::_canUseInstancing(void) const
+    {
+        // The axes have to be the same for all billboards
+        if (mPointRendering || mAccurateFacing || mBillboardType == BBT_ORIENTED_SELF ||
+            mBillboardType == BBT_PERPENDICULAR_SELF)
+            return false;
+
+        RenderSystem* rs = Root::getSingleton().getRenderSystem();
+        if (rs && !rs->getCapabilities()->hasCapability(RSC_VERTEX_BUFFER_INSTANCE_DATA))
+            return false;
+
+        // The corners are expanded by the vertex program. Techniques of other schemes,
+        // like those the RTSS generates, would not know how to. Without a render system
+        // nothing is compiled, so look at all techniques.
+        if (!mMaterial)
+            return false;
+        const Material::Techniques& techniques =
+            rs ? mMaterial->getSupportedTechniques() : mMaterial->getTechniques();
+        for (Material::Techniques::const_iterator t = techniques.begin(); t != techniques.end(); ++t)
+        {
+            if ((*t)->getSchemeName() != MaterialManager::DEFAULT_SCHEME_NAME)
+                continue;
+
+            const Technique::Passes& passes = (*t)->getPasses();
+            for (Technique::Passes::const_iterator p = passes.begin(); p != passes.end(); ++p)
+            {
+                if (!(*p)->hasVertexProgram())
+                    return false;
+            }
+            return !passes.empty();
+        }
+        return false;
+    }
+    //-----------------------------------------------------------------------
     void BillboardSet::_destroyBuffers(void)
     {
         mVertexData.reset();
         mIndexData.reset();
         mMainBuf.reset();
+        mCornerBuf.reset();
+        mInstancingActive = false;
 
         mBuffersCreated = false;
     }
@@ -1062,6 +1264,9 @@ namespace Ogre {
     void BillboardSet::setBillboardType(BillboardType bbt)
     {
         mBillboardType = bbt;
+        // Per billboard axes need the CPU path
+        if (mInstancing)
+            _destroyBuffers();
     }
     //-----------------------------------------------------------------------
     BillboardType BillboardSet::getBillboardType(void) const
@@ -1335,6 +1540,135 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void BillboardSet::genVerticesBatch(const Billboard* bbs, size_t count)
+    {
+        // Resolve the colour format once rather than per billboard
+        VertexElementType colourType = mColourType;
+
+        // Interleaved layout: position (3 floats), colour (RGBA), texcoord (2 floats)
+        static const size_t floatsPerVertex = 6;
+
+        Vector3 vOwnOffset[4];
+        float* pDest = mLockPtr;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Billboard& bb = bbs[i];
+
+            const Vector3* offsets = mVOffset;
+            if (!mAllDefaultSize && bb.mOwnDimensions)
+            {
+                genVertOffsets(mLeftOff, mRightOff, mTopOff, mBottomOff,
+                    bb.mWidth, bb.mHeight, mCamX, mCamY, vOwnOffset);
+                offsets = vOwnOffset;
+            }
+
+            if (!mAllDefaultRotation && bb.mRotation != Radian(0))
+            {
+                // Rotated billboards need the per-corner rotation of genVertices
+                mLockPtr = pDest;
+                genVertices(offsets, bb);
+                pDest = mLockPtr;
+                continue;
+            }
+
+            assert( bb.mUseTexcoordRect || bb.mTexcoordIndex < mTextureCoords.size() );
+            const FloatRect& r =
+                bb.mUseTexcoordRect ? bb.mTexcoordRect : mTextureCoords[bb.mTexcoordIndex];
+            RGBA colour = VertexElement::convertColourValue(bb.mColour, colourType);
+
+            // Corners in genVertOffsets order: left-top, right-top, left-bottom, right-bottom
+            const float u[4] = { r.left, r.right, r.left, r.right };
+            const float v[4] = { r.top, r.top, r.bottom, r.bottom };
+            for (int c = 0; c < 4; ++c)
+            {
+                pDest[0] = offsets[c].x + bb.mPosition.x;
+                pDest[1] = offsets[c].y + bb.mPosition.y;
+                pDest[2] = offsets[c].z + bb.mPosition.z;
+                memcpy(pDest + 3, &colour, sizeof(RGBA));
+                pDest[4] = u[c];
+                pDest[5] = v[c];
+                pDest += floatsPerVertex;
+            }
+        }
+        mLockPtr = pDest;
+    }
+    //-----------------------------------------------------------------------
+    void BillboardSet::genInstanceData(const Billboard* bbs, size_t count)
+    {
+        // Keep the set wide values in locals, the float stores below could alias the members
+        const bool ownDimensions = !mAllDefaultSize;
+        const bool ownRotation = !mAllDefaultRotation;
+        const float defaultWidth = mDefaultWidth;
+        const float defaultHeight = mDefaultHeight;
+        const VertexElementType colourType = mColourType;
+
+        // Record layout: position (3 floats), colour (RGBA), width, height and
+        // rotation (3 floats), texture rectangle (4 normalised ushorts)
+        static const size_t recordSize = 6 * sizeof(float) + sizeof(RGBA) + 4 * sizeof(uint16);
+
+#if OGRE_BILLBOARD_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 colourScale = _mm_set1_ps(255.0f);
+        const __m128 rectScale = _mm_set1_ps(65535.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128i rectBias = _mm_set1_epi32(0x8000);
+        const __m128i rectSign = _mm_set1_epi16(short(0x8000));
+#endif
+
+        uchar* pDest = reinterpret_cast<uchar*>(mLockPtr);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Billboard& bb = bbs[i];
+            assert( bb.mUseTexcoordRect || bb.mTexcoordIndex < mTextureCoords.size() );
+            const FloatRect& r =
+                bb.mUseTexcoordRect ? bb.mTexcoordRect : mTextureCoords[bb.mTexcoordIndex];
+            const bool ownSize = ownDimensions && bb.mOwnDimensions;
+
+            float* pFloat = reinterpret_cast<float*>(pDest);
+            // Position
+            pFloat[0] = bb.mPosition.x;
+            pFloat[1] = bb.mPosition.y;
+            pFloat[2] = bb.mPosition.z;
+            // Dimensions and rotation
+            pFloat[4] = ownSize ? bb.mWidth : defaultWidth;
+            pFloat[5] = ownSize ? bb.mHeight : defaultHeight;
+            pFloat[6] = ownRotation ? bb.mRotation.valueRadians() : 0.0f;
+
+#if OGRE_BILLBOARD_SSE2
+            // Colour, truncated like ColourValue::getAsABGR. Reorder to BGRA for ARGB.
+            __m128 colour = _mm_loadu_ps(bb.mColour.ptr());
+            if (colourType == VET_COLOUR_ARGB)
+                colour = _mm_shuffle_ps(colour, colour, _MM_SHUFFLE(3, 0, 1, 2));
+            colour = _mm_mul_ps(_mm_min_ps(_mm_max_ps(colour, zero), one), colourScale);
+            __m128i colour8 = _mm_cvttps_epi32(colour);
+            colour8 = _mm_packs_epi32(colour8, colour8);
+            colour8 = _mm_packus_epi16(colour8, colour8);
+            RGBA packedColour = static_cast<RGBA>(_mm_cvtsi128_si32(colour8));
+            memcpy(pFloat + 3, &packedColour, sizeof(RGBA));
+
+            // Texture rectangle, normalised. There is no unsigned saturating pack
+            // before SSE4.1, so bias into the signed range and flip the sign bit back.
+            __m128 rect = _mm_loadu_ps(&r.left);
+            rect = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(rect, zero), one), rectScale), half);
+            __m128i rect16 = _mm_sub_epi32(_mm_cvttps_epi32(rect), rectBias);
+            rect16 = _mm_xor_si128(_mm_packs_epi32(rect16, rect16), rectSign);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pFloat + 7), rect16);
+#else
+            RGBA packedColour = VertexElement::convertColourValue(bb.mColour, colourType);
+            memcpy(pFloat + 3, &packedColour, sizeof(RGBA));
+
+            uint16* pShort = reinterpret_cast<uint16*>(pFloat + 7);
+            pShort[0] = static_cast<uint16>(Math::saturate(r.left) * 65535.0f + 0.5f);
+            pShort[1] = static_cast<uint16>(Math::saturate(r.top) * 65535.0f + 0.5f);
+            pShort[2] = static_cast<uint16>(Math::saturate(r.right) * 65535.0f + 0.5f);
+            pShort[3] = static_cast<uint16>(Math::saturate(r.bottom) * 65535.0f + 0.5f);
+#endif
+            pDest += recordSize;
+        }
+        mLockPtr = reinterpret_cast<float*>(pDest);
+    }
+    //-----------------------------------------------------------------------
     void BillboardSet::genVertOffsets(Real inleft, Real inright, Real intop, Real inbottom,
         Real width, Real height, const Vector3& x, const Vector3& y, Vector3* pDestVec)
     {
@@ -1452,6 +1786,17 @@ namespace Ogre {
         }
     }
 
+    //-----------------------------------------------------------------------
+    void BillboardSet::setInstancingEnabled(bool enabled)
+    {
+        // Whether it can be used is decided when the buffers are created
+        if (enabled != mInstancing)
+        {
+            mInstancing = enabled;
+            // Different buffer structure (4 verts or 1 instance record per billboard)
+            _destroyBuffers();
+        }
+    }
     //-----------------------------------------------------------------------
     void BillboardSet::setAutoUpdate(bool autoUpdate)
     {
@@ -34,8 +34,50 @@ THE SOFTWARE.
 #include "OgreCompositionPass.h"
 #include "OgreCompositorManager.h"
 #include "OgreRenderTarget.h"
+#include "OgreHardwarePixelBuffer.h"
+#include "OgreRenderTexture.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
 
 namespace Ogre {
+namespace {
+    /// A transient texture of a chain and the render texture it needs
+    struct TransientTextureUse
+    {
+        CompositorInstance* instance;
+        const CompositionTechnique::TextureDefinition* def;
+        size_t first;
+        size_t last;
+        size_t width;
+        size_t height;
+        uint fsaa;
+        String fsaaHint;
+        bool hwGamma;
+
+        bool isCompatible(const TransientTextureUse& other) const
+        {
+            return width == other.width && height == other.height &&
+                def->formatList[0] == other.def->formatList[0] &&
+                fsaa == other.fsaa && fsaaHint == other.fsaaHint &&
+                hwGamma == other.hwGamma && def->depthBufferId == other.def->depthBufferId;
+        }
+    };
+
+    bool firstUsedEarlier(const TransientTextureUse& a, const TransientTextureUse& b)
+    {
+        return a.first < b.first;
+    }
+
+    /// Transient textures sharing one render texture, in order of their lifetimes
+    struct TextureAlias
+    {
+        std::vector<size_t> uses;
+        size_t last;
+        /// Whether still used by the output operation
+        bool output;
+    };
+}
+//-----------------------------------------------------------------------
 CompositorChain::CompositorChain(Viewport *vp):
     mViewport(vp),
     mOriginalScene(0),
@@ -59,6 +101,7 @@ CompositorChain::~CompositorChain()
 void CompositorChain::destroyResources(void)
 {
     clearCompiledState();
+    releaseTransientTextures();
 
     if (mViewport)
     {
@@ -322,10 +365,22 @@ void CompositorChain::preRenderTargetUpdate(const RenderTargetEvent& evt)
         if(i->onlyInitial && i->hasBeenRendered)
             continue;
         i->hasBeenRendered = true;
+        Viewport* vp = i->target->getViewport(0);
+        if (cam && vp->getCamera() != cam)
+        {
+            // Transient targets are shared with the chains of other viewports, whose
+            // camera may be gone by now, so don't let the viewport touch it
+            Viewport* oldViewport = cam->getViewport();
+            Real aspectRatio = cam->getAspectRatio();
+            vp->setCamera(0);
+            vp->setCamera(cam);
+            cam->setAspectRatio(aspectRatio);
+            cam->_notifyViewport(oldViewport);
+        }
         /// Setup and render
-        preTargetOperation(*i, i->target->getViewport(0), cam);
+        preTargetOperation(*i, vp, cam);
         i->target->update();
-        postTargetOperation(*i, i->target->getViewport(0), cam);
+        postTargetOperation(*i, vp, cam);
     }
 }
 //-----------------------------------------------------------------------
@@ -344,23 +399,12 @@ void CompositorChain::preViewportUpdate(const RenderTargetViewportEvent& evt)
     if(evt.source != mViewport || !mAnyCompositorsEnabled)
         return;
 
-    // set original scene details from viewport
-    CompositionPass* pass = mOriginalScene->getTechnique()->getOutputTargetPass()->getPasses()[0];
-    CompositionTargetPass* passParent = pass->getParent();
-    if (pass->getClearBuffers() != mViewport->getClearBuffers() ||
-        pass->getClearColour() != mViewport->getBackgroundColour() ||
-        pass->getClearDepth() != mViewport->getDepthClear() ||
-        passParent->getVisibilityMask() != mViewport->getVisibilityMask() ||
-        passParent->getMaterialScheme() != mViewport->getMaterialScheme() ||
-        passParent->getShadowsEnabled() != mViewport->getShadowsEnabled())
-    {
-        // recompile if viewport settings are different
-        pass->setClearBuffers(mViewport->getClearBuffers());
-        pass->setClearColour(mViewport->getBackgroundColour());
-        pass->setClearDepth(mViewport->getDepthClear());
-        passParent->setVisibilityMask(mViewport->getVisibilityMask());
+    // The clear, visibility mask and shadows of the original scene are read from the
+    // viewport when executed, only a different material scheme needs a recompile
+    CompositionTargetPass* passParent = mOriginalScene->getTechnique()->getOutputTargetPass();
+    if (passParent->getMaterialScheme() != mViewport->getMaterialScheme())
+    {
         passParent->setMaterialScheme(mViewport->getMaterialScheme());
-        passParent->setShadowsEnabled(mViewport->getShadowsEnabled());
         _compile();
     }
 
@@ -390,15 +434,24 @@ void CompositorChain::preTargetOperation(CompositorInstance::TargetOperation &op
         cam->setLodBias(cam->getLodBias() * op.lodBias);
     }
 
+    uint32 visibilityMask = op.visibilityMask;
+    bool shadowsEnabled = op.shadowsEnabled;
+    if (op.originalScene)
+    {
+        /// Patch in the current settings of our viewport, before vp might overwrite them
+        visibilityMask &= mViewport->getVisibilityMask();
+        shadowsEnabled = mViewport->getShadowsEnabled();
+    }
+
     // Set the visibility mask
     mOldVisibilityMask = vp->getVisibilityMask();
-    vp->setVisibilityMask(op.visibilityMask);
+    vp->setVisibilityMask(visibilityMask);
     /// Set material scheme 
     mOldMaterialScheme = vp->getMaterialScheme();
     vp->setMaterialScheme(op.materialScheme);
     /// Set shadows enabled
     mOldShadowsEnabled = vp->getShadowsEnabled();
-    vp->setShadowsEnabled(op.shadowsEnabled);
+    vp->setShadowsEnabled(shadowsEnabled);
     /// XXX TODO
     //vp->setClearEveryFrame( true );
     //vp->setOverlaysEnabled( false );
@@ -493,10 +546,8 @@ void CompositorChain::_compile()
     /// Set previous CompositorInstance for each compositor in the list
     CompositorInstance *lastComposition = mOriginalScene;
     mOriginalScene->mPreviousInstance = 0;
-    CompositionPass* pass = mOriginalScene->getTechnique()->getOutputTargetPass()->getPasses()[0];
-    pass->setClearBuffers(mViewport->getClearBuffers());
-    pass->setClearColour(mViewport->getBackgroundColour());
-    pass->setClearDepth(mViewport->getDepthClear());
+    mOriginalScene->getTechnique()->getOutputTargetPass()->setMaterialScheme(
+        mViewport->getMaterialScheme());
     for(Instances::iterator i=mInstances.begin(); i!=mInstances.end(); ++i)
     {
         if((*i)->getEnabled())
@@ -508,6 +559,9 @@ void CompositorChain::_compile()
     }
     
 
+    /// Assign transient textures before the targets get looked up
+    aliasTransientTextures(lastComposition);
+
     /// Compile misc targets
     lastComposition->_compileTargetOperations(mCompiledState);
     
@@ -541,6 +595,165 @@ void CompositorChain::_compile()
     mDirty = false;
 }
 //-----------------------------------------------------------------------
+void CompositorChain::releaseTransientTextures(void)
+{
+    for (CompositorInstance* inst : mInstances)
+    {
+        for (const String& name : inst->mTransientTextures)
+            inst->mLocalTextures.erase(name);
+    }
+
+    for (size_t i = 0; i < mTransientTextures.size(); ++i)
+        TextureManager::getSingleton().remove(mTransientTextures[i]);
+    mTransientTextures.clear();
+}
+//-----------------------------------------------------------------------
+void CompositorChain::collectTargetPassLifetimes(CompositorInstance* inst, CompositionTargetPass* target,
+    bool output, size_t step, TextureLifetimeMap& lifetimes)
+{
+    if (inst->mTransientTextures.empty())
+        return;
+
+    CompositorInstance::TextureNameSet names;
+    inst->getTargetPassInputs(target, names);
+    if (!output)
+        names.insert(target->getOutputName());
+
+    for (const String& name : names)
+    {
+        if (inst->mTransientTextures.find(name) == inst->mTransientTextures.end())
+            continue;
+        // steps only grow, so the first insertion holds the first use
+        TextureLifetimeMap::iterator i = lifetimes.insert(TextureLifetimeMap::value_type(
+            std::make_pair(inst, name), std::make_pair(step, step))).first;
+        i->second.second = step;
+    }
+}
+//-----------------------------------------------------------------------
+size_t CompositorChain::collectTextureLifetimes(CompositorInstance* inst, size_t step,
+    TextureLifetimeMap& lifetimes)
+{
+    if (inst->mPreviousInstance)
+        step = collectTextureLifetimes(inst->mPreviousInstance, step, lifetimes);
+
+    const CompositionTechnique::TargetPasses& passes = inst->getTechnique()->getTargetPasses();
+    for (CompositionTargetPass* target : passes)
+    {
+        if (inst->mCulledTargetPasses.find(target) != inst->mCulledTargetPasses.end())
+            continue;
+        if (target->getInputMode() == CompositionTargetPass::IM_PREVIOUS)
+            collectOutputTextureLifetimes(inst->mPreviousInstance, step, lifetimes);
+        collectTargetPassLifetimes(inst, target, false, step, lifetimes);
+        ++step;
+    }
+    return step;
+}
+//-----------------------------------------------------------------------
+void CompositorChain::collectOutputTextureLifetimes(CompositorInstance* inst, size_t step,
+    TextureLifetimeMap& lifetimes)
+{
+    CompositionTargetPass* tpass = inst->getTechnique()->getOutputTargetPass();
+    if (tpass->getInputMode() == CompositionTargetPass::IM_PREVIOUS)
+        collectOutputTextureLifetimes(inst->mPreviousInstance, step, lifetimes);
+    collectTargetPassLifetimes(inst, tpass, true, step, lifetimes);
+}
+//-----------------------------------------------------------------------
+void CompositorChain::aliasTransientTextures(CompositorInstance* lastComposition)
+{
+    releaseTransientTextures();
+
+    if (!CompositorManager::getSingleton().getTextureAliasing())
+        return;
+
+    /// Lifetimes in the order of the compiled target operations, the output last
+    TextureLifetimeMap lifetimes;
+    size_t outputStep = collectTextureLifetimes(lastComposition, 0, lifetimes);
+    collectOutputTextureLifetimes(lastComposition, outputStep, lifetimes);
+
+    std::vector<TransientTextureUse> uses;
+    uses.reserve(lifetimes.size());
+    for (TextureLifetimeMap::iterator i = lifetimes.begin(); i != lifetimes.end(); ++i)
+    {
+        TransientTextureUse use;
+        use.instance = i->first.first;
+        use.def = use.instance->getTechnique()->getTextureDefinition(i->first.second);
+        use.first = i->second.first;
+        use.last = i->second.second;
+        use.instance->deriveTextureOptions(use.def, use.width, use.height,
+            use.hwGamma, use.fsaa, use.fsaaHint);
+        use.hwGamma = use.hwGamma && !PixelUtil::isFloatingPoint(use.def->formatList[0]);
+        uses.push_back(use);
+    }
+    std::stable_sort(uses.begin(), uses.end(), firstUsedEarlier);
+
+    // Greedy interval colouring: a texture takes over the render texture of one
+    // that is no longer used, which can't be in the same step as it might be read
+    // while the other gets written
+    std::vector<TextureAlias> aliases;
+    for (size_t u = 0; u < uses.size(); ++u)
+    {
+        size_t a = 0;
+        for (; a < aliases.size(); ++a)
+        {
+            if (aliases[a].last < uses[u].first && uses[aliases[a].uses[0]].isCompatible(uses[u]))
+                break;
+        }
+        if (a == aliases.size())
+        {
+            aliases.push_back(TextureAlias());
+            aliases[a].output = false;
+        }
+        aliases[a].uses.push_back(u);
+        aliases[a].last = uses[u].last;
+        aliases[a].output = aliases[a].output || uses[u].last == outputStep;
+    }
+
+    // Render textures dead before the output operation are shared with the other
+    // chains, which run their target operations before or after ours
+    for (size_t a = 0; a < aliases.size(); ++a)
+    {
+        const TransientTextureUse& first = uses[aliases[a].uses[0]];
+        PixelFormat format = first.def->formatList[0];
+        TexturePtr tex;
+        if (aliases[a].output)
+        {
+            static size_t dummyCounter = 0;
+            String texName = "c" + StringConverter::toString(dummyCounter++) +
+                "/Transient/" + mViewport->getTarget()->getName();
+            std::replace(texName.begin(), texName.end(), ' ', '_');
+            tex = TextureManager::getSingleton().createManual(
+                texName, ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME, TEX_TYPE_2D,
+                (uint)first.width, (uint)first.height, 0, format, TU_RENDERTARGET, 0,
+                first.hwGamma, first.fsaa, first.fsaaHint);
+            mTransientTextures.push_back(tex);
+        }
+        else
+        {
+            // index among the shared aliases with the same render texture
+            size_t index = 0;
+            for (size_t b = 0; b < a; ++b)
+            {
+                if (!aliases[b].output && uses[aliases[b].uses[0]].isCompatible(first))
+                    ++index;
+            }
+            tex = CompositorManager::getSingleton()._getTransientTexture(index,
+                first.width, first.height, format, first.fsaa, first.fsaaHint,
+                first.hwGamma, first.def->depthBufferId);
+        }
+
+        first.instance->initialiseRenderTarget(tex->getBuffer()->getRenderTarget(),
+            first.def->depthBufferId);
+        for (size_t u = 0; u < aliases[a].uses.size(); ++u)
+        {
+            const TransientTextureUse& use = uses[aliases[a].uses[u]];
+            use.instance->mLocalTextures[use.def->name] = tex;
+        }
+    }
+
+    // Shared render textures nobody took any more
+    CompositorManager::getSingleton().freePooledTextures(true);
+}
+//-----------------------------------------------------------------------
 void CompositorChain::_markDirty()
 {
     mDirty = true;
@@ -110,7 +110,12 @@ class RSClearOperation: public CompositorInstance::RenderSystemOperation
 {
 public:
     RSClearOperation(uint32 inBuffers, ColourValue inColour, Real inDepth, unsigned short inStencil, bool inAutomaticColour):
-        buffers(inBuffers), colour(inColour), automaticColour(inAutomaticColour), depth(inDepth), stencil(inStencil)
+        buffers(inBuffers), colour(inColour), automaticColour(inAutomaticColour), depth(inDepth), stencil(inStencil),
+        chain(0)
+    {}
+    /// Clear following the settings of the viewport of a chain, as the original scene does
+    RSClearOperation(CompositorChain* inChain):
+        buffers(0), colour(ColourValue::Black), automaticColour(false), depth(1), stencil(0), chain(inChain)
     {}
     /// Which buffers to clear (FrameBufferType)
     uint32 buffers;
@@ -122,13 +127,45 @@ public:
     Real depth;
     /// Stencil value to set in case FBT_STENCIL is set
     unsigned short stencil;
+    /// Chain whose viewport gives the buffers not set above and their values, if any
+    CompositorChain* chain;
+
+    /// Add the buffers of a clear directly following this one, its values win
+    void merge(uint32 inBuffers, const ColourValue& inColour, Real inDepth, unsigned short inStencil, bool inAutomaticColour)
+    {
+        if (inBuffers & FBT_COLOUR)
+        {
+            colour = inColour;
+            automaticColour = inAutomaticColour;
+        }
+        if (inBuffers & FBT_DEPTH)
+            depth = inDepth;
+        if (inBuffers & FBT_STENCIL)
+            stencil = inStencil;
+        buffers |= inBuffers;
+    }
 
     virtual void execute(SceneManager *sm, RenderSystem *rs)
     {
         // _getViewport returns the viewport currently rendered, while getViewport returns lastViewport!
         if((buffers & FBT_COLOUR) && automaticColour)
           colour = rs->_getViewport()->getCamera()->getViewport()->getBackgroundColour();
-        rs->clearFrameBuffer(buffers, colour, depth, stencil);
+
+        // Read the viewport now, so changing its background does not need a recompile
+        uint32 clearBuffers = buffers;
+        ColourValue clearColour = colour;
+        Real clearDepth = depth;
+        if (chain)
+        {
+            Viewport* vp = chain->getViewport();
+            uint32 viewportBuffers = vp->getClearBuffers() & ~buffers;
+            clearBuffers |= viewportBuffers;
+            if (viewportBuffers & FBT_COLOUR)
+                clearColour = vp->getBackgroundColour();
+            if (viewportBuffers & FBT_DEPTH)
+                clearDepth = vp->getDepthClear();
+        }
+        rs->clearFrameBuffer(clearBuffers, clearColour, clearDepth, stencil);
     }
 };
 
@@ -307,6 +344,33 @@ void CompositorInstance::collectPasses(TargetOperation &finalState, CompositionT
         switch(pass->getType())
         {
         case CompositionPass::PT_CLEAR:
+        {
+            if (this == mChain->_getOriginalSceneCompositor())
+            {
+                queueRenderSystemOp(finalState, OGRE_NEW RSClearOperation(mChain));
+                break;
+            }
+
+
+            // Clears with nothing in between take a single one
+            RSClearOperation* lastClear = 0;
+            if (!finalState.renderSystemOperations.empty() &&
+                finalState.renderSystemOperations.back().first == finalState.currentQueueGroupID)
+            {
+                lastClear = dynamic_cast<RSClearOperation*>(finalState.renderSystemOperations.back().second);
+            }
+
+            if (lastClear)
+            {
+                lastClear->merge(
+                    pass->getClearBuffers(),
+                    pass->getClearColour(),
+                    pass->getClearDepth(),
+                    (ushort)pass->getClearStencil(),
+                    pass->getAutomaticColour());
+                break;
+            }
+
             queueRenderSystemOp(finalState, OGRE_NEW RSClearOperation(
                 pass->getClearBuffers(),
                 pass->getClearColour(),
@@ -315,6 +379,7 @@ void CompositorInstance::collectPasses(TargetOperation &finalState, CompositionT
                 pass->getAutomaticColour()
                 ));
             break;
+        }
         case CompositionPass::PT_STENCIL:
             queueRenderSystemOp(finalState, OGRE_NEW RSStencilOperation(
                 pass->getStencilCheck(),pass->getStencilFunc(), pass->getStencilRefValue(),
@@ -443,6 +508,8 @@ void CompositorInstance::_compileTargetOperations(CompiledState &compiledState)
     for (it = passes.begin(); it != passes.end(); ++it)
     {
         CompositionTargetPass *target = *it;
+        if (mCulledTargetPasses.find(target) != mCulledTargetPasses.end())
+            continue;
         
         TargetOperation ts(getTargetForTex(target->getOutputName()));
         /// Set "only initial" flag, visibilityMask and lodBias according to CompositionTargetPass.
@@ -471,7 +538,11 @@ void CompositorInstance::_compileOutputOperation(TargetOperation &finalState)
     CompositionTargetPass *tpass = mTechnique->getOutputTargetPass();
     
     /// Logical-and together the visibilityMask, and multiply the lodBias
-    finalState.visibilityMask &= tpass->getVisibilityMask();
+    /// The original scene takes the visibilityMask and shadows of the viewport when executed
+    if (this == mChain->_getOriginalSceneCompositor())
+        finalState.originalScene = true;
+    else
+        finalState.visibilityMask &= tpass->getVisibilityMask();
     finalState.lodBias *= tpass->getLodBias();
     finalState.materialScheme = tpass->getMaterialScheme();
     finalState.shadowsEnabled = tpass->getShadowsEnabled();
@@ -614,6 +685,9 @@ void CompositorInstance::createResources(bool forResizeOnly)
     /// are composited.
     CompositorManager::UniqueTextureSet assignedTextures;
 
+    if (!forResizeOnly)
+        analyseTextureUsage();
+
     const CompositionTechnique::TextureDefinitions& tdefs = mTechnique->getTextureDefinitions();
     CompositionTechnique::TextureDefinitions::const_iterator it = tdefs.begin();
     for (; it != tdefs.end(); ++it)
@@ -624,6 +698,11 @@ void CompositorInstance::createResources(bool forResizeOnly)
             //This is a reference, isn't created in this compositor
             continue;
         }
+
+        if (mTransientTextures.find(def->name) != mTransientTextures.end()) {
+            //The chain assigns these, aliased with other transient textures
+            continue;
+        }
         
         RenderTarget* rendTarget;
         if (def->scope == CompositionTechnique::TS_GLOBAL) {
@@ -651,34 +730,17 @@ void CompositorInstance::createResources(bool forResizeOnly)
             }
             
         } else {
-            /// Determine width and height
-            size_t width = def->width;
-            size_t height = def->height;
-            uint fsaa = 0;
-            String fsaaHint;
-            bool hwGamma = false;
-            
             // Skip this one if we're only (re)creating for a resize & it's not derived
             // from the target size
-            if (forResizeOnly && width != 0 && height != 0)
+            if (forResizeOnly && def->width != 0 && def->height != 0)
                 continue;
             
-            deriveTextureRenderTargetOptions(def->name, &hwGamma, &fsaa, &fsaaHint);
-            
-            if(width == 0)
-                width = static_cast<size_t>(
-                                            static_cast<float>(mChain->getViewport()->getActualWidth()) * def->widthFactor);
-            if(height == 0)
-                height = static_cast<size_t>(
-                                             static_cast<float>(mChain->getViewport()->getActualHeight()) * def->heightFactor);
-            
-            // determine options as a combination of selected options and possible options
-            if (!def->fsaa)
-            {
-                fsaa = 0;
-                fsaaHint = BLANKSTRING;
-            }
-            hwGamma = hwGamma || def->hwGammaWrite;
+            /// Determine width and height
+            size_t width, height;
+            uint fsaa;
+            String fsaaHint;
+            bool hwGamma;
+            deriveTextureOptions(def, width, height, hwGamma, fsaa, fsaaHint);
             
             /// Make the tetxure
             if (def->formatList.size() > 1)
@@ -759,44 +821,73 @@ void CompositorInstance::createResources(bool forResizeOnly)
             }
         }
         
-        //Set DepthBuffer pool for sharing
-        rendTarget->setDepthBufferPool( def->depthBufferId );
-        
-        /// Set up viewport over entire texture
-        rendTarget->setAutoUpdated( false );
-        
-        // We may be sharing / reusing this texture, so test before adding viewport
-        if (rendTarget->getNumViewports() == 0)
+        initialiseRenderTarget(rendTarget, def->depthBufferId);
+    }
+    
+    _fireNotifyResourcesCreated(forResizeOnly);
+}
+//---------------------------------------------------------------------
+void CompositorInstance::deriveTextureOptions(const CompositionTechnique::TextureDefinition* def,
+    size_t& width, size_t& height, bool& hwGammaWrite, uint& fsaa, String& fsaaHint)
+{
+    width = def->width;
+    height = def->height;
+    
+    deriveTextureRenderTargetOptions(def->name, &hwGammaWrite, &fsaa, &fsaaHint);
+    
+    if(width == 0)
+        width = static_cast<size_t>(
+                                    static_cast<float>(mChain->getViewport()->getActualWidth()) * def->widthFactor);
+    if(height == 0)
+        height = static_cast<size_t>(
+                                     static_cast<float>(mChain->getViewport()->getActualHeight()) * def->heightFactor);
+    
+    // determine options as a combination of selected options and possible options
+    if (!def->fsaa)
+    {
+        fsaa = 0;
+        fsaaHint = BLANKSTRING;
+    }
+    hwGammaWrite = hwGammaWrite || def->hwGammaWrite;
+}
+//---------------------------------------------------------------------
+void CompositorInstance::initialiseRenderTarget(RenderTarget* rendTarget, uint16 depthBufferId)
+{
+    //Set DepthBuffer pool for sharing
+    rendTarget->setDepthBufferPool( depthBufferId );
+    
+    /// Set up viewport over entire texture
+    rendTarget->setAutoUpdated( false );
+    
+    // We may be sharing / reusing this texture, so test before adding viewport
+    if (rendTarget->getNumViewports() == 0)
+    {
+        Viewport* v;
+        Camera* camera = mChain->getViewport()->getCamera();
+        if (!camera)
         {
-            Viewport* v;
-            Camera* camera = mChain->getViewport()->getCamera();
-            if (!camera)
-            {
-                v = rendTarget->addViewport( camera );
-            }
-            else
-            {
-                // Save last viewport and current aspect ratio
-                Viewport* oldViewport = camera->getViewport();
-                Real aspectRatio = camera->getAspectRatio();
-                
-                v = rendTarget->addViewport( camera );
-                
-                // Should restore aspect ratio, in case of auto aspect ratio
-                // enabled, it'll changed when add new viewport.
-                camera->setAspectRatio(aspectRatio);
-                // Should restore last viewport, i.e. never disturb user code
-                // which might based on that.
-                camera->_notifyViewport(oldViewport);
-            }
+            v = rendTarget->addViewport( camera );
+        }
+        else
+        {
+            // Save last viewport and current aspect ratio
+            Viewport* oldViewport = camera->getViewport();
+            Real aspectRatio = camera->getAspectRatio();
             
-            v->setClearEveryFrame( false );
-            v->setOverlaysEnabled( false );
-            v->setBackgroundColour( ColourValue( 0, 0, 0, 0 ) );
+            v = rendTarget->addViewport( camera );
+            
+            // Should restore aspect ratio, in case of auto aspect ratio
+            // enabled, it'll changed when add new viewport.
+            camera->setAspectRatio(aspectRatio);
+            // Should restore last viewport, i.e. never disturb user code
+            // which might based on that.
+            camera->_notifyViewport(oldViewport);
         }
+        
+        v->setClearEveryFrame( false );
+        v->setOverlaysEnabled( false );
+        v->setBackgroundColour( ColourValue( 0, 0, 0, 0 ) );
     }
-    
-    _fireNotifyResourcesCreated(forResizeOnly);
 }
 //---------------------------------------------------------------------
 void CompositorInstance::deriveTextureRenderTargetOptions(
@@ -869,6 +960,132 @@ void CompositorInstance::deriveTextureRenderTargetOptions(
 
 }
 //---------------------------------------------------------------------
+void CompositorInstance::getTargetPassInputs(CompositionTargetPass* target, TextureNameSet& inputs) const
+{
+    CompositionTargetPass::Passes::const_iterator pit = target->getPasses().begin();
+    for (; pit != target->getPasses().end(); ++pit)
+    {
+        CompositionPass* pass = *pit;
+        if (pass->getType() != CompositionPass::PT_RENDERQUAD)
+            continue;
+
+        for (size_t x = 0; x < pass->getNumInputs(); ++x)
+        {
+            const CompositionPass::InputTex& inp = pass->getInput(x);
+            if (!inp.name.empty())
+                inputs.insert(inp.name);
+        }
+
+        // The material may also refer to our textures directly
+        const MaterialPtr& mat = pass->getMaterial();
+        if (!mat)
+            continue;
+        for (Technique* tech : mat->getTechniques())
+        {
+            for (Pass* p : tech->getPasses())
+            {
+                for (TextureUnitState* tus : p->getTextureUnitStates())
+                {
+                    if (tus->getContentType() == TextureUnitState::CONTENT_COMPOSITOR &&
+                        tus->getReferencedCompositorName() == mCompositor->getName())
+                    {
+                        inputs.insert(tus->getReferencedTextureName());
+                    }
+                }
+            }
+        }
+    }
+}
+//---------------------------------------------------------------------
+void CompositorInstance::analyseTextureUsage()
+{
+    mTransientTextures.clear();
+    mCulledTargetPasses.clear();
+
+    // Textures only known to the technique. Compositor logics and custom passes
+    // may use them in ways we can't see.
+    if (!CompositorManager::getSingleton().getTextureAliasing() ||
+        !mTechnique->getCompositorLogicName().empty())
+    {
+        return;
+    }
+
+    // The target passes run in order, the output pass after them
+    CompositionTechnique::TargetPasses passes = mTechnique->getTargetPasses();
+    passes.push_back(mTechnique->getOutputTargetPass());
+
+    TextureNameSet candidates;
+    const CompositionTechnique::TextureDefinitions& tdefs = mTechnique->getTextureDefinitions();
+    for (CompositionTechnique::TextureDefinition* def : tdefs)
+    {
+        if (def->refCompName.empty() && def->scope == CompositionTechnique::TS_LOCAL &&
+            !def->pooled && def->formatList.size() == 1)
+        {
+            candidates.insert(def->name);
+        }
+    }
+
+    for (CompositionTargetPass* target : passes)
+    {
+        for (CompositionPass* pass : target->getPasses())
+        {
+            if (pass->getType() == CompositionPass::PT_RENDERCUSTOM)
+                return;
+        }
+        // Rendered once, so it has to persist
+        if (target->getOnlyInitial())
+            candidates.erase(target->getOutputName());
+    }
+
+    // Cull the passes writing textures nobody reads, until there are none left
+    std::vector<TextureNameSet> inputs(passes.size());
+    for (size_t p = 0; p < passes.size(); ++p)
+        getTargetPassInputs(passes[p], inputs[p]);
+
+    typedef std::map<String, size_t> FirstUseMap;
+    FirstUseMap firstWrites, firstReads;
+    bool culled = true;
+    while (culled)
+    {
+        firstWrites.clear();
+        firstReads.clear();
+        for (size_t p = 0; p < passes.size(); ++p)
+        {
+            if (mCulledTargetPasses.find(passes[p]) != mCulledTargetPasses.end())
+                continue;
+            // a pass reads its inputs before it writes its output
+            for (const String& name : inputs[p])
+                firstReads.insert(FirstUseMap::value_type(name, p));
+            if (passes[p] != mTechnique->getOutputTargetPass())
+                firstWrites.insert(FirstUseMap::value_type(passes[p]->getOutputName(), p));
+        }
+
+        culled = false;
+        for (size_t p = 0; p + 1 < passes.size(); ++p)
+        {
+            const String& output = passes[p]->getOutputName();
+            if (candidates.find(output) != candidates.end() &&
+                firstReads.find(output) == firstReads.end() &&
+                mCulledTargetPasses.insert(passes[p]).second)
+            {
+                culled = true;
+            }
+        }
+    }
+
+    for (const String& name : candidates)
+    {
+        FirstUseMap::iterator w = firstWrites.find(name);
+        FirstUseMap::iterator r = firstReads.find(name);
+        // Unused, or written before it is read
+        if ((w == firstWrites.end() && r == firstReads.end()) ||
+            (w != firstWrites.end() && (r == firstReads.end() || w->second < r->second)))
+        {
+            mTransientTextures.insert(name);
+        }
+    }
+}
+//---------------------------------------------------------------------
 String CompositorInstance::getMRTTexLocalName(const String& baseName, size_t attachment)
 {
     return baseName + "/" + StringConverter::toString(attachment);
@@ -912,9 +1129,11 @@ void CompositorInstance::freeResources(bool forResizeOnly, bool clearReserveText
                 LocalTextureMap::iterator i = mLocalTextures.find(texName);
                 if (i != mLocalTextures.end())
                 {
-                    if (!def->pooled && def->scope != CompositionTechnique::TS_GLOBAL)
+                    if (!def->pooled && def->scope != CompositionTechnique::TS_GLOBAL &&
+                        mTransientTextures.find(texName) == mTransientTextures.end())
                     {
-                        // remove myself from central only if not pooled and not global
+                        // remove myself from central only if not pooled, not global
+                        // and not assigned by the chain
                         TextureManager::getSingleton().remove(i->second);
                     }
 
@@ -47,7 +47,7 @@ CompositorManager& CompositorManager::getSingleton(void)
     assert( msSingleton );  return ( *msSingleton );  
 }//-----------------------------------------------------------------------
 CompositorManager::CompositorManager():
-    mRectangle(0)
+    mRectangle(0), mTextureAliasing(false)
 {
     initialise();
 
@@ -324,6 +324,58 @@ TexturePtr CompositorManager::getPooledTexture(const String& name,
     return ret;
 }
 //---------------------------------------------------------------------
+void CompositorManager::setTextureAliasing(bool enabled)
+{
+    if (mTextureAliasing == enabled)
+        return;
+    mTextureAliasing = enabled;
+
+    // Instances decide which textures are transient when creating their resources
+    for (Chains::iterator i = mChains.begin(); i != mChains.end(); ++i)
+    {
+        for (CompositorInstance* inst : i->second->getCompositorInstances())
+        {
+            if (inst->getAlive())
+            {
+                bool enabledInst = inst->getEnabled();
+                inst->setAlive(false);
+                inst->setAlive(true);
+                inst->setEnabled(enabledInst);
+            }
+        }
+    }
+}
+//---------------------------------------------------------------------
+TexturePtr CompositorManager::_getTransientTexture(size_t index, size_t w, size_t h,
+    PixelFormat f, uint aa, const String& aaHint, bool srgb, uint16 depthBufferId)
+{
+    static size_t dummyCounter = 0;
+
+    TextureDef def(w, h, f, aa, aaHint, srgb);
+    TextureDefLess less;
+    for (TransientTextureList::iterator t = mTransientTextures.begin(); t != mTransientTextures.end(); ++t)
+    {
+        if (!less(t->def, def) && !less(def, t->def) && t->depthBufferId == depthBufferId)
+        {
+            if (index == 0)
+                return t->texture;
+            --index;
+        }
+    }
+
+    TexturePtr ret;
+    for (++index; index > 0; --index)
+    {
+        ret = TextureManager::getSingleton().createManual(
+            "Ogre/Compositor/Transient/" + StringConverter::toString(dummyCounter++),
+            ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME, TEX_TYPE_2D,
+            (uint)w, (uint)h, 0, f, TU_RENDERTARGET, 0,
+            srgb, aa, aaHint);
+        mTransientTextures.push_back(TransientTexture(def, depthBufferId, ret));
+    }
+    return ret;
+}
+//---------------------------------------------------------------------
 bool CompositorManager::isInputPreviousTarget(CompositorInstance* inst, const Ogre::String& localName)
 {
     const CompositionTechnique::TargetPasses& passes = inst->getTechnique()->getTargetPasses();
@@ -424,6 +476,16 @@ void CompositorManager::freePooledTextures(bool onlyIfUnreferenced)
                     ++j;
             }
         }
+        for (TransientTextureList::iterator j = mTransientTextures.begin(); j != mTransientTextures.end();)
+        {
+            if (j->texture.use_count() == ResourceGroupManager::RESOURCE_SYSTEM_NUM_REFERENCE_COUNTS + 1)
+            {
+                TextureManager::getSingleton().remove(j->texture->getHandle());
+                j = mTransientTextures.erase(j);
+            }
+            else
+                ++j;
+        }
         for (ChainTexturesByDef::iterator i = mChainTexturesByDef.begin(); i != mChainTexturesByDef.end(); ++i)
         {
             TextureDefMap& texMap = i->second;
@@ -449,6 +511,7 @@ void CompositorManager::freePooledTextures(bool onlyIfUnreferenced)
         }
         mTexturesByDef.clear();
         mChainTexturesByDef.clear();
+        mTransientTextures.clear();
     }
 
 }
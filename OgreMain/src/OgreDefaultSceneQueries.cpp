@@ -198,7 +198,7 @@ namespace Ogre {
                     std::pair<bool, Real> result =
                         mRay.intersects(a->getWorldBoundingBox());
 
-                    if (result.first)
+                    if (result.first && intersectsTriangles(a, result.second))
                     {
                         if (!listener->queryResult(a, result.second)) return;
                     }
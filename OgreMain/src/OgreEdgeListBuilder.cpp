@@ -181,6 +181,19 @@ namespace Ogre {
             mEdgeData->edgeGroups[vSet].triCount = 0;
         }
 
+        // Size the lookup tables up front, a rehash on a multi million triangle
+        // mesh costs more than the lookups themselves
+        size_t vertexCount = 0, indexCount = 0;
+        for (VertexDataList::const_iterator vi = mVertexDataList.begin(); vi != mVertexDataList.end(); ++vi)
+            vertexCount += (*vi)->vertexCount;
+        for (GeometryList::const_iterator gi = mGeometryList.begin(); gi != mGeometryList.end(); ++gi)
+            indexCount += gi->indexData->indexCount;
+        mVertices.reserve(vertexCount);
+        mCommonVertexMap.reserve(vertexCount);
+        // Closed meshes leave roughly half the edges open at any time
+        mEdgeMap.reserve(indexCount / 2);
+        mPendingEdges.reserve(indexCount / 2);
+
         // Build triangles and edge list
         GeometryList::const_iterator i, iend;
         iend = mGeometryList.end();
@@ -366,21 +379,42 @@ namespace Ogre {
         EdgeMap::iterator emi = mEdgeMap.find(std::pair<size_t, size_t>(sharedVertIndex1, sharedVertIndex0));
         if (emi != mEdgeMap.end())
         {
-            // The edge already exist, connect it
-            EdgeData::Edge& e = mEdgeData->edgeGroups[emi->second.first].edges[emi->second.second];
+            // The edge already exist, connect the oldest one on this vertex pair
+            const PendingEdge& pending = mPendingEdges[emi->second.head];
+            EdgeData::Edge& e = mEdgeData->edgeGroups[pending.vertexSet].edges[pending.edgeIndex];
             // update with second side
             e.triIndex[1] = triangleIndex;
             e.degenerate = false;
 
             // Remove from the edge map, so we never supplied to connect edge again
-            mEdgeMap.erase(emi);
+            if (pending.next == static_cast<size_t>(~0))
+                mEdgeMap.erase(emi);
+            else
+                emi->second.head = pending.next;
         }
         else
         {
             // Not found, create new edge
-            mEdgeMap.insert(EdgeMap::value_type(
-                std::pair<size_t, size_t>(sharedVertIndex0, sharedVertIndex1),
-                std::pair<size_t, size_t>(vertexSet, mEdgeData->edgeGroups[vertexSet].edges.size())));
+            PendingEdge pending;
+            pending.vertexSet = vertexSet;
+            pending.edgeIndex = mEdgeData->edgeGroups[vertexSet].edges.size();
+            pending.next = static_cast<size_t>(~0);
+            size_t pendingIndex = mPendingEdges.size();
+            mPendingEdges.push_back(pending);
+
+            std::pair<EdgeMap::iterator, bool> inserted = mEdgeMap.insert(EdgeMap::value_type(
+                std::pair<size_t, size_t>(sharedVertIndex0, sharedVertIndex1), PendingEdgeChain()));
+            if (inserted.second)
+            {
+                inserted.first->second.head = pendingIndex;
+            }
+            else
+            {
+                // Same directed edge already waiting, queue behind it
+                mPendingEdges[inserted.first->second.tail].next = pendingIndex;
+            }
+            inserted.first->second.tail = pendingIndex;
+
             EdgeData::Edge e;
             e.degenerate = true; // initialise as degenerate
 
@@ -30,6 +30,7 @@ Copyright (c) 2000-2014 Torus Knot Software Ltd
 #include "OgreSubEntity.h"
 #include "OgreTagPoint.h"
 #include "OgreSkeletonInstance.h"
+#include "OgreMeshBVH.h"
 #include "OgreOptimisedUtil.h"
 #include "OgreLodStrategy.h"
 #include "OgreLodListener.h"
@@ -50,6 +51,8 @@ namespace Ogre {
           mUpdateBoundingBoxFromSkeleton(false),
           mVertexProgramInUse(false),
           mInitialised(false),
+          mMeshletCulling(false),
+          mMeshletCamera(NULL),
           mHardwarePoseCount(0),
           mNumBoneMatrices(0),
           mBoneWorldMatrices(NULL),
@@ -366,6 +369,7 @@ namespace Ogre {
     void Entity::_notifyCurrentCamera(Camera* cam)
     {
         MovableObject::_notifyCurrentCamera(cam);
+        mMeshletCamera = cam;
 
         // Calculate the LOD
         if (mParentNode)
@@ -459,6 +463,18 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void Entity::setMeshletCullingEnabled(bool enabled)
+    {
+        mMeshletCulling = enabled;
+        if (!enabled)
+        {
+            SubEntityList::iterator i, iend;
+            iend = mSubEntityList.end();
+            for (i = mSubEntityList.begin(); i != iend; ++i)
+                (*i)->updateVisibleMeshlets(0);
+        }
+    }
+    //-----------------------------------------------------------------------
     void Entity::setUpdateBoundingBoxFromSkeleton(bool update)
     {
         mUpdateBoundingBoxFromSkeleton = update;
@@ -646,12 +662,28 @@ namespace Ogre {
         }
 #endif
 
+        // Meshlets are only culled for the highest LOD of meshes that are not animated
+        const Camera* meshletCamera = 0;
+        if (mMeshletCulling && displayEntity == this && !hasSkeleton() && !hasVertexAnimation())
+            meshletCamera = mMeshletCamera;
+#if !OGRE_NO_MESHLOD
+        if (mMeshLodIndex > 0)
+            meshletCamera = 0;
+#endif
+
         // Add each visible SubEntity to the queue
         SubEntityList::iterator i, iend;
         iend = displayEntity->mSubEntityList.end();
         for (i = displayEntity->mSubEntityList.begin(); i != iend; ++i)
         {
-            if((*i)->isVisible())
+            if (!(*i)->isVisible())
+                continue;
+
+            // only the sub entities actually queued pay for the culling
+            if (mMeshletCulling)
+                (*i)->updateVisibleMeshlets(meshletCamera);
+
+            if(!(*i)->areAllMeshletsCulled())
             {
                 // Order: first use subentity queue settings, if available
                 //        if not then use entity queue settings, if available
@@ -1627,6 +1659,50 @@ namespace Ogre {
         return mMesh->getBoundingSphereRadius();
     }
     //-----------------------------------------------------------------------
+    std::pair<bool, Real> Entity::intersectsTriangles(const Ray& ray)
+    {
+        std::pair<bool, Real> result(false, (Real)0);
+        if (!mParentNode)
+            return result;
+
+        const Affine3& xform = _getParentNodeFullTransform();
+        MeshBVH* bvh = mMesh->getTriangleBVH();
+
+        if (_isSkeletonAnimated())
+        {
+            // The triangles are in the bind pose, follow the animation with the
+            // bounds of the vertices influenced by each bone
+            const MeshBVH::BoneBoundsList& boneBounds = bvh->getBoneBounds();
+            size_t numBones = std::min(boneBounds.size(), (size_t)mSkeletonInstance->getNumBones());
+            for (unsigned short handle = 0; handle < numBones; ++handle)
+            {
+                if (boneBounds[handle].isNull())
+                    continue;
+
+                Affine3 offset;
+                mSkeletonInstance->getBone(handle)->_getOffsetTransform(offset);
+                Affine3 inv = (xform * offset).inverse();
+                Ray boneRay(inv * ray.getOrigin(), inv.linear() * ray.getDirection());
+                std::pair<bool, Real> hit = boneRay.intersects(boneBounds[handle]);
+                if (hit.first && (!result.first || hit.second < result.second))
+                    result = hit;
+            }
+            return result;
+        }
+
+        // Distances along the mesh space ray match the world space ones, since the
+        // direction is transformed without normalising
+        Affine3 inv = xform.inverse();
+        Ray meshRay(inv * ray.getOrigin(), inv.linear() * ray.getDirection());
+        MeshBVH::TriangleHit hit;
+        if (bvh->raycast(meshRay, hit))
+        {
+            result.first = true;
+            result.second = hit.distance;
+        }
+        return result;
+    }
+    //-----------------------------------------------------------------------
     void Entity::prepareTempBlendBuffers(void)
     {
         mSkelAnimVertexData.reset();
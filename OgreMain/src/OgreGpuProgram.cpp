@@ -39,6 +39,7 @@ namespace Ogre
     GpuProgram::CmdMorph GpuProgram::msMorphCmd;
     GpuProgram::CmdPose GpuProgram::msPoseCmd;
     GpuProgram::CmdVTF GpuProgram::msVTFCmd;
+    GpuProgram::CmdInstancing GpuProgram::msInstancingCmd;
     GpuProgram::CmdManualNamedConstsFile GpuProgram::msManNamedConstsFileCmd;
     GpuProgram::CmdAdjacency GpuProgram::msAdjacencyCmd;
     GpuProgram::CmdComputeGroupDims GpuProgram::msComputeGroupDimsCmd;
@@ -50,7 +51,7 @@ namespace Ogre
         :Resource(creator, name, handle, group, isManual, loader),
         mType(GPT_VERTEX_PROGRAM), mLoadFromFile(true), mSkeletalAnimation(false),
         mMorphAnimation(false), mPoseAnimation(0),
-        mVertexTextureFetch(false), mNeedsAdjacencyInfo(false),
+        mVertexTextureFetch(false), mInstancing(false), mNeedsAdjacencyInfo(false),
         mCompileError(false), mLoadedManualNamedConstants(false)
     {
         createParameterMappingStructures();
@@ -355,6 +356,10 @@ namespace Ogre
             ParameterDef("uses_vertex_texture_fetch", 
                          "Whether this vertex program requires vertex texture fetch support.", PT_BOOL), 
             &msVTFCmd);
+        dict->addParameter(
+            ParameterDef("includes_instancing",
+                         "Whether this vertex program reads world matrices from per-instance vertex data.", PT_BOOL),
+            &msInstancingCmd);
         dict->addParameter(
             ParameterDef("manual_named_constants", 
                          "File containing named parameter mappings for low-level programs.", PT_BOOL), 
@@ -491,6 +496,17 @@ namespace Ogre
         t->setVertexTextureFetchRequired(StringConverter::parseBool(val));
     }
     //-----------------------------------------------------------------------
+    String GpuProgram::CmdInstancing::doGet(const void* target) const
+    {
+        const GpuProgram* t = static_cast<const GpuProgram*>(target);
+        return StringConverter::toString(t->isInstancingIncluded());
+    }
+    void GpuProgram::CmdInstancing::doSet(void* target, const String& val)
+    {
+        GpuProgram* t = static_cast<GpuProgram*>(target);
+        t->setInstancingIncluded(StringConverter::parseBool(val));
+    }
+    //-----------------------------------------------------------------------
     String GpuProgram::CmdManualNamedConstsFile::doGet(const void* target) const
     {
         const GpuProgram* t = static_cast<const GpuProgram*>(target);
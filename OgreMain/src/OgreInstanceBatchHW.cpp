@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "OgreInstanceBatchHW.h"
 #include "OgreRenderOperation.h"
 #include "OgreInstancedEntity.h"
+#include "OgreCamera.h"
+#include "OgreSIMDHelper.h"
 
 namespace Ogre
 {
@@ -37,7 +39,8 @@ namespace Ogre
                                         const Mesh::IndexMap *indexToBoneMap, const String &batchName ) :
                 InstanceBatch( creator, meshReference, material, instancesPerBatch,
                                 indexToBoneMap, batchName ),
-                mKeepStatic( false )
+                mKeepStatic( false ),
+                mInstanceDataDirty( true )
     {
         //Override defaults, so that InstancedEntities don't create a skeleton instance
         mTechnSupportsSkeletal = false;
@@ -81,6 +84,10 @@ namespace Ogre
         thisVertexData->vertexBufferBinding->setBinding( lastSource, vertexBuffer );
         vertexBuffer->setIsInstanceData( true );
         vertexBuffer->setInstanceDataStepRate( 1 );
+
+        //The new buffer holds nothing yet
+        mUploadedInstances.clear();
+        mInstanceDataDirty = true;
     }
     //-----------------------------------------------------------------------
     void InstanceBatchHW::setupVertices( const SubMesh* baseSubMesh )
@@ -175,63 +182,174 @@ namespace Ogre
         return InstanceBatch::checkSubMeshCompatibility( baseSubMesh );
     }
     //-----------------------------------------------------------------------
-    size_t InstanceBatchHW::updateVertexBuffer( Camera *currentCamera )
+    void InstanceBatchHW::cullInstances( const Camera *currentCamera )
     {
-        size_t retVal = 0;
+        mCullCandidates.clear();
+        mVisibleInstances.clear();
 
-        //Now lock the vertex buffer and copy the 4x3 matrices, only those who need it!
-        const ushort bufferIdx = ushort(mRenderOperation.vertexData->vertexBufferBinding->getBufferCount()-1);
-        float *pDest = static_cast<float*>(mRenderOperation.vertexData->vertexBufferBinding->
-                                            getBuffer(bufferIdx)->lock( HardwareBuffer::HBL_DISCARD ));
+        if( !currentCamera )
+        {
+            for( size_t i=0; i<mInstancedEntities.size(); ++i )
+            {
+                const InstancedEntity *entity = mInstancedEntities[i];
+                if( entity->isInScene() && entity->isVisible() )
+                    mVisibleInstances.push_back( static_cast<uint32>( i ) );
+            }
+            return;
+        }
 
-        InstancedEntityVec::const_iterator itor = mInstancedEntities.begin();
-        InstancedEntityVec::const_iterator end  = mInstancedEntities.end();
+        //Gather the bounding spheres of the candidates in SoA layout, padded to a multiple of 4
+        const size_t stride = (mInstancedEntities.size() + 3) & ~size_t(3);
+        mCullSpheres.resize( stride * 4 );
+        Real *centreX = mCullSpheres.empty() ? 0 : &mCullSpheres[0];
+        Real *centreY = centreX + stride;
+        Real *centreZ = centreY + stride;
+        Real *radius  = centreZ + stride;
 
-        unsigned char numCustomParams           = mCreator->getNumCustomParams();
-        size_t customParamIdx                   = 0;
+        //All instances share the mesh, hence its radius; only their scale differs
+        const Real meshRadius = mMeshReference->getBoundingSphereRadius();
 
-        while( itor != end )
+        size_t numCandidates = 0;
+        for( size_t i=0; i<mInstancedEntities.size(); ++i )
         {
-            //Cull on an individual basis, the less entities are visible, the less instances we draw.
-            //No need to use null matrices at all!
-            if( (*itor)->findVisible( currentCamera ) )
+            const InstancedEntity *entity = mInstancedEntities[i];
+            if( entity->isInScene() && entity->isVisible() )
             {
-                const size_t floatsWritten = (*itor)->getTransforms3x4( pDest );
+                const Vector3 &centre = entity->_getDerivedPosition();
+                centreX[numCandidates] = centre.x;
+                centreY[numCandidates] = centre.y;
+                centreZ[numCandidates] = centre.z;
+                radius[numCandidates]  = meshRadius * entity->getMaxScaleCoef();
+                mCullCandidates.push_back( static_cast<uint32>( i ) );
+                ++numCandidates;
+            }
+        }
+        for( size_t i=numCandidates; i<((numCandidates + 3) & ~size_t(3)); ++i )
+            centreX[i] = centreY[i] = centreZ[i] = radius[i] = 0;
 
-                if( mManager->getCameraRelativeRendering() )
-                    makeMatrixCameraRelative3x4( pDest, floatsWritten );
+        //Same planes Camera::isVisible would test, skipping the far one when it's infinite
+        const Frustum *frustum = currentCamera->getCullingFrustum();
+        if( !frustum )
+            frustum = currentCamera;
+        const Plane *frustumPlanes = frustum->getFrustumPlanes();
 
-                pDest += floatsWritten;
+        Plane planes[6];
+        size_t numPlanes = 0;
+        for( int i=0; i<6; ++i )
+        {
+            if( i != FRUSTUM_PLANE_FAR || frustum->getFarClipDistance() != 0 )
+                planes[numPlanes++] = frustumPlanes[i];
+        }
 
-                //Write custom parameters, if any
-                for( unsigned char i=0; i<numCustomParams; ++i )
+        for( size_t i=0; i<numCandidates; i += 4 )
+        {
+            //Bit n is set when sphere i+n lies completely on the negative side of any plane
+            int culledMask = 0;
+#if __OGRE_HAVE_SSE
+            const __m128 x      = _mm_loadu_ps( centreX + i );
+            const __m128 y      = _mm_loadu_ps( centreY + i );
+            const __m128 z      = _mm_loadu_ps( centreZ + i );
+            const __m128 negRad = _mm_sub_ps( _mm_setzero_ps(), _mm_loadu_ps( radius + i ) );
+            __m128 culled = _mm_setzero_ps();
+            for( size_t j=0; j<numPlanes; ++j )
+            {
+                __m128 dist = _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( planes[j].normal.x ) ),
+                                          _mm_mul_ps( y, _mm_set1_ps( planes[j].normal.y ) ) );
+                dist = _mm_add_ps( dist, _mm_mul_ps( z, _mm_set1_ps( planes[j].normal.z ) ) );
+                dist = _mm_add_ps( dist, _mm_set1_ps( planes[j].d ) );
+                culled = _mm_or_ps( culled, _mm_cmplt_ps( dist, negRad ) );
+            }
+            culledMask = _mm_movemask_ps( culled );
+#else
+            for( size_t j=0; j<numPlanes; ++j )
+            {
+                const Plane &plane = planes[j];
+                for( size_t k=0; k<4; ++k )
                 {
-                    *pDest++ = mCustomParams[customParamIdx+i].x;
-                    *pDest++ = mCustomParams[customParamIdx+i].y;
-                    *pDest++ = mCustomParams[customParamIdx+i].z;
-                    *pDest++ = mCustomParams[customParamIdx+i].w;
+                    const Real dist = plane.normal.x * centreX[i+k] + plane.normal.y * centreY[i+k] +
+                                      plane.normal.z * centreZ[i+k] + plane.d;
+                    if( dist < -radius[i+k] )
+                        culledMask |= 1 << k;
                 }
-
-                ++retVal;
             }
-            ++itor;
+#endif
+            const size_t lanes = std::min<size_t>( 4, numCandidates - i );
+            for( size_t k=0; k<lanes; ++k )
+            {
+                if( !(culledMask & (1 << k)) )
+                    mVisibleInstances.push_back( mCullCandidates[i+k] );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    size_t InstanceBatchHW::updateVertexBuffer( Camera *currentCamera )
+    {
+        //Cull on an individual basis, the less entities are visible, the less instances we draw.
+        //No need to use null matrices at all!
+        cullInstances( currentCamera );
 
-            customParamIdx += numCustomParams;
+        //Nothing moved and the same instances are visible (i.e. camera didn't change the result,
+        //or this is another pass with the same outcome): the buffer already has what we need.
+        //Camera relative transforms depend on the camera position, so those are always rewritten.
+        if( !mInstanceDataDirty && !mManager->getCameraRelativeRendering() &&
+            mVisibleInstances == mUploadedInstances )
+        {
+            return mVisibleInstances.size();
         }
 
-        mRenderOperation.vertexData->vertexBufferBinding->getBuffer(bufferIdx)->unlock();
+        //Now lock the vertex buffer and copy the 4x3 matrices, only those who need it!
+        const ushort bufferIdx = ushort(mRenderOperation.vertexData->vertexBufferBinding->getBufferCount()-1);
+        HardwareVertexBufferLockGuard vertexLock( mRenderOperation.vertexData->vertexBufferBinding->
+                                                  getBuffer(bufferIdx), HardwareBuffer::HBL_DISCARD );
+        float *pDest = static_cast<float*>( vertexLock.pData );
 
-        return retVal;
+        unsigned char numCustomParams = mCreator->getNumCustomParams();
+
+        for( size_t i=0; i<mVisibleInstances.size(); ++i )
+        {
+            const uint32 instanceIdx = mVisibleInstances[i];
+            const size_t floatsWritten = mInstancedEntities[instanceIdx]->getTransforms3x4( pDest );
+
+            if( mManager->getCameraRelativeRendering() )
+                makeMatrixCameraRelative3x4( pDest, floatsWritten );
+
+            pDest += floatsWritten;
+
+            //Write custom parameters, if any
+            const size_t customParamIdx = instanceIdx * numCustomParams;
+            for( unsigned char j=0; j<numCustomParams; ++j )
+            {
+                *pDest++ = mCustomParams[customParamIdx+j].x;
+                *pDest++ = mCustomParams[customParamIdx+j].y;
+                *pDest++ = mCustomParams[customParamIdx+j].z;
+                *pDest++ = mCustomParams[customParamIdx+j].w;
+            }
+        }
+
+        mUploadedInstances = mVisibleInstances;
+        mInstanceDataDirty = false;
+
+        return mVisibleInstances.size();
     }
     //-----------------------------------------------------------------------
     void InstanceBatchHW::_boundsDirty(void)
     {
+        //Some instance moved (or the batch got defragmented), its transform must be rewritten
+        mInstanceDataDirty = true;
+
         //Don't update if we're static, but still mark we're dirty
         if( !mBoundsDirty && !mKeepStatic )
             mCreator->_addDirtyBatch( this );
         mBoundsDirty = true;
     }
     //-----------------------------------------------------------------------
+    void InstanceBatchHW::_setCustomParam( InstancedEntity *instancedEntity, unsigned char idx,
+                                           const Vector4 &newParam )
+    {
+        InstanceBatch::_setCustomParam( instancedEntity, idx, newParam );
+        mInstanceDataDirty = true;
+    }
+    //-----------------------------------------------------------------------
     void InstanceBatchHW::setStaticAndUpdate( bool bStatic )
     {
         //We were dirty but didn't update bounds. Do it now.
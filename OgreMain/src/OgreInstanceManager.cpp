@@ -51,6 +51,17 @@ namespace Ogre
     {
         mMeshReference = MeshManager::getSingleton().load( meshName, groupName );
 
+        //The instancing shaders read the positions as they are, without a decode
+        const SubMesh* subMesh = mMeshReference->getSubMesh( mSubMeshIdx );
+        const VertexData* vertexData = subMesh->useSharedVertices ? mMeshReference->sharedVertexData :
+                                                                    subMesh->vertexData;
+        const VertexElement* posElem = vertexData->vertexDeclaration->findElementBySemantic( VES_POSITION );
+        if( posElem && posElem->getType() != VET_FLOAT3 )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Mesh '" + meshName + "' has quantised positions, "
+                         "instancing requires VET_FLOAT3", "InstanceManager::InstanceManager" );
+        }
+
         if(mMeshReference->sharedVertexData)
             unshareVertices(mMeshReference);
 
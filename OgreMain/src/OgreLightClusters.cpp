@@ -0,0 +1,347 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreLightClusters.h"
+#include "OgreCamera.h"
+#include "OgreLight.h"
+#include "OgreTextureManager.h"
+#include "OgreHardwarePixelBuffer.h"
+
+namespace Ogre
+{
+    //---------------------------------------------------------------------
+    LightClusters::LightClusters(const String& name)
+        : mName("Ogre/LightClusters/" + name)
+        , mTilesX(16)
+        , mTilesY(9)
+        , mSlices(24)
+        , mFarDistance(0)
+        , mMaxLightsPerCluster(64)
+        , mNear(1)
+        , mFar(1)
+        , mSliceScale(0)
+        , mPerspective(true)
+        , mNumDirectionalLights(0)
+        , mDepthParams(Vector4::ZERO)
+        , mProjectionParams(Vector4::ZERO)
+        , mGridParams(Vector4::ZERO)
+        , mTextureParams(Vector4::ZERO)
+    {
+    }
+    //---------------------------------------------------------------------
+    LightClusters::~LightClusters()
+    {
+        destroyTextures();
+    }
+    //---------------------------------------------------------------------
+    void LightClusters::setDimensions(uint16 tilesX, uint16 tilesY, uint16 slices)
+    {
+        if (!tilesX || !tilesY || !slices)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Cluster dimensions must not be zero",
+                        "LightClusters::setDimensions");
+        }
+        mTilesX = tilesX;
+        mTilesY = tilesY;
+        mSlices = slices;
+    }
+    //---------------------------------------------------------------------
+    void LightClusters::setMaxLightsPerCluster(size_t count)
+    {
+        mMaxLightsPerCluster = std::min(count, MAX_LIGHTS_PER_CLUSTER);
+    }
+    //---------------------------------------------------------------------
+    void LightClusters::packLight(const Light* light)
+    {
+        Vector3 toLight = -(mViewMatrix.linear() * light->getDerivedDirection());
+        toLight.normalise();
+
+        Vector4 texels[LIGHT_TEXELS];
+        if (light->getType() == Light::LT_DIRECTIONAL)
+            texels[0] = Vector4(toLight.x, toLight.y, toLight.z, 0);
+        else
+            texels[0] = Vector4(mViewMatrix * light->getDerivedPosition());
+        texels[0].w = light->getType() == Light::LT_DIRECTIONAL ? 0 : light->getAttenuationRange();
+
+        ColourValue diffuse = light->getDiffuseColour() * light->getPowerScale();
+        ColourValue specular = light->getSpecularColour() * light->getPowerScale();
+        texels[1] = Vector4(diffuse.r, diffuse.g, diffuse.b, (Real)light->getType());
+        texels[2] = Vector4(specular.r, specular.g, specular.b, light->getSpotlightFalloff());
+        texels[3] = Vector4(light->getAttenuationConstant(), light->getAttenuationLinear(),
+                            light->getAttenuationQuadric(),
+                            Math::Cos(light->getSpotlightOuterAngle() * 0.5));
+        texels[4] = Vector4(toLight.x, toLight.y, toLight.z,
+                            Math::Cos(light->getSpotlightInnerAngle() * 0.5));
+
+        for (size_t t = 0; t < LIGHT_TEXELS; ++t)
+            for (size_t c = 0; c < 4; ++c)
+                mLightData.push_back(static_cast<float>(texels[t][c]));
+    }
+    //---------------------------------------------------------------------
+    void LightClusters::build(const Camera* camera, const LightList& lights)
+    {
+        mViewMatrix = camera->getViewMatrix();
+        mNear = camera->getNearClipDistance();
+        mPerspective = camera->getProjectionType() == PT_PERSPECTIVE;
+
+        // Light data, directional lights first. Node transforms are read here so
+        // that the workers only touch plain data.
+        mLightData.clear();
+        mSpheres.clear();
+        mNumDirectionalLights = 0;
+        for (size_t i = 0; i < lights.size(); ++i)
+        {
+            if (lights[i]->getType() == Light::LT_DIRECTIONAL)
+            {
+                packLight(lights[i]);
+                mSpheres.push_back(Vector4::ZERO);
+                ++mNumDirectionalLights;
+            }
+        }
+
+        Real furthest = 0;
+        for (size_t i = 0; i < lights.size(); ++i)
+        {
+            const Light* light = lights[i];
+            if (light->getType() == Light::LT_DIRECTIONAL)
+                continue;
+
+            packLight(light);
+            const float* data = &mLightData[mLightData.size() - LIGHT_TEXELS * 4];
+            mSpheres.push_back(Vector4(data[0], data[1], data[2], data[3]));
+            furthest = std::max(furthest, -data[2] + data[3]);
+        }
+
+        mFar = mFarDistance;
+        if (mFar <= 0)
+            mFar = camera->getFarClipDistance();
+        if (mFar <= 0)
+            mFar = furthest;
+        mFar = std::max(mFar, mNear * 2);
+        mSliceScale = mSlices / Math::Log(mFar / mNear);
+
+        RealRect extents = camera->getFrustumExtents();
+        Real halfWidth = (extents.right - extents.left) * 0.5f;
+        Real halfHeight = (extents.top - extents.bottom) * 0.5f;
+        Real projScale = mPerspective ? mNear : 1;
+        mProjectionParams = Vector4(projScale / halfWidth, projScale / halfHeight,
+                                    -(extents.right + extents.left) * 0.5f / halfWidth,
+                                    -(extents.top + extents.bottom) * 0.5f / halfHeight);
+        mDepthParams = Vector4(mNear, mSliceScale, mSlices, mPerspective ? 1 : 0);
+
+        // Bin the positional lights, in parallel. Each light has its own pair lists.
+        size_t count = mSpheres.size() - mNumDirectionalLights;
+        std::vector<std::vector<uint32> > clusterLists(count);
+        std::vector<std::vector<uint32> > lightLists(count);
+        WorkQueue::parallelForDefault(count, [this, &clusterLists, &lightLists](size_t i) {
+            size_t light = mNumDirectionalLights + i;
+            binLights(light, light + 1, clusterLists[i], lightLists[i]);
+        });
+
+        // Counting sort of the pairs by cluster. Visiting the lists in light
+        // order keeps the lights of a cluster in order.
+        size_t numClusters = (size_t)mTilesX * mTilesY * mSlices;
+        mClusters.assign(numClusters * 2, 0);
+        for (size_t t = 0; t < count; ++t)
+        {
+            const std::vector<uint32>& clusterList = clusterLists[t];
+            for (size_t p = 0; p < clusterList.size(); ++p)
+            {
+                uint32& clusterCount = mClusters[clusterList[p] * 2 + 1];
+                if (clusterCount < mMaxLightsPerCluster)
+                    ++clusterCount;
+            }
+        }
+
+        uint32 offset = 0;
+        for (size_t c = 0; c < numClusters; ++c)
+        {
+            mClusters[c * 2] = offset;
+            offset += mClusters[c * 2 + 1];
+            // reset, counts again while filling
+            mClusters[c * 2 + 1] = 0;
+        }
+
+        mLightIndices.resize(offset);
+        for (size_t t = 0; t < count; ++t)
+        {
+            const std::vector<uint32>& clusterList = clusterLists[t];
+            const std::vector<uint32>& lightList = lightLists[t];
+            for (size_t p = 0; p < clusterList.size(); ++p)
+            {
+                uint32* cluster = &mClusters[clusterList[p] * 2];
+                if (cluster[1] < mMaxLightsPerCluster)
+                    mLightIndices[cluster[0] + cluster[1]++] = lightList[p];
+            }
+        }
+
+        mGridParams = Vector4(mTilesX, mTilesY, (Real)mNumDirectionalLights, mGridParams.w);
+    }
+    //---------------------------------------------------------------------
+    bool LightClusters::getTileRange(Real minimum, Real maximum, Real nearDepth, Real farDepth,
+                                     Real scale, Real offset, int tiles, int& first, int& last) const
+    {
+        if (mPerspective)
+        {
+            // Widest projection over the depth range
+            minimum /= minimum >= 0 ? farDepth : nearDepth;
+            maximum /= maximum >= 0 ? nearDepth : farDepth;
+        }
+
+        Real firstTile = ((minimum * scale + offset) * 0.5f + 0.5f) * tiles;
+        Real lastTile = ((maximum * scale + offset) * 0.5f + 0.5f) * tiles;
+        if (lastTile < 0 || firstTile >= tiles)
+            return false;
+
+        first = (int)std::max(firstTile, Real(0));
+        last = (int)std::min(lastTile, Real(tiles - 1));
+        return true;
+    }
+    //---------------------------------------------------------------------
+    void LightClusters::binLights(size_t begin, size_t end, std::vector<uint32>& clusters,
+                                  std::vector<uint32>& lights) const
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Vector4& sphere = mSpheres[i];
+            Real depth = -sphere.z;
+            Real radius = sphere.w;
+            Real minDepth = std::max(depth - radius, mNear);
+            Real maxDepth = std::min(depth + radius, mFar);
+            if (minDepth > maxDepth)
+                continue;
+
+            int firstSlice = Math::Clamp((int)(Math::Log(minDepth / mNear) * mSliceScale), 0, mSlices - 1);
+            int lastSlice = Math::Clamp((int)(Math::Log(maxDepth / mNear) * mSliceScale), 0, mSlices - 1);
+
+            for (int slice = firstSlice; slice <= lastSlice; ++slice)
+            {
+                // Part of the sphere within the slice
+                Real sliceNear = std::max(minDepth, mNear * Math::Exp(slice / mSliceScale));
+                Real sliceFar = std::max(sliceNear,
+                    std::min(maxDepth, mNear * Math::Exp((slice + 1) / mSliceScale)));
+                Real toSlice = depth < sliceNear ? sliceNear - depth :
+                    (depth > sliceFar ? depth - sliceFar : 0);
+                Real halfSize = Math::Sqrt(std::max(radius * radius - toSlice * toSlice, Real(0)));
+
+                int firstX, lastX, firstY, lastY;
+                if (!getTileRange(sphere.x - halfSize, sphere.x + halfSize, sliceNear, sliceFar,
+                                  mProjectionParams.x, mProjectionParams.z, mTilesX, firstX, lastX) ||
+                    !getTileRange(sphere.y - halfSize, sphere.y + halfSize, sliceNear, sliceFar,
+                                  mProjectionParams.y, mProjectionParams.w, mTilesY, firstY, lastY))
+                {
+                    continue;
+                }
+
+                for (int y = firstY; y <= lastY; ++y)
+                {
+                    for (int x = firstX; x <= lastX; ++x)
+                    {
+                        clusters.push_back(static_cast<uint32>(getClusterIndex(x, y, slice)));
+                        lights.push_back(static_cast<uint32>(i));
+                    }
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void LightClusters::prepareTexture(TexturePtr& texture, const String& name, PixelFormat format,
+                                       uint32 width, uint32 height)
+    {
+        if (!texture)
+        {
+            texture = TextureManager::getSingleton().createManual(
+                name, ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME, TEX_TYPE_2D,
+                width, height, 0, format, TU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+        }
+        else if (texture->getWidth() != width || texture->getHeight() < height)
+        {
+            // Keep the same texture, materials hold on to it
+            texture->freeInternalResources();
+            texture->setWidth(width);
+            texture->setHeight(std::max(height, texture->getHeight() * 2));
+            texture->createInternalResources();
+        }
+    }
+    //---------------------------------------------------------------------
+    void LightClusters::upload(void)
+    {
+        size_t numLights = getNumLights();
+        size_t numIndices = mLightIndices.size();
+        uint32 indexRows = static_cast<uint32>((numIndices + INDEX_TEXTURE_WIDTH - 1) / INDEX_TEXTURE_WIDTH);
+
+        prepareTexture(mLightTexture, mName + "/Lights", PF_FLOAT32_RGBA, LIGHT_TEXELS,
+                       std::max<uint32>(Bitwise::firstPO2From(static_cast<uint32>(numLights)), 64));
+        prepareTexture(mClusterTexture, mName + "/Clusters", PF_FLOAT32_RGBA,
+                       (uint32)mTilesX * mTilesY, mSlices);
+        prepareTexture(mIndexTexture, mName + "/Indices", PF_FLOAT32_R, INDEX_TEXTURE_WIDTH,
+                       std::max<uint32>(Bitwise::firstPO2From(indexRows), 16));
+
+        if (numLights)
+        {
+            PixelBox src(LIGHT_TEXELS, static_cast<uint32>(numLights), 1, PF_FLOAT32_RGBA,
+                         const_cast<float*>(&mLightData[0]));
+            mLightTexture->getBuffer()->blitFromMemory(src, Box(0, 0, src.getWidth(), src.getHeight()));
+        }
+
+        // Empty clusters until built with the current dimensions
+        size_t numClusters = (size_t)mTilesX * mTilesY * mSlices;
+        mUploadBuffer.assign(numClusters * 4, 0.0f);
+        for (size_t c = 0; c < numClusters && mClusters.size() == numClusters * 2; ++c)
+        {
+            mUploadBuffer[c * 4] = static_cast<float>(mClusters[c * 2]);
+            mUploadBuffer[c * 4 + 1] = static_cast<float>(mClusters[c * 2 + 1]);
+        }
+        mClusterTexture->getBuffer()->blitFromMemory(
+            PixelBox((uint32)mTilesX * mTilesY, mSlices, 1, PF_FLOAT32_RGBA, &mUploadBuffer[0]));
+
+        if (numIndices)
+        {
+            mUploadBuffer.assign(indexRows * INDEX_TEXTURE_WIDTH, 0.0f);
+            for (size_t i = 0; i < numIndices; ++i)
+                mUploadBuffer[i] = static_cast<float>(mLightIndices[i]);
+            PixelBox src(INDEX_TEXTURE_WIDTH, indexRows, 1, PF_FLOAT32_R, &mUploadBuffer[0]);
+            mIndexTexture->getBuffer()->blitFromMemory(src, Box(0, 0, src.getWidth(), src.getHeight()));
+        }
+
+        mGridParams.w = (Real)mLightTexture->getHeight();
+        mTextureParams = Vector4((Real)mClusterTexture->getWidth(), (Real)mClusterTexture->getHeight(),
+                                 (Real)mIndexTexture->getWidth(), (Real)mIndexTexture->getHeight());
+    }
+    //---------------------------------------------------------------------
+    void LightClusters::destroyTextures(void)
+    {
+        TexturePtr* textures[] = {&mLightTexture, &mClusterTexture, &mIndexTexture};
+        for (size_t i = 0; i < 3; ++i)
+        {
+            if (*textures[i] && TextureManager::getSingletonPtr())
+                TextureManager::getSingleton().remove(*textures[i]);
+            textures[i]->reset();
+        }
+    }
+}
@@ -433,10 +433,19 @@ namespace Ogre {
                 "You must call begin() before this method",
                 "ManualObject::index");
         }
-        mAnyIndexed = true;
         if (idx >= 65536)
             mCurrentSection->set32BitIndices(true);
 
+        IndexData* indexData = getCurrentIndexData();
+        resizeTempIndexBufferIfNeeded(++indexData->indexCount);
+
+        mTempIndexBuffer[indexData->indexCount - 1] = idx;
+    }
+    //-----------------------------------------------------------------------------
+    IndexData* ManualObject::getCurrentIndexData(void)
+    {
+        mAnyIndexed = true;
+
         // make sure we have index data
         RenderOperation* rop = mCurrentSection->getRenderOperation();
         if (!rop->indexData)
@@ -445,9 +454,7 @@ namespace Ogre {
             rop->indexData->indexCount = 0;
         }
         rop->useIndexes = true;
-        resizeTempIndexBufferIfNeeded(++rop->indexData->indexCount);
-
-        mTempIndexBuffer[rop->indexData->indexCount - 1] = idx;
+        return rop->indexData;
     }
     //-----------------------------------------------------------------------------
     void ManualObject::triangle(uint32 i1, uint32 i2, uint32 i3)
@@ -479,6 +486,79 @@ namespace Ogre {
         triangle(i3, i4, i1);
     }
     //-----------------------------------------------------------------------------
+    void ManualObject::appendVertices(const void* pData, size_t count)
+    {
+        if (!mCurrentSection)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "You must call begin() before this method",
+                "ManualObject::appendVertices");
+        }
+        if (mTempVertexPending)
+        {
+            // bake current vertex
+            copyTempVertexToBuffer();
+        }
+
+        RenderOperation* rop = mCurrentSection->getRenderOperation();
+        if (!mCurrentUpdating && rop->vertexData->vertexCount == 0)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "The vertex declaration is not known before the first vertex is defined",
+                "ManualObject::appendVertices");
+        }
+        // The declaration is complete, so no more elements may be added
+        mFirstVertex = false;
+
+        size_t firstVertex = rop->vertexData->vertexCount;
+        rop->vertexData->vertexCount += count;
+        resizeTempVertexBufferIfNeeded(rop->vertexData->vertexCount);
+        char* pBase = mTempVertexBuffer + mDeclSize * firstVertex;
+        memcpy(pBase, pData, mDeclSize * count);
+
+        // update bounds
+        const VertexElement* posElem =
+            rop->vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+        if (posElem)
+        {
+            for (size_t v = 0; v < count; ++v, pBase += mDeclSize)
+            {
+                float* pPos;
+                posElem->baseVertexPointerToElement(pBase, &pPos);
+                Vector3 pos(pPos[0], pPos[1], pPos[2]);
+                mAABB.merge(pos);
+                mRadius = std::max(mRadius, pos.length());
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------
+    void ManualObject::appendIndices(const uint32* pIndices, size_t count)
+    {
+        if (!mCurrentSection)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "You must call begin() before this method",
+                "ManualObject::appendIndices");
+        }
+        if (!mCurrentSection->get32BitIndices())
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (pIndices[i] >= 65536)
+                {
+                    mCurrentSection->set32BitIndices(true);
+                    break;
+                }
+            }
+        }
+
+        IndexData* indexData = getCurrentIndexData();
+        size_t firstIndex = indexData->indexCount;
+        indexData->indexCount += count;
+        resizeTempIndexBufferIfNeeded(indexData->indexCount);
+        memcpy(mTempIndexBuffer + firstIndex, pIndices, count * sizeof(uint32));
+    }
+    //-----------------------------------------------------------------------------
     size_t ManualObject::getCurrentVertexCount() const
     {
         if (!mCurrentSection)
@@ -662,7 +742,7 @@ namespace Ogre {
                 if (vbuf->getNumVertices() >= rop->vertexData->vertexCount)
                     vbufNeedsCreating = false;
 
-                if (rop->useIndexes)
+                if (rop->useIndexes && rop->indexData->indexBuffer)
                 {
                     if ((rop->indexData->indexBuffer->getNumIndexes() >= rop->indexData->indexCount) &&
                         (indexType == rop->indexData->indexBuffer->getType()))
@@ -676,6 +756,10 @@ namespace Ogre {
                 // to allow for user-configured growth area
                 size_t vertexCount = std::max(rop->vertexData->vertexCount, 
                     mEstVertexCount);
+                // Grow dynamic buffers geometrically, so that steadily growing
+                // geometry doesn't recreate them on every update
+                if (mCurrentUpdating && mDynamic)
+                    vertexCount = std::max(vertexCount, vbuf->getNumVertices() * 2);
                 vbuf =
                     HardwareBufferManager::getSingleton().createVertexBuffer(
                         mDeclSize,
@@ -690,6 +774,9 @@ namespace Ogre {
                 // to allow for user-configured growth area
                 size_t indexCount = std::max(rop->indexData->indexCount, 
                     mEstIndexCount);
+                if (mCurrentUpdating && mDynamic && rop->indexData->indexBuffer)
+                    indexCount = std::max(indexCount,
+                        rop->indexData->indexBuffer->getNumIndexes() * 2);
                 rop->indexData->indexBuffer =
                     HardwareBufferManager::getSingleton().createIndexBuffer(
                         indexType,
@@ -732,7 +819,9 @@ namespace Ogre {
         } // empty section check
 
         mCurrentSection = 0;
-        resetTempAreas();
+        // Dynamic objects keep the temp areas for their next update
+        if (!mDynamic)
+            resetTempAreas();
 
         // Tell parent if present
         if (mParentNode)
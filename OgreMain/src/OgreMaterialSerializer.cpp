@@ -2011,6 +2011,9 @@ namespace Ogre
                         if ((currentParam->name == "uses_vertex_texture_fetch")
                             && (paramstr == "false"))
                             paramstr.clear();
+                        if ((currentParam->name == "includes_instancing")
+                            && (paramstr == "false"))
+                            paramstr.clear();
 
                         if ((language != "asm") && (currentParam->name == "syntax"))
                             paramstr.clear();
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreAnimationTrack.h"
 #include "OgreOptimisedUtil.h"
 #include "OgreTangentSpaceCalc.h"
+#include "OgreMeshBVH.h"
 #include "OgreLodStrategyManager.h"
 #include "OgrePixelCountLodStrategy.h"
 
@@ -57,6 +58,7 @@ namespace Ogre {
         mPreparedForShadowVolumes(false),
         mEdgeListsBuilt(false),
         mAutoBuildEdgeLists(true), // will be set to false by serializers of 1.30 and above
+        mTriangleBVH(0),
         mSharedVertexDataAnimationType(VAT_NONE),
         mSharedVertexDataAnimationIncludesNormals(false),
         mAnimationTypesDirty(true),
@@ -262,6 +264,7 @@ namespace Ogre {
         mSubMeshNameMap.clear();
 
         freeEdgeList();
+        freeTriangleBVH();
 #if !OGRE_NO_MESHLOD
         // Removes all LOD data
         removeLodLevels();
@@ -1862,6 +1865,305 @@ namespace Ogre {
         mEdgeListsBuilt = false;
     }
     //---------------------------------------------------------------------
+    void Mesh::optimiseVertexCache(void)
+    {
+        for (SubMeshList::iterator i = mSubMeshList.begin(); i != mSubMeshList.end(); ++i)
+        {
+            SubMesh* sm = *i;
+            if (sm->operationType != RenderOperation::OT_TRIANGLE_LIST)
+                continue;
+
+            std::vector<IndexData*> indexDatas(1, sm->indexData);
+            indexDatas.insert(indexDatas.end(), sm->mLodFaceList.begin(), sm->mLodFaceList.end());
+            for (size_t n = 0; n < indexDatas.size(); ++n)
+            {
+                IndexData* indexData = indexDatas[n];
+                if (!indexData || !indexData->indexBuffer || !indexData->indexCount)
+                    continue;
+
+                // Ranges of a shared (compressed LOD) buffer may overlap
+                bool sharedBuffer = false;
+                for (size_t m = 0; m < indexDatas.size() && !sharedBuffer; ++m)
+                {
+                    sharedBuffer = m != n && indexDatas[m] &&
+                        indexDatas[m]->indexBuffer == indexData->indexBuffer;
+                }
+                if (!sharedBuffer)
+                    indexData->optimiseVertexCacheTriList();
+            }
+        }
+
+        // The hierarchy references triangles by index
+        freeTriangleBVH();
+    }
+    //---------------------------------------------------------------------
+    void Mesh::optimiseOverdraw(Real threshold)
+    {
+        for (SubMeshList::iterator i = mSubMeshList.begin(); i != mSubMeshList.end(); ++i)
+        {
+            SubMesh* sm = *i;
+            if (sm->operationType != RenderOperation::OT_TRIANGLE_LIST)
+                continue;
+
+            const VertexData* vertexData = sm->useSharedVertices ? sharedVertexData : sm->vertexData;
+            if (!vertexData)
+                continue;
+
+            std::vector<IndexData*> indexDatas(1, sm->indexData);
+            indexDatas.insert(indexDatas.end(), sm->mLodFaceList.begin(), sm->mLodFaceList.end());
+            for (size_t n = 0; n < indexDatas.size(); ++n)
+            {
+                IndexData* indexData = indexDatas[n];
+                if (!indexData || !indexData->indexBuffer || !indexData->indexCount)
+                    continue;
+
+                // Ranges of a shared (compressed LOD) buffer may overlap
+                bool sharedBuffer = false;
+                for (size_t m = 0; m < indexDatas.size() && !sharedBuffer; ++m)
+                {
+                    sharedBuffer = m != n && indexDatas[m] &&
+                        indexDatas[m]->indexBuffer == indexData->indexBuffer;
+                }
+                if (!sharedBuffer)
+                    indexData->optimiseOverdrawTriList(vertexData, threshold);
+            }
+        }
+
+        // The hierarchy references triangles by index
+        freeTriangleBVH();
+    }
+    //---------------------------------------------------------------------
+    static bool remapVertexFetch(VertexData* vertexData, const std::vector<IndexData*>& indexDatas,
+        Mesh::VertexBoneAssignmentList& boneAssignments)
+    {
+        if (!vertexData || vertexData->vertexStart != 0 || indexDatas.empty())
+            return false;
+
+        const size_t vertexCount = vertexData->vertexCount;
+        const uint32 unassigned = static_cast<uint32>(~0);
+        std::vector<uint32> oldToNew(vertexCount, unassigned);
+        uint32 nextVertex = 0;
+
+        // New order is the order of first reference
+        for (size_t n = 0; n < indexDatas.size(); ++n)
+        {
+            const IndexData* indexData = indexDatas[n];
+            if (!indexData->indexCount)
+                continue;
+            HardwareIndexBufferLockGuard indexLock(indexData->indexBuffer,
+                indexData->indexStart * indexData->indexBuffer->getIndexSize(),
+                indexData->indexCount * indexData->indexBuffer->getIndexSize(),
+                HardwareBuffer::HBL_READ_ONLY);
+            bool idx32bit = indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT;
+            for (size_t i = 0; i < indexData->indexCount; ++i)
+            {
+                uint32 index = idx32bit ? static_cast<uint32*>(indexLock.pData)[i] :
+                    static_cast<uint16*>(indexLock.pData)[i];
+                if (index >= vertexCount)
+                    return false; // malformed, leave everything as is
+                if (oldToNew[index] == unassigned)
+                    oldToNew[index] = nextVertex++;
+            }
+        }
+        // Unreferenced vertices go last
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            if (oldToNew[v] == unassigned)
+                oldToNew[v] = nextVertex++;
+        }
+
+        // Remap whole index buffers once each, LOD levels may share one. Indexes
+        // outside the ranges in use are remapped too, so check them all first.
+        std::set<HardwareIndexBuffer*> remappedBuffers;
+        for (size_t n = 0; n < indexDatas.size(); ++n)
+        {
+            const HardwareIndexBufferSharedPtr& ibuf = indexDatas[n]->indexBuffer;
+            if (!remappedBuffers.insert(ibuf.get()).second)
+                continue;
+            HardwareIndexBufferLockGuard indexLock(ibuf, HardwareBuffer::HBL_READ_ONLY);
+            bool idx32bit = ibuf->getType() == HardwareIndexBuffer::IT_32BIT;
+            for (size_t i = 0; i < ibuf->getNumIndexes(); ++i)
+            {
+                uint32 index = idx32bit ? static_cast<uint32*>(indexLock.pData)[i] :
+                    static_cast<uint16*>(indexLock.pData)[i];
+                if (index >= vertexCount)
+                    return false;
+            }
+        }
+        remappedBuffers.clear();
+        for (size_t n = 0; n < indexDatas.size(); ++n)
+        {
+            const HardwareIndexBufferSharedPtr& ibuf = indexDatas[n]->indexBuffer;
+            if (!remappedBuffers.insert(ibuf.get()).second)
+                continue;
+            HardwareIndexBufferLockGuard indexLock(ibuf, HardwareBuffer::HBL_NORMAL);
+            if (ibuf->getType() == HardwareIndexBuffer::IT_32BIT)
+            {
+                uint32* pIdx = static_cast<uint32*>(indexLock.pData);
+                for (size_t i = 0; i < ibuf->getNumIndexes(); ++i)
+                    pIdx[i] = oldToNew[pIdx[i]];
+            }
+            else
+            {
+                uint16* pIdx = static_cast<uint16*>(indexLock.pData);
+                for (size_t i = 0; i < ibuf->getNumIndexes(); ++i)
+                    pIdx[i] = static_cast<uint16>(oldToNew[pIdx[i]]);
+            }
+        }
+
+        // Move the vertices; buffers extended for shadow volumes hold several
+        // copies back to back, each is permuted the same way
+        const VertexBufferBinding::VertexBufferBindingMap& bindings =
+            vertexData->vertexBufferBinding->getBindings();
+        std::vector<unsigned char> scratch;
+        for (VertexBufferBinding::VertexBufferBindingMap::const_iterator b = bindings.begin();
+            b != bindings.end(); ++b)
+        {
+            const HardwareVertexBufferSharedPtr& vbuf = b->second;
+            size_t vertexSize = vbuf->getVertexSize();
+            size_t copies = vbuf->getNumVertices() / vertexCount;
+
+            HardwareVertexBufferLockGuard vertexLock(vbuf, HardwareBuffer::HBL_NORMAL);
+            unsigned char* pData = static_cast<unsigned char*>(vertexLock.pData);
+            scratch.assign(pData, pData + copies * vertexCount * vertexSize);
+            for (size_t c = 0; c < copies; ++c)
+            {
+                const unsigned char* pSrc = &scratch[c * vertexCount * vertexSize];
+                unsigned char* pDst = pData + c * vertexCount * vertexSize;
+                for (size_t v = 0; v < vertexCount; ++v)
+                    memcpy(pDst + oldToNew[v] * vertexSize, pSrc + v * vertexSize, vertexSize);
+            }
+        }
+
+        Mesh::VertexBoneAssignmentList remapped;
+        for (Mesh::VertexBoneAssignmentList::const_iterator i = boneAssignments.begin();
+            i != boneAssignments.end(); ++i)
+        {
+            VertexBoneAssignment vba = i->second;
+            vba.vertexIndex = oldToNew[vba.vertexIndex];
+            remapped.insert(Mesh::VertexBoneAssignmentList::value_type(vba.vertexIndex, vba));
+        }
+        boneAssignments.swap(remapped);
+
+        return true;
+    }
+    //---------------------------------------------------------------------
+    void Mesh::optimiseVertexFetch(void)
+    {
+        if (!mPoseList.empty() || hasVertexAnimation())
+        {
+            LogManager::getSingleton().logWarning("the mesh '" + mName + "' has pose or morph "
+                "animation, vertex order is left untouched. In Mesh::optimiseVertexFetch");
+            return;
+        }
+
+        bool changed = false;
+        if (sharedVertexData)
+        {
+            std::vector<IndexData*> indexDatas;
+            for (SubMeshList::iterator i = mSubMeshList.begin(); i != mSubMeshList.end(); ++i)
+            {
+                SubMesh* sm = *i;
+                if (!sm->useSharedVertices)
+                    continue;
+                indexDatas.push_back(sm->indexData);
+                indexDatas.insert(indexDatas.end(), sm->mLodFaceList.begin(), sm->mLodFaceList.end());
+            }
+            changed |= remapVertexFetch(sharedVertexData, indexDatas, mBoneAssignments);
+        }
+
+        for (SubMeshList::iterator i = mSubMeshList.begin(); i != mSubMeshList.end(); ++i)
+        {
+            SubMesh* sm = *i;
+            if (sm->useSharedVertices)
+                continue;
+            std::vector<IndexData*> indexDatas(1, sm->indexData);
+            indexDatas.insert(indexDatas.end(), sm->mLodFaceList.begin(), sm->mLodFaceList.end());
+            changed |= remapVertexFetch(sm->vertexData, indexDatas, sm->mBoneAssignments);
+        }
+
+        // Edge lists reference vertices by index
+        if (changed && mEdgeListsBuilt)
+        {
+            freeEdgeList();
+            buildEdgeList();
+        }
+    }
+    //---------------------------------------------------------------------
+    void Mesh::buildMeshlets(size_t maxTrianglesPerMeshlet)
+    {
+        for (SubMeshList::iterator i = mSubMeshList.begin(); i != mSubMeshList.end(); ++i)
+            (*i)->buildMeshlets(maxTrianglesPerMeshlet);
+
+        // Edge lists and the triangle hierarchy reference triangles by index
+        if (mEdgeListsBuilt)
+        {
+            freeEdgeList();
+            buildEdgeList();
+        }
+        freeTriangleBVH();
+    }
+    //---------------------------------------------------------------------
+    MeshBVH* Mesh::getTriangleBVH(void)
+    {
+        // Entities on different threads may query a shared mesh for the first time together
+        OGRE_LOCK_AUTO_MUTEX;
+        if (!mTriangleBVH)
+            buildTriangleBVH();
+        return mTriangleBVH;
+    }
+    //---------------------------------------------------------------------
+    void Mesh::buildTriangleBVH(void)
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        freeTriangleBVH();
+        mTriangleBVH = OGRE_NEW MeshBVH(this);
+    }
+    //---------------------------------------------------------------------
+    void Mesh::freeTriangleBVH(void)
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        OGRE_DELETE mTriangleBVH;
+        mTriangleBVH = 0;
+    }
+    //---------------------------------------------------------------------
+    VertexData::QuantisationReport Mesh::quantiseVertexData(bool positions, bool directions,
+        bool texCoords)
+    {
+        // Software animation works on float positions and normals
+        if (hasSkeleton() || hasVertexAnimation() || !mPoseList.empty())
+            positions = directions = false;
+
+        VertexData::QuantisationReport report;
+        if (sharedVertexData)
+            sharedVertexData->quantise(positions, directions, texCoords, report);
+        for (SubMeshList::iterator i = mSubMeshList.begin(); i != mSubMeshList.end(); ++i)
+        {
+            if (!(*i)->useSharedVertices)
+                (*i)->vertexData->quantise(positions, directions, texCoords, report);
+        }
+
+        if (positions)
+        {
+            // Shadow volumes are extruded from float positions on the CPU
+            if (mEdgeListsBuilt || mAutoBuildEdgeLists)
+            {
+                LogManager::getSingleton().logWarning("Mesh '" + mName +
+                    "' has quantised positions, its edge lists are freed and it casts no stencil shadows");
+            }
+            freeEdgeList();
+            mAutoBuildEdgeLists = false;
+        }
+
+        LogManager::getSingleton().stream()
+            << "Quantised vertex data of mesh '" << mName << "' from " << report.bytesBefore
+            << " to " << report.bytesAfter << " bytes, maximum errors: position "
+            << report.maxPositionError << ", direction "
+            << report.maxDirectionError.valueDegrees() << " degrees, texture coordinate "
+            << report.maxTexCoordError;
+        return report;
+    }
+    //---------------------------------------------------------------------
     void Mesh::prepareForShadowVolume(void)
     {
         if (mPreparedForShadowVolumes)
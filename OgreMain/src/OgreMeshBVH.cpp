@@ -0,0 +1,396 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreMeshBVH.h"
+#include "OgreSubMesh.h"
+#include "OgreSphere.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        /// Triangles per leaf node
+        const uint32 LEAF_SIZE = 4;
+
+        /// Merges the positions of the vertices each bone influences into its bounds
+        void mergeBoneBounds(const Mesh::VertexBoneAssignmentList& assignments,
+            const std::vector<Vector3>& positions, MeshBVH::BoneBoundsList& boneBounds)
+        {
+            Mesh::VertexBoneAssignmentList::const_iterator i;
+            for (i = assignments.begin(); i != assignments.end(); ++i)
+            {
+                const VertexBoneAssignment& vba = i->second;
+                if (vba.weight <= 0 || vba.vertexIndex >= positions.size())
+                    continue;
+                if (vba.boneIndex >= boneBounds.size())
+                    boneBounds.resize(vba.boneIndex + 1);
+                boneBounds[vba.boneIndex].merge(positions[vba.vertexIndex]);
+            }
+        }
+
+        /// Squared distance from a point to the closest point of a triangle
+        Real squaredDistanceToTriangle(const Vector3& p, const Vector3& a, const Vector3& b,
+            const Vector3& c)
+        {
+            // Find the Voronoi region of the triangle containing p
+            Vector3 ab = b - a, ac = c - a, ap = p - a;
+            Real d1 = ab.dotProduct(ap), d2 = ac.dotProduct(ap);
+            if (d1 <= 0 && d2 <= 0)
+                return ap.squaredLength();
+
+            Vector3 bp = p - b;
+            Real d3 = ab.dotProduct(bp), d4 = ac.dotProduct(bp);
+            if (d3 >= 0 && d4 <= d3)
+                return bp.squaredLength();
+
+            Real vc = d1 * d4 - d3 * d2;
+            if (vc <= 0 && d1 >= 0 && d3 <= 0)
+                return (ap - ab * (d1 / (d1 - d3))).squaredLength();
+
+            Vector3 cp = p - c;
+            Real d5 = ab.dotProduct(cp), d6 = ac.dotProduct(cp);
+            if (d6 >= 0 && d5 <= d6)
+                return cp.squaredLength();
+
+            Real vb = d5 * d2 - d1 * d6;
+            if (vb <= 0 && d2 >= 0 && d6 <= 0)
+                return (ap - ac * (d2 / (d2 - d6))).squaredLength();
+
+            Real va = d3 * d6 - d5 * d4;
+            if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+                return (bp - (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))).squaredLength();
+
+            // Inside the face
+            Real denom = 1 / (va + vb + vc);
+            return (ap - ab * (vb * denom) - ac * (vc * denom)).squaredLength();
+        }
+
+        /// Orders triangles by their centroid along one axis
+        struct CentroidLess
+        {
+            int axis;
+            explicit CentroidLess(int a) : axis(a) {}
+
+            template <typename T> bool operator()(const T& l, const T& r) const
+            {
+                return l.v[0][axis] + l.v[1][axis] + l.v[2][axis] <
+                    r.v[0][axis] + r.v[1][axis] + r.v[2][axis];
+            }
+        };
+    }
+    //---------------------------------------------------------------------
+    MeshBVH::MeshBVH(const Mesh* mesh)
+    {
+        std::vector<Vector3> sharedPositions, positions;
+        if (mesh->sharedVertexData)
+            mesh->sharedVertexData->readPositions(sharedPositions);
+
+        for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+        {
+            SubMesh* sm = mesh->getSubMesh(i);
+            if (sm->operationType != RenderOperation::OT_TRIANGLE_LIST &&
+                sm->operationType != RenderOperation::OT_TRIANGLE_STRIP &&
+                sm->operationType != RenderOperation::OT_TRIANGLE_FAN)
+                continue;
+
+            if (sm->useSharedVertices)
+            {
+                addTriangles(sm->indexData, sm->operationType, i, sharedPositions);
+            }
+            else
+            {
+                sm->vertexData->readPositions(positions);
+                addTriangles(sm->indexData, sm->operationType, i, positions);
+                mergeBoneBounds(sm->getBoneAssignments(), positions, mBoneBounds);
+            }
+        }
+        mergeBoneBounds(mesh->getBoneAssignments(), sharedPositions, mBoneBounds);
+
+        buildNodes();
+    }
+    //---------------------------------------------------------------------
+    void MeshBVH::addTriangles(const IndexData* indexData, RenderOperation::OperationType opType,
+        unsigned short subMesh, const std::vector<Vector3>& positions)
+    {
+        // Non indexed geometry uses the vertices in order
+        bool indexed = indexData && indexData->indexCount;
+        size_t count = indexed ? indexData->indexCount : positions.size();
+        if (count < 3)
+            return;
+
+        const void* pIndices = 0;
+        bool use32bit = false;
+        if (indexed)
+        {
+            const HardwareIndexBufferSharedPtr& ibuf = indexData->indexBuffer;
+            use32bit = ibuf->getType() == HardwareIndexBuffer::IT_32BIT;
+            pIndices = static_cast<const char*>(ibuf->lock(HardwareBuffer::HBL_READ_ONLY)) +
+                indexData->indexStart * ibuf->getIndexSize();
+        }
+
+        size_t numTriangles = opType == RenderOperation::OT_TRIANGLE_LIST ? count / 3 : count - 2;
+        mTriangles.reserve(mTriangles.size() + numTriangles);
+        for (size_t t = 0; t < numTriangles; ++t)
+        {
+            size_t corners[3];
+            switch (opType)
+            {
+            case RenderOperation::OT_TRIANGLE_STRIP:
+                // every other triangle of a strip is wound the other way
+                corners[0] = t;
+                corners[1] = t + 1 + (t & 1);
+                corners[2] = t + 2 - (t & 1);
+                break;
+            case RenderOperation::OT_TRIANGLE_FAN:
+                corners[0] = 0;
+                corners[1] = t + 1;
+                corners[2] = t + 2;
+                break;
+            default:
+                corners[0] = t * 3;
+                corners[1] = t * 3 + 1;
+                corners[2] = t * 3 + 2;
+                break;
+            }
+
+            Triangle tri;
+            bool valid = true;
+            for (int c = 0; c < 3; ++c)
+            {
+                size_t v = corners[c];
+                if (indexed)
+                    v = use32bit ? static_cast<const uint32*>(pIndices)[v] :
+                        static_cast<const uint16*>(pIndices)[v];
+                if (v >= positions.size())
+                {
+                    valid = false;
+                    break;
+                }
+                tri.v[c] = positions[v];
+            }
+            if (!valid)
+                continue;
+
+            tri.subMesh = subMesh;
+            tri.index = static_cast<uint32>(t);
+            mTriangles.push_back(tri);
+        }
+
+        if (indexed)
+            indexData->indexBuffer->unlock();
+    }
+    //---------------------------------------------------------------------
+    void MeshBVH::buildNodes(void)
+    {
+        mNodes.clear();
+        mBounds.setNull();
+        if (mTriangles.empty())
+            return;
+
+        mNodes.reserve(2 * (mTriangles.size() / LEAF_SIZE + 1));
+        Node root;
+        root.first = 0;
+        root.count = static_cast<uint32>(mTriangles.size());
+        mNodes.push_back(root);
+
+        // Nodes are split top down, each pending one still holding its triangle range
+        std::vector<uint32> pending(1, 0);
+        while (!pending.empty())
+        {
+            uint32 nodeIndex = pending.back();
+            pending.pop_back();
+            uint32 first = mNodes[nodeIndex].first;
+            uint32 count = mNodes[nodeIndex].count;
+
+            AxisAlignedBox bounds, centroidBounds;
+            for (uint32 t = first; t < first + count; ++t)
+            {
+                const Triangle& tri = mTriangles[t];
+                bounds.merge(tri.v[0]);
+                bounds.merge(tri.v[1]);
+                bounds.merge(tri.v[2]);
+                centroidBounds.merge(tri.v[0] + tri.v[1] + tri.v[2]);
+            }
+            mNodes[nodeIndex].minimum = bounds.getMinimum();
+            mNodes[nodeIndex].maximum = bounds.getMaximum();
+
+            // Split at the median centroid along the longest axis
+            Vector3 extent = centroidBounds.getSize();
+            int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+            if (count <= LEAF_SIZE || extent[axis] <= 0)
+                continue;
+
+            uint32 half = count / 2;
+            std::nth_element(mTriangles.begin() + first, mTriangles.begin() + first + half,
+                mTriangles.begin() + first + count, CentroidLess(axis));
+
+            uint32 child = static_cast<uint32>(mNodes.size());
+            Node left, right;
+            left.first = first;
+            left.count = half;
+            right.first = first + half;
+            right.count = count - half;
+            mNodes.push_back(left);
+            mNodes.push_back(right);
+            mNodes[nodeIndex].first = child;
+            mNodes[nodeIndex].count = 0;
+            pending.push_back(child);
+            pending.push_back(child + 1);
+        }
+
+        mBounds.setExtents(mNodes[0].minimum, mNodes[0].maximum);
+    }
+    //---------------------------------------------------------------------
+    bool MeshBVH::raycast(const Ray& ray, TriangleHit& hit, bool positiveSide,
+        bool negativeSide) const
+    {
+        if (mNodes.empty())
+            return false;
+
+        const Vector3& origin = ray.getOrigin();
+        const Vector3& dir = ray.getDirection();
+        const Vector3 invDir(1 / dir.x, 1 / dir.y, 1 / dir.z);
+        Real nearest = std::numeric_limits<Real>::infinity();
+        const Triangle* nearestTri = 0;
+
+        // Slab test of a node against the ray up to the nearest hit so far; a NaN from
+        // an origin on a slab with a zero direction component leaves the range unchanged
+        struct NodeTest
+        {
+            static bool intersects(const Node& node, const Vector3& o, const Vector3& inv,
+                Real maxT, Real& entry)
+            {
+                Real tmin = 0, tmax = maxT;
+                for (int a = 0; a < 3; ++a)
+                {
+                    Real t0 = (node.minimum[a] - o[a]) * inv[a];
+                    Real t1 = (node.maximum[a] - o[a]) * inv[a];
+                    if (t0 > t1)
+                        std::swap(t0, t1);
+                    if (t0 > tmin)
+                        tmin = t0;
+                    if (t1 < tmax)
+                        tmax = t1;
+                    if (tmin > tmax)
+                        return false;
+                }
+                entry = tmin;
+                return true;
+            }
+        };
+
+        Real entry;
+        if (!NodeTest::intersects(mNodes[0], origin, invDir, nearest, entry))
+            return false;
+
+        uint32 stack[64];
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize)
+        {
+            const Node& node = mNodes[stack[--stackSize]];
+            if (node.count)
+            {
+                for (uint32 t = node.first; t < node.first + node.count; ++t)
+                {
+                    const Triangle& tri = mTriangles[t];
+                    std::pair<bool, Real> result = Math::intersects(ray, tri.v[0], tri.v[1],
+                        tri.v[2], positiveSide, negativeSide);
+                    if (result.first && result.second < nearest)
+                    {
+                        nearest = result.second;
+                        nearestTri = &tri;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first
+            Real entryLeft, entryRight;
+            bool hitLeft = NodeTest::intersects(mNodes[node.first], origin, invDir, nearest, entryLeft);
+            bool hitRight = NodeTest::intersects(mNodes[node.first + 1], origin, invDir, nearest, entryRight);
+            if (hitLeft && hitRight)
+            {
+                bool leftFirst = entryLeft <= entryRight;
+                stack[stackSize++] = node.first + (leftFirst ? 1 : 0);
+                stack[stackSize++] = node.first + (leftFirst ? 0 : 1);
+            }
+            else if (hitLeft)
+                stack[stackSize++] = node.first;
+            else if (hitRight)
+                stack[stackSize++] = node.first + 1;
+        }
+
+        if (!nearestTri)
+            return false;
+
+        hit.distance = nearest;
+        hit.subMesh = nearestTri->subMesh;
+        hit.triangle = nearestTri->index;
+        return true;
+    }
+    //---------------------------------------------------------------------
+    void MeshBVH::sphereQuery(const Sphere& sphere, TriangleHitList& hits) const
+    {
+        if (mNodes.empty())
+            return;
+
+        const Vector3& centre = sphere.getCenter();
+        const Real radiusSq = sphere.getRadius() * sphere.getRadius();
+
+        uint32 stack[64];
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize)
+        {
+            const Node& node = mNodes[stack[--stackSize]];
+            if (!Math::intersects(sphere, AxisAlignedBox(node.minimum, node.maximum)))
+                continue;
+
+            if (!node.count)
+            {
+                stack[stackSize++] = node.first;
+                stack[stackSize++] = node.first + 1;
+                continue;
+            }
+
+            for (uint32 t = node.first; t < node.first + node.count; ++t)
+            {
+                const Triangle& tri = mTriangles[t];
+                if (squaredDistanceToTriangle(centre, tri.v[0], tri.v[1], tri.v[2]) <= radiusSq)
+                {
+                    TriangleHit hit;
+                    hit.distance = 0;
+                    hit.subMesh = tri.subMesh;
+                    hit.triangle = tri.index;
+                    hits.push_back(hit);
+                }
+            }
+        }
+    }
+}
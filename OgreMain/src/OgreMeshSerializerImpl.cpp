@@ -48,7 +48,7 @@ namespace Ogre {
     MeshSerializerImpl::MeshSerializerImpl()
     {
         // Version number
-        mVersion = "[MeshSerializer_v1.100]";
+        mVersion = "[MeshSerializer_v1.110]";
     }
     //---------------------------------------------------------------------
     MeshSerializerImpl::~MeshSerializerImpl()
@@ -205,6 +205,12 @@ namespace Ogre {
 
         // Write submesh extremes
         writeExtremes(pMesh);
+
+        // Write submesh meshlets
+        writeMeshlets(pMesh);
+
+        // Write decodes of quantised positions
+        writePositionDecodes(pMesh);
             popInnerChunk(mStream);
         }
     }
@@ -359,6 +365,101 @@ namespace Ogre {
         return MSTREAM_OVERHEAD_SIZE + sizeof (unsigned short) +
             s->extremityPoints.size() * sizeof (float)* 3;
     }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeMeshlets(const Mesh *pMesh)
+    {
+        bool has_meshlets = false;
+        for (unsigned short i = 0; i < pMesh->getNumSubMeshes(); ++i)
+        {
+            SubMesh *sm = pMesh->getSubMesh(i);
+            if (sm->meshlets.empty())
+                continue;
+            if (!has_meshlets)
+            {
+                has_meshlets = true;
+                LogManager::getSingleton().logMessage("Writing submesh meshlets...");
+            }
+            writeSubMeshMeshlets(i, sm);
+        }
+        if (has_meshlets)
+            LogManager::getSingleton().logMessage("Meshlets exported.");
+    }
+    size_t MeshSerializerImpl::calcMeshletsSize(const Mesh* pMesh)
+    {
+        size_t size = 0;
+        for (unsigned short i = 0; i < pMesh->getNumSubMeshes(); ++i)
+        {
+            SubMesh *sm = pMesh->getSubMesh(i);
+            if (!sm->meshlets.empty())
+                size += calcSubMeshMeshletsSize(i, sm);
+        }
+        return size;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeSubMeshMeshlets(unsigned short idx, const SubMesh* s)
+    {
+        writeChunkHeader(M_TABLE_MESHLETS, calcSubMeshMeshletsSize(idx, s));
+
+        writeShorts(&idx, 1);
+        uint32 count = static_cast<uint32>(s->meshlets.size());
+        writeInts(&count, 1);
+
+        for (SubMesh::MeshletList::const_iterator i = s->meshlets.begin(); i != s->meshlets.end(); ++i)
+        {
+            writeInts(&i->indexStart, 1);
+            writeInts(&i->indexCount, 1);
+            float bounds[8] = {float(i->centre.x), float(i->centre.y), float(i->centre.z), float(i->radius),
+                               float(i->coneAxis.x), float(i->coneAxis.y), float(i->coneAxis.z),
+                               float(i->coneCutoff)};
+            writeFloats(bounds, 8);
+        }
+    }
+
+    size_t MeshSerializerImpl::calcSubMeshMeshletsSize(unsigned short idx, const SubMesh* s)
+    {
+        return MSTREAM_OVERHEAD_SIZE + sizeof (unsigned short) + sizeof (uint32) +
+            s->meshlets.size() * (sizeof (uint32) * 2 + sizeof (float) * 8);
+    }
+    //---------------------------------------------------------------------
+    namespace
+    {
+        /// Gets the vertex data written with the given index in M_TABLE_POSITION_DECODE
+        VertexData* getPositionDecodeVertexData(const Mesh* pMesh, unsigned short idx)
+        {
+            if (idx == 0xFFFF)
+                return pMesh->sharedVertexData;
+            SubMesh* sm = pMesh->getSubMesh(idx);
+            return sm->useSharedVertices ? 0 : sm->vertexData;
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writePositionDecodes(const Mesh *pMesh)
+    {
+        const size_t chunkSize = MSTREAM_OVERHEAD_SIZE + sizeof(unsigned short) + sizeof(float) * 4;
+        for (int i = -1; i < int(pMesh->getNumSubMeshes()); ++i)
+        {
+            unsigned short idx = i < 0 ? 0xFFFF : static_cast<unsigned short>(i);
+            const VertexData* vertexData = getPositionDecodeVertexData(pMesh, idx);
+            if (!vertexData || vertexData->positionDecode == Vector4(0, 0, 0, 1))
+                continue;
+
+            writeChunkHeader(M_TABLE_POSITION_DECODE, chunkSize);
+            writeShorts(&idx, 1);
+            writeFloats(vertexData->positionDecode.ptr(), 4);
+        }
+    }
+    size_t MeshSerializerImpl::calcPositionDecodesSize(const Mesh* pMesh)
+    {
+        size_t size = 0;
+        for (int i = -1; i < int(pMesh->getNumSubMeshes()); ++i)
+        {
+            unsigned short idx = i < 0 ? 0xFFFF : static_cast<unsigned short>(i);
+            const VertexData* vertexData = getPositionDecodeVertexData(pMesh, idx);
+            if (vertexData && vertexData->positionDecode != Vector4(0, 0, 0, 1))
+                size += MSTREAM_OVERHEAD_SIZE + sizeof(unsigned short) + sizeof(float) * 4;
+        }
+        return size;
+    }
 
 
     //---------------------------------------------------------------------
@@ -569,6 +670,8 @@ namespace Ogre {
         }
 
         size += calcExtremesSize(pMesh);
+        size += calcMeshletsSize(pMesh);
+        size += calcPositionDecodesSize(pMesh);
 
         return size;
     }
@@ -911,7 +1014,9 @@ namespace Ogre {
                  streamID == M_EDGE_LISTS ||
                  streamID == M_POSES ||
                  streamID == M_ANIMATIONS ||
-                 streamID == M_TABLE_EXTREMES))
+                 streamID == M_TABLE_EXTREMES ||
+                 streamID == M_TABLE_MESHLETS ||
+                 streamID == M_TABLE_POSITION_DECODE))
             {
                 switch(streamID)
                 {
@@ -959,6 +1064,12 @@ namespace Ogre {
                 case M_TABLE_EXTREMES:
                     readExtremes(stream, pMesh);
                     break;
+                case M_TABLE_MESHLETS:
+                    readMeshlets(stream, pMesh);
+                    break;
+                case M_TABLE_POSITION_DECODE:
+                    readPositionDecode(stream, pMesh);
+                    break;
                 }
 
                 if (!stream->eof())
@@ -1649,9 +1760,11 @@ namespace Ogre {
                         typeSize = sizeof(double);
                         break;
                     case VET_SHORT1:
+                    case VET_SHORT2_NORM:
                         typeSize = sizeof(short);
                         break;
                     case VET_USHORT1:
+                    case VET_USHORT2_NORM:
                         typeSize = sizeof(unsigned short);
                         break;
                     case VET_INT1:
@@ -1666,6 +1779,9 @@ namespace Ogre {
                         typeSize = sizeof(RGBA);
                         break;
                     case VET_UBYTE4:
+                    case VET_UBYTE4_NORM:
+                    case VET_BYTE4:
+                    case VET_BYTE4_NORM:
                         typeSize = 0; // NO FLIPPING
                         break;
                     default:
@@ -2737,6 +2853,41 @@ namespace Ogre {
         
         OGRE_FREE(vert, MEMCATEGORY_GEOMETRY);
     }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readMeshlets(DataStreamPtr& stream, Mesh *pMesh)
+    {
+        unsigned short idx;
+        readShorts(stream, &idx, 1);
+        uint32 count;
+        readInts(stream, &count, 1);
+
+        SubMesh *sm = pMesh->getSubMesh(idx);
+        sm->meshlets.resize(count);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            SubMesh::Meshlet& meshlet = sm->meshlets[i];
+            readInts(stream, &meshlet.indexStart, 1);
+            readInts(stream, &meshlet.indexCount, 1);
+            float bounds[8];
+            readFloats(stream, bounds, 8);
+            meshlet.centre = Vector3(bounds[0], bounds[1], bounds[2]);
+            meshlet.radius = bounds[3];
+            meshlet.coneAxis = Vector3(bounds[4], bounds[5], bounds[6]);
+            meshlet.coneCutoff = bounds[7];
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readPositionDecode(DataStreamPtr& stream, Mesh *pMesh)
+    {
+        unsigned short idx;
+        readShorts(stream, &idx, 1);
+        float decode[4];
+        readFloats(stream, decode, 4);
+
+        VertexData* vertexData = getPositionDecodeVertexData(pMesh, idx);
+        if (vertexData)
+            vertexData->positionDecode = Vector4(decode[0], decode[1], decode[2], decode[3]);
+    }
 
     void MeshSerializerImpl::enableValidation()
     {
@@ -2746,6 +2897,50 @@ namespace Ogre {
     }
 
 
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v1_10::MeshSerializerImpl_v1_10()
+    {
+        // Version number
+        mVersion = "[MeshSerializer_v1.100]";
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v1_10::~MeshSerializerImpl_v1_10()
+    {
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v1_10::writeMeshlets(const Mesh *pMesh)
+    {
+        // Meshlets can be rebuilt after loading, just leave them out
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl_v1_10::calcMeshletsSize(const Mesh* pMesh)
+    {
+        return 0;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v1_10::writePositionDecodes(const Mesh *pMesh)
+    {
+        // Quantised positions would be garbage without their decode
+        for (int i = -1; i < int(pMesh->getNumSubMeshes()); ++i)
+        {
+            const VertexData* vertexData =
+                getPositionDecodeVertexData(pMesh, i < 0 ? 0xFFFF : static_cast<unsigned short>(i));
+            if (vertexData && vertexData->positionDecode != Vector4(0, 0, 0, 1))
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                            "Mesh '" + pMesh->getName() + "' has quantised positions, which this "
+                            "version of the .mesh format does not support",
+                            "MeshSerializerImpl_v1_10::writePositionDecodes");
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl_v1_10::calcPositionDecodesSize(const Mesh* pMesh)
+    {
+        return 0;
+    }
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
@@ -54,7 +54,7 @@ namespace Ogre {
     will remain to load the latest version.
 
      @note
-        This mesh format was used from Ogre v1.10.
+        This mesh format was used from Ogre v1.11.
 
     */
     class _OgrePrivate MeshSerializerImpl : public Serializer
@@ -112,6 +112,9 @@ namespace Ogre {
         virtual void writePoseKeyframePoseRef(const VertexPoseKeyFrame::PoseRef& poseRef);
         virtual void writeExtremes(const Mesh *pMesh);
         virtual void writeSubMeshExtremes(unsigned short idx, const SubMesh* s);
+        virtual void writeMeshlets(const Mesh *pMesh);
+        virtual void writeSubMeshMeshlets(unsigned short idx, const SubMesh* s);
+        virtual void writePositionDecodes(const Mesh *pMesh);
 
         virtual size_t calcMeshSize(const Mesh* pMesh);
         virtual size_t calcSubMeshSize(const SubMesh* pSub);
@@ -140,6 +143,9 @@ namespace Ogre {
         virtual size_t calcBoundsInfoSize(const Mesh* pMesh);
         virtual size_t calcExtremesSize(const Mesh* pMesh);
         virtual size_t calcSubMeshExtremesSize(unsigned short idx, const SubMesh* s);
+        virtual size_t calcMeshletsSize(const Mesh* pMesh);
+        virtual size_t calcSubMeshMeshletsSize(unsigned short idx, const SubMesh* s);
+        virtual size_t calcPositionDecodesSize(const Mesh* pMesh);
 
         virtual void readTextureLayer(DataStreamPtr& stream, Mesh* pMesh, MaterialPtr& pMat);
         virtual void readSubMeshNameTable(DataStreamPtr& stream, Mesh* pMesh);
@@ -173,6 +179,8 @@ namespace Ogre {
         virtual void readMorphKeyFrame(DataStreamPtr& stream, Mesh* pMesh, VertexAnimationTrack* track);
         virtual void readPoseKeyFrame(DataStreamPtr& stream, VertexAnimationTrack* track);
         virtual void readExtremes(DataStreamPtr& stream, Mesh *pMesh);
+        virtual void readMeshlets(DataStreamPtr& stream, Mesh *pMesh);
+        virtual void readPositionDecode(DataStreamPtr& stream, Mesh *pMesh);
 
 
         /// Flip an entire vertex buffer from little endian
@@ -190,10 +198,25 @@ namespace Ogre {
     };
 
 
+    /** Class for providing backwards-compatibility for loading version 1.10 of the .mesh format. 
+     This mesh format was used from Ogre v1.10, it has no meshlets and no quantised positions.
+     */
+    class _OgrePrivate MeshSerializerImpl_v1_10 : public MeshSerializerImpl
+    {
+    public:
+        MeshSerializerImpl_v1_10();
+        ~MeshSerializerImpl_v1_10();
+    protected:
+        void writeMeshlets(const Mesh *pMesh);
+        void writePositionDecodes(const Mesh *pMesh);
+        size_t calcMeshletsSize(const Mesh* pMesh);
+        size_t calcPositionDecodesSize(const Mesh* pMesh);
+    };
+
     /** Class for providing backwards-compatibility for loading version 1.8 of the .mesh format. 
      This mesh format was used from Ogre v1.8.
      */
-    class _OgrePrivate MeshSerializerImpl_v1_8 : public MeshSerializerImpl
+    class _OgrePrivate MeshSerializerImpl_v1_8 : public MeshSerializerImpl_v1_10
     {
     public:
         MeshSerializerImpl_v1_8();
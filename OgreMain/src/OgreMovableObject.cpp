@@ -54,6 +54,7 @@ namespace Ogre {
         , mRenderQueueIDSet(false)
         , mRenderQueuePrioritySet(false)
         , mRenderingDisabled(false)
+        , mStaticShadowCaster(false)
         , mRenderQueueID(RENDER_QUEUE_MAIN)
         , mRenderQueuePriority(100)
         , mUpperDistance(0)
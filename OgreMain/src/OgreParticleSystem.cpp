@@ -35,6 +35,8 @@ THE SOFTWARE.
 #include "OgreParticleAffectorFactory.h"
 #include "OgreParticleSystemRenderer.h"
 #include "OgreControllerManager.h"
+#include "OgreParticleSystemManager.h"
+#include "OgreTimer.h"
 
 namespace Ogre {
     // Init statics
@@ -50,6 +52,13 @@ namespace Ogre {
     ParticleSystem::CmdIterationInterval ParticleSystem::msIterationIntervalCmd;
     ParticleSystem::CmdNonvisibleTimeout ParticleSystem::msNonvisibleTimeoutCmd;
 
+    /// Scales an emission count by a detail factor, rounding stochastically so
+    /// that low emission rates do not drop to zero
+    static unsigned scaleEmission(unsigned requested, Real factor)
+    {
+        return static_cast<unsigned>(requested * factor + Math::UnitRandom());
+    }
+
     RadixSort<ParticleSystem::ActiveParticleList, Particle*, float> ParticleSystem::mRadixSorter;
 
     Real ParticleSystem::msDefaultIterationInterval = 0;
@@ -87,6 +96,12 @@ namespace Ogre {
         mNonvisibleTimeoutSet(false),
         mTimeSinceLastVisible(0),
         mLastVisibleFrame(0),
+        mLodFactor(1.0f),
+        mDistanceLodFactor(1.0f),
+        mLastStatsFrame(0),
+        mRequestedSinceStats(0),
+        mTimeSinceStats(0),
+        mMeanTimeToLive(0),
         mTimeController(0),
         mEmittedEmitterPoolInitialised(false),
         mIsEmitting(true),
@@ -120,6 +135,12 @@ namespace Ogre {
         mNonvisibleTimeoutSet(false),
         mTimeSinceLastVisible(0),
         mLastVisibleFrame(Root::getSingleton().getNextFrameNumber()),
+        mLodFactor(1.0f),
+        mDistanceLodFactor(1.0f),
+        mLastStatsFrame(0),
+        mRequestedSinceStats(0),
+        mTimeSinceStats(0),
+        mMeanTimeToLive(0),
         mTimeController(0),
         mEmittedEmitterPoolInitialised(false),
         mIsEmitting(true),
@@ -384,8 +405,18 @@ namespace Ogre {
             }
         }
 
+        ParticleSystemManager& psm = ParticleSystemManager::getSingleton();
+        Timer* timer = psm.getUpdateTimeBudget() > 0 ? Root::getSingleton().getTimer() : 0;
+        unsigned long startTime = timer ? timer->getMicroseconds() : 0;
+
+        // Move the detail towards its target over about half a second, so
+        // that budget or distance changes don't cause visible popping
+        Real targetLod = mDistanceLodFactor * psm.getBudgetFactor();
+        mLodFactor += (targetLod - mLodFactor) * std::min(Real(1.0f), timeElapsed * 2.0f);
+
         // Scale incoming speed for the rest of the calculation
         timeElapsed *= mSpeedFactor;
+        mTimeSinceStats += timeElapsed;
 
         // Init renderer if not done already
         configureRenderer();
@@ -395,6 +426,12 @@ namespace Ogre {
 
         Real iterationInterval = mIterationIntervalSet ? 
             mIterationInterval : msDefaultIterationInterval;
+        Real maxLodInterval = psm.getMaxLodIterationInterval();
+        if (mLodFactor < 1.0f && maxLodInterval > iterationInterval)
+        {
+            // Lower detail systems update less often
+            iterationInterval = Math::lerp(maxLodInterval, iterationInterval, mLodFactor);
+        }
         if (iterationInterval > 0)
         {
             mUpdateRemainTime += timeElapsed;
@@ -433,6 +470,26 @@ namespace Ogre {
             mBoundsUpdateTime -= timeElapsed; // count down 
         _updateBounds();
 
+        // Report once per frame, fastForward may update many times in a row
+        unsigned long frame = Root::getSingleton().getNextFrameNumber();
+        if (frame != mLastStatsFrame)
+        {
+            Real elapsedMs = timer ? (timer->getMicroseconds() - startTime) / 1000.0f : 0;
+            Real budgetFactor = mDistanceLodFactor > 0 ? mLodFactor / mDistanceLodFactor : 1.0f;
+
+            // The particles alive were emitted at older factors, so estimate the
+            // steady state count from the unscaled emission rate and lifetime instead
+            Real demand = 0;
+            if (mTimeSinceStats > 0)
+            {
+                demand = mRequestedSinceStats / mTimeSinceStats * mMeanTimeToLive;
+                demand = std::min(demand, Real(mPoolSize)) * mDistanceLodFactor;
+            }
+            psm._notifyParticleSystemUpdated(demand, elapsedMs, budgetFactor);
+            mLastStatsFrame = frame;
+            mRequestedSinceStats = 0;
+            mTimeSinceStats = 0;
+        }
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::_expire(Real timeElapsed)
@@ -503,6 +560,15 @@ namespace Ogre {
         emissionAllowed = mFreeParticles.size();
         totalRequested = 0;
 
+        if (mLodFactor < 1.0f)
+        {
+            // Lower detail shrinks the effective quota, existing particles are
+            // left to expire rather than being removed
+            size_t lodQuota = static_cast<size_t>(mPoolSize * mLodFactor);
+            size_t numActive = mActiveParticles.size();
+            emissionAllowed = std::min(emissionAllowed, lodQuota > numActive ? lodQuota - numActive : 0);
+        }
+
         // Count up total requested emissions for regular emitters (and exclude the ones that are used as
         // a template for emitted emitters)
         for (itEmit = mEmitters.begin(), i = 0; itEmit != iEmitEnd; ++itEmit, ++i)
@@ -510,6 +576,9 @@ namespace Ogre {
             if (!(*itEmit)->isEmitted())
             {
                 requested[i] = (*itEmit)->_getEmissionCount(timeElapsed);
+                mRequestedSinceStats += requested[i];
+                if (mLodFactor < 1.0f)
+                    requested[i] = scaleEmission(requested[i], mLodFactor);
                 totalRequested += requested[i];
             }
         }
@@ -518,6 +587,9 @@ namespace Ogre {
         for (itActiveEmit = mActiveEmittedEmitters.begin(), i=0; itActiveEmit != itActiveEnd; ++itActiveEmit, ++i)
         {
             emittedRequested[i] = (*itActiveEmit)->_getEmissionCount(timeElapsed);
+            mRequestedSinceStats += emittedRequested[i];
+            if (mLodFactor < 1.0f)
+                emittedRequested[i] = scaleEmission(emittedRequested[i], mLodFactor);
             totalRequested += emittedRequested[i];
         }
 
@@ -582,6 +654,8 @@ namespace Ogre {
                 return;
 
             emitter->_initParticle(p);
+            mMeanTimeToLive = mMeanTimeToLive > 0 ?
+                Math::lerp(mMeanTimeToLive, p->mTotalTimeToLive, Real(0.01f)) : p->mTotalTimeToLive;
 
             // Translate position & direction into world space
             if (!mLocalSpace)
@@ -972,7 +1046,14 @@ namespace Ogre {
         // Record visible
         if (isVisible())
         {           
-            mLastVisibleFrame = Root::getSingleton().getNextFrameNumber();
+            // Detail follows the closest camera rendering this system in the frame
+            unsigned long frame = Root::getSingleton().getNextFrameNumber();
+            Real distance = cam->getDerivedPosition().distance(mParentNode->_getDerivedPosition());
+            Real lodFactor = ParticleSystemManager::getSingleton()._getLodFactor(distance);
+            mDistanceLodFactor =
+                mLastVisibleFrame == frame ? std::max(mDistanceLodFactor, lodFactor) : lodFactor;
+
+            mLastVisibleFrame = frame;
             mTimeSinceLastVisible = 0.0f;
 
             if (mSorted)
@@ -37,6 +37,7 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     // Shortcut to set up billboard particle renderer
     BillboardParticleRendererFactory* mBillboardRendererFactory = 0;
+    InstancedBillboardParticleRendererFactory* mInstancedBillboardRendererFactory = 0;
     //-----------------------------------------------------------------------
     template<> ParticleSystemManager* Singleton<ParticleSystemManager>::msSingleton = 0;
     ParticleSystemManager* ParticleSystemManager::getSingletonPtr(void)
@@ -49,6 +50,16 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     ParticleSystemManager::ParticleSystemManager()
+        : mParticleBudget(0),
+          mUpdateTimeBudget(0),
+          mLodStartDistance(0),
+          mLodEndDistance(0),
+          mMinimumLodFactor(0.25f),
+          mMaxLodIterationInterval(0),
+          mBudgetFactor(1.0f),
+          mStatsFrame(0),
+          mFrameParticleDemand(0),
+          mFrameUpdateDemand(0)
     {
         OGRE_LOCK_AUTO_MUTEX;
         mFactory = OGRE_NEW ParticleSystemFactory();
@@ -73,6 +84,11 @@ namespace Ogre {
             OGRE_DELETE mBillboardRendererFactory;
             mBillboardRendererFactory = 0;
         }
+        if (mInstancedBillboardRendererFactory)
+        {
+            OGRE_DELETE mInstancedBillboardRendererFactory;
+            mInstancedBillboardRendererFactory = 0;
+        }
 
         if (mFactory)
         {
@@ -359,7 +375,73 @@ namespace Ogre {
         // Create Billboard renderer factory
         mBillboardRendererFactory = OGRE_NEW BillboardParticleRendererFactory();
         addRendererFactory(mBillboardRendererFactory);
+        // And its GPU expanded variant
+        mInstancedBillboardRendererFactory = OGRE_NEW InstancedBillboardParticleRendererFactory();
+        addRendererFactory(mInstancedBillboardRendererFactory);
+
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystemManager::setLodDistances(Real startDistance, Real endDistance)
+    {
+        mLodStartDistance = startDistance;
+        mLodEndDistance = std::max(startDistance, endDistance);
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystemManager::setMinimumLodFactor(Real factor)
+    {
+        mMinimumLodFactor = Math::saturate(factor);
+    }
+    //-----------------------------------------------------------------------
+    Real ParticleSystemManager::_getLodFactor(Real distance) const
+    {
+        Real factor = 1.0f;
+        if (mLodEndDistance > 0 && distance > mLodStartDistance)
+        {
+            if (distance >= mLodEndDistance)
+            {
+                factor = mMinimumLodFactor;
+            }
+            else
+            {
+                Real t = (distance - mLodStartDistance) / (mLodEndDistance - mLodStartDistance);
+                factor = Math::lerp(Real(1.0f), mMinimumLodFactor, t);
+            }
+        }
+        return factor;
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystemManager::_notifyParticleSystemUpdated(Real particleDemand, Real milliseconds,
+                                                             Real budgetFactor)
+    {
+        // Systems are updated before the frame is rendered, so a change of frame
+        // number means the previous frame's statistics are complete
+        unsigned long frame = Root::getSingleton().getNextFrameNumber();
+        if (frame != mStatsFrame)
+        {
+            updateBudgetFactor();
+            mStatsFrame = frame;
+            mFrameParticleDemand = 0;
+            mFrameUpdateDemand = 0;
+        }
 
+        // Emission and effective quota scale with the factor, so does the load
+        budgetFactor = std::max(budgetFactor, Real(0.01f));
+        mFrameParticleDemand += particleDemand;
+        mFrameUpdateDemand += milliseconds / budgetFactor;
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystemManager::updateBudgetFactor(void)
+    {
+        // The factor that would have kept the last frame within the budgets
+        Real target = 1.0f;
+        if (mParticleBudget && mFrameParticleDemand > 0)
+            target = std::min(target, mParticleBudget / mFrameParticleDemand);
+        if (mUpdateTimeBudget > 0 && mFrameUpdateDemand > 0)
+            target = std::min(target, mUpdateTimeBudget / mFrameUpdateDemand);
+
+        // The update time is measured on particles emitted at older factors, so
+        // its estimate lags behind. Move towards the target gradually to not overshoot.
+        mBudgetFactor = Math::lerp(mBudgetFactor, target, Real(0.1f));
     }
     //-----------------------------------------------------------------------
     ParticleSystemManager::ParticleAffectorFactoryIterator 
@@ -45,6 +45,19 @@ namespace Ogre
             Real getValue(void) const { return 0; }// not a source 
             void setValue(Real value) { mTrail->_timeUpdate(value); }
         };
+
+        /// Fades a contiguous run of chain elements
+        void fadeElements(BillboardChain::Element* elems, size_t count,
+            Real widthDelta, const ColourValue& colourDelta)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                BillboardChain::Element& elem = elems[i];
+                elem.width = std::max(Real(0.0f), elem.width - widthDelta);
+                elem.colour -= colourDelta;
+                elem.colour.saturate();
+            }
+        }
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
@@ -443,25 +456,31 @@ namespace Ogre
         for (size_t s = 0; s < mChainSegmentList.size(); ++s)
         {
             ChainSegment& seg = mChainSegmentList[s];
-            if (seg.head != SEGMENT_EMPTY && seg.head != seg.tail)
+            if (seg.head == SEGMENT_EMPTY || seg.head == seg.tail)
+                continue;
+
+            Real widthDelta = time * mDeltaWidth[s];
+            ColourValue colourDelta = mDeltaColour[s] * time;
+            // Nothing fades, leave the chain's vertices alone
+            if (widthDelta == 0 && colourDelta == ColourValue::ZERO)
+                continue;
+
+            // Every element but the head fades. In the ring buffer they form
+            // one contiguous run, or two when they wrap around the end.
+            Element* elems = &mChainElementList[seg.start];
+            size_t first = (seg.head + 1) % mMaxElementsPerChain;
+            if (first <= seg.tail)
             {
-                
-                for(size_t e = seg.head + 1;; ++e) // until break
-                {
-                    e = e % mMaxElementsPerChain;
-
-                    Element& elem = mChainElementList[seg.start + e];
-                    elem.width = elem.width - (time * mDeltaWidth[s]);
-                    elem.width = std::max(Real(0.0f), elem.width);
-                    elem.colour = elem.colour - (mDeltaColour[s] * time);
-                    elem.colour.saturate();
-
-                    if (e == seg.tail)
-                        break;
-                }
+                fadeElements(elems + first, seg.tail - first + 1, widthDelta, colourDelta);
+            }
+            else
+            {
+                fadeElements(elems + first, mMaxElementsPerChain - first, widthDelta, colourDelta);
+                fadeElements(elems, seg.tail + 1, widthDelta, colourDelta);
             }
+
+            _markChainDirty(s);
         }
-        mVertexContentDirty = true;
     }
     //-----------------------------------------------------------------------
     void RibbonTrail::resetTrail(size_t index, const Node* node)
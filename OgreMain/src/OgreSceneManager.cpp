@@ -46,6 +46,7 @@ THE SOFTWARE.
 #include "OgreRenderTexture.h"
 #include "OgreLodListener.h"
 #include "OgreUnifiedHighLevelGpuProgram.h"
+#include "OgreLightClusters.h"
 
 // This class implements the most basic scene manager
 
@@ -81,10 +82,16 @@ mResetIdentityProj(false),
 mNormaliseNormalsOnScale(true),
 mFlipCullingOnNegativeScale(true),
 mLightsDirtyCounter(0),
+mLightGridThreshold(16),
 mMovableNameGenerator("Ogre/MO"),
 mShadowRenderer(this),
 mDisplayNodes(false),
 mShowBoundingBoxes(false),
+mAutoInstancing(false),
+mAutoInstancingDeclaration(0),
+mAutoInstancingRun(false),
+mAutoInstancingRunScaled(false),
+mAutoInstancingRunNegativeScale(false),
 mActiveCompositorChain(0),
 mLateMaterialResolving(false),
 mIlluminationStage(IRS_NONE),
@@ -103,6 +110,9 @@ mGpuParamsDirty((uint16)GPV_ALL)
 {
     mShadowCasterQueryListener.reset(new ShadowCasterSceneQueryListener(this));
 
+    mLightGrid.stamp = 0;
+    mLightGrid.dirtyCounter = std::numeric_limits<ulong>::max();
+
     Root *root = Root::getSingletonPtr();
     if (root)
         _setDestinationRenderSystem(root->getRenderSystem());
@@ -115,7 +125,6 @@ mGpuParamsDirty((uint16)GPV_ALL)
 
     // create the auto param data source instance
     mAutoParamDataSource.reset(createAutoParamDataSource());
-
 }
 //-----------------------------------------------------------------------
 SceneManager::~SceneManager()
@@ -135,6 +144,11 @@ SceneManager::~SceneManager()
         }
         mMovableObjectCollectionMap.clear();
     }
+
+    mAutoInstancingBuffer.reset();
+    mAutoInstancingIdentityBuffer.reset();
+    if (mAutoInstancingDeclaration && HardwareBufferManager::getSingletonPtr())
+        HardwareBufferManager::getSingleton().destroyVertexDeclaration(mAutoInstancingDeclaration);
 }
 //-----------------------------------------------------------------------
 RenderQueue* SceneManager::getRenderQueue(void)
@@ -350,41 +364,229 @@ bool SceneManager::lightLess::operator()(const Light* a, const Light* b) const
     return a->tempSquareDist < b->tempSquareDist;
 }
 //-----------------------------------------------------------------------
+void SceneManager::buildLightGrid(void)
+{
+    // Lights overlapping more cells are tested by every query instead
+    static const size_t MAX_CELLS_PER_LIGHT = 64;
+    static const int MAX_DIMS = 64;
+
+    LightGrid& grid = mLightGrid;
+    const LightList& lights = mLightsAffectingFrustum;
+
+    grid.dirtyCounter = mLightsDirtyCounter;
+    grid.cellStart.clear();
+    grid.lightIndices.clear();
+    grid.globalLights.clear();
+    grid.stamps.assign(lights.size(), 0);
+    grid.stamp = 0;
+
+    AxisAlignedBox bounds;
+    std::vector<Real> diameters;
+    diameters.reserve(lights.size());
+    for (size_t i = 0; i < lights.size(); ++i)
+    {
+        Light* lt = lights[i];
+        if (lt->getType() == Light::LT_DIRECTIONAL)
+            continue;
+
+        Real range = lt->getAttenuationRange();
+        Vector3 pos = lt->getDerivedPosition();
+        bounds.merge(AxisAlignedBox(pos - range, pos + range));
+        diameters.push_back(range * 2);
+    }
+
+    if (diameters.empty() || !bounds.isFinite())
+    {
+        // nothing to index, test every light
+        for (uint32 i = 0; i < lights.size(); ++i)
+            grid.globalLights.push_back(i);
+        grid.cellStart.assign(2, 0);
+        grid.origin = Vector3::ZERO;
+        grid.invCellSize = Vector3::ZERO;
+        grid.dims[0] = grid.dims[1] = grid.dims[2] = 1;
+        return;
+    }
+
+    // Cells about the size of a typical light, but not many more cells than lights
+    std::nth_element(diameters.begin(), diameters.begin() + diameters.size() / 2, diameters.end());
+    Vector3 extent = bounds.getSize();
+    Real volume = std::max(extent.x, Real(1e-3)) * std::max(extent.y, Real(1e-3)) *
+        std::max(extent.z, Real(1e-3));
+    Real cellSize = std::max(diameters[diameters.size() / 2],
+                             Math::Pow(volume / (diameters.size() * 4), Real(1) / 3));
+    cellSize = std::max(cellSize, Real(1e-3));
+
+    size_t numCells = 1;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        grid.dims[axis] = Math::Clamp((int)Math::Ceil(extent[axis] / cellSize), 1, MAX_DIMS);
+        grid.invCellSize[axis] = grid.dims[axis] / std::max(extent[axis], Real(1e-3));
+        numCells *= grid.dims[axis];
+    }
+    grid.origin = bounds.getMinimum();
+
+    // Counting sort of the light indices by cell
+    grid.cellStart.assign(numCells + 1, 0);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (uint32 i = 0; i < lights.size(); ++i)
+        {
+            Light* lt = lights[i];
+            if (lt->getType() == Light::LT_DIRECTIONAL)
+            {
+                if (pass == 0)
+                    grid.globalLights.push_back(i);
+                continue;
+            }
+
+            Real range = lt->getAttenuationRange();
+            Vector3 pos = lt->getDerivedPosition();
+            int lo[3], hi[3];
+            size_t count = 1;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                lo[axis] = Math::Clamp(
+                    (int)((pos[axis] - range - grid.origin[axis]) * grid.invCellSize[axis]), 0,
+                    grid.dims[axis] - 1);
+                hi[axis] = Math::Clamp(
+                    (int)((pos[axis] + range - grid.origin[axis]) * grid.invCellSize[axis]), 0,
+                    grid.dims[axis] - 1);
+                count *= hi[axis] - lo[axis] + 1;
+            }
+
+            if (count > MAX_CELLS_PER_LIGHT)
+            {
+                if (pass == 0)
+                    grid.globalLights.push_back(i);
+                continue;
+            }
+
+            for (int z = lo[2]; z <= hi[2]; ++z)
+                for (int y = lo[1]; y <= hi[1]; ++y)
+                    for (int x = lo[0]; x <= hi[0]; ++x)
+                    {
+                        size_t cell = (z * grid.dims[1] + y) * grid.dims[0] + x;
+                        if (pass == 0)
+                            ++grid.cellStart[cell + 1];
+                        else
+                            grid.lightIndices[grid.cellStart[cell]++] = i;
+                    }
+        }
+
+        if (pass == 0)
+        {
+            for (size_t c = 0; c < numCells; ++c)
+                grid.cellStart[c + 1] += grid.cellStart[c];
+            grid.lightIndices.resize(grid.cellStart[numCells]);
+        }
+        else
+        {
+            // filling advanced each start to the next cell, shift them back
+            for (size_t c = numCells; c > 0; --c)
+                grid.cellStart[c] = grid.cellStart[c - 1];
+            grid.cellStart[0] = 0;
+        }
+    }
+}
+//-----------------------------------------------------------------------
 void SceneManager::_populateLightList(const Vector3& position, Real radius, 
                                       LightList& destList, uint32 lightMask)
 {
-    // Really basic trawl of the lights, then sort
-    // Subclasses could do something smarter
-
     // Pick up the lights that affecting frustum only, which should has been
     // cached, so better than take all lights in the scene into account.
     const LightList& candidateLights = _getLightsAffectingFrustum();
 
-    // Pre-allocate memory
     destList.clear();
-    destList.reserve(candidateLights.size());
 
-    LightList::const_iterator it;
-    for (it = candidateLights.begin(); it != candidateLights.end(); ++it)
+    if (mLightGridThreshold == 0 || candidateLights.size() < mLightGridThreshold)
+    {
+        // Few lights, test all of them
+        destList.reserve(candidateLights.size());
+
+        LightList::const_iterator it;
+        for (it = candidateLights.begin(); it != candidateLights.end(); ++it)
+        {
+            Light* lt = *it;
+            // check whether or not this light is suppose to be taken into consideration for the current light mask set for this operation
+            if(!(lt->getLightMask() & lightMask))
+                continue; //skip this light
+
+            // Calc squared distance
+            lt->_calcTempSquareDist(position);
+
+            if (lt->getType() == Light::LT_DIRECTIONAL)
+            {
+                // Always included
+                destList.push_back(lt);
+            }
+            else
+            {
+                // only add in-range lights
+                if (lt->isInLightRange(Sphere(position,radius)))
+                {
+                    destList.push_back(lt);
+                }
+            }
+        }
+    }
+    else
     {
-        Light* lt = *it;
-        // check whether or not this light is suppose to be taken into consideration for the current light mask set for this operation
-        if(!(lt->getLightMask() & lightMask))
-            continue; //skip this light
+        if (mLightGrid.dirtyCounter != mLightsDirtyCounter)
+            buildLightGrid();
 
-        // Calc squared distance
-        lt->_calcTempSquareDist(position);
+        LightGrid& grid = mLightGrid;
+        if (++grid.stamp == 0)
+        {
+            std::fill(grid.stamps.begin(), grid.stamps.end(), 0);
+            grid.stamp = 1;
+        }
 
-        if (lt->getType() == Light::LT_DIRECTIONAL)
+        grid.candidates = grid.globalLights;
+
+        int lo[3], hi[3];
+        bool overlaps = true;
+        for (int axis = 0; axis < 3 && overlaps; ++axis)
         {
-            // Always included
-            destList.push_back(lt);
+            Real minCell = (position[axis] - radius - grid.origin[axis]) * grid.invCellSize[axis];
+            Real maxCell = (position[axis] + radius - grid.origin[axis]) * grid.invCellSize[axis];
+            overlaps = maxCell >= 0 && minCell < grid.dims[axis];
+            lo[axis] = (int)std::max(minCell, Real(0));
+            hi[axis] = (int)std::min(maxCell, Real(grid.dims[axis] - 1));
         }
-        else
+
+        if (overlaps && !grid.lightIndices.empty())
+        {
+            for (int z = lo[2]; z <= hi[2]; ++z)
+                for (int y = lo[1]; y <= hi[1]; ++y)
+                    for (int x = lo[0]; x <= hi[0]; ++x)
+                    {
+                        size_t cell = (z * grid.dims[1] + y) * grid.dims[0] + x;
+                        for (uint32 l = grid.cellStart[cell]; l < grid.cellStart[cell + 1]; ++l)
+                        {
+                            uint32 i = grid.lightIndices[l];
+                            if (grid.stamps[i] != grid.stamp)
+                            {
+                                grid.stamps[i] = grid.stamp;
+                                grid.candidates.push_back(i);
+                            }
+                        }
+                    }
+        }
+
+        // Keep the frustum list order, the sorting below relies on it
+        std::sort(grid.candidates.begin(), grid.candidates.end());
+        destList.reserve(grid.candidates.size());
+
+        Sphere sphere(position, radius);
+        for (size_t c = 0; c < grid.candidates.size(); ++c)
         {
-            // only add in-range lights
-            if (lt->isInLightRange(Sphere(position,radius)))
+            Light* lt = candidateLights[grid.candidates[c]];
+            if(!(lt->getLightMask() & lightMask))
+                continue;
+
+            if (lt->getType() == Light::LT_DIRECTIONAL || lt->isInLightRange(sphere))
             {
+                lt->_calcTempSquareDist(position);
                 destList.push_back(lt);
             }
         }
@@ -1067,7 +1269,14 @@ const Pass* SceneManager::_setPass(const Pass* pass, bool evenIfSuppressed,
     // The rest of the settings are the same no matter whether we use programs or not
 
     // Set scene blending
-    if ( pass->hasSeparateSceneBlending( ) )
+    if (mIlluminationStage == IRS_RENDER_TO_TEXTURE &&
+        mShadowRenderer.mCasterFilter == ShadowRenderer::CF_DYNAMIC)
+    {
+        // Dynamic casters over a cached shadow texture, keep the nearest or darkest value.
+        // renderCachedShadowTexture only caches formats where this holds per texel.
+        mDestRenderSystem->_setSceneBlending(SBF_ONE, SBF_ONE, SBO_MIN);
+    }
+    else if ( pass->hasSeparateSceneBlending( ) )
     {
         mDestRenderSystem->_setSeparateSceneBlending(
             pass->getSourceBlendFactor(), pass->getDestBlendFactor(),
@@ -1386,6 +1595,12 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
             // Locate any lights which could be affecting the frustum
             findLightsAffectingFrustum(camera);
 
+            if (mLightClusters)
+            {
+                mLightClusters->build(camera, mLightsAffectingFrustum);
+                mLightClusters->upload();
+            }
+
             // Are we using any shadows at all?
             if (isShadowTechniqueInUse() && vp->getShadowsEnabled())
             {
@@ -1466,8 +1681,13 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
 
             // Parse the scene and tag visibles
             firePreFindVisibleObjects(vp);
-            _findVisibleObjects(camera, &(camVisObjIt->second),
-                mIlluminationStage == IRS_RENDER_TO_TEXTURE? true : false);
+            // Shadow cameras may have been culled together in prepareShadowTextures
+            if (mIlluminationStage != IRS_RENDER_TO_TEXTURE ||
+                !mShadowRenderer.queueCulledShadowCasters(camera, &(camVisObjIt->second)))
+            {
+                _findVisibleObjects(camera, &(camVisObjIt->second),
+                    mIlluminationStage == IRS_RENDER_TO_TEXTURE? true : false);
+            }
             firePostFindVisibleObjects(vp);
 
             mAutoParamDataSource->setMainCamBoundsInfo(&(camVisObjIt->second));
@@ -1865,6 +2085,12 @@ void SceneManager::SceneMgrQueuedRenderableVisitor::visit(const Pass* p, Rendera
     // Set pass, store the actual one used
     mUsedPass = targetSceneMgr->_setPass(p);
 
+    if (targetSceneMgr->isAutoInstancingEnabled())
+    {
+        targetSceneMgr->renderAutoInstancedObjects(rs, mUsedPass, scissoring, autoLights, manualLightList);
+        return;
+    }
+
     for (Renderable* r : rs)
     {
         // Give SM a chance to eliminate
@@ -1876,6 +2102,216 @@ void SceneManager::SceneMgrQueuedRenderableVisitor::visit(const Pass* p, Rendera
     }
 }
 //-----------------------------------------------------------------------
+bool SceneManager::AutoInstancingEntry::operator<(const AutoInstancingEntry& rhs) const
+{
+    if (op.vertexData != rhs.op.vertexData)
+        return op.vertexData < rhs.op.vertexData;
+    if (op.indexData != rhs.op.indexData)
+        return op.indexData < rhs.op.indexData;
+    if (op.operationType != rhs.op.operationType)
+        return op.operationType < rhs.op.operationType;
+    return negativeScale < rhs.negativeScale;
+}
+//-----------------------------------------------------------------------
+bool SceneManager::AutoInstancingEntry::sharesRun(const AutoInstancingEntry& rhs) const
+{
+    return op.vertexData == rhs.op.vertexData && op.indexData == rhs.op.indexData &&
+           op.operationType == rhs.op.operationType && negativeScale == rhs.negativeScale;
+}
+//-----------------------------------------------------------------------
+bool SceneManager::AutoInstancingEntry::canInstance() const
+{
+    return op.vertexData && op.numberOfInstances == 1 && op.useGlobalInstancingVertexBufferIsAvailable &&
+           !op.vertexData->vertexBufferBinding->hasInstanceData() && rend->getNumWorldTransforms() == 1;
+}
+//-----------------------------------------------------------------------
+void SceneManager::renderAutoInstancedObjects(const RenderableList& rs, const Pass* pass,
+                                              bool lightScissoringClipping, bool doLightIteration,
+                                              const LightList* manualLightList)
+{
+    const GpuProgram* vprog = pass->hasVertexProgram() ? pass->getVertexProgram().get() : 0;
+
+    if (!vprog || !vprog->isInstancingIncluded() || mDestRenderSystem->getGlobalInstanceVertexBuffer() ||
+        !mDestRenderSystem->getCapabilities()->hasCapability(RSC_VERTEX_BUFFER_INSTANCE_DATA))
+    {
+        for (Renderable* r : rs)
+        {
+            if (validateRenderableForRendering(pass, r))
+                renderSingleObject(r, pass, lightScissoringClipping, doLightIteration, manualLightList);
+        }
+        return;
+    }
+
+    // Gather the render operations and sort them, so renderables sharing geometry form runs
+    mAutoInstancingEntries.clear();
+    for (Renderable* r : rs)
+    {
+        if (!validateRenderableForRendering(pass, r))
+            continue;
+
+        AutoInstancingEntry entry;
+        entry.rend = r;
+        r->getRenderOperation(entry.op);
+        entry.negativeScale = false;
+        if (entry.canInstance())
+        {
+            r->getWorldTransforms(&entry.xform);
+            entry.negativeScale = entry.xform.linear().hasNegativeScale();
+        }
+        mAutoInstancingEntries.push_back(entry);
+    }
+    std::stable_sort(mAutoInstancingEntries.begin(), mAutoInstancingEntries.end());
+
+    // Geometry using the texture coordinate sets of the matrix rows can't be instanced
+    const unsigned short texCoord = OGRE_MAX_TEXTURE_COORD_SETS - 3;
+
+    const size_t numEntries = mAutoInstancingEntries.size();
+    size_t runStart = 0;
+    while (runStart < numEntries)
+    {
+        const AutoInstancingEntry& first = mAutoInstancingEntries[runStart];
+        if (!first.canInstance() ||
+            first.op.vertexData->vertexDeclaration->getNextFreeTextureCoordinate() > texCoord)
+        {
+            renderSingleObject(first.rend, pass, lightScissoringClipping, doLightIteration, manualLightList);
+            ++runStart;
+            continue;
+        }
+
+        // Extend the run while geometry, mirroring (and lights, if the renderables pick their own) match
+        size_t runEnd = runStart + 1;
+        while (runEnd < numEntries)
+        {
+            const AutoInstancingEntry& entry = mAutoInstancingEntries[runEnd];
+            if (!entry.canInstance() || !entry.sharesRun(first) ||
+                (doLightIteration && entry.rend->getLights().getHash() != first.rend->getLights().getHash()))
+            {
+                break;
+            }
+            ++runEnd;
+        }
+
+        // Each renderable gets its preRender call, as in _issueRenderOp, and drops out of the run
+        // if it declines. The last one left is drawn for all, the listeners hear of the others first.
+        size_t numInstances = 0;
+        bool scaled = false;
+        for (size_t i = runStart; i < runEnd; ++i)
+        {
+            AutoInstancingEntry& entry = mAutoInstancingEntries[i];
+            if (!entry.rend->preRender(this, mDestRenderSystem))
+            {
+                entry.rend->postRender(this, mDestRenderSystem);
+                continue;
+            }
+            scaled |= entry.xform.linear().hasScale();
+            std::swap(mAutoInstancingEntries[runStart + numInstances++], entry);
+        }
+
+        if (numInstances)
+        {
+            if (!mAutoInstancingBuffer || mAutoInstancingBuffer->getNumVertices() < numInstances)
+            {
+                mAutoInstancingBuffer = HardwareBufferManager::getSingleton().createVertexBuffer(
+                    sizeof(float) * 12, std::max<size_t>(Bitwise::firstPO2From(uint32(numInstances)), 64),
+                    HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+                mAutoInstancingBuffer->setIsInstanceData(true);
+                mAutoInstancingBuffer->setInstanceDataStepRate(1);
+            }
+
+            {
+                HardwareVertexBufferLockGuard instanceLock(mAutoInstancingBuffer, 0,
+                                                           numInstances * sizeof(float) * 12,
+                                                           HardwareBuffer::HBL_DISCARD);
+                float* pDest = static_cast<float*>(instanceLock.pData);
+                for (size_t i = runStart; i < runStart + numInstances; ++i)
+                {
+                    Matrix4 xform = mAutoInstancingEntries[i].xform;
+                    if (mCameraRelativeRendering)
+                        xform.setTrans(xform.getTrans() - mCameraRelativePosition);
+
+                    for (int row = 0; row < 3; ++row)
+                    {
+                        for (int col = 0; col < 4; ++col)
+                            *pDest++ = static_cast<float>(xform[row][col]);
+                    }
+                }
+            }
+
+            const size_t drawn = runStart + numInstances - 1;
+            for (size_t i = runStart; i < drawn; ++i)
+            {
+                Renderable* rend = mAutoInstancingEntries[i].rend;
+                mAutoParamDataSource->setCurrentRenderable(rend);
+                fireRenderSingleObject(rend, pass, mAutoParamDataSource.get(),
+                                       doLightIteration ? &rend->getLights() : manualLightList,
+                                       mSuppressRenderStateChanges);
+            }
+
+            // Issue the last renderable once, for all instances
+            mDestRenderSystem->setGlobalInstanceVertexBuffer(mAutoInstancingBuffer);
+            mDestRenderSystem->setGlobalInstanceVertexBufferVertexDeclaration(getAutoInstancingDeclaration());
+            mDestRenderSystem->setGlobalNumberOfInstances(numInstances);
+
+            mAutoInstancingRun = true;
+            mAutoInstancingRunScaled = scaled;
+            mAutoInstancingRunNegativeScale = first.negativeScale;
+            renderSingleObject(mAutoInstancingEntries[drawn].rend, pass, lightScissoringClipping,
+                               doLightIteration, manualLightList);
+            mAutoInstancingRun = false;
+
+            mDestRenderSystem->setGlobalInstanceVertexBuffer(HardwareVertexBufferSharedPtr());
+            mDestRenderSystem->setGlobalInstanceVertexBufferVertexDeclaration(NULL);
+            mDestRenderSystem->setGlobalNumberOfInstances(1);
+
+            for (size_t i = runStart; i <= drawn; ++i)
+                mAutoInstancingEntries[i].rend->postRender(this, mDestRenderSystem);
+        }
+
+        runStart = runEnd;
+    }
+}
+//-----------------------------------------------------------------------
+VertexDeclaration* SceneManager::getAutoInstancingDeclaration()
+{
+    if (!mAutoInstancingDeclaration)
+    {
+        // The matrix rows go into the last 3 texture coordinate sets, where generated shaders expect them
+        const unsigned short texCoord = OGRE_MAX_TEXTURE_COORD_SETS - 3;
+        mAutoInstancingDeclaration = HardwareBufferManager::getSingleton().createVertexDeclaration();
+        for (unsigned short i = 0; i < 3; ++i)
+            mAutoInstancingDeclaration->addElement(0, i * sizeof(float) * 4, VET_FLOAT4,
+                                                   VES_TEXTURE_COORDINATES, texCoord + i);
+    }
+    return mAutoInstancingDeclaration;
+}
+//-----------------------------------------------------------------------
+bool SceneManager::bindAutoInstancingIdentity(const Pass* pass)
+{
+    const GpuProgram* vprog = pass->hasVertexProgram() ? pass->getVertexProgram().get() : 0;
+    if (mAutoInstancingRun || !vprog || !vprog->isInstancingIncluded() ||
+        mDestRenderSystem->getGlobalInstanceVertexBuffer() ||
+        !mDestRenderSystem->getCapabilities()->hasCapability(RSC_VERTEX_BUFFER_INSTANCE_DATA))
+    {
+        return false;
+    }
+
+    if (!mAutoInstancingIdentityBuffer)
+    {
+        mAutoInstancingIdentityBuffer = HardwareBufferManager::getSingleton().createVertexBuffer(
+            sizeof(float) * 12, 1, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        mAutoInstancingIdentityBuffer->setIsInstanceData(true);
+        mAutoInstancingIdentityBuffer->setInstanceDataStepRate(1);
+
+        const float identity[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+        mAutoInstancingIdentityBuffer->writeData(0, sizeof(identity), identity, true);
+    }
+
+    mDestRenderSystem->setGlobalInstanceVertexBuffer(mAutoInstancingIdentityBuffer);
+    mDestRenderSystem->setGlobalInstanceVertexBufferVertexDeclaration(getAutoInstancingDeclaration());
+    mDestRenderSystem->setGlobalNumberOfInstances(1);
+    return true;
+}
+//-----------------------------------------------------------------------
 void SceneManager::SceneMgrQueuedRenderableVisitor::visit(RenderablePass* rp)
 {
     // Skip this one if we're in transparency cast shadows mode & it doesn't
@@ -2033,7 +2469,12 @@ void SceneManager::setWorldTransform(Renderable* rend, bool fixedFunction)
     {
         rend->getWorldTransforms(reinterpret_cast<Matrix4*>(mTempXform));
 
-        if (mCameraRelativeRendering && !rend->getUseIdentityView())
+        if (mAutoInstancingRun)
+        {
+            // the instance matrices already moved the vertices to world space
+            mTempXform[0] = Affine3::IDENTITY;
+        }
+        else if (mCameraRelativeRendering && !rend->getUseIdentityView())
         {
             for (ushort i = 0; i < numMatrices; ++i)
             {
@@ -2101,6 +2542,15 @@ void SceneManager::renderSingleObject(Renderable* rend, const Pass* pass,
                                       bool lightScissoringClipping, bool doLightIteration,
                                       const LightList* manualLightList)
 {
+    // Programs reading the world matrix from the instance data need one even when not instanced
+    if (bindAutoInstancingIdentity(pass))
+    {
+        renderSingleObject(rend, pass, lightScissoringClipping, doLightIteration, manualLightList);
+        mDestRenderSystem->setGlobalInstanceVertexBuffer(HardwareVertexBufferSharedPtr());
+        mDestRenderSystem->setGlobalInstanceVertexBufferVertexDeclaration(NULL);
+        return;
+    }
+
     OgreProfileBeginGPUEvent("Material: " + pass->getParent()->getParent()->getName());
 
     GpuProgram* vprog = pass->hasVertexProgram() ? pass->getVertexProgram().get() : 0;
@@ -2148,8 +2598,9 @@ void SceneManager::renderSingleObject(Renderable* rend, const Pass* pass,
     // Sort out normalisation
     // Assume first world matrix representative - shaders that use multiple
     // matrices should control renormalisation themselves
-    if ((pass->getNormaliseNormals() || mNormaliseNormalsOnScale) &&
-        mTempXform[0].linear().hasScale())
+    // Auto instanced runs have an identity world matrix, their instances tell
+    bool hasScale = mAutoInstancingRun ? mAutoInstancingRunScaled : mTempXform[0].linear().hasScale();
+    if ((pass->getNormaliseNormals() || mNormaliseNormalsOnScale) && hasScale)
         mDestRenderSystem->setNormaliseNormals(true);
     else
         mDestRenderSystem->setNormaliseNormals(false);
@@ -2160,7 +2611,9 @@ void SceneManager::renderSingleObject(Renderable* rend, const Pass* pass,
     {
         CullingMode cullMode = mPassCullingMode;
 
-        if (mTempXform[0].linear().hasNegativeScale())
+        bool negativeScale =
+            mAutoInstancingRun ? mAutoInstancingRunNegativeScale : mTempXform[0].linear().hasNegativeScale();
+        if (negativeScale)
         {
             switch(mPassCullingMode)
             {
@@ -3096,6 +3549,19 @@ void SceneManager::updateRenderQueueGroupSplitOptions(RenderQueueGroup* group,
     }
 
 
+}
+//-----------------------------------------------------------------------
+void SceneManager::setLightClustersEnabled(bool enabled)
+{
+    if (enabled && !mLightClusters)
+    {
+        mLightClusters.reset(OGRE_NEW LightClusters(mName));
+        // Create the textures, so that materials can refer to them right away
+        if (TextureManager::getSingletonPtr())
+            mLightClusters->upload();
+    }
+    else if (!enabled)
+        mLightClusters.reset();
 }
 //-----------------------------------------------------------------------
 void SceneManager::_notifyLightsDirty(void)
@@ -3796,6 +4262,19 @@ void SceneManager::destroyShadowTextures(void)
 {
     mShadowRenderer.destroyShadowTextures();
 }
+void SceneManager::setShadowTextureCaching(bool enabled)
+{
+    mShadowRenderer.mShadowTextureCaching = enabled;
+    if (!enabled)
+        mShadowRenderer.destroyShadowTextureCaches();
+}
+//---------------------------------------------------------------------
+void SceneManager::invalidateShadowTextureCache()
+{
+    for (size_t i = 0; i < mShadowRenderer.mShadowTextureCaches.size(); ++i)
+        mShadowRenderer.mShadowTextureCaches[i].valid = false;
+}
+//---------------------------------------------------------------------
 void SceneManager::prepareShadowTextures(Camera* cam, Viewport* vp, const LightList* lightList)
 {
     mShadowRenderer.prepareShadowTextures(cam, vp, lightList);
@@ -4587,7 +5066,8 @@ void SceneManager::updateGpuProgramParameters(const Pass* pass)
 //---------------------------------------------------------------------
 void SceneManager::_issueRenderOp(Renderable* rend, const Pass* pass)
 {
-    if(rend->preRender(this, mDestRenderSystem))
+    // renderAutoInstancedObjects calls these for all renderables of a run
+    if(mAutoInstancingRun || rend->preRender(this, mDestRenderSystem))
     {
         // Finalise GPU parameter bindings
         if(pass)
@@ -4601,7 +5081,8 @@ void SceneManager::_issueRenderOp(Renderable* rend, const Pass* pass)
         mDestRenderSystem->_render(ro);
     }
 
-    rend->postRender(this, mDestRenderSystem);
+    if(!mAutoInstancingRun)
+        rend->postRender(this, mDestRenderSystem);
 }
 //---------------------------------------------------------------------
 VisibleObjectsBoundsInfo::VisibleObjectsBoundsInfo()
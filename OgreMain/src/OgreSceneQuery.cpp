@@ -27,6 +27,7 @@ THE SOFTWARE.
 */
 #include "OgreStableHeaders.h"
 #include "OgreSceneQuery.h"
+#include "OgreEntity.h"
 
 namespace Ogre {
 
@@ -193,6 +194,7 @@ namespace Ogre {
     RaySceneQuery::RaySceneQuery(SceneManager* mgr) : SceneQuery(mgr)
     {
         mSortByDistance = false;
+        mTriangleAccurate = false;
         mMaxResults = 0;
     }
     //-----------------------------------------------------------------------
@@ -226,6 +228,19 @@ namespace Ogre {
         return mMaxResults;
     }
     //-----------------------------------------------------------------------
+    bool RaySceneQuery::intersectsTriangles(MovableObject* obj, Real& distance)
+    {
+        if (!mTriangleAccurate || obj->getMovableType() != EntityFactory::FACTORY_TYPE_NAME)
+            return true;
+
+        std::pair<bool, Real> result = static_cast<Entity*>(obj)->intersectsTriangles(mRay);
+        if (!result.first)
+            return false;
+
+        distance = result.second;
+        return true;
+    }
+    //-----------------------------------------------------------------------
     RaySceneQueryResult& RaySceneQuery::execute(void)
     {
         // Clear without freeing the vector buffer
@@ -51,273 +51,255 @@ namespace Ogre {
     void ShadowCaster::updateEdgeListLightFacing(EdgeData* edgeData, 
         const Vector4& lightPos)
     {
-        edgeData->updateTriangleLightFacing(lightPos);
+        // Within a batch the light facing is calculated along with the volume
+        ShadowVolumeBatch* batch = ShadowVolumeBatch::getActive();
+        if (batch)
+            batch->_setLightPosition(edgeData, lightPos);
+        else
+            edgeData->updateTriangleLightFacing(lightPos);
     }
     // ------------------------------------------------------------------------
-    void ShadowCaster::generateShadowVolume(EdgeData* edgeData, 
-        const HardwareIndexBufferSharedPtr& indexBuffer, size_t& indexBufferUsedSize, 
-        const Light* light, ShadowRenderableList& shadowRenderables, unsigned long flags)
+    namespace
     {
-        // Edge groups should be 1:1 with shadow renderables
-        assert(edgeData->edgeGroups.size() == shadowRenderables.size());
-
-        Light::LightTypes lightType = light->getType();
-
-        // Whether to use the McGuire method, a triangle fan covering all silhouette
-        // This won't work properly with multiple separate edge groups (should be one fan per group, not implemented)
-        // or when light position is inside light cap bound as extrusion could be in opposite directions
-        // and McGuire cap could intersect near clip plane of camera frustum without being noticed.
-        bool useMcGuire = edgeData->edgeGroups.size() <= 1 && 
-            (lightType == Light::LT_DIRECTIONAL || !getLightCapBounds().contains(light->getDerivedPosition()));
-        EdgeData::EdgeGroupList::const_iterator egi, egiend;
-        ShadowRenderableList::const_iterator si;
-
-        // pre-count the size of index data we need since it makes a big perf difference
-        // to GL in particular if we lock a smaller area of the index buffer
-        size_t preCountIndexes = 0;
-
-        si = shadowRenderables.begin();
-        egiend = edgeData->edgeGroups.end();
-        for (egi = edgeData->edgeGroups.begin(); egi != egiend; ++egi, ++si)
+        /// Counts the indexes generateShadowVolume writes for the given light facings
+        size_t countShadowVolumeIndexes(const EdgeData* edgeData, const char* lightFacings,
+            Light::LightTypes lightType, bool useMcGuire, unsigned long flags)
         {
-            const EdgeData::EdgeGroup& eg = *egi;
-            bool  firstDarkCapTri = true;
+            size_t preCountIndexes = 0;
 
-            EdgeData::EdgeList::const_iterator i, iend;
-            iend = eg.edges.end();
-            for (i = eg.edges.begin(); i != iend; ++i)
+            EdgeData::EdgeGroupList::const_iterator egi, egiend;
+            egiend = edgeData->edgeGroups.end();
+            for (egi = edgeData->edgeGroups.begin(); egi != egiend; ++egi)
             {
-                const EdgeData::Edge& edge = *i;
+                const EdgeData::EdgeGroup& eg = *egi;
+                bool  firstDarkCapTri = true;
 
-                // Silhouette edge, when two tris has opposite light facing, or
-                // degenerate edge where only tri 1 is valid and the tri light facing
-                char lightFacing = edgeData->triangleLightFacings[edge.triIndex[0]];
-                if ((edge.degenerate && lightFacing) ||
-                    (!edge.degenerate && (lightFacing != edgeData->triangleLightFacings[edge.triIndex[1]])))
+                EdgeData::EdgeList::const_iterator i, iend;
+                iend = eg.edges.end();
+                for (i = eg.edges.begin(); i != iend; ++i)
                 {
+                    const EdgeData::Edge& edge = *i;
 
-                    preCountIndexes += 3;
-
-                    // Are we extruding to infinity?
-                    if (!(lightType == Light::LT_DIRECTIONAL &&
-                        flags & SRF_EXTRUDE_TO_INFINITY))
+                    // Silhouette edge, when two tris has opposite light facing, or
+                    // degenerate edge where only tri 1 is valid and the tri light facing
+                    char lightFacing = lightFacings[edge.triIndex[0]];
+                    if ((edge.degenerate && lightFacing) ||
+                        (!edge.degenerate && (lightFacing != lightFacings[edge.triIndex[1]])))
                     {
+
                         preCountIndexes += 3;
-                    }
 
-                    if(useMcGuire)
-                    {
-                        // Do dark cap tri
-                        // Use McGuire et al method, a triangle fan covering all silhouette
-                        // edges and one point (taken from the initial tri)
-                        if (flags & SRF_INCLUDE_DARK_CAP)
+                        // Are we extruding to infinity?
+                        if (!(lightType == Light::LT_DIRECTIONAL &&
+                            flags & SRF_EXTRUDE_TO_INFINITY))
                         {
-                            if (firstDarkCapTri)
-                            {
-                                firstDarkCapTri = false;
-                            }
-                            else
+                            preCountIndexes += 3;
+                        }
+
+                        if(useMcGuire)
+                        {
+                            // Do dark cap tri
+                            // Use McGuire et al method, a triangle fan covering all silhouette
+                            // edges and one point (taken from the initial tri)
+                            if (flags & SRF_INCLUDE_DARK_CAP)
                             {
-                                preCountIndexes += 3;
+                                if (firstDarkCapTri)
+                                {
+                                    firstDarkCapTri = false;
+                                }
+                                else
+                                {
+                                    preCountIndexes += 3;
+                                }
                             }
                         }
                     }
-                }
 
-            }
+                }
 
-            if(useMcGuire)
-            {
-                // Do light cap
-                if (flags & SRF_INCLUDE_LIGHT_CAP) 
+                // Light facing triangles of the group, for the caps
+                size_t facingTris = 0;
+                const char* lfi = lightFacings + eg.triStart;
+                const char* lfiend = lfi + eg.triCount;
+                for ( ; lfi != lfiend; ++lfi)
                 {
-                    // Iterate over the triangles which are using this vertex set
-                    EdgeData::TriangleList::const_iterator ti, tiend;
-                    EdgeData::TriangleLightFacingList::const_iterator lfi;
-                    ti = edgeData->triangles.begin() + eg.triStart;
-                    tiend = ti + eg.triCount;
-                    lfi = edgeData->triangleLightFacings.begin() + eg.triStart;
-                    for ( ; ti != tiend; ++ti, ++lfi)
-                    {
-                        assert(ti->vertexSet == eg.vertexSet);
-                        // Check it's light facing
-                        if (*lfi)
-                        {
-                            preCountIndexes += 3;
-                        }
-                    }
+                    if (*lfi)
+                        ++facingTris;
+                }
 
+                if(useMcGuire)
+                {
+                    // Do light cap
+                    if (flags & SRF_INCLUDE_LIGHT_CAP)
+                        preCountIndexes += facingTris * 3;
                 }
-            }
-            else
-            {
-                // Do both caps
-                int increment = ((flags & SRF_INCLUDE_DARK_CAP) ? 3 : 0) + ((flags & SRF_INCLUDE_LIGHT_CAP) ? 3 : 0);
-                if(increment != 0)
+                else
                 {
-                    // Iterate over the triangles which are using this vertex set
-                    EdgeData::TriangleList::const_iterator ti, tiend;
-                    EdgeData::TriangleLightFacingList::const_iterator lfi;
-                    ti = edgeData->triangles.begin() + eg.triStart;
-                    tiend = ti + eg.triCount;
-                    lfi = edgeData->triangleLightFacings.begin() + eg.triStart;
-                    for ( ; ti != tiend; ++ti, ++lfi)
-                    {
-                        assert(ti->vertexSet == eg.vertexSet);
-                        // Check it's light facing
-                        if (*lfi)
-                            preCountIndexes += increment;
-                    }
+                    // Do both caps
+                    int increment = ((flags & SRF_INCLUDE_DARK_CAP) ? 3 : 0) + ((flags & SRF_INCLUDE_LIGHT_CAP) ? 3 : 0);
+                    preCountIndexes += facingTris * increment;
                 }
             }
-        }
-        // End pre-count
-        
-        //Check if index buffer is to small 
-        if (preCountIndexes > indexBuffer->getNumIndexes())
-        {
-            LogManager::getSingleton().logWarning(
-                "shadow index buffer size to small. Auto increasing buffer size to" +
-                StringConverter::toString(sizeof(unsigned short) * preCountIndexes));
-
-            SceneManager* pManager = Root::getSingleton()._getCurrentSceneManager();
-            if (pManager)
-            {
-                pManager->setShadowIndexBufferSize(preCountIndexes);
-            }
-            
-            //Check that the index buffer size has actually increased
-            if (preCountIndexes > indexBuffer->getNumIndexes())
-            {
-                //increasing index buffer size has failed
-                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
-                    "Lock request out of bounds.",
-                    "ShadowCaster::generateShadowVolume");
-            }
-        }
-        else if(indexBufferUsedSize + preCountIndexes > indexBuffer->getNumIndexes())
-        {
-            indexBufferUsedSize = 0;
+            return preCountIndexes;
         }
 
-        // Lock index buffer for writing, just enough length as we need
-        unsigned short* pIdx = static_cast<unsigned short*>(
-            indexBuffer->lock(sizeof(unsigned short) * indexBufferUsedSize, sizeof(unsigned short) * preCountIndexes,
-            indexBufferUsedSize == 0 ? HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NO_OVERWRITE));
-        size_t numIndices = indexBufferUsedSize;
-        
-        // Iterate over the groups and form renderables for each based on their
-        // lightFacing
-        si = shadowRenderables.begin();
-        egiend = edgeData->edgeGroups.end();
-        for (egi = edgeData->edgeGroups.begin(); egi != egiend; ++egi, ++si)
+        /** Writes the shadow volume indexes at pIdx and points the renderables to them.
+        @param numIndices
+            Position of pIdx in the index buffer
+        @return
+            Position after the written indexes
+        */
+        size_t writeShadowVolumeIndexes(const EdgeData* edgeData, const char* lightFacings,
+            Light::LightTypes lightType, bool useMcGuire, unsigned long flags,
+            const ShadowCaster::ShadowRenderableList& shadowRenderables,
+            unsigned short* pIdx, size_t numIndices)
         {
-            const EdgeData::EdgeGroup& eg = *egi;
-            // Initialise the index start for this shadow renderable
-            IndexData* indexData = (*si)->getRenderOperationForUpdate()->indexData;
-
-            if (indexData->indexBuffer != indexBuffer)
+            // Iterate over the groups and form renderables for each based on their
+            // lightFacing
+            EdgeData::EdgeGroupList::const_iterator egi, egiend;
+            ShadowCaster::ShadowRenderableList::const_iterator si = shadowRenderables.begin();
+            egiend = edgeData->edgeGroups.end();
+            for (egi = edgeData->edgeGroups.begin(); egi != egiend; ++egi, ++si)
             {
-                (*si)->rebindIndexBuffer(indexBuffer);
-                indexData = (*si)->getRenderOperationForUpdate()->indexData;
-            }
+                const EdgeData::EdgeGroup& eg = *egi;
+                // Initialise the index start for this shadow renderable
+                IndexData* indexData = (*si)->getRenderOperationForUpdate()->indexData;
+
+                indexData->indexStart = numIndices;
+                // original number of verts (without extruded copy)
+                size_t originalVertexCount = eg.vertexData->vertexCount;
+                bool  firstDarkCapTri = true;
+                unsigned short darkCapStart = 0;
+
+                EdgeData::EdgeList::const_iterator i, iend;
+                iend = eg.edges.end();
+                for (i = eg.edges.begin(); i != iend; ++i)
+                {
+                    const EdgeData::Edge& edge = *i;
 
-            indexData->indexStart = numIndices;
-            // original number of verts (without extruded copy)
-            size_t originalVertexCount = eg.vertexData->vertexCount;
-            bool  firstDarkCapTri = true;
-            unsigned short darkCapStart = 0;
+                    // Silhouette edge, when two tris has opposite light facing, or
+                    // degenerate edge where only tri 1 is valid and the tri light facing
+                    char lightFacing = lightFacings[edge.triIndex[0]];
+                    if ((edge.degenerate && lightFacing) ||
+                        (!edge.degenerate && (lightFacing != lightFacings[edge.triIndex[1]])))
+                    {
+                        size_t v0 = edge.vertIndex[0];
+                        size_t v1 = edge.vertIndex[1];
+                        if (!lightFacing)
+                        {
+                            // Inverse edge indexes when t1 is light away
+                            std::swap(v0, v1);
+                        }
 
-            EdgeData::EdgeList::const_iterator i, iend;
-            iend = eg.edges.end();
-            for (i = eg.edges.begin(); i != iend; ++i)
-            {
-                const EdgeData::Edge& edge = *i;
+                        /* Note edge(v0, v1) run anticlockwise along the edge from
+                        the light facing tri so to point shadow volume tris outward,
+                        light cap indexes have to be backwards
 
-                // Silhouette edge, when two tris has opposite light facing, or
-                // degenerate edge where only tri 1 is valid and the tri light facing
-                char lightFacing = edgeData->triangleLightFacings[edge.triIndex[0]];
-                if ((edge.degenerate && lightFacing) ||
-                    (!edge.degenerate && (lightFacing != edgeData->triangleLightFacings[edge.triIndex[1]])))
-                {
-                    size_t v0 = edge.vertIndex[0];
-                    size_t v1 = edge.vertIndex[1];
-                    if (!lightFacing)
-                    {
-                        // Inverse edge indexes when t1 is light away
-                        std::swap(v0, v1);
-                    }
+                        We emit 2 tris if light is a point light, 1 if light 
+                        is directional, because directional lights cause all
+                        points to converge to a single point at infinity.
 
-                    /* Note edge(v0, v1) run anticlockwise along the edge from
-                    the light facing tri so to point shadow volume tris outward,
-                    light cap indexes have to be backwards
-
-                    We emit 2 tris if light is a point light, 1 if light 
-                    is directional, because directional lights cause all
-                    points to converge to a single point at infinity.
-
-                    First side tri = near1, near0, far0
-                    Second tri = far0, far1, near1
-
-                    'far' indexes are 'near' index + originalVertexCount
-                    because 'far' verts are in the second half of the 
-                    buffer
-                    */
-                    assert(v1 < 65536 && v0 < 65536 && (v0 + originalVertexCount) < 65536 &&
-                        "Vertex count exceeds 16-bit index limit!");
-                    *pIdx++ = static_cast<unsigned short>(v1);
-                    *pIdx++ = static_cast<unsigned short>(v0);
-                    *pIdx++ = static_cast<unsigned short>(v0 + originalVertexCount);
-                    numIndices += 3;
-
-                    // Are we extruding to infinity?
-                    if (!(lightType == Light::LT_DIRECTIONAL &&
-                        flags & SRF_EXTRUDE_TO_INFINITY))
-                    {
-                        // additional tri to make quad
-                        *pIdx++ = static_cast<unsigned short>(v0 + originalVertexCount);
-                        *pIdx++ = static_cast<unsigned short>(v1 + originalVertexCount);
+                        First side tri = near1, near0, far0
+                        Second tri = far0, far1, near1
+
+                        'far' indexes are 'near' index + originalVertexCount
+                        because 'far' verts are in the second half of the 
+                        buffer
+                        */
+                        assert(v1 < 65536 && v0 < 65536 && (v0 + originalVertexCount) < 65536 &&
+                            "Vertex count exceeds 16-bit index limit!");
                         *pIdx++ = static_cast<unsigned short>(v1);
+                        *pIdx++ = static_cast<unsigned short>(v0);
+                        *pIdx++ = static_cast<unsigned short>(v0 + originalVertexCount);
                         numIndices += 3;
-                    }
 
-                    if(useMcGuire)
-                    {
-                        // Do dark cap tri
-                        // Use McGuire et al method, a triangle fan covering all silhouette
-                        // edges and one point (taken from the initial tri)
-                        if (flags & SRF_INCLUDE_DARK_CAP)
+                        // Are we extruding to infinity?
+                        if (!(lightType == Light::LT_DIRECTIONAL &&
+                            flags & SRF_EXTRUDE_TO_INFINITY))
+                        {
+                            // additional tri to make quad
+                            *pIdx++ = static_cast<unsigned short>(v0 + originalVertexCount);
+                            *pIdx++ = static_cast<unsigned short>(v1 + originalVertexCount);
+                            *pIdx++ = static_cast<unsigned short>(v1);
+                            numIndices += 3;
+                        }
+
+                        if(useMcGuire)
                         {
-                            if (firstDarkCapTri)
+                            // Do dark cap tri
+                            // Use McGuire et al method, a triangle fan covering all silhouette
+                            // edges and one point (taken from the initial tri)
+                            if (flags & SRF_INCLUDE_DARK_CAP)
                             {
-                                darkCapStart = static_cast<unsigned short>(v0 + originalVertexCount);
-                                firstDarkCapTri = false;
+                                if (firstDarkCapTri)
+                                {
+                                    darkCapStart = static_cast<unsigned short>(v0 + originalVertexCount);
+                                    firstDarkCapTri = false;
+                                }
+                                else
+                                {
+                                    *pIdx++ = darkCapStart;
+                                    *pIdx++ = static_cast<unsigned short>(v1 + originalVertexCount);
+                                    *pIdx++ = static_cast<unsigned short>(v0 + originalVertexCount);
+                                    numIndices += 3;
+                                }
+
                             }
-                            else
+                        }
+                    }
+
+                }
+
+                if(!useMcGuire)
+                {
+                    // Do dark cap
+                    if (flags & SRF_INCLUDE_DARK_CAP) 
+                    {
+                        // Iterate over the triangles which are using this vertex set
+                        EdgeData::TriangleList::const_iterator ti, tiend;
+                        ti = edgeData->triangles.begin() + eg.triStart;
+                        tiend = ti + eg.triCount;
+                        const char* lfi = lightFacings + eg.triStart;
+                        for ( ; ti != tiend; ++ti, ++lfi)
+                        {
+                            const EdgeData::Triangle& t = *ti;
+                            assert(t.vertexSet == eg.vertexSet);
+                            // Check it's light facing
+                            if (*lfi)
                             {
-                                *pIdx++ = darkCapStart;
-                                *pIdx++ = static_cast<unsigned short>(v1 + originalVertexCount);
-                                *pIdx++ = static_cast<unsigned short>(v0 + originalVertexCount);
+                                assert(t.vertIndex[0] < 65536 && t.vertIndex[1] < 65536 &&
+                                    t.vertIndex[2] < 65536 && 
+                                    "16-bit index limit exceeded!");
+                                *pIdx++ = static_cast<unsigned short>(t.vertIndex[1] + originalVertexCount);
+                                *pIdx++ = static_cast<unsigned short>(t.vertIndex[0] + originalVertexCount);
+                                *pIdx++ = static_cast<unsigned short>(t.vertIndex[2] + originalVertexCount);
                                 numIndices += 3;
                             }
-
                         }
+
                     }
                 }
 
-            }
-
-            if(!useMcGuire)
-            {
-                // Do dark cap
-                if (flags & SRF_INCLUDE_DARK_CAP) 
+                // Do light cap
+                if (flags & SRF_INCLUDE_LIGHT_CAP) 
                 {
+                    // separate light cap?
+                    if ((*si)->isLightCapSeparate())
+                    {
+                        // update index count for this shadow renderable
+                        indexData->indexCount = numIndices - indexData->indexStart;
+
+                        // get light cap index data for update
+                        indexData = (*si)->getLightCapRenderable()->getRenderOperationForUpdate()->indexData;
+                        // start indexes after the current total
+                        indexData->indexStart = numIndices;
+                    }
+
                     // Iterate over the triangles which are using this vertex set
                     EdgeData::TriangleList::const_iterator ti, tiend;
-                    EdgeData::TriangleLightFacingList::const_iterator lfi;
                     ti = edgeData->triangles.begin() + eg.triStart;
                     tiend = ti + eg.triCount;
-                    lfi = edgeData->triangleLightFacings.begin() + eg.triStart;
+                    const char* lfi = lightFacings + eg.triStart;
                     for ( ; ti != tiend; ++ti, ++lfi)
                     {
                         const EdgeData::Triangle& t = *ti;
@@ -328,60 +310,106 @@ namespace Ogre {
                             assert(t.vertIndex[0] < 65536 && t.vertIndex[1] < 65536 &&
                                 t.vertIndex[2] < 65536 && 
                                 "16-bit index limit exceeded!");
-                            *pIdx++ = static_cast<unsigned short>(t.vertIndex[1] + originalVertexCount);
-                            *pIdx++ = static_cast<unsigned short>(t.vertIndex[0] + originalVertexCount);
-                            *pIdx++ = static_cast<unsigned short>(t.vertIndex[2] + originalVertexCount);
+                            *pIdx++ = static_cast<unsigned short>(t.vertIndex[0]);
+                            *pIdx++ = static_cast<unsigned short>(t.vertIndex[1]);
+                            *pIdx++ = static_cast<unsigned short>(t.vertIndex[2]);
                             numIndices += 3;
                         }
                     }
 
                 }
+
+                // update index count for current index data (either this shadow renderable or its light cap)
+                indexData->indexCount = numIndices - indexData->indexStart;
+
             }
+            return numIndices;
+        }
 
-            // Do light cap
-            if (flags & SRF_INCLUDE_LIGHT_CAP) 
+        /// Makes sure the index buffer can take preCountIndexes more indexes
+        void reserveShadowIndexes(const HardwareIndexBufferSharedPtr& indexBuffer,
+            size_t& indexBufferUsedSize, size_t preCountIndexes)
+        {
+            //Check if index buffer is to small 
+            if (preCountIndexes > indexBuffer->getNumIndexes())
             {
-                // separate light cap?
-                if ((*si)->isLightCapSeparate())
-                {
-                    // update index count for this shadow renderable
-                    indexData->indexCount = numIndices - indexData->indexStart;
+                LogManager::getSingleton().logWarning(
+                    "shadow index buffer size to small. Auto increasing buffer size to" +
+                    StringConverter::toString(sizeof(unsigned short) * preCountIndexes));
 
-                    // get light cap index data for update
-                    indexData = (*si)->getLightCapRenderable()->getRenderOperationForUpdate()->indexData;
-                    // start indexes after the current total
-                    indexData->indexStart = numIndices;
+                SceneManager* pManager = Root::getSingleton()._getCurrentSceneManager();
+                if (pManager)
+                {
+                    pManager->setShadowIndexBufferSize(preCountIndexes);
                 }
-
-                // Iterate over the triangles which are using this vertex set
-                EdgeData::TriangleList::const_iterator ti, tiend;
-                EdgeData::TriangleLightFacingList::const_iterator lfi;
-                ti = edgeData->triangles.begin() + eg.triStart;
-                tiend = ti + eg.triCount;
-                lfi = edgeData->triangleLightFacings.begin() + eg.triStart;
-                for ( ; ti != tiend; ++ti, ++lfi)
+                
+                //Check that the index buffer size has actually increased
+                if (preCountIndexes > indexBuffer->getNumIndexes())
                 {
-                    const EdgeData::Triangle& t = *ti;
-                    assert(t.vertexSet == eg.vertexSet);
-                    // Check it's light facing
-                    if (*lfi)
-                    {
-                        assert(t.vertIndex[0] < 65536 && t.vertIndex[1] < 65536 &&
-                            t.vertIndex[2] < 65536 && 
-                            "16-bit index limit exceeded!");
-                        *pIdx++ = static_cast<unsigned short>(t.vertIndex[0]);
-                        *pIdx++ = static_cast<unsigned short>(t.vertIndex[1]);
-                        *pIdx++ = static_cast<unsigned short>(t.vertIndex[2]);
-                        numIndices += 3;
-                    }
+                    //increasing index buffer size has failed
+                    OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                        "Lock request out of bounds.",
+                        "ShadowCaster::generateShadowVolume");
                 }
+            }
+            else if(indexBufferUsedSize + preCountIndexes > indexBuffer->getNumIndexes())
+            {
+                indexBufferUsedSize = 0;
+            }
+        }
 
+        /// Points the renderables to the index buffer they are about to use
+        void bindShadowIndexBuffer(const ShadowCaster::ShadowRenderableList& shadowRenderables,
+            const HardwareIndexBufferSharedPtr& indexBuffer)
+        {
+            ShadowCaster::ShadowRenderableList::const_iterator si, siend = shadowRenderables.end();
+            for (si = shadowRenderables.begin(); si != siend; ++si)
+            {
+                if ((*si)->getRenderOperationForUpdate()->indexData->indexBuffer != indexBuffer)
+                    (*si)->rebindIndexBuffer(indexBuffer);
             }
+        }
+    }
+    // ------------------------------------------------------------------------
+    void ShadowCaster::generateShadowVolume(EdgeData* edgeData, 
+        const HardwareIndexBufferSharedPtr& indexBuffer, size_t& indexBufferUsedSize, 
+        const Light* light, ShadowRenderableList& shadowRenderables, unsigned long flags)
+    {
+        // Edge groups should be 1:1 with shadow renderables
+        assert(edgeData->edgeGroups.size() == shadowRenderables.size());
 
-            // update index count for current index data (either this shadow renderable or its light cap)
-            indexData->indexCount = numIndices - indexData->indexStart;
+        Light::LightTypes lightType = light->getType();
 
-        }
+        // Whether to use the McGuire method, a triangle fan covering all silhouette
+        // This won't work properly with multiple separate edge groups (should be one fan per group, not implemented)
+        // or when light position is inside light cap bound as extrusion could be in opposite directions
+        // and McGuire cap could intersect near clip plane of camera frustum without being noticed.
+        bool useMcGuire = edgeData->edgeGroups.size() <= 1 && 
+            (lightType == Light::LT_DIRECTIONAL || !getLightCapBounds().contains(light->getDerivedPosition()));
+
+        // Within a batch, the volume is built along the ones of the other casters
+        ShadowVolumeBatch* batch = ShadowVolumeBatch::getActive();
+        if (batch && batch->_add(edgeData, light, useMcGuire, shadowRenderables, flags))
+            return;
+
+        const char* lightFacings = edgeData->triangleLightFacings.empty() ? NULL :
+            &edgeData->triangleLightFacings[0];
+
+        // pre-count the size of index data we need since it makes a big perf difference
+        // to GL in particular if we lock a smaller area of the index buffer
+        size_t preCountIndexes = countShadowVolumeIndexes(edgeData, lightFacings, lightType,
+            useMcGuire, flags);
+
+        reserveShadowIndexes(indexBuffer, indexBufferUsedSize, preCountIndexes);
+        bindShadowIndexBuffer(shadowRenderables, indexBuffer);
+
+        // Lock index buffer for writing, just enough length as we need
+        unsigned short* pIdx = static_cast<unsigned short*>(
+            indexBuffer->lock(sizeof(unsigned short) * indexBufferUsedSize, sizeof(unsigned short) * preCountIndexes,
+            indexBufferUsedSize == 0 ? HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NO_OVERWRITE));
+
+        size_t numIndices = writeShadowVolumeIndexes(edgeData, lightFacings, lightType, useMcGuire,
+            flags, shadowRenderables, pIdx, indexBufferUsedSize);
 
         // Unlock index buffer
         indexBuffer->unlock();
@@ -395,6 +423,140 @@ namespace Ogre {
         indexBufferUsedSize = numIndices;
     }
     // ------------------------------------------------------------------------
+    ShadowVolumeBatch* ShadowVolumeBatch::msActive = 0;
+    // ------------------------------------------------------------------------
+    ShadowVolumeBatch::ShadowVolumeBatch()
+        : mVolumeCount(0)
+        , mPendingEdgeData(0)
+        , mIndexes(0)
+        , mIndexBase(0)
+    {
+    }
+    // ------------------------------------------------------------------------
+    ShadowVolumeBatch::~ShadowVolumeBatch()
+    {
+        if (msActive == this)
+            msActive = 0;
+    }
+    // ------------------------------------------------------------------------
+    void ShadowVolumeBatch::begin()
+    {
+        mVolumeCount = 0;
+        mPendingEdgeData = 0;
+        msActive = this;
+    }
+    // ------------------------------------------------------------------------
+    void ShadowVolumeBatch::cancel()
+    {
+        mVolumeCount = 0;
+        mPendingEdgeData = 0;
+        if (msActive == this)
+            msActive = 0;
+    }
+    // ------------------------------------------------------------------------
+    void ShadowVolumeBatch::_setLightPosition(const EdgeData* edgeData, const Vector4& lightPos)
+    {
+        // Same as EdgeData::updateTriangleLightFacing, into storage of our own. This can't
+        // wait for end: animated casters update the face normals of their edge data, which
+        // is shared by all the entities of a mesh.
+        mPendingEdgeData = edgeData;
+        mPendingLightFacings.resize(edgeData->triangleFaceNormals.size());
+        if (!edgeData->triangleFaceNormals.empty())
+        {
+            OptimisedUtil::getImplementation()->calculateLightFacing(
+                lightPos,
+                &edgeData->triangleFaceNormals.front(),
+                &mPendingLightFacings.front(),
+                mPendingLightFacings.size());
+        }
+    }
+    // ------------------------------------------------------------------------
+    bool ShadowVolumeBatch::_add(const EdgeData* edgeData, const Light* light, bool useMcGuire,
+        ShadowCaster::ShadowRenderableList& shadowRenderables, unsigned long flags)
+    {
+        if (edgeData != mPendingEdgeData)
+            return false;
+        mPendingEdgeData = 0;
+
+        if (mVolumeCount == mVolumes.size())
+            mVolumes.resize(mVolumeCount + 1);
+
+        // Swapping keeps the light facing storage of earlier batches around for reuse
+        Volume& volume = mVolumes[mVolumeCount++];
+        volume.edgeData = edgeData;
+        volume.light = light;
+        volume.renderables = &shadowRenderables;
+        volume.useMcGuire = useMcGuire;
+        volume.flags = flags;
+        volume.lightFacings.swap(mPendingLightFacings);
+        volume.indexStart = 0;
+        volume.indexCount = 0;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void ShadowVolumeBatch::prepareVolume(size_t v)
+    {
+        Volume& volume = mVolumes[v];
+        const char* lightFacings = volume.lightFacings.empty() ? NULL : &volume.lightFacings[0];
+        volume.indexCount = countShadowVolumeIndexes(volume.edgeData, lightFacings,
+            volume.light->getType(), volume.useMcGuire, volume.flags);
+    }
+    // ------------------------------------------------------------------------
+    void ShadowVolumeBatch::writeVolume(size_t v)
+    {
+        Volume& volume = mVolumes[v];
+        const char* lightFacings = volume.lightFacings.empty() ? NULL : &volume.lightFacings[0];
+        size_t numIndices = writeShadowVolumeIndexes(volume.edgeData, lightFacings,
+            volume.light->getType(), volume.useMcGuire, volume.flags, *volume.renderables,
+            mIndexes + volume.indexStart, mIndexBase + volume.indexStart);
+
+        assert(numIndices == mIndexBase + volume.indexStart + volume.indexCount);
+        (void)numIndices;
+    }
+    // ------------------------------------------------------------------------
+    void ShadowVolumeBatch::end(const HardwareIndexBufferSharedPtr& indexBuffer,
+        size_t& indexBufferUsedSize)
+    {
+        if (msActive == this)
+            msActive = 0;
+        mPendingEdgeData = 0;
+        if (!mVolumeCount)
+            return;
+
+        // Light facings and index counts first, so that every volume gets its range
+        WorkQueue::parallelForDefault(mVolumeCount, [this](size_t v) { prepareVolume(v); });
+
+        size_t preCountIndexes = 0;
+        for (size_t v = 0; v < mVolumeCount; ++v)
+        {
+            mVolumes[v].indexStart = preCountIndexes;
+            preCountIndexes += mVolumes[v].indexCount;
+        }
+
+        reserveShadowIndexes(indexBuffer, indexBufferUsedSize, preCountIndexes);
+        for (size_t v = 0; v < mVolumeCount; ++v)
+            bindShadowIndexBuffer(*mVolumes[v].renderables, indexBuffer);
+
+        // Lock index buffer for writing, just enough length as we need
+        mIndexBase = indexBufferUsedSize;
+        mIndexes = 0;
+        if (preCountIndexes)
+        {
+            mIndexes = static_cast<unsigned short*>(
+                indexBuffer->lock(sizeof(unsigned short) * indexBufferUsedSize, sizeof(unsigned short) * preCountIndexes,
+                indexBufferUsedSize == 0 ? HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NO_OVERWRITE));
+        }
+
+        WorkQueue::parallelForDefault(mVolumeCount, [this](size_t v) { writeVolume(v); });
+
+        if (preCountIndexes)
+            indexBuffer->unlock();
+        mIndexes = 0;
+
+        indexBufferUsedSize += preCountIndexes;
+        mVolumeCount = 0;
+    }
+    // ------------------------------------------------------------------------
     void ShadowCaster::extrudeVertices(
         const HardwareVertexBufferSharedPtr& vertexBuffer, 
         size_t originalVertexCount, const Vector4& light, Real extrudeDist)
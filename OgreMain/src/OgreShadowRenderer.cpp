@@ -34,6 +34,9 @@ THE SOFTWARE.
 #include "OgreShadowCameraSetup.h"
 #include "OgreShadowVolumeExtrudeProgram.h"
 #include "OgreHighLevelGpuProgram.h"
+#include "OgreEntity.h"
+#include "OgreSubEntity.h"
+#include "OgreSceneManagerEnumerator.h"
 
 #include "OgreSpotShadowFadePng.h"
 
@@ -61,7 +64,12 @@ mDefaultShadowFarDist(0),
 mDefaultShadowFarDistSquared(0),
 mShadowTextureOffset(0.6),
 mShadowTextureFadeStart(0.7),
-mShadowTextureFadeEnd(0.9)
+mShadowTextureFadeEnd(0.9),
+mSharedCasterCulling(true),
+mCullChildrenByParent(true),
+mShadowTextureCaching(false),
+mCasterFilter(CF_ALL),
+mFilteredCache(0)
 {
     // set up default shadow camera setup
     mDefaultShadowCameraSetup.reset(new DefaultShadowCameraSetup());
@@ -738,6 +746,7 @@ void SceneManager::ShadowRenderer::ensureShadowTexturesCreated()
 //---------------------------------------------------------------------
 void SceneManager::ShadowRenderer::destroyShadowTextures(void)
 {
+    destroyShadowTextureCaches();
 
     ShadowTextureList::iterator i, iend;
     iend = mShadowTextures.end();
@@ -821,6 +830,8 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
         // start of the light list, therefore we do not need to deal with potential
         // mismatches in the light<->shadow texture list any more
 
+        // First set up all the shadow cameras, so that their casters can be culled
+        // in a single pass before any of the textures is rendered
         LightList::const_iterator i, iend;
         ShadowTextureList::iterator si, siend;
         CameraList::iterator ci;
@@ -828,6 +839,7 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
         siend = mShadowTextures.end();
         ci = mShadowTextureCameras.begin();
         mShadowTextureIndexLightList.clear();
+        LightList shadowLights;
         size_t shadowTextureIndex = 0;
         for (i = lightList->begin(), si = mShadowTextures.begin();
             i != iend && si != siend; ++i)
@@ -838,22 +850,11 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
             if (!light->getCastShadows())
                 continue;
 
-            if (mShadowTextureCurrentCasterLightList.empty())
-                mShadowTextureCurrentCasterLightList.push_back(light);
-            else
-                mShadowTextureCurrentCasterLightList[0] = light;
-
-
             // texture iteration per light.
             size_t textureCountPerLight = mShadowTextureCountPerType[light->getType()];
             for (size_t j = 0; j < textureCountPerLight && si != siend; ++j)
             {
-                TexturePtr &shadowTex = *si;
-                RenderTarget *shadowRTT = shadowTex->getBuffer()->getRenderTarget();
-                Viewport *shadowView = shadowRTT->getViewport(0);
                 Camera *texCam = *ci;
-                // rebind camera, incase another SM in use which has switched to its cam
-                shadowView->setCamera(texCam);
 
                 // Associate main view camera as LOD camera
                 texCam->setLodCamera(cam);
@@ -863,10 +864,6 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
                 if (light->getType() != Light::LT_DIRECTIONAL)
                     texCam->setPosition(light->getDerivedPosition());
 
-                // Use the material scheme of the main viewport
-                // This is required to pick up the correct shadow_caster_material and similar properties.
-                shadowView->setMaterialScheme(vp->getMaterialScheme());
-
                 // update shadow cam - light mapping
                 ShadowCamLightMapping::iterator camLightIt = mShadowCamLightMapping.find( texCam );
                 assert(camLightIt != mShadowCamLightMapping.end());
@@ -877,30 +874,76 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
                 else
                     light->getCustomShadowCameraSetup()->getShadowCamera(mSceneManager, cam, vp, light, texCam, j);
 
+                ++si; // next shadow texture
+                ++ci; // next camera
+            }
+
+            shadowLights.push_back(light);
+            // set the first shadow texture index for this light.
+            mShadowTextureIndexLightList.push_back(shadowTextureIndex);
+            shadowTextureIndex += textureCountPerLight;
+        }
+
+        if (mSharedCasterCulling)
+        {
+            CameraList cameras(mShadowTextureCameras.begin(), ci);
+            cullShadowCasters(cameras);
+        }
+
+        // Now render the textures
+        si = mShadowTextures.begin();
+        ci = mShadowTextureCameras.begin();
+        for (i = shadowLights.begin(); i != shadowLights.end(); ++i)
+        {
+            Light* light = *i;
+
+            if (mShadowTextureCurrentCasterLightList.empty())
+                mShadowTextureCurrentCasterLightList.push_back(light);
+            else
+                mShadowTextureCurrentCasterLightList[0] = light;
+
+            size_t textureCountPerLight = mShadowTextureCountPerType[light->getType()];
+            for (size_t j = 0; j < textureCountPerLight && si != siend; ++j)
+            {
+                TexturePtr &shadowTex = *si;
+                RenderTarget *shadowRTT = shadowTex->getBuffer()->getRenderTarget();
+                Viewport *shadowView = shadowRTT->getViewport(0);
+                Camera *texCam = *ci;
+                // rebind camera, incase another SM in use which has switched to its cam
+                shadowView->setCamera(texCam);
+
+                // Use the material scheme of the main viewport
+                // This is required to pick up the correct shadow_caster_material and similar properties.
+                shadowView->setMaterialScheme(vp->getMaterialScheme());
+
                 // Setup background colour
                 shadowView->setBackgroundColour(ColourValue::White);
 
                 // Fire shadow caster update, callee can alter camera settings
                 mSceneManager->fireShadowTexturesPreCaster(light, texCam, j);
 
-                // Update target
-                shadowRTT->update();
+                // Update target, from its static casters cache if possible
+                if (!mShadowTextureCaching ||
+                    !renderCachedShadowTexture(si - mShadowTextures.begin(), texCam, vp))
+                {
+                    shadowRTT->update();
+                }
 
                 ++si; // next shadow texture
                 ++ci; // next camera
             }
-
-            // set the first shadow texture index for this light.
-            mShadowTextureIndexLightList.push_back(shadowTextureIndex);
-            shadowTextureIndex += textureCountPerLight;
         }
     }
     catch (Exception&)
     {
         // we must reset the illumination stage if an exception occurs
         mSceneManager->mIlluminationStage = savedStage;
+        mCasterFilter = CF_ALL;
+        mCulledCameras.clear();
         throw;
     }
+    // The culled casters are only valid for this update
+    mCulledCameras.clear();
     // Set the illumination stage, prevents recursive calls
     mSceneManager->mIlluminationStage = savedStage;
 
@@ -911,6 +954,419 @@ void SceneManager::ShadowRenderer::prepareShadowTextures(Camera* cam, Viewport*
 
 }
 //---------------------------------------------------------------------
+uint64 SceneManager::ShadowRenderer::cullCasterBox(const AxisAlignedBox& box, uint64 mask) const
+{
+    if (box.isNull())
+        return 0;
+    if (box.isInfinite())
+        return mask;
+
+    Vector3 centre = box.getCenter();
+    Vector3 halfSize = box.getHalfSize();
+    for (size_t c = 0; c < mCulledFrustums.size(); ++c)
+    {
+        uint64 bit = uint64(1) << c;
+        if (!(mask & bit))
+            continue;
+        const CasterCullingFrustum& frustum = mCulledFrustums[c];
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            if (plane == FRUSTUM_PLANE_FAR && frustum.infiniteFar)
+                continue;
+            if (frustum.planes[plane].getSide(centre, halfSize) == Plane::NEGATIVE_SIDE)
+            {
+                mask &= ~bit;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+//---------------------------------------------------------------------
+uint64 SceneManager::ShadowRenderer::collectCasters(SceneNode* node, uint64 mask,
+    CulledShadowCasterList& casters) const
+{
+    const AxisAlignedBox& box = node->_getWorldAABB();
+    uint64 objectMask = cullCasterBox(box, mask);
+
+    // Whether the objects cast or receive is left to RenderQueue::processVisibleObject,
+    // finding out about receivers may load materials which is not safe here
+    if (objectMask)
+    {
+        const SceneNode::ObjectMap& objects = node->getAttachedObjects();
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            CulledShadowCaster caster = {objects[i], node, objectMask};
+            casters.push_back(caster);
+        }
+    }
+
+    // Nodes without objects have null bounds under some scene managers, and only
+    // the bounds of the generic scene nodes enclose their children
+    if (mCullChildrenByParent && !box.isNull())
+        return objectMask;
+    return mask;
+}
+//---------------------------------------------------------------------
+void SceneManager::ShadowRenderer::collectSubtreeCasters(SceneNode* node, uint64 mask,
+    CulledShadowCasterList& casters) const
+{
+    // Same traversal as SceneNode::_findVisibleObjects, for several cameras at once
+    uint64 childMask = collectCasters(node, mask, casters);
+    if (!childMask)
+        return;
+
+    const Node::ChildNodeMap& children = node->getChildren();
+    for (size_t i = 0; i < children.size(); ++i)
+        collectSubtreeCasters(static_cast<SceneNode*>(children[i]), childMask, casters);
+
+    if (node->getShowBoundingBox())
+    {
+        uint64 boxMask = cullCasterBox(node->_getWorldAABB(), mask);
+        if (boxMask)
+        {
+            CulledShadowCaster entry = {NULL, node, boxMask};
+            casters.push_back(entry);
+        }
+    }
+}
+//---------------------------------------------------------------------
+void SceneManager::ShadowRenderer::cullShadowCasters(const CameraList& cameras)
+{
+    mCulledCameras.clear();
+    mCulledCasters.clear();
+
+    // Debug geometry is added per node in the middle of the traversal, keep it simple
+    if (mSceneManager->mDisplayNodes || mSceneManager->mShowBoundingBoxes)
+        return;
+
+    // One mask bit per camera, any further ones just cull on their own
+    size_t count = std::min<size_t>(cameras.size(), 64);
+    mCulledCameras.assign(cameras.begin(), cameras.begin() + count);
+    mCulledFrustums.resize(count);
+    for (size_t c = 0; c < count; ++c)
+    {
+        // as Camera::isVisible, this also brings the planes up to date before going wide
+        const Frustum* frustum = cameras[c]->getCullingFrustum();
+        if (!frustum)
+            frustum = cameras[c];
+        const Plane* planes = frustum->getFrustumPlanes();
+        std::copy(planes, planes + 6, mCulledFrustums[c].planes);
+        mCulledFrustums[c].infiniteFar = frustum->getFarClipDistance() == 0;
+    }
+    if (!count)
+        return;
+
+    // Scene managers with their own spatial structure, like the octree one, keep
+    // the bounds of the objects of a node only
+    mCullChildrenByParent =
+        mSceneManager->getTypeName() == DefaultSceneManagerFactory::FACTORY_TYPE_NAME;
+
+    // The objects of the root itself come first, then each subtree in order
+    SceneNode* root = mSceneManager->getRootSceneNode();
+    uint64 mask = count == 64 ? ~uint64(0) : (uint64(1) << count) - 1;
+    uint64 childMask = collectCasters(root, mask, mCulledCasters);
+    if (childMask)
+    {
+        const Node::ChildNodeMap& children = root->getChildren();
+        std::vector<CulledShadowCasterList> casters(children.size());
+        WorkQueue::parallelForDefault(children.size(), [this, &children, &casters, childMask](size_t i) {
+            collectSubtreeCasters(static_cast<SceneNode*>(children[i]), childMask, casters[i]);
+        });
+        for (size_t i = 0; i < casters.size(); ++i)
+            mCulledCasters.insert(mCulledCasters.end(), casters[i].begin(), casters[i].end());
+    }
+
+    // The bounding box of the root is added after all its children
+    if (root->getShowBoundingBox())
+    {
+        uint64 boxMask = cullCasterBox(root->_getWorldAABB(), mask);
+        if (boxMask)
+        {
+            CulledShadowCaster entry = {NULL, root, boxMask};
+            mCulledCasters.push_back(entry);
+        }
+    }
+}
+//---------------------------------------------------------------------
+size_t SceneManager::ShadowRenderer::getCulledCameraIndex(const Camera* cam) const
+{
+    CameraList::const_iterator it = std::find(mCulledCameras.begin(), mCulledCameras.end(), cam);
+    if (it == mCulledCameras.end())
+        return mCulledCameras.size();
+
+    // Listeners may have moved the camera since the pass
+    size_t c = it - mCulledCameras.begin();
+    const Frustum* frustum = cam->getCullingFrustum();
+    if (!frustum)
+        frustum = cam;
+    const Plane* planes = frustum->getFrustumPlanes();
+    if (!std::equal(planes, planes + 6, mCulledFrustums[c].planes) ||
+        mCulledFrustums[c].infiniteFar != (frustum->getFarClipDistance() == 0))
+        return mCulledCameras.size();
+
+    return c;
+}
+//---------------------------------------------------------------------
+namespace
+{
+    /// Same bounds as RenderQueue::processVisibleObject gathers, without queueing the object
+    void mergeShadowCasterBounds(RenderQueue* queue, MovableObject* mo, Camera* cam,
+                                 VisibleObjectsBoundsInfo* visibleBounds)
+    {
+        mo->_notifyCurrentCamera(cam);
+        if (!visibleBounds || !mo->isVisible())
+            return;
+
+        bool receiveShadows = queue->getQueueGroup(mo->getRenderQueueGroup())->getShadowsEnabled()
+            && mo->getReceivesShadows();
+        if (mo->getCastShadows())
+        {
+            visibleBounds->merge(mo->getWorldBoundingBox(true), mo->getWorldBoundingSphere(true),
+                cam, receiveShadows);
+        }
+        else if (receiveShadows)
+        {
+            visibleBounds->mergeNonRenderedButInFrustum(mo->getWorldBoundingBox(true),
+                mo->getWorldBoundingSphere(true), cam);
+        }
+    }
+}
+//---------------------------------------------------------------------
+bool SceneManager::ShadowRenderer::queueCulledShadowCasters(Camera* cam,
+    VisibleObjectsBoundsInfo* visibleBounds)
+{
+    size_t c = getCulledCameraIndex(cam);
+    if (c == mCulledCameras.size())
+        return false;
+
+    RenderQueue* queue = mSceneManager->getRenderQueue();
+    uint64 bit = uint64(1) << c;
+    CulledShadowCasterList::const_iterator i, iend = mCulledCasters.end();
+    for (i = mCulledCasters.begin(); i != iend; ++i)
+    {
+        if (!(i->cameraMask & bit))
+            continue;
+
+        if (!i->object)
+        {
+            if (mCasterFilter != CF_STATIC)
+                i->node->_addBoundingBoxToQueue(queue);
+        }
+        else if (mCasterFilter == CF_ALL ||
+                 i->object->isStaticShadowCaster() == (mCasterFilter == CF_STATIC))
+        {
+            queue->processVisibleObject(i->object, cam, true, visibleBounds);
+        }
+    }
+
+    if (mCasterFilter != CF_ALL && visibleBounds)
+    {
+        // Static and dynamic casters share the depth range of their cache
+        visibleBounds->minDistanceInFrustum = mFilteredCache->minDistance;
+        visibleBounds->maxDistanceInFrustum = mFilteredCache->maxDistance;
+    }
+    return true;
+}
+//---------------------------------------------------------------------
+namespace
+{
+    /// Collects the technique of every renderable of a shadow caster
+    struct CasterTechniqueCollector : public Renderable::Visitor
+    {
+        std::vector<const Technique*>& techniques;
+
+        CasterTechniqueCollector(std::vector<const Technique*>& t) : techniques(t) {}
+
+        void visit(Renderable* rend, ushort lodIndex, bool isDebug, Any* pAny = 0)
+        {
+            if (!isDebug && lodIndex == 0)
+                techniques.push_back(rend->getTechnique());
+        }
+    };
+}
+//---------------------------------------------------------------------
+bool SceneManager::ShadowRenderer::checkShadowTextureCache(ShadowTextureCache& cache, Camera* texCam,
+    size_t c, VisibleObjectsBoundsInfo& bounds, bool& dynamicCasters)
+{
+    // Gather the depth range of all the casters, as _renderScene would, together
+    // with the state of the static ones to compare against the cache
+    RenderQueue* queue = mSceneManager->getRenderQueue();
+    bounds.reset();
+    std::vector<CachedShadowCaster> casters;
+    casters.reserve(cache.casters.size());
+    dynamicCasters = false;
+
+    uint64 bit = uint64(1) << c;
+    CulledShadowCasterList::const_iterator i, iend = mCulledCasters.end();
+    for (i = mCulledCasters.begin(); i != iend; ++i)
+    {
+        MovableObject* mo = i->object;
+        if (!(i->cameraMask & bit) || !mo)
+            continue;
+
+        // This also brings the LOD of the object up to date for the texture camera
+        mergeShadowCasterBounds(queue, mo, texCam, &bounds);
+        if (!mo->isVisible() || !mo->getCastShadows())
+            continue;
+
+        if (!mo->isStaticShadowCaster())
+        {
+            dynamicCasters = true;
+            continue;
+        }
+
+        casters.push_back(CachedShadowCaster());
+        CachedShadowCaster& caster = casters.back();
+        caster.object = mo;
+        caster.transform = mo->_getParentNodeFullTransform();
+        caster.bounds = mo->getWorldBoundingBox();
+        caster.lodIndex = 0;
+        if (mo->getMovableType() == EntityFactory::FACTORY_TYPE_NAME)
+        {
+            Entity* ent = static_cast<Entity*>(mo);
+            caster.lodIndex = ent->getCurrentLodIndex();
+            for (size_t s = 0; s < ent->getNumSubEntities(); ++s)
+            {
+                SubEntity* sub = ent->getSubEntity(s);
+                caster.techniques.push_back(sub->isVisible() ? sub->getTechnique() : NULL);
+            }
+        }
+        else
+        {
+            CasterTechniqueCollector collector(caster.techniques);
+            mo->visitRenderables(&collector);
+        }
+    }
+
+    // Dynamic casters only count when they leave the depth range of the cache
+    if (cache.valid &&
+        cache.viewMatrix == texCam->getViewMatrix(true) &&
+        cache.projMatrix == texCam->getProjectionMatrix() &&
+        cache.shadowColour == mShadowColour &&
+        cache.minDistance <= bounds.minDistanceInFrustum &&
+        cache.maxDistance >= bounds.maxDistanceInFrustum &&
+        cache.casters == casters)
+    {
+        return true;
+    }
+
+    cache.valid = true;
+    cache.viewMatrix = texCam->getViewMatrix(true);
+    cache.projMatrix = texCam->getProjectionMatrix();
+    cache.shadowColour = mShadowColour;
+    cache.minDistance = bounds.minDistanceInFrustum;
+    cache.maxDistance = bounds.maxDistanceInFrustum;
+    cache.casters.swap(casters);
+    return false;
+}
+//---------------------------------------------------------------------
+bool SceneManager::ShadowRenderer::renderCachedShadowTexture(size_t index, Camera* texCam,
+    const Viewport* vp)
+{
+    const TexturePtr& shadowTex = mShadowTextures[index];
+    // Caster depth is composited in colour, the depth buffer is not kept
+    PixelFormat format = shadowTex->getFormat();
+    if (shadowTex->getFSAA() > 0 || PixelUtil::isDepth(format))
+        return false;
+
+    // The dynamic casters are combined with the cache by a minimum blend in _setPass.
+    // That holds for the shadow colour of modulative shadows, and for casters writing
+    // a single depth value growing with the distance. Depth packed into several
+    // channels, or moments as used by variance shadow maps, would be mixed up.
+    bool colourCasters = (mShadowTechnique & SHADOWDETAILTYPE_MODULATIVE) &&
+        !(mShadowTechnique & SHADOWDETAILTYPE_INTEGRATED);
+    if (!colourCasters &&
+        (!PixelUtil::isFloatingPoint(format) || PixelUtil::getComponentCount(format) != 1))
+        return false;
+
+    // Static and dynamic casters are told apart from the shared culling pass
+    size_t c = getCulledCameraIndex(texCam);
+    if (c == mCulledCameras.size())
+        return false;
+
+    if (mShadowTextureCaches.size() < mShadowTextures.size())
+        mShadowTextureCaches.resize(mShadowTextures.size());
+    ShadowTextureCache& cache = mShadowTextureCaches[index];
+
+    // (Re)create the cache texture along the shadow texture
+    if (!cache.texture || cache.texture->getWidth() != shadowTex->getWidth() ||
+        cache.texture->getHeight() != shadowTex->getHeight() ||
+        cache.texture->getFormat() != format)
+    {
+        if (cache.texture)
+            TextureManager::getSingleton().remove(cache.texture);
+
+        cache.texture = TextureManager::getSingleton().createManual(
+            shadowTex->getName() + "/StaticCasters/" + mSceneManager->getName(),
+            ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME, TEX_TYPE_2D,
+            shadowTex->getWidth(), shadowTex->getHeight(), 0, format, TU_RENDERTARGET);
+
+        RenderTexture* cacheRTT = cache.texture->getBuffer()->getRenderTarget();
+        cacheRTT->setDepthBufferPool(
+            shadowTex->getBuffer()->getRenderTarget()->getDepthBufferPool());
+        Viewport* v = cacheRTT->addViewport(texCam);
+        v->setClearEveryFrame(true);
+        v->setOverlaysEnabled(false);
+        cacheRTT->setAutoUpdated(false);
+        cache.valid = false;
+    }
+
+    VisibleObjectsBoundsInfo bounds;
+    bool dynamicCasters;
+    if (!checkShadowTextureCache(cache, texCam, c, bounds, dynamicCasters))
+    {
+        RenderTexture* cacheRTT = cache.texture->getBuffer()->getRenderTarget();
+        Viewport* cacheView = cacheRTT->getViewport(0);
+        cacheView->setCamera(texCam);
+        cacheView->setMaterialScheme(vp->getMaterialScheme());
+        cacheView->setBackgroundColour(ColourValue::White);
+
+        mCasterFilter = CF_STATIC;
+        mFilteredCache = &cache;
+        cacheRTT->update();
+        mCasterFilter = CF_ALL;
+        mFilteredCache = 0;
+    }
+
+    shadowTex->getBuffer()->blit(cache.texture->getBuffer());
+
+    if (dynamicCasters)
+    {
+        // Keep the copied static casters, only start from a fresh depth buffer
+        Viewport* shadowView = shadowTex->getBuffer()->getRenderTarget()->getViewport(0);
+        bool clear = shadowView->getClearEveryFrame();
+        unsigned int clearBuffers = shadowView->getClearBuffers();
+        shadowView->setClearEveryFrame(true, FBT_DEPTH);
+
+        mCasterFilter = CF_DYNAMIC;
+        mFilteredCache = &cache;
+        shadowTex->getBuffer()->getRenderTarget()->update();
+        mCasterFilter = CF_ALL;
+        mFilteredCache = 0;
+
+        shadowView->setClearEveryFrame(clear, clearBuffers);
+    }
+    else
+    {
+        // Nothing rendered, but receivers still look up the depth range of the camera
+        bounds.minDistanceInFrustum = cache.minDistance;
+        bounds.maxDistanceInFrustum = cache.maxDistance;
+        mSceneManager->mCamVisibleObjectsMap[texCam] = bounds;
+    }
+    return true;
+}
+//---------------------------------------------------------------------
+void SceneManager::ShadowRenderer::destroyShadowTextureCaches()
+{
+    for (size_t i = 0; i < mShadowTextureCaches.size(); ++i)
+    {
+        if (mShadowTextureCaches[i].texture)
+            TextureManager::getSingleton().remove(mShadowTextureCaches[i].texture);
+    }
+    mShadowTextureCaches.clear();
+}
+//---------------------------------------------------------------------
 void SceneManager::ShadowRenderer::renderShadowVolumesToStencil(const Light* light,
     const Camera* camera, bool calcScissor)
 {
@@ -1027,108 +1483,106 @@ void SceneManager::ShadowRenderer::renderShadowVolumesToStencil(const Light* lig
     ShadowCasterList::const_iterator si, siend;
     siend = casters.end();
 
-
-    // Now iterate over the casters and render
-    for (si = casters.begin(); si != siend; ++si)
+    // With vertex program extrusion the volumes of all casters are built together,
+    // and rendered once they are all done
+    bool batched = !extrudeInSoftware;
+    std::vector<ShadowVolume> volumes;
+    if (batched)
     {
-        ShadowCaster* caster = *si;
-        bool zfailAlgo = camera->isCustomNearClipPlaneEnabled();
-        unsigned long flags = 0;
+        volumes.reserve(casters.size());
+        mShadowVolumeBatch.begin();
+    }
 
-        if (light->getType() != Light::LT_DIRECTIONAL)
+    try
+    {
+        for (si = casters.begin(); si != siend; ++si)
         {
-            extrudeDist = caster->getPointExtrusionDistance(light);
-        }
+            ShadowCaster* caster = *si;
+            bool zfailAlgo = camera->isCustomNearClipPlaneEnabled();
+            unsigned long flags = 0;
 
-        Real darkCapExtrudeDist = extrudeDist;
-        if (!extrudeInSoftware && !finiteExtrude)
-        {
-            // hardware extrusion, to infinity (and beyond!)
-            flags |= SRF_EXTRUDE_TO_INFINITY;
-            darkCapExtrudeDist = mShadowDirLightExtrudeDist;
-        }
-
-        // Determine whether zfail is required
-        if (zfailAlgo || nearClipVol.intersects(caster->getWorldBoundingBox()))
-        {
-            // We use zfail for this object only because zfail
-            // compatible with zpass algorithm
-            zfailAlgo = true;
-            // We need to include the light and / or dark cap
-            // But only if they will be visible
-            if(camera->isVisible(caster->getLightCapBounds()))
+            if (light->getType() != Light::LT_DIRECTIONAL)
             {
-                flags |= SRF_INCLUDE_LIGHT_CAP;
+                extrudeDist = caster->getPointExtrusionDistance(light);
             }
-            // zfail needs dark cap
-            // UNLESS directional lights using hardware extrusion to infinity
-            // since that extrudes to a single point
-            if(!((flags & SRF_EXTRUDE_TO_INFINITY) &&
-                light->getType() == Light::LT_DIRECTIONAL) &&
-                camera->isVisible(caster->getDarkCapBounds(*light, darkCapExtrudeDist)))
+
+            Real darkCapExtrudeDist = extrudeDist;
+            if (!extrudeInSoftware && !finiteExtrude)
             {
-                flags |= SRF_INCLUDE_DARK_CAP;
+                // hardware extrusion, to infinity (and beyond!)
+                flags |= SRF_EXTRUDE_TO_INFINITY;
+                darkCapExtrudeDist = mShadowDirLightExtrudeDist;
             }
-        }
-        else
-        {
-            // In zpass we need a dark cap if
-            // 1: infinite extrusion on point/spotlight sources in modulative shadows
-            //    mode, since otherwise in areas where there is no depth (skybox)
-            //    the infinitely projected volume will leave a dark band
-            // 2: finite extrusion on any light source since glancing angles
-            //    can peek through the end and shadow objects behind incorrectly
-            if ((flags & SRF_EXTRUDE_TO_INFINITY) &&
-                light->getType() != Light::LT_DIRECTIONAL &&
-                (mShadowTechnique & SHADOWDETAILTYPE_MODULATIVE) &&
-                camera->isVisible(caster->getDarkCapBounds(*light, darkCapExtrudeDist)))
+
+            // Determine whether zfail is required
+            if (zfailAlgo || nearClipVol.intersects(caster->getWorldBoundingBox()))
             {
-                flags |= SRF_INCLUDE_DARK_CAP;
+                // We use zfail for this object only because zfail
+                // compatible with zpass algorithm
+                zfailAlgo = true;
+                // We need to include the light and / or dark cap
+                // But only if they will be visible
+                if(camera->isVisible(caster->getLightCapBounds()))
+                {
+                    flags |= SRF_INCLUDE_LIGHT_CAP;
+                }
+                // zfail needs dark cap
+                // UNLESS directional lights using hardware extrusion to infinity
+                // since that extrudes to a single point
+                if(!((flags & SRF_EXTRUDE_TO_INFINITY) &&
+                    light->getType() == Light::LT_DIRECTIONAL) &&
+                    camera->isVisible(caster->getDarkCapBounds(*light, darkCapExtrudeDist)))
+                {
+                    flags |= SRF_INCLUDE_DARK_CAP;
+                }
             }
-            else if (!(flags & SRF_EXTRUDE_TO_INFINITY) &&
-                camera->isVisible(caster->getDarkCapBounds(*light, darkCapExtrudeDist)))
+            else
             {
-                flags |= SRF_INCLUDE_DARK_CAP;
-            }
+                // In zpass we need a dark cap if
+                // 1: infinite extrusion on point/spotlight sources in modulative shadows
+                //    mode, since otherwise in areas where there is no depth (skybox)
+                //    the infinitely projected volume will leave a dark band
+                // 2: finite extrusion on any light source since glancing angles
+                //    can peek through the end and shadow objects behind incorrectly
+                if ((flags & SRF_EXTRUDE_TO_INFINITY) &&
+                    light->getType() != Light::LT_DIRECTIONAL &&
+                    (mShadowTechnique & SHADOWDETAILTYPE_MODULATIVE) &&
+                    camera->isVisible(caster->getDarkCapBounds(*light, darkCapExtrudeDist)))
+                {
+                    flags |= SRF_INCLUDE_DARK_CAP;
+                }
+                else if (!(flags & SRF_EXTRUDE_TO_INFINITY) &&
+                    camera->isVisible(caster->getDarkCapBounds(*light, darkCapExtrudeDist)))
+                {
+                    flags |= SRF_INCLUDE_DARK_CAP;
+                }
 
-        }
+            }
 
-        // Get shadow renderables
-        ShadowCaster::ShadowRenderableListIterator iShadowRenderables =
-            caster->getShadowVolumeRenderableIterator(mShadowTechnique,
-            light, &mShadowIndexBuffer, &mShadowIndexBufferUsedSize,
-            extrudeInSoftware, extrudeDist, flags);
+            // Get shadow renderables
+            ShadowVolume volume = {
+                caster->getShadowVolumeRenderableIterator(mShadowTechnique,
+                light, &mShadowIndexBuffer, &mShadowIndexBufferUsedSize,
+                extrudeInSoftware, extrudeDist, flags),
+                flags, zfailAlgo};
 
-        // Render a shadow volume here
-        //  - if we have 2-sided stencil, one render with no culling
-        //  - otherwise, 2 renders, one with each culling method and invert the ops
-        setShadowVolumeStencilState(false, zfailAlgo, stencil2sided);
-        renderShadowVolumeObjects(iShadowRenderables, mShadowStencilPass, &lightList, flags,
-            false, zfailAlgo, stencil2sided);
-        if (!stencil2sided)
-        {
-            // Second pass
-            setShadowVolumeStencilState(true, zfailAlgo, false);
-            renderShadowVolumeObjects(iShadowRenderables, mShadowStencilPass, &lightList, flags,
-                true, zfailAlgo, false);
+            if (batched)
+                volumes.push_back(volume);
+            else
+                renderShadowVolume(volume, lightList, stencil2sided);
         }
+    }
+    catch (...)
+    {
+        mShadowVolumeBatch.cancel();
+        throw;
+    }
 
-        // Do we need to render a debug shadow marker?
-        if (mDebugShadows)
-        {
-            // reset stencil & colour ops
-            mDestRenderSystem->setStencilBufferParams();
-            if (mShadowDebugPass->hasFragmentProgram())
-            {
-                mShadowDebugPass->getFragmentProgramParameters()->setNamedConstant(
-                    "colour", zfailAlgo ? ColourValue(0.7, 0.0, 0.2) : ColourValue(0.0, 0.7, 0.2));
-            }
-            mSceneManager->_setPass(mShadowDebugPass);
-            renderShadowVolumeObjects(iShadowRenderables, mShadowDebugPass, &lightList, flags,
-                true, false, false);
-            mDestRenderSystem->_setColourBufferWriteEnabled(false, false, false, false);
-            mDestRenderSystem->_setDepthBufferFunction(CMPF_LESS);
-        }
+    if (batched)
+    {
+        mShadowVolumeBatch.end(mShadowIndexBuffer, mShadowIndexBufferUsedSize);
+        for (size_t v = 0; v < volumes.size(); ++v)
+            renderShadowVolume(volumes[v], lightList, stencil2sided);
     }
 
     // revert colour write state
@@ -1148,6 +1602,41 @@ void SceneManager::ShadowRenderer::renderShadowVolumesToStencil(const Light* lig
 
 }
 //---------------------------------------------------------------------
+void SceneManager::ShadowRenderer::renderShadowVolume(const ShadowVolume& volume,
+    const LightList& lightList, bool stencil2sided)
+{
+    // Render a shadow volume here
+    //  - if we have 2-sided stencil, one render with no culling
+    //  - otherwise, 2 renders, one with each culling method and invert the ops
+    setShadowVolumeStencilState(false, volume.zfail, stencil2sided);
+    renderShadowVolumeObjects(volume.renderables, mShadowStencilPass, &lightList, volume.flags,
+        false, volume.zfail, stencil2sided);
+    if (!stencil2sided)
+    {
+        // Second pass
+        setShadowVolumeStencilState(true, volume.zfail, false);
+        renderShadowVolumeObjects(volume.renderables, mShadowStencilPass, &lightList, volume.flags,
+            true, volume.zfail, false);
+    }
+
+    // Do we need to render a debug shadow marker?
+    if (mDebugShadows)
+    {
+        // reset stencil & colour ops
+        mDestRenderSystem->setStencilBufferParams();
+        if (mShadowDebugPass->hasFragmentProgram())
+        {
+            mShadowDebugPass->getFragmentProgramParameters()->setNamedConstant(
+                "colour", volume.zfail ? ColourValue(0.7, 0.0, 0.2) : ColourValue(0.0, 0.7, 0.2));
+        }
+        mSceneManager->_setPass(mShadowDebugPass);
+        renderShadowVolumeObjects(volume.renderables, mShadowDebugPass, &lightList, volume.flags,
+            true, false, false);
+        mDestRenderSystem->_setColourBufferWriteEnabled(false, false, false, false);
+        mDestRenderSystem->_setDepthBufferFunction(CMPF_LESS);
+    }
+}
+//---------------------------------------------------------------------
 void SceneManager::ShadowRenderer::renderShadowVolumeObjects(ShadowCaster::ShadowRenderableListIterator iShadowRenderables,
                                              Pass* pass,
                                              const LightList *manualLightList,
@@ -232,30 +232,17 @@ namespace Ogre {
         const Vector3& position, const Quaternion& orientation,
         const Vector3& scale)
     {
-        const VertexElement* posElem =
-            vertexData->vertexDeclaration->findElementBySemantic(
-                VES_POSITION);
-        HardwareVertexBufferSharedPtr vbuf =
-            vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
-        unsigned char* vertex =
-            static_cast<unsigned char*>(
-                vbuf->lock(HardwareBuffer::HBL_READ_ONLY));
-        float* pFloat;
+        // Quantised positions are decoded here
+        std::vector<Vector3> positions;
+        vertexData->readPositions(positions);
 
         Vector3 min = Vector3::ZERO, max = Vector3::UNIT_SCALE;
         bool first = true;
 
-        for(size_t j = 0; j < vertexData->vertexCount; ++j, vertex += vbuf->getVertexSize())
+        for(size_t j = 0; j < positions.size(); ++j)
         {
-            posElem->baseVertexPointerToElement(vertex, &pFloat);
-
-            Vector3 pt;
-
-            pt.x = (*pFloat++);
-            pt.y = (*pFloat++);
-            pt.z = (*pFloat++);
             // Transform to world (scale, rotate, translate)
-            pt = (orientation * (pt * scale)) + position;
+            Vector3 pt = (orientation * (positions[j] * scale)) + position;
             if (first)
             {
                 min = max = pt;
@@ -268,7 +255,6 @@ namespace Ogre {
             }
 
         }
-        vbuf->unlock();
         return AxisAlignedBox(min, max);
     }
     //--------------------------------------------------------------------------
@@ -290,11 +276,14 @@ namespace Ogre {
         for (uint i = 0; i < ent->getNumSubEntities(); ++i)
         {
             SubEntity* se = ent->getSubEntity(i);
-            QueuedSubMesh* q = OGRE_NEW QueuedSubMesh();
-
             // Get the geometry for this SubMesh
+            SubMeshLodGeometryLinkList* geometryLodList = determineGeometry(se->getSubMesh());
+
+            QueuedSubMesh* q = OGRE_NEW QueuedSubMesh();
             q->submesh = se->getSubMesh();
-            q->geometryLodList = determineGeometry(q->submesh);
+            q->entity = ent;
+            q->region = 0;
+            q->geometryLodList = geometryLodList;
             q->materialName = se->getMaterialName();
             q->orientation = orientation;
             q->position = position;
@@ -318,6 +307,24 @@ namespace Ogre {
         {
             return i->second;
         }
+        // The buckets keep the source vertex format, but transform positions
+        // and directions as floats
+        const VertexData* vd = sm->useSharedVertices ? sm->parent->sharedVertexData : sm->vertexData;
+        const VertexDeclaration::VertexElementList& elems = vd->vertexDeclaration->getElements();
+        for (VertexDeclaration::VertexElementList::const_iterator e = elems.begin(); e != elems.end(); ++e)
+        {
+            VertexElementSemantic sem = e->getSemantic();
+            bool isFloat = e->getType() == VET_FLOAT3 || (sem == VES_TANGENT && e->getType() == VET_FLOAT4);
+            if (!isFloat && (sem == VES_POSITION || sem == VES_NORMAL || sem == VES_TANGENT || sem == VES_BINORMAL))
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                    "Mesh '" + sm->parent->getName() + "' has quantised or packed " +
+                    (sem == VES_POSITION ? "positions" : "directions") +
+                    ", which StaticGeometry can not transform. Use VET_FLOAT3 instead.",
+                    "StaticGeometry::determineGeometry");
+            }
+        }
+
         // Otherwise, we have to create a new one
         SubMeshLodGeometryLinkList* lodList = OGRE_NEW_T(SubMeshLodGeometryLinkList, MEMCATEGORY_GEOMETRY)();
         mSubMeshGeometryLookup[sm] = lodList;
@@ -535,6 +542,27 @@ namespace Ogre {
         }
     }
     //--------------------------------------------------------------------------
+    void StaticGeometry::removeEntity(const Entity* ent)
+    {
+        QueuedSubMeshList::iterator dst = mQueuedSubMeshes.begin();
+        for (QueuedSubMeshList::iterator qi = mQueuedSubMeshes.begin();
+            qi != mQueuedSubMeshes.end(); ++qi)
+        {
+            QueuedSubMesh* qsm = *qi;
+            if (qsm->entity == ent)
+            {
+                if (qsm->region)
+                    mDirtyRegions.insert(qsm->region);
+                OGRE_DELETE qsm;
+            }
+            else
+            {
+                *dst++ = qsm;
+            }
+        }
+        mQueuedSubMeshes.erase(dst, mQueuedSubMeshes.end());
+    }
+    //--------------------------------------------------------------------------
     void StaticGeometry::build(void)
     {
         // Make sure there's nothing from previous builds
@@ -547,23 +575,138 @@ namespace Ogre {
             QueuedSubMesh* qsm = *qi;
             Region* region = getRegion(qsm->worldBounds, true);
             region->assign(qsm);
+            qsm->region = region;
         }
+
+        // Now tell each region to build itself
+        std::vector<Region*> regions;
+        regions.reserve(mRegionMap.size());
+        for (RegionMap::iterator ri = mRegionMap.begin();
+            ri != mRegionMap.end(); ++ri)
+        {
+            regions.push_back(ri->second);
+        }
+        buildRegions(regions);
+
+        mBuilt = true;
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::rebuildDirtyRegions(void)
+    {
+        if (!mBuilt)
+        {
+            build();
+            return;
+        }
+
+        // Newly queued meshes dirty the region they land in
+        for (QueuedSubMeshList::iterator qi = mQueuedSubMeshes.begin();
+            qi != mQueuedSubMeshes.end(); ++qi)
+        {
+            QueuedSubMesh* qsm = *qi;
+            if (!qsm->region)
+            {
+                qsm->region = getRegion(qsm->worldBounds, true);
+                mDirtyRegions.insert(qsm->region);
+            }
+        }
+        if (mDirtyRegions.empty())
+            return;
+
+        // Reassign everything which still belongs to the dirty regions
+        for (std::set<Region*>::iterator ri = mDirtyRegions.begin();
+            ri != mDirtyRegions.end(); ++ri)
+        {
+            (*ri)->_clear();
+        }
+        std::set<Region*> usedRegions;
+        for (QueuedSubMeshList::iterator qi = mQueuedSubMeshes.begin();
+            qi != mQueuedSubMeshes.end(); ++qi)
+        {
+            QueuedSubMesh* qsm = *qi;
+            if (mDirtyRegions.find(qsm->region) != mDirtyRegions.end())
+            {
+                qsm->region->assign(qsm);
+                usedRegions.insert(qsm->region);
+            }
+        }
+
+        std::vector<Region*> regions;
+        for (std::set<Region*>::iterator ri = mDirtyRegions.begin();
+            ri != mDirtyRegions.end(); ++ri)
+        {
+            Region* region = *ri;
+            if (usedRegions.find(region) != usedRegions.end())
+            {
+                regions.push_back(region);
+            }
+            else
+            {
+                // Nothing left in it
+                mRegionMap.erase(region->getID());
+                mOwner->extractMovableObject(region);
+                OGRE_DELETE region;
+            }
+        }
+        mDirtyRegions.clear();
+
+        buildRegions(regions);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::buildRegions(const std::vector<Region*>& regions)
+    {
         bool stencilShadows = false;
         if (mCastShadows && mOwner->isShadowTechniqueStencilBased())
         {
             stencilShadows = true;
         }
 
-        // Now tell each region to build itself
-        for (RegionMap::iterator ri = mRegionMap.begin();
-            ri != mRegionMap.end(); ++ri)
+        // Scene graph, materials and buffer creation are not thread safe
+        std::vector<GeometryBucket*> buckets;
+        for (size_t r = 0; r < regions.size(); ++r)
         {
-            ri->second->build(stencilShadows);
-            
-            // Set the visibility flags on these regions
-            ri->second->setVisibilityFlags(mVisibilityFlags);
+            regions[r]->_beginBuild(stencilShadows);
+            regions[r]->_getGeometryBuckets(buckets);
+        }
+
+        if (buckets.size() > 1)
+        {
+            // Many buckets copy from the same mesh, and a buffer can only be
+            // locked once, so lock each source up front for all threads
+            std::vector<HardwareBuffer*> sources;
+            for (size_t i = 0; i < buckets.size(); ++i)
+                buckets[i]->_getSourceBuffers(sources);
+            SourceLockMap sourceLocks;
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                if (sourceLocks.find(sources[i]) == sourceLocks.end())
+                {
+                    sourceLocks[sources[i]] = static_cast<const uchar*>(
+                        sources[i]->lock(HardwareBuffer::HBL_READ_ONLY));
+                }
+            }
+
+            // Buckets never share a destination buffer
+            WorkQueue::parallelForDefault(buckets.size(), [&buckets, &sourceLocks](size_t i) {
+                buckets[i]->_copyGeometry(&sourceLocks);
+            });
+
+            for (SourceLockMap::iterator i = sourceLocks.begin(); i != sourceLocks.end(); ++i)
+                i->first->unlock();
         }
+        else
+        {
+            for (size_t i = 0; i < buckets.size(); ++i)
+                buckets[i]->_copyGeometry(0);
+        }
+
+        for (size_t r = 0; r < regions.size(); ++r)
+        {
+            regions[r]->_endBuild(stencilShadows);
 
+            // Set the visibility flags on these regions
+            regions[r]->setVisibilityFlags(mVisibilityFlags);
+        }
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::destroy(void)
@@ -576,6 +719,13 @@ namespace Ogre {
             OGRE_DELETE i->second;
         }
         mRegionMap.clear();
+        mDirtyRegions.clear();
+        for (QueuedSubMeshList::iterator qi = mQueuedSubMeshes.begin();
+            qi != mQueuedSubMeshes.end(); ++qi)
+        {
+            (*qi)->region = 0;
+        }
+        mBuilt = false;
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::reset(void)
@@ -710,6 +860,11 @@ namespace Ogre {
     }
     //--------------------------------------------------------------------------
     StaticGeometry::Region::~Region()
+    {
+        _clear();
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::_clear(void)
     {
         if (mNode)
         {
@@ -726,7 +881,12 @@ namespace Ogre {
         mLodBucketList.clear();
 
         // no need to delete queued meshes, these are managed in StaticGeometry
-
+        mQueuedSubMeshes.clear();
+        mLodValues.clear();
+        mLodStrategy = 0;
+        mCurrentLod = 0;
+        mAABB.setNull();
+        mBoundingRadius = 0.0f;
     }
     //-----------------------------------------------------------------------
     void StaticGeometry::Region::_releaseManualHardwareResources()
@@ -795,6 +955,20 @@ namespace Ogre {
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::Region::build(bool stencilShadows)
+    {
+        _beginBuild(stencilShadows);
+
+        std::vector<GeometryBucket*> buckets;
+        _getGeometryBuckets(buckets);
+        for (size_t i = 0; i < buckets.size(); ++i)
+        {
+            buckets[i]->_copyGeometry(0);
+        }
+
+        _endBuild(stencilShadows);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::_beginBuild(bool stencilShadows)
     {
         // Create a node
         mNode = mSceneMgr->getRootSceneNode()->createChildSceneNode(mName,
@@ -816,11 +990,32 @@ namespace Ogre {
                 lodBucket->assign(*qi, lod);
             }
             // now build
-            lodBucket->build(stencilShadows);
+            lodBucket->_beginBuild(stencilShadows);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::_endBuild(bool stencilShadows)
+    {
+        for (LODBucketList::iterator i = mLodBucketList.begin();
+            i != mLodBucketList.end(); ++i)
+        {
+            (*i)->_endBuild(stencilShadows);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::_getGeometryBuckets(std::vector<GeometryBucket*>& buckets)
+    {
+        for (LODBucketList::iterator i = mLodBucketList.begin();
+            i != mLodBucketList.end(); ++i)
+        {
+            LODBucket::MaterialIterator mi = (*i)->getMaterialIterator();
+            while (mi.hasMoreElements())
+            {
+                MaterialBucket::GeometryIterator gi = mi.getNext()->getGeometryIterator();
+                while (gi.hasMoreElements())
+                    buckets.push_back(gi.getNext());
+            }
         }
-
-
-
     }
     //--------------------------------------------------------------------------
     const String& StaticGeometry::Region::getMovableType(void) const
@@ -1091,6 +1286,31 @@ namespace Ogre {
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::LODBucket::build(bool stencilShadows)
+    {
+        _beginBuild(stencilShadows);
+
+        for (MaterialBucketMap::iterator i = mMaterialBucketMap.begin();
+            i != mMaterialBucketMap.end(); ++i)
+        {
+            MaterialBucket::GeometryIterator gi = i->second->getGeometryIterator();
+            while (gi.hasMoreElements())
+                gi.getNext()->_copyGeometry(0);
+        }
+
+        _endBuild(stencilShadows);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::LODBucket::_beginBuild(bool stencilShadows)
+    {
+        // Just pass this on to child buckets
+        for (MaterialBucketMap::iterator i = mMaterialBucketMap.begin();
+            i != mMaterialBucketMap.end(); ++i)
+        {
+            i->second->_beginBuild(stencilShadows);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::LODBucket::_endBuild(bool stencilShadows)
     {
 
         EdgeListBuilder eb;
@@ -1102,7 +1322,7 @@ namespace Ogre {
         {
             MaterialBucket* mat = i->second;
 
-            mat->build(stencilShadows);
+            mat->_endBuild(stencilShadows);
 
             if (stencilShadows)
             {
@@ -1303,6 +1523,17 @@ namespace Ogre {
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::MaterialBucket::build(bool stencilShadows)
+    {
+        _beginBuild(stencilShadows);
+        for (GeometryBucketList::iterator i = mGeometryBucketList.begin();
+            i != mGeometryBucketList.end(); ++i)
+        {
+            (*i)->_copyGeometry(0);
+        }
+        _endBuild(stencilShadows);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::MaterialBucket::_beginBuild(bool stencilShadows)
     {
         mTechnique = 0;
         mMaterial = MaterialManager::getSingleton().getByName(mMaterialName);
@@ -1317,7 +1548,16 @@ namespace Ogre {
         for (GeometryBucketList::iterator i = mGeometryBucketList.begin();
             i != mGeometryBucketList.end(); ++i)
         {
-            (*i)->build(stencilShadows);
+            (*i)->_beginBuild(stencilShadows);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::MaterialBucket::_endBuild(bool stencilShadows)
+    {
+        for (GeometryBucketList::iterator i = mGeometryBucketList.begin();
+            i != mGeometryBucketList.end(); ++i)
+        {
+            (*i)->_endBuild(stencilShadows);
         }
     }
     //--------------------------------------------------------------------------
@@ -1413,7 +1653,7 @@ namespace Ogre {
     StaticGeometry::GeometryBucket::GeometryBucket(MaterialBucket* parent,
         const String& formatString, const VertexData* vData,
         const IndexData* iData)
-        : Renderable(), mParent(parent), mFormatString(formatString)
+        : Renderable(), mParent(parent), mFormatString(formatString), mIndexLock(0)
     {
         // Clone the structure from the example
         mVertexData = vData->clone(false);
@@ -1530,6 +1770,13 @@ namespace Ogre {
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::GeometryBucket::build(bool stencilShadows)
+    {
+        _beginBuild(stencilShadows);
+        _copyGeometry(0);
+        _endBuild(stencilShadows);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::GeometryBucket::_beginBuild(bool stencilShadows)
     {
         // Ok, here's where we transfer the vertices and indexes to the shared
         // buffers
@@ -1541,25 +1788,12 @@ namespace Ogre {
         mIndexData->indexBuffer = HardwareBufferManager::getSingleton()
             .createIndexBuffer(mIndexType, mIndexData->indexCount,
                 HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-        uint32* p32Dest = 0;
-        uint16* p16Dest = 0;
-        if (mIndexType == HardwareIndexBuffer::IT_32BIT)
-        {
-            p32Dest = static_cast<uint32*>(
-                mIndexData->indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
-        }
-        else
-        {
-            p16Dest = static_cast<uint16*>(
-                mIndexData->indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
-        }
+        mIndexLock = mIndexData->indexBuffer->lock(HardwareBuffer::HBL_DISCARD);
         // create all vertex buffers, and lock
-        ushort b;
         ushort posBufferIdx = dcl->findElementBySemantic(VES_POSITION)->getSource();
 
-        std::vector<uchar*> destBufferLocks;
-        std::vector<VertexDeclaration::VertexElementList> bufferElements;
-        for (b = 0; b < binds->getBufferCount(); ++b)
+        mVertexLocks.clear();
+        for (ushort b = 0; b < binds->getBufferCount(); ++b)
         {
             size_t vertexCount = mVertexData->vertexCount;
             // Need to double the vertex count for the position buffer
@@ -1579,11 +1813,48 @@ namespace Ogre {
             binds->setBinding(b, vbuf);
             uchar* pLock = static_cast<uchar*>(
                 vbuf->lock(HardwareBuffer::HBL_DISCARD));
-            destBufferLocks.push_back(pLock);
-            // Pre-cache vertex elements per buffer
-            bufferElements.push_back(dcl->findElementsBySource(b));
+            mVertexLocks.push_back(pLock);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::GeometryBucket::_getSourceBuffers(std::vector<HardwareBuffer*>& buffers) const
+    {
+        for (QueuedGeometryList::const_iterator gi = mQueuedGeometry.begin();
+            gi != mQueuedGeometry.end(); ++gi)
+        {
+            const SubMeshLodGeometryLink* geom = (*gi)->geometry;
+            buffers.push_back(geom->indexData->indexBuffer.get());
+            VertexBufferBinding* srcBinds = geom->vertexData->vertexBufferBinding;
+            for (ushort b = 0; b < mVertexData->vertexBufferBinding->getBufferCount(); ++b)
+            {
+                buffers.push_back(srcBinds->getBuffer(b).get());
+            }
         }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::GeometryBucket::_copyGeometry(const SourceLockMap* sourceLocks)
+    {
+        VertexDeclaration* dcl = mVertexData->vertexDeclaration;
+        VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
+        ushort b;
 
+        uint32* p32Dest = 0;
+        uint16* p16Dest = 0;
+        if (mIndexType == HardwareIndexBuffer::IT_32BIT)
+        {
+            p32Dest = static_cast<uint32*>(mIndexLock);
+        }
+        else
+        {
+            p16Dest = static_cast<uint16*>(mIndexLock);
+        }
+        std::vector<uchar*> destBufferLocks(mVertexLocks);
+        // Pre-cache vertex elements per buffer
+        std::vector<VertexDeclaration::VertexElementList> bufferElements;
+        for (b = 0; b < binds->getBufferCount(); ++b)
+        {
+            bufferElements.push_back(dcl->findElementsBySource(b));
+        }
 
         // Iterate over the geometry items
         size_t indexOffset = 0;
@@ -1595,32 +1866,35 @@ namespace Ogre {
             QueuedGeometry* geom = *gi;
             // Copy indexes across with offset
             IndexData* srcIdxData = geom->geometry->indexData;
-            if (mIndexType == HardwareIndexBuffer::IT_32BIT)
+            HardwareIndexBuffer* srcIdxBuf = srcIdxData->indexBuffer.get();
+            const void* pSrcIdx;
+            if (sourceLocks)
+            {
+                pSrcIdx = sourceLocks->find(srcIdxBuf)->second +
+                    srcIdxData->indexStart * srcIdxBuf->getIndexSize();
+            }
+            else
             {
                 // Lock source indexes
-                uint32* pSrc = static_cast<uint32*>(
-                    srcIdxData->indexBuffer->lock(
-                        srcIdxData->indexStart * srcIdxData->indexBuffer->getIndexSize(), 
-                        srcIdxData->indexCount * srcIdxData->indexBuffer->getIndexSize(),
-                        HardwareBuffer::HBL_READ_ONLY));
-
-                copyIndexes(pSrc, p32Dest, srcIdxData->indexCount, indexOffset);
+                pSrcIdx = srcIdxBuf->lock(
+                    srcIdxData->indexStart * srcIdxBuf->getIndexSize(),
+                    srcIdxData->indexCount * srcIdxBuf->getIndexSize(),
+                    HardwareBuffer::HBL_READ_ONLY);
+            }
+            if (mIndexType == HardwareIndexBuffer::IT_32BIT)
+            {
+                copyIndexes(static_cast<const uint32*>(pSrcIdx), p32Dest,
+                    srcIdxData->indexCount, indexOffset);
                 p32Dest += srcIdxData->indexCount;
-                srcIdxData->indexBuffer->unlock();
             }
             else
             {
-                // Lock source indexes
-                uint16* pSrc = static_cast<uint16*>(
-                    srcIdxData->indexBuffer->lock(
-                    srcIdxData->indexStart * srcIdxData->indexBuffer->getIndexSize(), 
-                    srcIdxData->indexCount * srcIdxData->indexBuffer->getIndexSize(),
-                    HardwareBuffer::HBL_READ_ONLY));
-
-                copyIndexes(pSrc, p16Dest, srcIdxData->indexCount, indexOffset);
+                copyIndexes(static_cast<const uint16*>(pSrcIdx), p16Dest,
+                    srcIdxData->indexCount, indexOffset);
                 p16Dest += srcIdxData->indexCount;
-                srcIdxData->indexBuffer->unlock();
             }
+            if (!sourceLocks)
+                srcIdxBuf->unlock();
 
             // Now deal with vertex buffers
             // we can rely on buffer counts / formats being the same
@@ -1631,8 +1905,9 @@ namespace Ogre {
                 // lock source
                 HardwareVertexBufferSharedPtr srcBuf =
                     srcBinds->getBuffer(b);
-                uchar* pSrcBase = static_cast<uchar*>(
-                    srcBuf->lock(HardwareBuffer::HBL_READ_ONLY));
+                uchar* pSrcBase = sourceLocks ?
+                    const_cast<uchar*>(sourceLocks->find(srcBuf.get())->second) :
+                    static_cast<uchar*>(srcBuf->lock(HardwareBuffer::HBL_READ_ONLY));
                 // Get buffer lock pointer, we'll update this later
                 uchar* pDstBase = destBufferLocks[b];
                 size_t bufInc = srcBuf->getVertexSize();
@@ -1701,18 +1976,28 @@ namespace Ogre {
 
                 // Update pointer
                 destBufferLocks[b] = pDstBase;
-                srcBuf->unlock();
+                if (!sourceLocks)
+                    srcBuf->unlock();
             }
 
             indexOffset += geom->geometry->vertexData->vertexCount;
         }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::GeometryBucket::_endBuild(bool stencilShadows)
+    {
+        VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
+        ushort posBufferIdx =
+            mVertexData->vertexDeclaration->findElementBySemantic(VES_POSITION)->getSource();
 
         // Unlock everything
         mIndexData->indexBuffer->unlock();
-        for (b = 0; b < binds->getBufferCount(); ++b)
+        for (ushort b = 0; b < binds->getBufferCount(); ++b)
         {
             binds->getBuffer(b)->unlock();
         }
+        mIndexLock = 0;
+        mVertexLocks.clear();
 
         // If we're dealing with stencil shadows, copy the position data from
         // the early half of the buffer to the latter part
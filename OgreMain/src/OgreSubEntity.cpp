@@ -29,12 +29,18 @@ THE SOFTWARE.
 
 #include "OgreEntity.h"
 #include "OgreSubEntity.h"
+#include "OgreCamera.h"
+#include "OgreTechnique.h"
+#include "OgrePass.h"
+#include "OgreSceneManager.h"
 
 namespace Ogre {
     //-----------------------------------------------------------------------
     SubEntity::SubEntity (Entity* parent, SubMesh* subMeshBasis)
         : Renderable(), mParentEntity(parent),
-        mSubMesh(subMeshBasis), mMaterialLodIndex(0), mCachedCamera(0)
+        mSubMesh(subMeshBasis), mMaterialLodIndex(0), mCachedCamera(0),
+        mCompactedMeshletSource(0),
+        mUseVisibleMeshlets(false)
     {
         mVisible = true;
         mRenderQueueID = 0;
@@ -120,6 +126,124 @@ namespace Ogre {
             op.indexData->indexStart = mIndexStart;
             op.indexData->indexCount = mIndexEnd;
         }
+        else if (mUseVisibleMeshlets)
+        {
+            op.indexData = mVisibleMeshletIndexData.get();
+        }
+    }
+    //-----------------------------------------------------------------------
+    void SubEntity::updateVisibleMeshlets(const Camera* cam)
+    {
+        mUseVisibleMeshlets = false;
+
+        const SubMesh::MeshletList& meshlets = mSubMesh->meshlets;
+        if (!cam || meshlets.empty() || mIndexStart != mIndexEnd || !mParentEntity->getParentNode())
+            return;
+
+        const Affine3& world = mParentEntity->_getParentNodeFullTransform();
+        Vector3 scale = mParentEntity->getParentNode()->_getDerivedScale();
+        Real radiusScale = std::max(std::max(Math::Abs(scale.x), Math::Abs(scale.y)), Math::Abs(scale.z));
+
+        // Back facing meshlets can only be dropped if all passes cull them, for the
+        // camera actually seeing the mesh and if the transform does not mirror it
+        bool coneCulling = cam->getProjectionType() == PT_PERSPECTIVE && world.determinant() > 0 &&
+                           mParentEntity->_getManager()->_getCurrentRenderStage() != SceneManager::IRS_RENDER_TO_TEXTURE;
+        Technique* tech = coneCulling ? getTechnique() : 0;
+        if (!tech)
+            coneCulling = false;
+        for (unsigned short p = 0; coneCulling && p < tech->getNumPasses(); ++p)
+            coneCulling = tech->getPass(p)->getCullingMode() == CULL_CLOCKWISE;
+
+        // Cone test happens in mesh space, frustum test in world space. A reflected camera
+        // flips the winding, so the faces it keeps are those facing the mirrored eye
+        Vector3 eye = cam->getDerivedPosition();
+        if (cam->isReflected())
+            eye = cam->getReflectionMatrix() * eye;
+        eye = world.inverse() * eye;
+
+        mVisibleMeshletRanges.clear();
+        uint32 visibleCount = 0;
+        uint32 visibleIndexCount = 0;
+        for (size_t i = 0; i < meshlets.size(); ++i)
+        {
+            const SubMesh::Meshlet& meshlet = meshlets[i];
+            if (coneCulling && meshlet.coneCutoff < 1)
+            {
+                Vector3 toCentre = meshlet.centre - eye;
+                if (toCentre.dotProduct(meshlet.coneAxis) >=
+                    meshlet.coneCutoff * toCentre.length() + meshlet.radius)
+                    continue;
+            }
+            if (!cam->isVisible(Sphere(world * meshlet.centre, meshlet.radius * radiusScale)))
+                continue;
+
+            visibleCount++;
+            visibleIndexCount += meshlet.indexCount;
+            uint32 end = meshlet.indexStart + meshlet.indexCount;
+            if (!mVisibleMeshletRanges.empty() && mVisibleMeshletRanges.back().second == meshlet.indexStart)
+                mVisibleMeshletRanges.back().second = end;
+            else
+                mVisibleMeshletRanges.push_back(std::make_pair(meshlet.indexStart, end));
+        }
+
+        // Nothing to gain, draw the submesh as usual
+        if (visibleCount == meshlets.size())
+            return;
+
+        const IndexData* source = mSubMesh->indexData;
+        if (!mVisibleMeshletIndexData)
+            mVisibleMeshletIndexData.reset(OGRE_NEW IndexData());
+        IndexData* visible = mVisibleMeshletIndexData.get();
+        mUseVisibleMeshlets = true;
+
+        if (mVisibleMeshletRanges.empty())
+        {
+            visible->indexCount = 0;
+            return;
+        }
+
+        // A single range, or no CPU copy to compact from: draw the span covering all visible meshlets
+        if (mVisibleMeshletRanges.size() == 1 ||
+            !(source->indexBuffer->hasShadowBuffer() || source->indexBuffer->isSystemMemory()))
+        {
+            visible->indexBuffer = source->indexBuffer;
+            visible->indexStart = source->indexStart + mVisibleMeshletRanges.front().first;
+            visible->indexCount = mVisibleMeshletRanges.back().second - mVisibleMeshletRanges.front().first;
+            return;
+        }
+
+        // The buffer still holds these meshlets while neither the camera nor the object move
+        if (!mVisibleMeshletIndexBuffer || mCompactedMeshletSource != source->indexBuffer.get() ||
+            mCompactedMeshletRanges != mVisibleMeshletRanges)
+        {
+            if (!mVisibleMeshletIndexBuffer ||
+                mVisibleMeshletIndexBuffer->getType() != source->indexBuffer->getType() ||
+                mVisibleMeshletIndexBuffer->getNumIndexes() < source->indexCount)
+            {
+                // kept from frame to frame, so not discardable
+                mVisibleMeshletIndexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+                    source->indexBuffer->getType(), source->indexCount, HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY);
+            }
+
+            size_t indexSize = source->indexBuffer->getIndexSize();
+            HardwareIndexBufferLockGuard srcLock(source->indexBuffer, HardwareBuffer::HBL_READ_ONLY);
+            HardwareIndexBufferLockGuard dstLock(mVisibleMeshletIndexBuffer, HardwareBuffer::HBL_DISCARD);
+            const uchar* src = static_cast<const uchar*>(srcLock.pData) + source->indexStart * indexSize;
+            uchar* dst = static_cast<uchar*>(dstLock.pData);
+            for (size_t i = 0; i < mVisibleMeshletRanges.size(); ++i)
+            {
+                uint32 rangeCount = mVisibleMeshletRanges[i].second - mVisibleMeshletRanges[i].first;
+                memcpy(dst, src + mVisibleMeshletRanges[i].first * indexSize, rangeCount * indexSize);
+                dst += rangeCount * indexSize;
+            }
+
+            mCompactedMeshletRanges = mVisibleMeshletRanges;
+            mCompactedMeshletSource = source->indexBuffer.get();
+        }
+
+        visible->indexBuffer = mVisibleMeshletIndexBuffer;
+        visible->indexStart = 0;
+        visible->indexCount = visibleIndexCount;
     }
     //-----------------------------------------------------------------------
     void SubEntity::setIndexDataStartIndex(size_t start_index)
@@ -185,6 +309,18 @@ namespace Ogre {
         {
             // No skeletal animation, or software skinning
             *xform = mParentEntity->_getParentNodeFullTransform();
+
+            // Restore quantised positions to object space
+            const VertexData* vertexData = mSubMesh->useSharedVertices ?
+                mSubMesh->parent->sharedVertexData : mSubMesh->vertexData;
+            if (vertexData && vertexData->positionDecode != Vector4(0, 0, 0, 1))
+            {
+                const Vector4& decode = vertexData->positionDecode;
+                Affine3 decodeXform;
+                decodeXform.makeTransform(Vector3(decode.x, decode.y, decode.z),
+                    Vector3(decode.w), Quaternion::IDENTITY);
+                *xform = mParentEntity->_getParentNodeFullTransform() * decodeXform;
+            }
         }
         else
         {
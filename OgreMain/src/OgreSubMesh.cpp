@@ -442,6 +442,183 @@ namespace Ogre {
         vbuf->unlock ();
     }
     //---------------------------------------------------------------------
+    void SubMesh::buildMeshlets(size_t maxTriangles)
+    {
+        meshlets.clear();
+
+        if (operationType != RenderOperation::OT_TRIANGLE_LIST || !indexData->indexBuffer ||
+            indexData->indexCount < 3 || maxTriangles == 0)
+            return;
+
+        // Reordering would break LOD levels referencing ranges of our buffer
+        for (size_t i = 0; i < mLodFaceList.size(); ++i)
+        {
+            if (mLodFaceList[i]->indexBuffer == indexData->indexBuffer)
+                return;
+        }
+
+        const VertexData* vert = useSharedVertices ? parent->sharedVertexData : vertexData;
+        // Meshlet bounds are in object space, so quantised positions are decoded
+        std::vector<Vector3> positions;
+        vert->readPositions(positions);
+        if (positions.empty())
+            return;
+
+        const size_t numTris = indexData->indexCount / 3;
+        const size_t indexCount = numTris * 3;
+        const bool use32bit = indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT;
+        const size_t indexSize = indexData->indexBuffer->getIndexSize();
+
+        std::vector<uint32> indices(indexCount);
+        {
+            HardwareIndexBufferLockGuard indexLock(indexData->indexBuffer,
+                                                   indexData->indexStart * indexSize,
+                                                   indexCount * indexSize, HardwareBuffer::HBL_READ_ONLY);
+            if (use32bit)
+                memcpy(&indices[0], indexLock.pData, indexCount * sizeof(uint32));
+            else
+                std::copy(static_cast<uint16*>(indexLock.pData),
+                          static_cast<uint16*>(indexLock.pData) + indexCount, indices.begin());
+        }
+
+        // Triangle facing, and the triangles using each vertex (packed, indexed by vertex)
+        std::vector<Vector3> normals(numTris);
+        std::vector<uint32> vertexTriStart(vert->vertexCount + 1, 0);
+        for (size_t t = 0; t < numTris; ++t)
+        {
+            const Vector3& p0 = positions[indices[t * 3]];
+            normals[t] = (positions[indices[t * 3 + 1]] - p0).crossProduct(positions[indices[t * 3 + 2]] - p0);
+            normals[t].normalise();
+            for (size_t k = 0; k < 3; ++k)
+                ++vertexTriStart[indices[t * 3 + k] + 1];
+        }
+        for (size_t v = 0; v < vert->vertexCount; ++v)
+            vertexTriStart[v + 1] += vertexTriStart[v];
+
+        std::vector<uint32> vertexTris(indexCount);
+        {
+            std::vector<uint32> fill(vertexTriStart.begin(), vertexTriStart.end() - 1);
+            for (size_t t = 0; t < numTris; ++t)
+            {
+                for (size_t k = 0; k < 3; ++k)
+                    vertexTris[fill[indices[t * 3 + k]]++] = static_cast<uint32>(t);
+            }
+        }
+
+        std::vector<bool> triUsed(numTris, false);
+        // Meshlet (plus one) that last took each vertex, to count shared vertices
+        std::vector<uint32> vertexMeshlet(vert->vertexCount, 0);
+        std::vector<uint32> candidates;
+        std::vector<uint32> meshletTris;
+        std::vector<uint32> newIndices;
+        newIndices.reserve(indexCount);
+
+        size_t nextSeed = 0;
+        while (true)
+        {
+            while (nextSeed < numTris && triUsed[nextSeed])
+                ++nextSeed;
+            if (nextSeed == numTris)
+                break;
+
+            const uint32 tag = static_cast<uint32>(meshlets.size() + 1);
+            candidates.clear();
+            meshletTris.clear();
+
+            uint32 tri = static_cast<uint32>(nextSeed);
+            while (true)
+            {
+                triUsed[tri] = true;
+                meshletTris.push_back(tri);
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    const uint32 v = indices[tri * 3 + k];
+                    if (vertexMeshlet[v] == tag)
+                        continue;
+                    vertexMeshlet[v] = tag;
+                    for (uint32 j = vertexTriStart[v]; j < vertexTriStart[v + 1]; ++j)
+                    {
+                        if (!triUsed[vertexTris[j]])
+                            candidates.push_back(vertexTris[j]);
+                    }
+                }
+
+                if (meshletTris.size() == maxTriangles)
+                    break;
+
+                // Grow with the neighbour sharing the most vertices with the meshlet so far,
+                // dropping candidates taken in the meantime
+                uint32 best = static_cast<uint32>(numTris);
+                int bestShared = 0;
+                for (size_t c = 0; c < candidates.size();)
+                {
+                    const uint32 cand = candidates[c];
+                    if (triUsed[cand])
+                    {
+                        candidates[c] = candidates.back();
+                        candidates.pop_back();
+                        continue;
+                    }
+                    const int shared = (vertexMeshlet[indices[cand * 3]] == tag) +
+                                       (vertexMeshlet[indices[cand * 3 + 1]] == tag) +
+                                       (vertexMeshlet[indices[cand * 3 + 2]] == tag);
+                    if (shared > bestShared)
+                    {
+                        bestShared = shared;
+                        best = cand;
+                    }
+                    ++c;
+                }
+                if (best == numTris)
+                    break;
+                tri = best;
+            }
+
+            Meshlet meshlet;
+            meshlet.indexStart = static_cast<uint32>(newIndices.size());
+            meshlet.indexCount = static_cast<uint32>(meshletTris.size() * 3);
+
+            AxisAlignedBox box;
+            Vector3 normalSum = Vector3::ZERO;
+            for (size_t i = 0; i < meshletTris.size(); ++i)
+            {
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    newIndices.push_back(indices[meshletTris[i] * 3 + k]);
+                    box.merge(positions[newIndices.back()]);
+                }
+                normalSum += normals[meshletTris[i]];
+            }
+
+            meshlet.centre = box.getCenter();
+            Real radiusSq = 0;
+            for (size_t i = meshlet.indexStart; i < newIndices.size(); ++i)
+                radiusSq = std::max(radiusSq, (positions[newIndices[i]] - meshlet.centre).squaredLength());
+            meshlet.radius = Math::Sqrt(radiusSq);
+
+            // The normal cone only helps if all triangles face roughly the same way
+            meshlet.coneAxis = normalSum;
+            meshlet.coneCutoff = 1;
+            if (meshlet.coneAxis.normalise() > 0)
+            {
+                Real minDot = 1;
+                for (size_t i = 0; i < meshletTris.size(); ++i)
+                    minDot = std::min(minDot, meshlet.coneAxis.dotProduct(normals[meshletTris[i]]));
+                if (minDot > 0.1f)
+                    meshlet.coneCutoff = Math::Sqrt(1 - minDot * minDot);
+            }
+
+            meshlets.push_back(meshlet);
+        }
+
+        HardwareIndexBufferLockGuard indexLock(indexData->indexBuffer, indexData->indexStart * indexSize,
+                                               indexCount * indexSize, HardwareBuffer::HBL_NORMAL);
+        if (use32bit)
+            memcpy(indexLock.pData, &newIndices[0], indexCount * sizeof(uint32));
+        else
+            std::copy(newIndices.begin(), newIndices.end(), static_cast<uint16*>(indexLock.pData));
+    }
+    //---------------------------------------------------------------------
     void SubMesh::setBuildEdgesEnabled(bool b)
     {
         mBuildEdgesEnabled = b;
@@ -468,6 +645,7 @@ namespace Ogre {
         newSub->operationType = this->operationType;
         newSub->useSharedVertices = this->useSharedVertices;
         newSub->extremityPoints = this->extremityPoints;
+        newSub->meshlets = this->meshlets;
 
         if (!this->useSharedVertices)
         {
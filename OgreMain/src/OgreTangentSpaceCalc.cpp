@@ -27,15 +27,35 @@ THE SOFTWARE.
 */
 #include "OgreStableHeaders.h"
 #include "OgreTangentSpaceCalc.h"
+#include "OgreSIMDHelper.h"
 
 namespace Ogre
 {
+    namespace
+    {
+#if __OGRE_HAVE_SSE
+        /// Same as Vector3::normalise for four vectors
+        inline void normaliseSSE(__m128* v)
+        {
+            __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(v[0], v[0]), _mm_mul_ps(v[1], v[1])),
+                                                _mm_mul_ps(v[2], v[2])));
+            __m128 nonZero = _mm_cmpgt_ps(len, _mm_setzero_ps());
+            __m128 invLen = _mm_div_ps(_mm_set1_ps(1.0f), len);
+            for (int k = 0; k < 3; ++k)
+            {
+                v[k] = _mm_or_ps(_mm_and_ps(nonZero, _mm_mul_ps(v[k], invLen)),
+                                 _mm_andnot_ps(nonZero, v[k]));
+            }
+        }
+#endif
+    }
     //---------------------------------------------------------------------
     TangentSpaceCalc::TangentSpaceCalc()
         : mVData(0)
         , mSplitMirrored(false)
         , mSplitRotated(false)
         , mStoreParityInW(false)
+        , mFaceArrayStart(0)
     {
     }
 
@@ -210,10 +230,8 @@ namespace Ogre
     void TangentSpaceCalc::normaliseVertices()
     {
         // Just run through our complete (possibly augmented) list of vertices
-        // Normalise the tangents & binormals
-        for (VertexInfoArray::iterator i = mVertexArray.begin(); i != mVertexArray.end(); ++i)
-        {
-            VertexInfo& v = *i;
+        WorkQueue::parallelForDefault(mVertexArray.size(), [this](size_t i) {
+            VertexInfo& v = mVertexArray[i];
 
             v.tangent.normalise();
             v.binormal.normalise();
@@ -230,8 +248,7 @@ namespace Ogre
             // renormalize 
             v.tangent.normalise();
             v.binormal.normalise();
-
-        }
+        });
     }
     //---------------------------------------------------------------------
     void TangentSpaceCalc::processFaces(Result& result)
@@ -247,6 +264,73 @@ namespace Ogre
             }
         }
 
+        populateFaceVertices();
+        const size_t faceCount = mFaceVertices.size() / 3;
+
+        // Splits depend on the tangent space accumulated so far, those need the faces in order
+        if (!mSplitMirrored && !mSplitRotated)
+        {
+            // Face tangent spaces are independent of each other, four at a time for SSE
+            mFaceArray.resize(faceCount);
+            mFaceArrayStart = 0;
+            WorkQueue::parallelForDefault((faceCount + 3) / 4, [this, faceCount](size_t i) {
+                calculateFaces(i * 4, std::min(i * 4 + 4, faceCount));
+            });
+
+            // Gather the faces around each vertex, in face order so that sums come
+            // out the same as when accumulating face by face
+            mVertexFaceStart.assign(mVertexArray.size() + 1, 0);
+            for (size_t i = 0; i < mFaceVertices.size(); ++i)
+                ++mVertexFaceStart[mFaceVertices[i] + 1];
+            for (size_t v = 0; v < mVertexArray.size(); ++v)
+                mVertexFaceStart[v + 1] += mVertexFaceStart[v];
+
+            mVertexFaces.resize(mFaceVertices.size());
+            std::vector<uint32> fill(mVertexFaceStart.begin(), mVertexFaceStart.end() - 1);
+            for (size_t i = 0; i < mFaceVertices.size(); ++i)
+                mVertexFaces[fill[mFaceVertices[i]]++] = static_cast<uint32>(i);
+
+            WorkQueue::parallelForDefault(mVertexArray.size(), [this](size_t v) { accumulateVertex(v); });
+
+            std::vector<uint32>().swap(mVertexFaces);
+            std::vector<uint32>().swap(mVertexFaceStart);
+        }
+        else
+        {
+            // A batch of faces at a time, keeps the working set small
+            const size_t batchSize = 1024;
+            mFaceArray.resize(std::min(batchSize, faceCount));
+            size_t indexSet = 0;
+            for (mFaceArrayStart = 0; mFaceArrayStart < faceCount; mFaceArrayStart += batchSize)
+            {
+                size_t batchEnd = std::min(mFaceArrayStart + batchSize, faceCount);
+                calculateFaces(mFaceArrayStart, batchEnd);
+
+                for (size_t f = mFaceArrayStart; f < batchEnd; ++f)
+                {
+                    const FaceInfo& face = mFaceArray[f - mFaceArrayStart];
+                    // Skip invalid UV space triangles
+                    if (face.tsU.isZeroLength() || face.tsV.isZeroLength())
+                        continue;
+
+                    while (f >= mIndexSetFaceStart[indexSet + 1])
+                        ++indexSet;
+                    size_t localVertInd[3] = { mFaceVertices[f * 3], mFaceVertices[f * 3 + 1],
+                                               mFaceVertices[f * 3 + 2] };
+                    addFaceTangentSpaceToVertices(indexSet, f - mIndexSetFaceStart[indexSet], localVertInd,
+                        face.tsU, face.tsV, face.norm, face.angleWeight, result);
+                }
+            }
+        }
+
+        FaceInfoArray().swap(mFaceArray);
+        std::vector<uint32>().swap(mFaceVertices);
+    }
+    //---------------------------------------------------------------------
+    void TangentSpaceCalc::populateFaceVertices()
+    {
+        mFaceVertices.clear();
+        mIndexSetFaceStart.assign(1, 0);
         for (size_t i = 0; i < mIDataList.size(); ++i)
         {
             IndexData* i_in = mIDataList[i];
@@ -276,6 +360,8 @@ namespace Ogre
             // loop through all faces to calculate the tangents and normals
             size_t faceCount = opType == RenderOperation::OT_TRIANGLE_LIST ? 
                 i_in->indexCount / 3 : i_in->indexCount - 2;
+            mFaceVertices.reserve(mFaceVertices.size() + faceCount * 3);
+            mIndexSetFaceStart.push_back(mIndexSetFaceStart.back() + faceCount);
             for (size_t f = 0; f < faceCount; ++f)
             {
                 bool invertOrdering = false;
@@ -324,30 +410,163 @@ namespace Ogre
                 }
 
 
-                // For each triangle
-                //   Calculate tangent & binormal per triangle
-                //   Note these are not normalised, are weighted by UV area
-                Vector3 faceTsU, faceTsV, faceNorm;
-                calculateFaceTangentSpace(localVertInd, faceTsU, faceTsV, faceNorm);
+                for (size_t v = 0; v < 3; ++v)
+                    mFaceVertices.push_back(static_cast<uint32>(localVertInd[v]));
+            }
 
-                // Skip invalid UV space triangles
-                if (faceTsU.isZeroLength() || faceTsV.isZeroLength())
-                    continue;
 
-                addFaceTangentSpaceToVertices(i, f, localVertInd, faceTsU, faceTsV, faceNorm, result);
+            ibuf->unlock();
+        }
 
+    }
+    //---------------------------------------------------------------------
+    void TangentSpaceCalc::calculateFaces(size_t begin, size_t end)
+    {
+        size_t f = begin;
+#if __OGRE_HAVE_SSE
+        // Four faces at a time, same operations as calculateFaceTangentSpace
+        for (; f + 4 <= end; f += 4)
+        {
+            float d1[3][4], d2[3][4], e1[3][4], e2[3][4], duv1[2][4], duv2[2][4];
+            for (size_t j = 0; j < 4; ++j)
+            {
+                const uint32* vertInd = &mFaceVertices[(f + j) * 3];
+                const VertexInfo& v0 = mVertexArray[vertInd[0]];
+                const VertexInfo& v1 = mVertexArray[vertInd[1]];
+                const VertexInfo& v2 = mVertexArray[vertInd[2]];
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    d1[k][j] = v1.pos[k] - v0.pos[k];
+                    d2[k][j] = v2.pos[k] - v0.pos[k];
+                    e1[k][j] = v2.pos[k] - v1.pos[k];
+                    e2[k][j] = v0.pos[k] - v2.pos[k];
+                }
+                for (size_t k = 0; k < 2; ++k)
+                {
+                    duv1[k][j] = v1.uv[k] - v0.uv[k];
+                    duv2[k][j] = v2.uv[k] - v0.uv[k];
+                }
             }
+            const __m128 d1x = _mm_loadu_ps(d1[0]), d1y = _mm_loadu_ps(d1[1]), d1z = _mm_loadu_ps(d1[2]);
+            const __m128 d2x = _mm_loadu_ps(d2[0]), d2y = _mm_loadu_ps(d2[1]), d2z = _mm_loadu_ps(d2[2]);
+            const __m128 duv1x = _mm_loadu_ps(duv1[0]), duv1y = _mm_loadu_ps(duv1[1]);
+            const __m128 duv2x = _mm_loadu_ps(duv2[0]), duv2y = _mm_loadu_ps(duv2[1]);
+
+            // face normal
+            __m128 n[3];
+            n[0] = _mm_sub_ps(_mm_mul_ps(d1y, d2z), _mm_mul_ps(d1z, d2y));
+            n[1] = _mm_sub_ps(_mm_mul_ps(d1z, d2x), _mm_mul_ps(d1x, d2z));
+            n[2] = _mm_sub_ps(_mm_mul_ps(d1x, d2y), _mm_mul_ps(d1y, d2x));
+            normaliseSSE(n);
+
+            const __m128 uvarea = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(duv1x, duv2y), _mm_mul_ps(duv1y, duv2x)),
+                                             _mm_set1_ps(0.5f));
+            const __m128 absArea = _mm_andnot_ps(_mm_set1_ps(-0.0f), uvarea);
+            // no tangent for null uv area
+            const __m128 valid = _mm_cmpgt_ps(absArea, _mm_set1_ps(std::numeric_limits<float>::epsilon()));
 
+            // Normalise by uvarea
+            const __m128 a = _mm_div_ps(duv2y, uvarea);
+            const __m128 b = _mm_div_ps(_mm_sub_ps(_mm_setzero_ps(), duv1y), uvarea);
+            const __m128 c = _mm_div_ps(_mm_sub_ps(_mm_setzero_ps(), duv2x), uvarea);
+            const __m128 d = _mm_div_ps(duv1x, uvarea);
+
+            __m128 tsU[3], tsV[3];
+            tsU[0] = _mm_add_ps(_mm_mul_ps(d1x, a), _mm_mul_ps(d2x, b));
+            tsU[1] = _mm_add_ps(_mm_mul_ps(d1y, a), _mm_mul_ps(d2y, b));
+            tsU[2] = _mm_add_ps(_mm_mul_ps(d1z, a), _mm_mul_ps(d2z, b));
+            tsV[0] = _mm_add_ps(_mm_mul_ps(d1x, c), _mm_mul_ps(d2x, d));
+            tsV[1] = _mm_add_ps(_mm_mul_ps(d1y, c), _mm_mul_ps(d2y, d));
+            tsV[2] = _mm_add_ps(_mm_mul_ps(d1z, c), _mm_mul_ps(d2z, d));
+            normaliseSSE(tsU);
+            normaliseSSE(tsV);
+
+            // Angle weights, the same as calculateAngleWeight for each corner
+            const __m128 edges[3][3] = {
+                { d1x, d1y, d1z },
+                { _mm_loadu_ps(e1[0]), _mm_loadu_ps(e1[1]), _mm_loadu_ps(e1[2]) },
+                { _mm_loadu_ps(e2[0]), _mm_loadu_ps(e2[1]), _mm_loadu_ps(e2[2]) } };
+            __m128 edgeLen[3];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                edgeLen[k] = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(edges[k][0], edges[k][0]), _mm_mul_ps(edges[k][1], edges[k][1])),
+                    _mm_mul_ps(edges[k][2], edges[k][2])));
+            }
+            float cosAngle[3][4];
+            for (size_t v = 0; v < 3; ++v)
+            {
+                const __m128* diff0 = edges[v];
+                const __m128* diff1 = edges[(v + 1) % 3];
+                __m128 lenProduct = _mm_max_ps(_mm_mul_ps(edgeLen[v], edgeLen[(v + 1) % 3]),
+                                               _mm_set1_ps(1e-6f));
+                __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(diff0[0], diff1[0]),
+                                                   _mm_mul_ps(diff0[1], diff1[1])),
+                                        _mm_mul_ps(diff0[2], diff1[2]));
+                __m128 cosine = _mm_div_ps(dot, lenProduct);
+                cosine = _mm_min_ps(_mm_max_ps(cosine, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+                _mm_storeu_ps(cosAngle[v], cosine);
+            }
 
-            ibuf->unlock();
+            float out[9][4];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                _mm_storeu_ps(out[k], _mm_and_ps(valid, _mm_mul_ps(tsU[k], absArea)));
+                _mm_storeu_ps(out[3 + k], _mm_and_ps(valid, _mm_mul_ps(tsV[k], absArea)));
+                _mm_storeu_ps(out[6 + k], n[k]);
+            }
+            for (size_t j = 0; j < 4; ++j)
+            {
+                FaceInfo& face = mFaceArray[f + j - mFaceArrayStart];
+                face.tsU = Vector3(out[0][j], out[1][j], out[2][j]);
+                face.tsV = Vector3(out[3][j], out[4][j], out[5][j]);
+                face.norm = Vector3(out[6][j], out[7][j], out[8][j]);
+                for (size_t v = 0; v < 3; ++v)
+                    face.angleWeight[v] = Math::ACos(cosAngle[v][j]).valueRadians();
+            }
+        }
+#endif
+        for (; f < end; ++f)
+        {
+            FaceInfo& face = mFaceArray[f - mFaceArrayStart];
+            size_t vertInd[3] = { mFaceVertices[f * 3], mFaceVertices[f * 3 + 1], mFaceVertices[f * 3 + 2] };
+            // Calculate tangent & binormal per triangle
+            // Note these are not normalised, are weighted by UV area
+            calculateFaceTangentSpace(vertInd, face.tsU, face.tsV, face.norm);
+            // We want to re-weight these by the angle the face makes with the vertex
+            // in order to obtain tessellation-independent results
+            for (size_t v = 0; v < 3; ++v)
+            {
+                face.angleWeight[v] = calculateAngleWeight(vertInd[v],
+                    vertInd[(v+1)%3], vertInd[(v+2)%3]);
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void TangentSpaceCalc::accumulateVertex(size_t v)
+    {
+        VertexInfo& vertex = mVertexArray[v];
+        for (uint32 j = mVertexFaceStart[v]; j < mVertexFaceStart[v + 1]; ++j)
+        {
+            const FaceInfo& face = mFaceArray[mVertexFaces[j] / 3];
+            // Skip invalid UV space triangles
+            if (face.tsU.isZeroLength() || face.tsV.isZeroLength())
+                continue;
+
+            // parity is set by the first face found
+            if (!vertex.parity)
+                vertex.parity = calculateParity(face.tsU, face.tsV, face.norm);
+
+            Real angleWeight = face.angleWeight[mVertexFaces[j] % 3];
+            vertex.tangent += (face.tsU * angleWeight);
+            vertex.binormal += (face.tsV * angleWeight);
         }
-
     }
     //---------------------------------------------------------------------
     void TangentSpaceCalc::addFaceTangentSpaceToVertices(
         size_t indexSet, size_t faceIndex, size_t *localVertInd, 
         const Vector3& faceTsU, const Vector3& faceTsV, const Vector3& faceNorm, 
-        Result& result)
+        const Real* angleWeights, Result& result)
     {
         // Calculate parity for this triangle
         int faceParity = calculateParity(faceTsU, faceTsV, faceNorm);
@@ -355,11 +574,7 @@ namespace Ogre
         for (int v = 0; v < 3; ++v)
         {
             // index 0 is vertex we're calculating, 1 and 2 are the others
-
-            // We want to re-weight these by the angle the face makes with the vertex
-            // in order to obtain tessellation-independent results
-            Real angleWeight = calculateAngleWeight(localVertInd[v], 
-                localVertInd[(v+1)%3], localVertInd[(v+2)%3]);
+            Real angleWeight = angleWeights[v];
 
 
             VertexInfo* vertex = &(mVertexArray[localVertInd[v]]);
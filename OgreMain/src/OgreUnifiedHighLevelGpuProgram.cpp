@@ -234,6 +234,14 @@ namespace Ogre
             return false;
     }
     //-----------------------------------------------------------------------
+    bool UnifiedHighLevelGpuProgram::isInstancingIncluded(void) const
+    {
+        if (_getDelegate())
+            return _getDelegate()->isInstancingIncluded();
+        else
+            return false;
+    }
+    //-----------------------------------------------------------------------
     GpuProgramParametersSharedPtr UnifiedHighLevelGpuProgram::getDefaultParameters(void)
     {
         if (_getDelegate())
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgreVertexIndexData.h"
 #include "OgreHardwareVertexBuffer.h"
+#include "OgreAxisAlignedBox.h"
 
 namespace Ogre {
 
@@ -41,6 +42,7 @@ namespace Ogre {
         vertexCount = 0;
         vertexStart = 0;
         hwAnimDataItemsUsed = 0;
+        positionDecode = Vector4(0, 0, 0, 1);
 
     }
     //---------------------------------------------------------------------
@@ -54,6 +56,7 @@ namespace Ogre {
         vertexCount = 0;
         vertexStart = 0;
         hwAnimDataItemsUsed = 0;
+        positionDecode = Vector4(0, 0, 0, 1);
     }
     //-----------------------------------------------------------------------
     VertexData::~VertexData()
@@ -103,6 +106,7 @@ namespace Ogre {
         // Basic vertex info
         dest->vertexStart = this->vertexStart;
         dest->vertexCount = this->vertexCount;
+        dest->positionDecode = this->positionDecode;
         // Copy elements
         const VertexDeclaration::VertexElementList elems = 
             this->vertexDeclaration->getElements();
@@ -666,6 +670,293 @@ namespace Ogre {
         } // each buffer
 
 
+    }
+    //-----------------------------------------------------------------------
+    namespace
+    {
+        /// Rounds v to a signed normalised integer, clamping to [-1, 1]
+        int quantiseSnorm(Real v, int maxValue)
+        {
+            v = Math::Clamp<Real>(v, -1, 1) * maxValue;
+            return int(v < 0 ? v - 0.5f : v + 0.5f);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void VertexData::quantise(bool positions, bool directions, bool texCoords,
+        QuantisationReport& report)
+    {
+        const VertexDeclaration::VertexElementList& elems = vertexDeclaration->getElements();
+        const VertexBufferBinding::VertexBufferBindingMap& bindMap =
+            vertexBufferBinding->getBindings();
+        VertexBufferBinding::VertexBufferBindingMap::const_iterator bindi;
+        for (bindi = bindMap.begin(); bindi != bindMap.end(); ++bindi)
+            report.bytesBefore += bindi->second->getSizeInBytes();
+
+        // Pick the new type of each element, the ranges of positions and texture
+        // coordinates decide whether and how they can be quantised
+        std::vector<VertexElementType> newTypes;
+        newTypes.reserve(elems.size());
+        AxisAlignedBox posBounds;
+        VertexDeclaration::VertexElementList::const_iterator ei;
+        for (ei = elems.begin(); ei != elems.end(); ++ei)
+        {
+            VertexElementType type = ei->getType();
+            newTypes.push_back(type);
+            if (!vertexBufferBinding->isBufferBound(ei->getSource()))
+                continue;
+
+            const HardwareVertexBufferSharedPtr& buf =
+                vertexBufferBinding->getBuffer(ei->getSource());
+            switch (ei->getSemantic())
+            {
+            case VES_POSITION:
+                // only one decode per vertex data, and shadow volume extrusion needs floats
+                if (!positions || type != VET_FLOAT3 || !posBounds.isNull() ||
+                    hardwareShadowVolWBuffer)
+                    break;
+                {
+                    unsigned char* pBase =
+                        static_cast<unsigned char*>(buf->lock(HardwareBuffer::HBL_READ_ONLY));
+                    for (size_t v = 0; v < buf->getNumVertices(); ++v, pBase += buf->getVertexSize())
+                    {
+                        float* pPos;
+                        ei->baseVertexPointerToElement(pBase, &pPos);
+                        posBounds.merge(Vector3(pPos[0], pPos[1], pPos[2]));
+                    }
+                    buf->unlock();
+                }
+                if (!posBounds.isNull())
+                    newTypes.back() = VET_SHORT4_NORM;
+                break;
+            case VES_NORMAL:
+            case VES_TANGENT:
+            case VES_BINORMAL:
+                // D3D9 has no signed normalised byte type, so shorts are used
+                if (directions && (type == VET_FLOAT3 || type == VET_FLOAT4))
+                    newTypes.back() = VET_SHORT4_NORM;
+                break;
+            case VES_TEXTURE_COORDINATES:
+                if (texCoords && type == VET_FLOAT2)
+                {
+                    float minValue = 0, maxValue = 0;
+                    unsigned char* pBase =
+                        static_cast<unsigned char*>(buf->lock(HardwareBuffer::HBL_READ_ONLY));
+                    for (size_t v = 0; v < buf->getNumVertices(); ++v, pBase += buf->getVertexSize())
+                    {
+                        float* pUV;
+                        ei->baseVertexPointerToElement(pBase, &pUV);
+                        minValue = std::min(minValue, std::min(pUV[0], pUV[1]));
+                        maxValue = std::max(maxValue, std::max(pUV[0], pUV[1]));
+                    }
+                    buf->unlock();
+
+                    if (maxValue <= 1 && minValue >= 0)
+                        newTypes.back() = VET_USHORT2_NORM;
+                    else if (maxValue <= 1 && minValue >= -1)
+                        newTypes.back() = VET_SHORT2_NORM;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        Vector3 posCentre = Vector3::ZERO;
+        Real posScale = 1;
+        if (!posBounds.isNull())
+        {
+            posCentre = posBounds.getCenter();
+            Vector3 halfSize = posBounds.getHalfSize();
+            posScale = std::max(halfSize.x, std::max(halfSize.y, halfSize.z));
+            if (posScale <= 0)
+                posScale = 1;
+        }
+
+        // Rebuild each buffer holding a changed element, packing its elements in
+        // their original order
+        std::vector<size_t> newOffsets;
+        newOffsets.reserve(elems.size());
+        for (ei = elems.begin(); ei != elems.end(); ++ei)
+            newOffsets.push_back(ei->getOffset());
+        for (bindi = bindMap.begin(); bindi != bindMap.end(); ++bindi)
+        {
+            unsigned short source = bindi->first;
+            const HardwareVertexBufferSharedPtr& oldBuf = bindi->second;
+
+            std::vector<std::pair<size_t, unsigned short> > sourceElems;
+            bool changed = false;
+            unsigned short elemIndex = 0;
+            for (ei = elems.begin(); ei != elems.end(); ++ei, ++elemIndex)
+            {
+                if (ei->getSource() != source)
+                    continue;
+                sourceElems.push_back(std::make_pair(ei->getOffset(), elemIndex));
+                changed = changed || newTypes[elemIndex] != ei->getType();
+            }
+            if (!changed)
+            {
+                report.bytesAfter += oldBuf->getSizeInBytes();
+                continue;
+            }
+            std::sort(sourceElems.begin(), sourceElems.end());
+
+            std::vector<const VertexElement*> sourceElemPtrs;
+            size_t newVertexSize = 0;
+            for (size_t i = 0; i < sourceElems.size(); ++i)
+            {
+                elemIndex = sourceElems[i].second;
+                sourceElemPtrs.push_back(vertexDeclaration->getElement(elemIndex));
+                newOffsets[elemIndex] = newVertexSize;
+                newVertexSize += VertexElement::getTypeSize(newTypes[elemIndex]);
+            }
+
+            HardwareVertexBufferSharedPtr newBuf = mMgr->createVertexBuffer(newVertexSize,
+                oldBuf->getNumVertices(), oldBuf->getUsage(), oldBuf->hasShadowBuffer());
+
+            const unsigned char* pSrc =
+                static_cast<const unsigned char*>(oldBuf->lock(HardwareBuffer::HBL_READ_ONLY));
+            unsigned char* pDst =
+                static_cast<unsigned char*>(newBuf->lock(HardwareBuffer::HBL_DISCARD));
+            for (size_t v = 0; v < oldBuf->getNumVertices(); ++v)
+            {
+                for (size_t i = 0; i < sourceElems.size(); ++i)
+                {
+                    const VertexElement& elem = *sourceElemPtrs[i];
+                    elemIndex = sourceElems[i].second;
+                    const float* pIn = reinterpret_cast<const float*>(pSrc + elem.getOffset());
+                    void* pOut = pDst + newOffsets[elemIndex];
+                    if (newTypes[elemIndex] == elem.getType())
+                    {
+                        memcpy(pOut, pIn, elem.getSize());
+                        continue;
+                    }
+
+                    switch (elem.getSemantic())
+                    {
+                    case VES_POSITION:
+                        {
+                            Vector3 pos(pIn[0], pIn[1], pIn[2]);
+                            Vector3 local = (pos - posCentre) / posScale;
+                            short* pShort = static_cast<short*>(pOut);
+                            Vector3 decoded;
+                            for (int c = 0; c < 3; ++c)
+                            {
+                                pShort[c] = short(quantiseSnorm(local[c], 32767));
+                                decoded[c] = pShort[c] / 32767.0f * posScale + posCentre[c];
+                            }
+                            pShort[3] = 32767;
+                            report.maxPositionError =
+                                std::max(report.maxPositionError, pos.distance(decoded));
+                        }
+                        break;
+                    case VES_NORMAL:
+                    case VES_TANGENT:
+                    case VES_BINORMAL:
+                        {
+                            Vector3 dir(pIn[0], pIn[1], pIn[2]);
+                            short* pShort = static_cast<short*>(pOut);
+                            Vector3 decoded;
+                            for (int c = 0; c < 3; ++c)
+                            {
+                                pShort[c] = short(quantiseSnorm(dir[c], 32767));
+                                decoded[c] = pShort[c];
+                            }
+                            // keep the handedness stored in 4 component tangents
+                            pShort[3] = (elem.getType() == VET_FLOAT4 && pIn[3] < 0) ? -32767 : 32767;
+                            // not angleBetween, the arc cosine is too coarse near 0
+                            if (dir.squaredLength() > 0 && decoded.squaredLength() > 0)
+                                report.maxDirectionError = std::max(report.maxDirectionError,
+                                    Math::ATan2(dir.crossProduct(decoded).length(), dir.dotProduct(decoded)));
+                        }
+                        break;
+                    case VES_TEXTURE_COORDINATES:
+                        if (newTypes[elemIndex] == VET_USHORT2_NORM)
+                        {
+                            unsigned short* pUShort = static_cast<unsigned short*>(pOut);
+                            for (int c = 0; c < 2; ++c)
+                            {
+                                pUShort[c] = static_cast<unsigned short>(
+                                    Math::saturate(pIn[c]) * 65535 + 0.5f);
+                                report.maxTexCoordError = std::max(report.maxTexCoordError,
+                                    Math::Abs(pUShort[c] / 65535.0f - pIn[c]));
+                            }
+                        }
+                        else
+                        {
+                            short* pShort = static_cast<short*>(pOut);
+                            for (int c = 0; c < 2; ++c)
+                            {
+                                pShort[c] = short(quantiseSnorm(pIn[c], 32767));
+                                report.maxTexCoordError = std::max(report.maxTexCoordError,
+                                    Math::Abs(pShort[c] / 32767.0f - pIn[c]));
+                            }
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                }
+                pSrc += oldBuf->getVertexSize();
+                pDst += newVertexSize;
+            }
+            newBuf->unlock();
+            oldBuf->unlock();
+
+            report.bytesAfter += newBuf->getSizeInBytes();
+            vertexBufferBinding->setBinding(source, newBuf);
+        }
+
+        // Finally update the declaration, which the loops above iterate over
+        unsigned short elemIndex = 0;
+        for (ei = elems.begin(); ei != elems.end(); ++ei, ++elemIndex)
+        {
+            if (!vertexBufferBinding->isBufferBound(ei->getSource()) ||
+                (newTypes[elemIndex] == ei->getType() && newOffsets[elemIndex] == ei->getOffset()))
+                continue;
+            vertexDeclaration->modifyElement(elemIndex, ei->getSource(), newOffsets[elemIndex],
+                newTypes[elemIndex], ei->getSemantic(), ei->getIndex());
+        }
+
+        if (!posBounds.isNull())
+            positionDecode = Vector4(posCentre.x, posCentre.y, posCentre.z, posScale);
+    }
+    //-----------------------------------------------------------------------
+    void VertexData::readPositions(std::vector<Vector3>& positions) const
+    {
+        positions.clear();
+        const VertexElement* posElem = vertexDeclaration->findElementBySemantic(VES_POSITION);
+        if (!posElem || !vertexCount)
+            return;
+
+        if (posElem->getType() != VET_FLOAT3 && posElem->getType() != VET_SHORT4_NORM)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "Positions must be VET_FLOAT3 or VET_SHORT4_NORM", "VertexData::readPositions");
+        }
+
+        HardwareVertexBufferSharedPtr vbuf = vertexBufferBinding->getBuffer(posElem->getSource());
+        const size_t vertexSize = vbuf->getVertexSize();
+        HardwareBufferLockGuard<HardwareVertexBufferSharedPtr> lock(vbuf, HardwareBuffer::HBL_READ_ONLY);
+        unsigned char* pBase = static_cast<unsigned char*>(lock.pData) + vertexStart * vertexSize;
+
+        const Vector3 offset(positionDecode.x, positionDecode.y, positionDecode.z);
+        const Real scale = positionDecode.w / 32767;
+
+        positions.resize(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v, pBase += vertexSize)
+        {
+            if (posElem->getType() == VET_FLOAT3)
+            {
+                float* pPos;
+                posElem->baseVertexPointerToElement(pBase, &pPos);
+                positions[v] = Vector3(pPos[0], pPos[1], pPos[2]);
+            }
+            else
+            {
+                const short* pPos = reinterpret_cast<const short*>(pBase + posElem->getOffset());
+                positions[v] = Vector3(pPos[0], pPos[1], pPos[2]) * scale + offset;
+            }
+        }
     }
     //-----------------------------------------------------------------------
     ushort VertexData::allocateHardwareAnimationElements(ushort count, bool animateNormals)
@@ -732,220 +1023,363 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
-    // Local Utility class for vertex cache optimizer
-    class Triangle
-    {
-    public:
-        enum EdgeMatchType {
-            AB, BC, CA, ANY, NONE
-        };
+    namespace {
+        /// Size of the simulated post-transform cache used for scoring
+        const int VERTEX_CACHE_SIZE = 32;
+        const float CACHE_DECAY_POWER = 1.5f;
+        const float LAST_TRI_SCORE = 0.75f;
+        const float VALENCE_BOOST_SCALE = 2.0f;
+        const float VALENCE_BOOST_POWER = 0.5f;
+
+        /** Score of a vertex as per Tom Forsyth's "Linear-Speed Vertex Cache
+            Optimisation": favours vertices recently used, and vertices with few
+            triangles left so that isolated triangles do not get stranded.
+        */
+        float vertexCacheScore(int cachePosition, uint32 activeTris)
+        {
+            if (activeTris == 0)
+                return -1.0f; // no triangles left, never pick it again
 
-        uint32 a, b, c;     
+            float score = 0.0f;
+            if (cachePosition >= 0)
+            {
+                if (cachePosition < 3)
+                {
+                    // Used by the last triangle, fixed score so that the order
+                    // within the triangle does not matter
+                    score = LAST_TRI_SCORE;
+                }
+                else
+                {
+                    const float scaler = 1.0f / (VERTEX_CACHE_SIZE - 3);
+                    score = 1.0f - (cachePosition - 3) * scaler;
+                    score = std::pow(score, CACHE_DECAY_POWER);
+                }
+            }
 
-        inline Triangle()
-        {
+            score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(activeTris), -VALENCE_BOOST_POWER);
+            return score;
         }
+    }
+    //-----------------------------------------------------------------------
+    void IndexData::optimiseVertexCacheTriList(void)
+    {
+        if (indexBuffer->isLocked()) return;
 
-        inline Triangle( uint32 ta, uint32 tb, uint32 tc ) 
-            : a( ta ), b( tb ), c( tc )
-        {
-        }
+        size_t nTriangles = indexCount / 3;
+        if (nTriangles == 0) return;
 
-        inline Triangle( uint32 t[3] )
-            : a( t[0] ), b( t[1] ), c( t[2] )
-        {
-        }
+        const bool idx32bit = indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT;
+        const size_t nIndexes = nTriangles * 3;
+        void* buffer = indexBuffer->lock(indexStart * indexBuffer->getIndexSize(),
+            nIndexes * indexBuffer->getIndexSize(), HardwareBuffer::HBL_NORMAL);
 
-        inline Triangle( const Triangle& t )
-            : a( t.a ), b( t.b ), c( t.c )
+        std::vector<uint32> indexes(nIndexes);
+        uint32 nVertices = 0;
+        for (size_t i = 0; i < nIndexes; ++i)
         {
+            indexes[i] = idx32bit ? static_cast<uint32*>(buffer)[i] : static_cast<uint16*>(buffer)[i];
+            nVertices = std::max(nVertices, indexes[i] + 1);
         }
 
-        inline bool sharesEdge(const Triangle& t) const
+        // Vertex -> triangle adjacency, packed; the first activeTris[v] entries
+        // of each range are the triangles not yet emitted
+        std::vector<uint32> activeTris(nVertices, 0);
+        for (size_t i = 0; i < nIndexes; ++i)
+            ++activeTris[indexes[i]];
+        std::vector<uint32> adjacencyStart(nVertices + 1, 0);
+        for (uint32 v = 0; v < nVertices; ++v)
+            adjacencyStart[v + 1] = adjacencyStart[v] + activeTris[v];
+        std::vector<uint32> adjacency(nIndexes);
         {
-            return( (a == t.a && b == t.c) ||
-                    (a == t.b && b == t.a) ||
-                    (a == t.c && b == t.b) ||
-                    (b == t.a && c == t.c) ||
-                    (b == t.b && c == t.a) ||
-                    (b == t.c && c == t.b) ||
-                    (c == t.a && a == t.c) ||
-                    (c == t.b && a == t.a) ||
-                    (c == t.c && a == t.b) );
+            std::vector<uint32> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+            for (size_t i = 0; i < nIndexes; ++i)
+                adjacency[fill[indexes[i]]++] = static_cast<uint32>(i / 3);
         }
 
-        inline bool sharesEdge(const uint32 ea, const uint32 eb, const Triangle& t) const
-        {
-            return( (ea == t.a && eb == t.c) ||
-                    (ea == t.b && eb == t.a) ||
-                    (ea == t.c && eb == t.b) ); 
-        }
+        std::vector<int> cachePosition(nVertices, -1);
+        std::vector<float> vertexScore(nVertices);
+        for (uint32 v = 0; v < nVertices; ++v)
+            vertexScore[v] = vertexCacheScore(-1, activeTris[v]);
 
-        inline bool sharesEdge(const EdgeMatchType edge, const Triangle& t) const
+        std::vector<float> triScore(nTriangles);
+        std::vector<unsigned char> emitted(nTriangles, 0);
+        size_t bestTri = 0;
+        for (size_t t = 0; t < nTriangles; ++t)
         {
-            if (edge == AB)
-                return sharesEdge(a, b, t);
-            else if (edge == BC)
-                return sharesEdge(b, c, t);
-            else if (edge == CA)
-                return sharesEdge(c, a, t);
-            else
-                return (edge == ANY) == sharesEdge(t);
+            triScore[t] = vertexScore[indexes[t * 3]] + vertexScore[indexes[t * 3 + 1]] +
+                vertexScore[indexes[t * 3 + 2]];
+            if (triScore[t] > triScore[bestTri])
+                bestTri = t;
         }
 
-        inline EdgeMatchType endoSharedEdge(const Triangle& t) const
-        {
-            if (sharesEdge(a, b, t)) return AB;
-            if (sharesEdge(b, c, t)) return BC;
-            if (sharesEdge(c, a, t)) return CA;
-            return NONE;
-        }
+        uint32 cache[VERTEX_CACHE_SIZE + 3];
+        uint32 newCache[VERTEX_CACHE_SIZE + 3];
+        int cacheCount = 0;
+        size_t nextUnemitted = 0;
 
-        inline EdgeMatchType exoSharedEdge(const Triangle& t) const
+        std::vector<uint32> result;
+        result.reserve(nIndexes);
+        for (size_t n = 0; n < nTriangles; ++n)
         {
-            return t.endoSharedEdge(*this);
+            if (bestTri == static_cast<size_t>(~0))
+            {
+                // Nothing in the cache has triangles left, restart from the
+                // first triangle not emitted yet
+                while (emitted[nextUnemitted])
+                    ++nextUnemitted;
+                bestTri = nextUnemitted;
+            }
+
+            emitted[bestTri] = 1;
+            const uint32* tri = &indexes[bestTri * 3];
+            int newCount = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                uint32 v = tri[i];
+                result.push_back(v);
+
+                // Retire the triangle from this vertex's active list
+                uint32* adjBegin = &adjacency[adjacencyStart[v]];
+                uint32* adjEnd = adjBegin + activeTris[v];
+                uint32* found = std::find(adjBegin, adjEnd, static_cast<uint32>(bestTri));
+                if (found != adjEnd)
+                {
+                    std::swap(*found, *(adjEnd - 1));
+                    --activeTris[v];
+                }
+
+                // Degenerate triangles may reference a vertex twice
+                if (std::find(newCache, newCache + newCount, v) == newCache + newCount)
+                    newCache[newCount++] = v;
+            }
+            // The rest of the cache shifts back behind the triangle's vertices
+            for (int i = 0; i < cacheCount; ++i)
+            {
+                uint32 v = cache[i];
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                    newCache[newCount++] = v;
+            }
+
+            // Rescore everything that moved in, along or out of the cache
+            for (int i = 0; i < newCount; ++i)
+            {
+                uint32 v = newCache[i];
+                cachePosition[v] = i < VERTEX_CACHE_SIZE ? i : -1;
+                float score = vertexCacheScore(cachePosition[v], activeTris[v]);
+                float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+                const uint32* adj = &adjacency[adjacencyStart[v]];
+                for (uint32 a = 0; a < activeTris[v]; ++a)
+                    triScore[adj[a]] += delta;
+            }
+
+            cacheCount = std::min(newCount, VERTEX_CACHE_SIZE);
+            std::copy(newCache, newCache + cacheCount, cache);
+
+            // Next triangle is the best one touching the cache
+            bestTri = static_cast<size_t>(~0);
+            float bestScore = -1.0f;
+            for (int i = 0; i < cacheCount; ++i)
+            {
+                uint32 v = cache[i];
+                const uint32* adj = &adjacency[adjacencyStart[v]];
+                for (uint32 a = 0; a < activeTris[v]; ++a)
+                {
+                    if (triScore[adj[a]] > bestScore)
+                    {
+                        bestScore = triScore[adj[a]];
+                        bestTri = adj[a];
+                    }
+                }
+            }
         }
 
-        inline void shiftClockwise()
+        for (size_t i = 0; i < nIndexes; ++i)
         {
-            uint32 t = a;
-            a = c;
-            c = b;
-            b = t;
+            if (idx32bit)
+                static_cast<uint32*>(buffer)[i] = result[i];
+            else
+                static_cast<uint16*>(buffer)[i] = static_cast<uint16>(result[i]);
         }
 
-        inline void shiftCounterClockwise()
+        indexBuffer->unlock();
+    }
+    //-----------------------------------------------------------------------
+    namespace
+    {
+        /// FIFO post-transform cache of the size assumed by the overdraw clustering
+        const uint32 OVERDRAW_CACHE_SIZE = 16;
+
+        /// Counts the misses of a triangle, a vertex stays cached for OVERDRAW_CACHE_SIZE misses
+        uint32 updateOverdrawCache(const uint32* tri, std::vector<uint32>& timestamps, uint32& timestamp)
         {
-            uint32 t = a;
-            a = b;
-            b = c;
-            c = t;
+            uint32 misses = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                if (timestamp - timestamps[tri[i]] > OVERDRAW_CACHE_SIZE)
+                {
+                    timestamps[tri[i]] = timestamp++;
+                    ++misses;
+                }
+            }
+            return misses;
         }
-    };
-    //-----------------------------------------------------------------------
+    }
     //-----------------------------------------------------------------------
-    void IndexData::optimiseVertexCacheTriList(void)
+    void IndexData::optimiseOverdrawTriList(const VertexData* vertexData, Real threshold)
     {
         if (indexBuffer->isLocked()) return;
 
-        void *buffer = indexBuffer->lock(HardwareBuffer::HBL_NORMAL);
+        const size_t nTriangles = indexCount / 3;
+        if (nTriangles < 2) return;
 
-        Triangle* triangles;
+        std::vector<Vector3> positions;
+        vertexData->readPositions(positions);
+        if (positions.empty()) return;
 
-        size_t nIndexes = indexCount;
-        size_t nTriangles = nIndexes / 3;
-        size_t i, j;
-        uint16 *source = 0;
+        const bool idx32bit = indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT;
+        const size_t nIndexes = nTriangles * 3;
+        HardwareBufferLockGuard<HardwareIndexBufferSharedPtr> lock(indexBuffer,
+            indexStart * indexBuffer->getIndexSize(), nIndexes * indexBuffer->getIndexSize(),
+            HardwareBuffer::HBL_NORMAL);
 
-        if (indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT)
+        std::vector<uint32> indexes(nIndexes);
+        for (size_t i = 0; i < nIndexes; ++i)
         {
-            triangles = OGRE_ALLOC_T(Triangle, nTriangles, MEMCATEGORY_GEOMETRY);
-            source = (uint16 *)buffer;
-            uint32 *dest = (uint32 *)triangles;
-            for (i = 0; i < nIndexes; ++i) dest[i] = source[i];
+            indexes[i] = idx32bit ? static_cast<uint32*>(lock.pData)[i] : static_cast<uint16*>(lock.pData)[i];
+            if (indexes[i] >= positions.size())
+                return;
         }
-        else
-            triangles = static_cast<Triangle*>(buffer);
-
-        // sort triangles based on shared edges
-        uint32 *destlist = OGRE_ALLOC_T(uint32, nTriangles, MEMCATEGORY_GEOMETRY);
-        unsigned char *visited = OGRE_ALLOC_T(unsigned char, nTriangles, MEMCATEGORY_GEOMETRY);
-
-        for (i = 0; i < nTriangles; ++i) visited[i] = 0;
 
-        uint32 start = 0, ti = 0, destcount = 0;
-
-        bool found = false;
-        for (i = 0; i < nTriangles; ++i)
+        // Hard boundaries: a triangle missing the cache on all three vertices
+        // starts a disjoint patch, reordering there costs nothing
+        std::vector<uint32> timestamps(positions.size(), 0);
+        uint32 timestamp = OVERDRAW_CACHE_SIZE + 1;
+        std::vector<size_t> hardClusters;
+        for (size_t t = 0; t < nTriangles; ++t)
         {
-            if (found)
-                found = false;
-            else
-            {
-                while (visited[start++]);
-                ti = start - 1;
-            }
-
-            destlist[destcount++] = ti;
-            visited[ti] = 1;
+            if (updateOverdrawCache(&indexes[t * 3], timestamps, timestamp) == 3 || t == 0)
+                hardClusters.push_back(t);
+        }
 
-            for (j = start; j < nTriangles; ++j)
+        // Soft boundaries: split each patch wherever restarting the cache keeps
+        // the ACMR of the pieces within threshold of the patch's own
+        std::vector<size_t> clusters;
+        for (size_t c = 0; c < hardClusters.size(); ++c)
+        {
+            const size_t start = hardClusters[c];
+            const size_t end = c + 1 < hardClusters.size() ? hardClusters[c + 1] : nTriangles;
+
+            timestamp += OVERDRAW_CACHE_SIZE + 1;
+            uint32 clusterMisses = 0;
+            for (size_t t = start; t < end; ++t)
+                clusterMisses += updateOverdrawCache(&indexes[t * 3], timestamps, timestamp);
+            const Real clusterThreshold = threshold * clusterMisses / Real(end - start);
+
+            clusters.push_back(start);
+            timestamp += OVERDRAW_CACHE_SIZE + 1;
+            uint32 runningMisses = 0, runningTris = 0;
+            for (size_t t = start; t < end; ++t)
             {
-                if (visited[j]) continue;
-                
-                if (triangles[ti].sharesEdge(triangles[j]))
+                runningMisses += updateOverdrawCache(&indexes[t * 3], timestamps, timestamp);
+                ++runningTris;
+                if (runningMisses <= clusterThreshold * runningTris)
                 {
-                    found = true;
-                    ti = static_cast<uint32>(j);
-                    break;
+                    clusters.push_back(t + 1);
+                    timestamp += OVERDRAW_CACHE_SIZE + 1;
+                    runningMisses = runningTris = 0;
                 }
             }
+            // Don't leave an empty cluster at the end of the patch
+            if (clusters.back() == end)
+                clusters.pop_back();
         }
 
-        if (indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT)
+        // Sort key: how far the cluster faces away from the mesh centre
+        Vector3 meshCentroid(Vector3::ZERO);
+        for (size_t i = 0; i < nIndexes; ++i)
+            meshCentroid += positions[indexes[i]];
+        meshCentroid /= Real(nIndexes);
+
+        const size_t nClusters = clusters.size();
+        std::vector<std::pair<Real, size_t> > order(nClusters);
+        for (size_t c = 0; c < nClusters; ++c)
         {
-            // reorder the indexbuffer
-            j = 0;
-            for (i = 0; i < nTriangles; ++i)
+            const size_t end = c + 1 < nClusters ? clusters[c + 1] : nTriangles;
+            Vector3 centroid(Vector3::ZERO), normal(Vector3::ZERO);
+            Real area = 0;
+            for (size_t t = clusters[c]; t < end; ++t)
             {
-                Triangle *t = &triangles[destlist[i]];
-                if(source)
-                {
-                    source[j++] = (uint16)t->a;
-                    source[j++] = (uint16)t->b;
-                    source[j++] = (uint16)t->c;
-                }
+                const Vector3& p0 = positions[indexes[t * 3]];
+                const Vector3& p1 = positions[indexes[t * 3 + 1]];
+                const Vector3& p2 = positions[indexes[t * 3 + 2]];
+                // Twice the area, weighted
+                Vector3 n = (p1 - p0).crossProduct(p2 - p0);
+                Real a = n.length();
+                centroid += (p0 + p1 + p2) * (a / 3);
+                normal += n;
+                area += a;
             }
-            OGRE_FREE(triangles, MEMCATEGORY_GEOMETRY);
+            if (area > 0)
+                centroid /= area;
+            normal.normalise();
+            // Negated so that sorting ascending draws outward facing clusters first
+            order[c] = std::make_pair(-(centroid - meshCentroid).dotProduct(normal), c);
         }
-        else
-        {
-            uint32 *reflist = OGRE_ALLOC_T(uint32, nTriangles, MEMCATEGORY_GEOMETRY);
-
-            // fill the referencebuffer
-            for (i = 0; i < nTriangles; ++i)
-                reflist[destlist[i]] = static_cast<uint32>(i);
-            
-            // reorder the indexbuffer
-            for (i = 0; i < nTriangles; ++i)
-            {
-                j = destlist[i];
-                if (i == j) continue; // do not move triangle
+        std::stable_sort(order.begin(), order.end());
 
-                // swap triangles
-
-                Triangle t = triangles[i];
-                triangles[i] = triangles[j];
-                triangles[j] = t;
+        std::vector<uint32> reordered;
+        reordered.reserve(nIndexes);
+        for (size_t o = 0; o < nClusters; ++o)
+        {
+            const size_t c = order[o].second;
+            const size_t end = c + 1 < nClusters ? clusters[c + 1] : nTriangles;
+            reordered.insert(reordered.end(), indexes.begin() + clusters[c] * 3, indexes.begin() + end * 3);
+        }
 
-                // change reference
-                destlist[reflist[i]] = static_cast<uint32>(j);
-                // destlist[i] = i; // not needed, it will not be used
-            }
+        // The clusters only bound the misses with a cold cache at their start, check
+        // the whole list and keep the original order if it got worse than allowed
+        uint32 oldMisses = 0, newMisses = 0;
+        timestamp += OVERDRAW_CACHE_SIZE + 1;
+        for (size_t t = 0; t < nTriangles; ++t)
+            oldMisses += updateOverdrawCache(&indexes[t * 3], timestamps, timestamp);
+        timestamp += OVERDRAW_CACHE_SIZE + 1;
+        for (size_t t = 0; t < nTriangles; ++t)
+            newMisses += updateOverdrawCache(&reordered[t * 3], timestamps, timestamp);
+        if (newMisses > threshold * oldMisses)
+            return;
 
-            OGRE_FREE(reflist, MEMCATEGORY_GEOMETRY);
+        for (size_t i = 0; i < nIndexes; ++i)
+        {
+            if (idx32bit)
+                static_cast<uint32*>(lock.pData)[i] = reordered[i];
+            else
+                static_cast<uint16*>(lock.pData)[i] = static_cast<uint16>(reordered[i]);
         }
-
-        OGRE_FREE(destlist, MEMCATEGORY_GEOMETRY);
-        OGRE_FREE(visited, MEMCATEGORY_GEOMETRY);
-                    
-        indexBuffer->unlock();
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     void VertexCacheProfiler::profile(const HardwareIndexBufferSharedPtr& indexBuffer)
+    {
+        profile(indexBuffer, 0, indexBuffer->getNumIndexes());
+    }
+    //-----------------------------------------------------------------------
+    void VertexCacheProfiler::profile(const HardwareIndexBufferSharedPtr& indexBuffer,
+                                      size_t indexStart, size_t indexCount)
     {
         if (indexBuffer->isLocked()) return;
 
-        uint16 *shortbuffer = (uint16 *)indexBuffer->lock(HardwareBuffer::HBL_READ_ONLY);
+        uint16 *shortbuffer = (uint16 *)indexBuffer->lock(indexStart * indexBuffer->getIndexSize(),
+            indexCount * indexBuffer->getIndexSize(), HardwareBuffer::HBL_READ_ONLY);
 
         if (indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT)
-            for (unsigned int i = 0; i < indexBuffer->getNumIndexes(); ++i)
+            for (size_t i = 0; i < indexCount; ++i)
                 inCache(shortbuffer[i]);
         else
         {
             uint32 *buffer = (uint32 *)shortbuffer;
-            for (unsigned int i = 0; i < indexBuffer->getNumIndexes(); ++i)
+            for (size_t i = 0; i < indexCount; ++i)
                 inCache(buffer[i]);
         }
 
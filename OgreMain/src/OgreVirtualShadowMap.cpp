@@ -0,0 +1,571 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreVirtualShadowMap.h"
+#include "OgreCamera.h"
+#include "OgreViewport.h"
+#include "OgreTextureManager.h"
+#include "OgreHardwarePixelBuffer.h"
+
+namespace Ogre
+{
+    /// Evicts pages requested longest ago first, finer ones first among those
+    struct VirtualShadowMap::EvictionOrder
+    {
+        const std::vector<Slot>* slots;
+
+        bool operator()(uint32 a, uint32 b) const
+        {
+            const Slot& sa = (*slots)[a];
+            const Slot& sb = (*slots)[b];
+            if (sa.lastUsedFrame != sb.lastUsedFrame)
+                return sa.lastUsedFrame < sb.lastUsedFrame;
+            if (sa.page.level != sb.page.level)
+                return sa.page.level < sb.page.level;
+            return a < b;
+        }
+    };
+
+    namespace
+    {
+        /// Requests coarse levels first, so the atlas holds fallbacks before details
+        bool coarserPageFirst(const VirtualShadowMap::PageId& a, const VirtualShadowMap::PageId& b)
+        {
+            if (a.level != b.level)
+                return a.level > b.level;
+            if (a.y != b.y)
+                return a.y < b.y;
+            return a.x < b.x;
+        }
+    }
+    //---------------------------------------------------------------------
+    VirtualShadowMap::VirtualShadowMap(const String& name)
+        : mName(name)
+        , mVirtualSize(0)
+        , mPageSize(0)
+        , mAtlasSize(0)
+        , mTexelSizeFactor(1)
+        , mViewMatrix(Affine3::IDENTITY)
+        , mProjectionMatrix(Matrix4::IDENTITY)
+        , mViewProjMatrix(Matrix4::IDENTITY)
+        , mFrame(0)
+        , mNumDroppedPages(0)
+    {
+        setSizes(16384, 128, 4096);
+    }
+    //---------------------------------------------------------------------
+    VirtualShadowMap::~VirtualShadowMap()
+    {
+        destroyPageTableTexture();
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::setSizes(uint32 virtualSize, uint32 pageSize, uint32 atlasSize)
+    {
+        if (!pageSize || !Bitwise::isPO2(virtualSize) || !Bitwise::isPO2(pageSize) ||
+            !Bitwise::isPO2(atlasSize) || pageSize > virtualSize || pageSize > atlasSize ||
+            virtualSize / pageSize > 0x8000)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                        "Sizes must be powers of two, with at most 32768 pages per side "
+                        "and pages no larger than the virtual map or the atlas",
+                        "VirtualShadowMap::setSizes");
+        }
+
+        mVirtualSize = virtualSize;
+        mPageSize = pageSize;
+        mAtlasSize = atlasSize;
+
+        uint32 pagesPerSide = getPagesPerSide();
+        size_t numLevels = Bitwise::mostSignificantBitSet(pagesPerSide) + 1;
+        mPageTables.resize(numLevels);
+        mRequested.resize(numLevels);
+        for (size_t level = 0; level < numLevels; ++level)
+        {
+            size_t pages = static_cast<size_t>(pagesPerSide >> level) * (pagesPerSide >> level);
+            mPageTables[level].assign(pages, 0);
+            mRequested[level].assign(pages, false);
+        }
+        mRequests.clear();
+
+        uint32 slotsPerSide = atlasSize / pageSize;
+        mSlots.resize(static_cast<size_t>(slotsPerSide) * slotsPerSide);
+        mPagesToRender.clear();
+        clear();
+
+        // The page table texture has to be recreated at the new size
+        destroyPageTableTexture();
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::setLightMatrices(const Affine3& viewMatrix, const Matrix4& projectionMatrix)
+    {
+        if (viewMatrix == mViewMatrix && projectionMatrix == mProjectionMatrix)
+            return;
+
+        mViewMatrix = viewMatrix;
+        mProjectionMatrix = projectionMatrix;
+        mViewProjMatrix = mProjectionMatrix * mViewMatrix;
+        invalidateAll();
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::beginFrame(void)
+    {
+        for (size_t i = 0; i < mRequests.size(); ++i)
+            mRequested[mRequests[i].level][getPageIndex(mRequests[i])] = false;
+        mRequests.clear();
+        ++mFrame;
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::requestPage(const PageId& page)
+    {
+        uint16 numLevels = getNumLevels();
+        PageId p = page;
+        while (p.level < numLevels)
+        {
+            std::vector<bool>::reference requested = mRequested[p.level][getPageIndex(p)];
+            // the ancestors are requested already
+            if (requested)
+                break;
+            requested = true;
+            mRequests.push_back(p);
+
+            ++p.level;
+            p.x >>= 1;
+            p.y >>= 1;
+        }
+    }
+    //---------------------------------------------------------------------
+    bool VirtualShadowMap::projectBounds(const AxisAlignedBox& bounds, RealRect& rect, Real& w) const
+    {
+        if (bounds.isNull())
+            return false;
+
+        if (bounds.isInfinite())
+        {
+            rect = RealRect(0, 0, 1, 1);
+            w = 1;
+            return true;
+        }
+
+        AxisAlignedBox::Corners corners = bounds.getAllCorners();
+        Real minU = Math::POS_INFINITY, minV = Math::POS_INFINITY;
+        Real maxU = Math::NEG_INFINITY, maxV = Math::NEG_INFINITY;
+        for (int i = 0; i < 8; ++i)
+        {
+            Vector4 clip = mViewProjMatrix * Vector4(corners[i]);
+            if (clip.w <= Real(1e-6))
+            {
+                // Behind a perspective light, cover the whole map
+                rect = RealRect(0, 0, 1, 1);
+                w = 1;
+                return true;
+            }
+            Real u = (clip.x / clip.w + 1) * 0.5f;
+            Real v = (1 - clip.y / clip.w) * 0.5f;
+            minU = std::min(minU, u);
+            maxU = std::max(maxU, u);
+            minV = std::min(minV, v);
+            maxV = std::max(maxV, v);
+        }
+
+        if (maxU < 0 || maxV < 0 || minU > 1 || minV > 1)
+            return false;
+
+        rect = RealRect(std::max(minU, Real(0)), std::max(minV, Real(0)),
+                        std::min(maxU, Real(1)), std::min(maxV, Real(1)));
+        w = (mViewProjMatrix * Vector4(bounds.getCenter())).w;
+        return true;
+    }
+    //---------------------------------------------------------------------
+    uint16 VirtualShadowMap::getLevel(Real worldTexelSize, Real w) const
+    {
+        // World space width of the light frustum at w, over the texels of level 0;
+        // this works for orthographic projections too, where w is 1
+        Real scale = std::max(Math::Abs(mProjectionMatrix[0][0]), Math::Abs(mProjectionMatrix[1][1]));
+        Real level0TexelSize = 2 * std::max(w, Real(1e-6)) / (scale * mVirtualSize);
+
+        Real ratio = worldTexelSize * mTexelSizeFactor / level0TexelSize;
+        if (!(ratio >= 2))
+            return 0;
+        int level = static_cast<int>(Math::Floor(Math::Log2(ratio)));
+        return static_cast<uint16>(std::min(level, getNumLevels() - 1));
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::requestRect(uint16 level, const RealRect& rect)
+    {
+        int pages = static_cast<int>(getPagesPerSide() >> level);
+        int firstX = Math::Clamp(static_cast<int>(rect.left * pages), 0, pages - 1);
+        int lastX = Math::Clamp(static_cast<int>(rect.right * pages), 0, pages - 1);
+        int firstY = Math::Clamp(static_cast<int>(rect.top * pages), 0, pages - 1);
+        int lastY = Math::Clamp(static_cast<int>(rect.bottom * pages), 0, pages - 1);
+
+        PageId page;
+        page.level = level;
+        for (int y = firstY; y <= lastY; ++y)
+        {
+            for (int x = firstX; x <= lastX; ++x)
+            {
+                page.x = static_cast<uint16>(x);
+                page.y = static_cast<uint16>(y);
+                requestPage(page);
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::requestBounds(const AxisAlignedBox& bounds, Real worldTexelSize)
+    {
+        RealRect rect;
+        Real w;
+        if (projectBounds(bounds, rect, w))
+            requestRect(getLevel(worldTexelSize, w), rect);
+    }
+    //---------------------------------------------------------------------
+    Real VirtualShadowMap::getPixelSize(const Camera* camera, Real depth, Real viewportHeight) const
+    {
+        if (camera->getProjectionType() == PT_ORTHOGRAPHIC)
+            return camera->getOrthoWindowHeight() / viewportHeight;
+        depth = std::max(depth, camera->getNearClipDistance());
+        return 2 * depth * Math::Tan(camera->getFOVy() * 0.5f) / viewportHeight;
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::requestReceiver(const AxisAlignedBox& bounds, const Camera* camera,
+                                           Real viewportHeight)
+    {
+        Real distance = bounds.isInfinite() ? 0 : bounds.distance(camera->getDerivedPosition());
+        requestBounds(bounds, getPixelSize(camera, distance, viewportHeight));
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::requestFromDepth(const PixelBox& depth, const Camera* camera,
+                                            Real viewportHeight)
+    {
+        if (depth.format != PF_FLOAT32_R)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Depths must be PF_FLOAT32_R",
+                        "VirtualShadowMap::requestFromDepth");
+        }
+
+        // Rebuild view space positions from the projection, then go to light clip
+        // space in one step
+        const Matrix4& proj = camera->getProjectionMatrix();
+        Matrix4 viewToLight = mViewProjMatrix * camera->getViewMatrix(true).inverse();
+        bool perspective = camera->getProjectionType() == PT_PERSPECTIVE;
+        uint32 width = depth.getWidth();
+        uint32 height = depth.getHeight();
+
+        PageId page;
+        for (uint32 y = 0; y < height; ++y)
+        {
+            const float* row = reinterpret_cast<const float*>(depth.data) +
+                               (y + depth.top) * depth.rowPitch + depth.left;
+            Real ndcY = 1 - 2 * (y + Real(0.5)) / height;
+            for (uint32 x = 0; x < width; ++x)
+            {
+                Real d = row[x];
+                if (!(d > 0))
+                    continue;
+
+                Real ndcX = 2 * (x + Real(0.5)) / width - 1;
+                Vector4 viewPos;
+                if (perspective)
+                {
+                    viewPos.x = (ndcX + proj[0][2]) * d / proj[0][0];
+                    viewPos.y = (ndcY + proj[1][2]) * d / proj[1][1];
+                }
+                else
+                {
+                    viewPos.x = (ndcX - proj[0][3]) / proj[0][0];
+                    viewPos.y = (ndcY - proj[1][3]) / proj[1][1];
+                }
+                viewPos.z = -d;
+                viewPos.w = 1;
+
+                Vector4 clip = viewToLight * viewPos;
+                if (clip.w <= Real(1e-6))
+                    continue;
+                Real u = (clip.x / clip.w + 1) * 0.5f;
+                Real v = (1 - clip.y / clip.w) * 0.5f;
+                if (u < 0 || v < 0 || u >= 1 || v >= 1)
+                    continue;
+
+                page.level = getLevel(getPixelSize(camera, d, viewportHeight), clip.w);
+                uint32 pages = getPagesPerSide() >> page.level;
+                page.x = static_cast<uint16>(u * pages);
+                page.y = static_cast<uint16>(v * pages);
+                requestPage(page);
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::invalidate(const AxisAlignedBox& bounds)
+    {
+        RealRect rect;
+        Real w;
+        if (!projectBounds(bounds, rect, w))
+            return;
+
+        for (size_t s = 0; s < mSlots.size(); ++s)
+        {
+            Slot& slot = mSlots[s];
+            if (slot.used && !slot.dirty)
+            {
+                RealRect pageRect = getPageRect(slot.page);
+                slot.dirty = pageRect.left <= rect.right && pageRect.right >= rect.left &&
+                             pageRect.top <= rect.bottom && pageRect.bottom >= rect.top;
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::invalidateAll(void)
+    {
+        for (size_t s = 0; s < mSlots.size(); ++s)
+            mSlots[s].dirty = true;
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::clear(void)
+    {
+        for (size_t level = 0; level < mPageTables.size(); ++level)
+            std::fill(mPageTables[level].begin(), mPageTables[level].end(), 0);
+
+        mFreeSlots.resize(mSlots.size());
+        for (size_t s = 0; s < mSlots.size(); ++s)
+        {
+            mSlots[s].used = false;
+            mSlots[s].dirty = true;
+            mSlots[s].lastUsedFrame = 0;
+            // slot 0 gets allocated first
+            mFreeSlots[s] = static_cast<uint32>(mSlots.size() - 1 - s);
+        }
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::evict(uint32 slot)
+    {
+        Slot& s = mSlots[slot];
+        mPageTables[s.page.level][getPageIndex(s.page)] = 0;
+        s.used = false;
+    }
+    //---------------------------------------------------------------------
+    const VirtualShadowMap::PageRenderList& VirtualShadowMap::update(void)
+    {
+        mPagesToRender.clear();
+        mNumDroppedPages = 0;
+
+        // Keep the resident pages, redrawing the dirty ones
+        for (size_t i = 0; i < mRequests.size(); ++i)
+        {
+            const PageId& page = mRequests[i];
+            uint32 entry = mPageTables[page.level][getPageIndex(page)];
+            if (!entry)
+                continue;
+
+            Slot& slot = mSlots[entry - 1];
+            slot.lastUsedFrame = mFrame;
+            if (slot.dirty)
+            {
+                slot.dirty = false;
+                PageRender render = {page, entry - 1};
+                mPagesToRender.push_back(render);
+            }
+        }
+
+        // Pages that were not requested this frame can make room, oldest first
+        std::vector<uint32> evictable;
+        for (uint32 s = 0; s < mSlots.size(); ++s)
+        {
+            if (mSlots[s].used && mSlots[s].lastUsedFrame != mFrame)
+                evictable.push_back(s);
+        }
+        EvictionOrder order = {&mSlots};
+        std::sort(evictable.begin(), evictable.end(), order);
+        size_t nextEvictable = 0;
+
+        std::sort(mRequests.begin(), mRequests.end(), coarserPageFirst);
+        for (size_t i = 0; i < mRequests.size(); ++i)
+        {
+            const PageId& page = mRequests[i];
+            uint32& entry = mPageTables[page.level][getPageIndex(page)];
+            if (entry)
+                continue;
+
+            uint32 slot;
+            if (!mFreeSlots.empty())
+            {
+                slot = mFreeSlots.back();
+                mFreeSlots.pop_back();
+            }
+            else if (nextEvictable < evictable.size())
+            {
+                slot = evictable[nextEvictable++];
+                evict(slot);
+            }
+            else
+            {
+                ++mNumDroppedPages;
+                continue;
+            }
+
+            Slot& s = mSlots[slot];
+            s.page = page;
+            s.lastUsedFrame = mFrame;
+            s.used = true;
+            s.dirty = false;
+            entry = slot + 1;
+
+            PageRender render = {page, slot};
+            mPagesToRender.push_back(render);
+        }
+
+        return mPagesToRender;
+    }
+    //---------------------------------------------------------------------
+    int32 VirtualShadowMap::getSlot(const PageId& page, bool fallback, uint16* resolvedLevel) const
+    {
+        PageId p = page;
+        while (p.level < getNumLevels())
+        {
+            uint32 entry = mPageTables[p.level][getPageIndex(p)];
+            if (entry)
+            {
+                if (resolvedLevel)
+                    *resolvedLevel = p.level;
+                return static_cast<int32>(entry - 1);
+            }
+            if (!fallback)
+                break;
+
+            ++p.level;
+            p.x >>= 1;
+            p.y >>= 1;
+        }
+        return -1;
+    }
+    //---------------------------------------------------------------------
+    RealRect VirtualShadowMap::getSlotRect(uint32 slot) const
+    {
+        uint32 slotsPerSide = mAtlasSize / mPageSize;
+        Real size = Real(1) / slotsPerSide;
+        Real left = (slot % slotsPerSide) * size;
+        Real top = (slot / slotsPerSide) * size;
+        return RealRect(left, top, left + size, top + size);
+    }
+    //---------------------------------------------------------------------
+    RealRect VirtualShadowMap::getPageRect(const PageId& page) const
+    {
+        Real size = Real(1) / (getPagesPerSide() >> page.level);
+        return RealRect(page.x * size, page.y * size, (page.x + 1) * size, (page.y + 1) * size);
+    }
+    //---------------------------------------------------------------------
+    Matrix4 VirtualShadowMap::getPageProjectionMatrix(const PageId& page) const
+    {
+        // Scale and offset the page area of clip space to all of it
+        RealRect rect = getPageRect(page);
+        Real left = rect.left * 2 - 1;
+        Real right = rect.right * 2 - 1;
+        Real top = 1 - rect.top * 2;
+        Real bottom = 1 - rect.bottom * 2;
+
+        Matrix4 crop = Matrix4::IDENTITY;
+        crop[0][0] = 2 / (right - left);
+        crop[0][3] = -(right + left) / (right - left);
+        crop[1][1] = 2 / (top - bottom);
+        crop[1][3] = -(top + bottom) / (top - bottom);
+        return crop * mProjectionMatrix;
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::renderPages(Viewport* viewport)
+    {
+        Camera* camera = viewport->getCamera();
+        if (!camera || mPagesToRender.empty())
+            return;
+
+        // Put the camera and the viewport back as they were afterwards
+        bool customView = camera->isCustomViewMatrixEnabled();
+        bool customProjection = camera->isCustomProjectionMatrixEnabled();
+        Affine3 viewMatrix = camera->getViewMatrix(true);
+        Matrix4 projectionMatrix = camera->getProjectionMatrix();
+        Real left = viewport->getLeft(), top = viewport->getTop();
+        Real width = viewport->getWidth(), height = viewport->getHeight();
+
+        camera->setCustomViewMatrix(true, mViewMatrix);
+        for (size_t i = 0; i < mPagesToRender.size(); ++i)
+        {
+            const PageRender& render = mPagesToRender[i];
+            RealRect rect = getSlotRect(render.slot);
+            viewport->setDimensions(rect.left, rect.top, rect.width(), rect.height());
+            camera->setCustomProjectionMatrix(true, getPageProjectionMatrix(render.page));
+            viewport->update();
+        }
+
+        viewport->setDimensions(left, top, width, height);
+        camera->setCustomProjectionMatrix(customProjection, projectionMatrix);
+        camera->setCustomViewMatrix(customView, viewMatrix);
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::uploadPageTable(void)
+    {
+        uint32 pagesPerSide = getPagesPerSide();
+        uint16 numLevels = getNumLevels();
+        if (!mPageTableTexture)
+        {
+            mPageTableTexture = TextureManager::getSingleton().createManual(
+                mName + "/PageTable", ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME,
+                TEX_TYPE_2D, pagesPerSide, pagesPerSide, numLevels - 1, PF_FLOAT32_RGBA,
+                TU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+        }
+
+        uint32 slotsPerSide = mAtlasSize / mPageSize;
+        PageId page;
+        for (page.level = 0; page.level < numLevels; ++page.level)
+        {
+            uint32 pages = pagesPerSide >> page.level;
+            mUploadBuffer.assign(static_cast<size_t>(pages) * pages * 4, 0.0f);
+            float* dest = &mUploadBuffer[0];
+            for (page.y = 0; page.y < pages; ++page.y)
+            {
+                for (page.x = 0; page.x < pages; ++page.x, dest += 4)
+                {
+                    uint16 resolvedLevel;
+                    int32 slot = getSlot(page, true, &resolvedLevel);
+                    if (slot < 0)
+                        continue;
+                    dest[0] = static_cast<float>(slot % slotsPerSide) / slotsPerSide;
+                    dest[1] = static_cast<float>(slot / slotsPerSide) / slotsPerSide;
+                    dest[2] = static_cast<float>(pagesPerSide >> resolvedLevel);
+                    dest[3] = 1;
+                }
+            }
+            mPageTableTexture->getBuffer(0, page.level)->blitFromMemory(
+                PixelBox(pages, pages, 1, PF_FLOAT32_RGBA, &mUploadBuffer[0]));
+        }
+    }
+    //---------------------------------------------------------------------
+    void VirtualShadowMap::destroyPageTableTexture(void)
+    {
+        if (mPageTableTexture && TextureManager::getSingletonPtr())
+            TextureManager::getSingleton().remove(mPageTableTexture);
+        mPageTableTexture.reset();
+    }
+}
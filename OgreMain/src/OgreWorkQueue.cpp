@@ -43,6 +43,24 @@ namespace Ogre {
         return i->second;
     }
     //---------------------------------------------------------------------
+    void WorkQueue::parallelFor(size_t count, const std::function<void(size_t)>& func)
+    {
+        for (size_t i = 0; i < count; ++i)
+            func(i);
+    }
+    //---------------------------------------------------------------------
+    void WorkQueue::parallelForDefault(size_t count, const std::function<void(size_t)>& func)
+    {
+        Root* root = Root::getSingletonPtr();
+        if (root && root->getWorkQueue())
+            root->getWorkQueue()->parallelFor(count, func);
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+                func(i);
+        }
+    }
+    //---------------------------------------------------------------------
     WorkQueue::Request::Request(uint16 channel, uint16 rtype, const Any& rData, uint8 retry, RequestID rid)
         : mChannel(channel), mType(rtype), mData(rData), mRetryCount(retry), mID(rid), mAborted(false)
     {
@@ -81,6 +99,8 @@ namespace Ogre {
         , mIdleThreadRunning(false)
         , mIdleProcessed(0)
     {
+        mParallelForChannel = getChannel("Ogre/ParallelFor");
+        addRequestHandler(mParallelForChannel, &mParallelForHandler);
     }
     //---------------------------------------------------------------------
     const String& DefaultWorkQueueBase::getName() const
@@ -756,6 +776,104 @@ namespace Ogre {
     }
 
 
+#if OGRE_THREAD_SUPPORT && defined(OGRE_THREAD_WAIT)
+    namespace
+    {
+        /// State shared by a parallelFor call and its helper requests
+        struct ParallelForJob
+        {
+            /// Only called for claimed indices, which all finish before parallelFor returns
+            const std::function<void(size_t)>* func;
+            size_t count;
+            /// Indices claimed at a time, so that fine grained loops do not contend on the mutex
+            size_t batch;
+            size_t next;
+            size_t done;
+            std::exception_ptr error;
+            OGRE_WQ_MUTEX(mutex);
+            OGRE_WQ_THREAD_SYNCHRONISER(finished);
+
+            ParallelForJob(size_t c, size_t b, const std::function<void(size_t)>* f)
+                : func(f), count(c), batch(b), next(0), done(0) {}
+
+            /// Claim and process batches of indices until there are none left
+            void run()
+            {
+                while (true)
+                {
+                    size_t begin, end;
+                    {
+                        OGRE_WQ_LOCK_MUTEX(mutex);
+                        if (next == count)
+                            return;
+                        begin = next;
+                        end = next = std::min(count, next + batch);
+                    }
+
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        try
+                        {
+                            (*func)(i);
+                        }
+                        catch (...)
+                        {
+                            OGRE_WQ_LOCK_MUTEX(mutex);
+                            if (!error)
+                                error = std::current_exception();
+                        }
+                    }
+
+                    OGRE_WQ_LOCK_MUTEX(mutex);
+                    done += end - begin;
+                    if (done == count)
+                        OGRE_THREAD_NOTIFY_ALL(finished);
+                }
+            }
+        };
+        typedef std::shared_ptr<ParallelForJob> ParallelForJobPtr;
+    }
+#endif
+    //---------------------------------------------------------------------
+    void DefaultWorkQueueBase::parallelFor(size_t count, const std::function<void(size_t)>& func)
+    {
+#if OGRE_THREAD_SUPPORT && defined(OGRE_THREAD_WAIT)
+        // Leave one share for the calling thread
+        size_t helpers = std::min(count, mWorkerThreadCount + 1);
+        helpers = helpers ? helpers - 1 : 0;
+        if (helpers && mIsRunning && !mPaused)
+        {
+            // A few batches per thread, to even out calls of uneven cost
+            size_t batch = std::max<size_t>(1, count / ((helpers + 1) * 4));
+            ParallelForJobPtr job = std::make_shared<ParallelForJob>(count, batch, &func);
+            for (size_t h = 0; h < helpers; ++h)
+                addRequest(mParallelForChannel, 0, Any(job));
+
+            // Helpers that start late find nothing left and return straight away
+            job->run();
+
+            OGRE_WQ_LOCK_MUTEX_NAMED(job->mutex, lock);
+            while (job->done < job->count)
+                OGRE_THREAD_WAIT(job->finished, job->mutex, lock);
+            if (job->error)
+                std::rethrow_exception(job->error);
+            return;
+        }
+#endif
+        WorkQueue::parallelFor(count, func);
+    }
+    //---------------------------------------------------------------------
+    WorkQueue::Response* DefaultWorkQueueBase::ParallelForHandler::handleRequest(
+        const Request* req, const WorkQueue* srcQ)
+    {
+#if OGRE_THREAD_SUPPORT && defined(OGRE_THREAD_WAIT)
+        any_cast<ParallelForJobPtr>(req->getData())->run();
+#endif
+        // Nothing to hand back to the main thread, flag the request so that
+        // it is discarded without a response
+        req->abortRequest();
+        return 0;
+    }
     //---------------------------------------------------------------------
 
     void DefaultWorkQueueBase::WorkerFunc::operator()()
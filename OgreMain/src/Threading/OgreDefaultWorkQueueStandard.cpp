@@ -106,7 +106,12 @@ namespace Ogre
             OGRE_THREAD_CURRENT_ID
             << ".";
 
-        mShuttingDown = true;
+        {
+            // under the queue lock, so that no worker can be between checking the
+            // flag and waiting when the threads are woken below
+            OGRE_WQ_LOCK_MUTEX(mRequestMutex);
+            mShuttingDown = true;
+        }
         abortAllRequests();
 #if OGRE_THREAD_SUPPORT
         // wake all threads (they should check shutting down as first thing after wait)
@@ -139,7 +144,7 @@ namespace Ogre
 #if OGRE_THREAD_SUPPORT
         // Lock; note that OGRE_THREAD_WAIT will free the lock
             OGRE_WQ_LOCK_MUTEX_NAMED(mRequestMutex, queueLock);
-        if (mRequestQueue.empty())
+        if (mRequestQueue.empty() && !mShuttingDown)
         {
             // frees lock and suspends the thread
             OGRE_THREAD_WAIT(mRequestCondition, mRequestMutex, queueLock);
@@ -56,6 +56,9 @@ namespace Ogre {
         // Set features for debugging render
         mShowNodeAABs = false;
 
+        // Level geometry is queued by _findVisibleObjects, not the scene graph
+        setShadowTextureSharedCasterCulling(false);
+
         mLevel.reset();
 
     }
@@ -204,7 +204,8 @@ void OctreeRaySceneQuery::execute(RaySceneQueryListener* listener)
 
                 if( result.first )
                 {
-                    listener -> queryResult( m, result.second );
+                    if (intersectsTriangles(m, result.second))
+                        listener -> queryResult( m, result.second );
                     // deal with attached objects, since they are not directly attached to nodes
                     if (m->getMovableType() == "Entity")
                     {
@@ -216,7 +217,7 @@ void OctreeRaySceneQuery::execute(RaySceneQueryListener* listener)
                             if (c->getQueryFlags() & mQueryMask)
                             {
                                 result = mRay.intersects(c->getWorldBoundingBox());
-                                if (result.first)
+                                if (result.first && intersectsTriangles(c, result.second))
                                 {
                                     listener->queryResult(c, result.second);
                                 }
@@ -55,7 +55,10 @@ namespace Ogre
     mShowPortals(false),
     mZoneFactoryManager(0),
     mActiveCameraZone(0)
-    { }
+    {
+        // Visibility goes through zones and portals, not just the scene graph
+        setShadowTextureSharedCasterCulling(false);
+    }
 
     PCZSceneManager::~PCZSceneManager()
     {
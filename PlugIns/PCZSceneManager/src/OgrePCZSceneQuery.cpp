@@ -207,7 +207,8 @@ namespace Ogre
 
                     if( result.first )
                     {
-                        listener -> queryResult( m, result.second );
+                        if (intersectsTriangles(m, result.second))
+                            listener -> queryResult( m, result.second );
                         // deal with attached objects, since they are not directly attached to nodes
                         if (m->getMovableType() == "Entity")
                         {
@@ -219,7 +220,7 @@ namespace Ogre
                                 if (c->getQueryFlags() & mQueryMask)
                                 {
                                     result = mRay.intersects(c->getWorldBoundingBox());
-                                    if (result.first)
+                                    if (result.first && intersectsTriangles(c, result.second))
                                     {
                                         listener->queryResult(c, result.second);
                                     }
@@ -3352,6 +3352,7 @@ namespace Ogre {
                 normalised = GL_TRUE;
                 break;
             case VET_UBYTE4_NORM:
+            case VET_BYTE4_NORM:
             case VET_SHORT2_NORM:
             case VET_USHORT2_NORM:
             case VET_SHORT4_NORM:
@@ -3375,10 +3376,37 @@ namespace Ogre {
         }
         else
         {
+            // glVertexPointer and glTexCoordPointer do not normalise integers
+            bool normalised = false;
+            switch(elem.getType())
+            {
+            case VET_UBYTE4_NORM:
+            case VET_BYTE4_NORM:
+            case VET_SHORT2_NORM:
+            case VET_USHORT2_NORM:
+            case VET_SHORT4_NORM:
+            case VET_USHORT4_NORM:
+                normalised = true;
+                break;
+            default:
+                break;
+            };
+
             // fixed-function & builtin attribute support
             switch(sem)
             {
             case VES_POSITION:
+                if (normalised)
+                {
+                    // generic attribute 0 aliases the vertex position
+                    glVertexAttribPointerARB(0, VertexElement::getTypeCount(elem.getType()),
+                                             GLHardwareBufferManager::getGLType(elem.getType()), GL_TRUE,
+                                             static_cast<GLsizei>(vertexBuffer->getVertexSize()),
+                                             pBufferData);
+                    glEnableVertexAttribArrayARB(0);
+                    mRenderAttribsBound.push_back(0);
+                    break;
+                }
                 glVertexPointer(VertexElement::getTypeCount(
                     elem.getType()),
                                 GLHardwareBufferManager::getGLType(elem.getType()),
@@ -3411,6 +3439,13 @@ namespace Ogre {
                 }
                 break;
             case VES_TEXTURE_COORDINATES:
+                if (normalised)
+                {
+                    OGRE_EXCEPT(Exception::ERR_RENDERINGAPI_ERROR,
+                                "Normalised texture coordinates need a vertex program reading them "
+                                "as generic attributes",
+                                "GLRenderSystem::bindVertexElementToGpu");
+                }
 
                 if (mCurrentVertexProgram)
                 {
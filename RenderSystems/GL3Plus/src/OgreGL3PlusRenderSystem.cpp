@@ -2417,6 +2417,7 @@ namespace Ogre {
             normalised = GL_TRUE;
             break;
         case VET_UBYTE4_NORM:
+        case VET_BYTE4_NORM:
         case VET_SHORT2_NORM:
         case VET_USHORT2_NORM:
         case VET_SHORT4_NORM:
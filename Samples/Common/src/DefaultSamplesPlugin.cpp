@@ -74,6 +74,7 @@
 #include "TextureArray.h"
 #include "TextureFX.h"
 #include "Transparency.h"
+#include "VirtualShadowMap.h"
 #ifdef OGRE_BUILD_COMPONENT_VOLUME
 #   include "VolumeCSG.h"
 #   include "VolumeTerrain.h"
@@ -138,6 +139,7 @@ DefaultSamplesPlugin::DefaultSamplesPlugin() : SamplePlugin("DefaultSamplesPlugi
     addSample(new Sample_Water);
     addSample(new Sample_Dot3Bump);
     addSample(new Sample_Fresnel);
+    addSample(new Sample_VirtualShadowMap);
 #ifdef OGRE_BUILD_COMPONENT_TERRAIN
     addSample(new Sample_Terrain);
     addSample(new Sample_EndlessWorld);
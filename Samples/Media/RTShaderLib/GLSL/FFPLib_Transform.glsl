@@ -83,3 +83,26 @@ void FFP_DerivePointSize(in vec4 params,
 {
 	sz = params.x/sqrt(params.y + params.z*d + params.w*d*d);
 }
+
+//-----------------------------------------------------------------------------
+void FFP_InstanceTransform(in vec4 r0,
+						   in vec4 r1,
+						   in vec4 r2,
+						   inout vec4 v)
+{
+	v = vec4(dot(r0, v), dot(r1, v), dot(r2, v), v.w);
+}
+
+//-----------------------------------------------------------------------------
+void FFP_InstanceTransformNormal(in vec4 r0,
+								 in vec4 r1,
+								 in vec4 r2,
+								 inout vec3 v)
+{
+	// inverse transpose of the 3x3 part, built from the cross products of its columns
+	vec3 c0 = vec3(r0.x, r1.x, r2.x);
+	vec3 c1 = vec3(r0.y, r1.y, r2.y);
+	vec3 c2 = vec3(r0.z, r1.z, r2.z);
+	vec3 c12 = cross(c1, c2);
+	v = (v.x * c12 + v.y * cross(c2, c0) + v.z * cross(c0, c1)) / dot(c0, c12);
+}
@@ -0,0 +1,190 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Program Name: SGXLib_ClusteredLighting
+// Program Desc: Clustered forward lighting functions.
+// Program Type: Pixel shader
+// Language: GLSL
+// Notes: The light data layout is described in LightClusters (OgreLightClusters.h).
+//-----------------------------------------------------------------------------
+
+// LightClusters::MAX_LIGHTS_PER_CLUSTER
+#define SGX_CLUSTER_MAX_LIGHTS 256
+#define SGX_CLUSTER_MAX_DIRECTIONAL_LIGHTS 8
+// LightClusters::LIGHT_TEXELS
+#define SGX_CLUSTER_LIGHT_TEXELS 5.0
+
+//-----------------------------------------------------------------------------
+vec4 SGX_FetchClusterTexel(in sampler2D s, in float x, in float y, in vec2 vSize)
+{
+	return texture2D(s, (vec2(x, y) + 0.5) / vSize);
+}
+
+//-----------------------------------------------------------------------------
+void SGX_Light_Clustered_Single(
+				    in sampler2D lightTex,
+				    in float fLightTexHeight,
+				    in float fLightIndex,
+				    in vec3 vNormalView,
+				    in vec3 vView,
+				    in vec3 vViewPos,
+				    in float fSpecularPower,
+				    inout vec3 vDiffuse,
+				    inout vec3 vSpecular)
+{
+	vec2 vSize = vec2(SGX_CLUSTER_LIGHT_TEXELS, fLightTexHeight);
+	vec4 vPosRange     = SGX_FetchClusterTexel(lightTex, 0.0, fLightIndex, vSize);
+	vec4 vDiffuseType  = SGX_FetchClusterTexel(lightTex, 1.0, fLightIndex, vSize);
+	vec4 vSpecFalloff  = SGX_FetchClusterTexel(lightTex, 2.0, fLightIndex, vSize);
+	vec4 vAttParams    = SGX_FetchClusterTexel(lightTex, 3.0, fLightIndex, vSize);
+	vec4 vSpotDir      = SGX_FetchClusterTexel(lightTex, 4.0, fLightIndex, vSize);
+
+	vec3 vLightView = vPosRange.xyz;
+	float fAtten = 1.0;
+
+	// Type 1 is directional, xyz is the direction towards the light
+	if (vDiffuseType.w != 1.0)
+	{
+		vLightView = vPosRange.xyz - vViewPos;
+		float fLightD = length(vLightView);
+		if (fLightD > vPosRange.w)
+			return;
+
+		vLightView /= fLightD;
+		fAtten = 1.0 / (vAttParams.x + vAttParams.y*fLightD + vAttParams.z*fLightD*fLightD);
+
+		// Type 2 is spot
+		if (vDiffuseType.w == 2.0)
+		{
+			float rho    = dot(vSpotDir.xyz, vLightView);
+			float fSpotE = clamp((rho - vAttParams.w) / (vSpotDir.w - vAttParams.w), 0.0, 1.0);
+			fAtten *= pow(fSpotE, vSpecFalloff.w);
+		}
+	}
+
+	float nDotL = dot(vNormalView, vLightView);
+	if (nDotL > 0.0)
+	{
+		vec3 vHalfWay = normalize(vView + vLightView);
+		float nDotH   = dot(vNormalView, vHalfWay);
+
+		vDiffuse  += vDiffuseType.xyz * nDotL * fAtten;
+		vSpecular += vSpecFalloff.xyz * pow(clamp(nDotH, 0.0, 1.0), fSpecularPower) * fAtten;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void SGX_Light_Clustered_DiffuseSpecular(
+				    in vec3 vNormal,
+				    in vec3 vViewPos,
+				    in vec4 vDepthParams,
+				    in vec4 vProjectionParams,
+				    in vec4 vGridParams,
+				    in vec4 vTextureParams,
+				    in sampler2D lightTex,
+				    in sampler2D clusterTex,
+				    in sampler2D indexTex,
+				    in vec3 vDiffuseColour,
+				    in vec3 vSpecularColour,
+				    in float fSpecularPower,
+				    in vec3 vBaseDiffuseColour,
+				    in vec3 vBaseSpecularColour,
+				    out vec3 vOutDiffuse,
+				    out vec3 vOutSpecular)
+{
+	vOutDiffuse  = vBaseDiffuseColour;
+	vOutSpecular = vBaseSpecularColour;
+
+	// Clustering disabled
+	if (vGridParams.x == 0.0)
+		return;
+
+	vec3 vNormalView = normalize(vNormal);
+	vec3 vView       = -normalize(vViewPos);
+	vec3 vDiffuse    = vec3(0.0);
+	vec3 vSpecular   = vec3(0.0);
+
+	for (int i = 0; i < SGX_CLUSTER_MAX_DIRECTIONAL_LIGHTS; ++i)
+	{
+		if (float(i) >= vGridParams.z)
+			break;
+		SGX_Light_Clustered_Single(lightTex, vGridParams.w, float(i), vNormalView, vView, vViewPos,
+			fSpecularPower, vDiffuse, vSpecular);
+	}
+
+	// Cluster of this pixel
+	float fDepth = -vViewPos.z;
+	vec2 vNDC = vViewPos.xy * vProjectionParams.xy;
+	if (vDepthParams.w != 0.0)
+		vNDC /= fDepth;
+	vNDC += vProjectionParams.zw;
+
+	vec2 vTile   = clamp(floor((vNDC * 0.5 + 0.5) * vGridParams.xy), vec2(0.0), vGridParams.xy - 1.0);
+	float fSlice = floor(log(max(fDepth, vDepthParams.x) / vDepthParams.x) * vDepthParams.y);
+	fSlice = clamp(fSlice, 0.0, vDepthParams.z - 1.0);
+
+	// x: offset into the light indices, y: light count
+	vec4 vCluster = SGX_FetchClusterTexel(clusterTex, vTile.y * vGridParams.x + vTile.x, fSlice, vTextureParams.xy);
+
+	for (int i = 0; i < SGX_CLUSTER_MAX_LIGHTS; ++i)
+	{
+		if (float(i) >= vCluster.y)
+			break;
+
+		float fIndex = vCluster.x + float(i);
+		float fRow   = floor(fIndex / vTextureParams.z);
+		float fLight = SGX_FetchClusterTexel(indexTex, fIndex - fRow * vTextureParams.z, fRow, vTextureParams.zw).x;
+
+		SGX_Light_Clustered_Single(lightTex, vGridParams.w, fLight, vNormalView, vView, vViewPos,
+			fSpecularPower, vDiffuse, vSpecular);
+	}
+
+	vOutDiffuse  += vDiffuse * vDiffuseColour;
+	vOutSpecular += vSpecular * vSpecularColour;
+}
+
+//-----------------------------------------------------------------------------
+void SGX_Light_Clustered_Diffuse(
+				    in vec3 vNormal,
+				    in vec3 vViewPos,
+				    in vec4 vDepthParams,
+				    in vec4 vProjectionParams,
+				    in vec4 vGridParams,
+				    in vec4 vTextureParams,
+				    in sampler2D lightTex,
+				    in sampler2D clusterTex,
+				    in sampler2D indexTex,
+				    in vec3 vDiffuseColour,
+				    in vec3 vBaseColour,
+				    out vec3 vOut)
+{
+	vec3 vSpecular;
+	SGX_Light_Clustered_DiffuseSpecular(vNormal, vViewPos, vDepthParams, vProjectionParams, vGridParams,
+		vTextureParams, lightTex, clusterTex, indexTex, vDiffuseColour, vec3(0.0), 1.0,
+		vBaseColour, vec3(0.0), vOut, vSpecular);
+}
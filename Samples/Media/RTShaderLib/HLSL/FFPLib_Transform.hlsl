@@ -76,3 +76,26 @@ void FFP_Transform(in float4x4 m,
 }
 
 
+
+//-----------------------------------------------------------------------------
+void FFP_InstanceTransform(in float4 r0,
+						   in float4 r1,
+						   in float4 r2,
+						   inout float4 v)
+{
+	v = float4(dot(r0, v), dot(r1, v), dot(r2, v), v.w);
+}
+
+//-----------------------------------------------------------------------------
+void FFP_InstanceTransformNormal(in float4 r0,
+								 in float4 r1,
+								 in float4 r2,
+								 inout float3 v)
+{
+	// inverse transpose of the 3x3 part, built from the cross products of its columns
+	float3 c0 = float3(r0.x, r1.x, r2.x);
+	float3 c1 = float3(r0.y, r1.y, r2.y);
+	float3 c2 = float3(r0.z, r1.z, r2.z);
+	float3 c12 = cross(c1, c2);
+	v = (v.x * c12 + v.y * cross(c2, c0) + v.z * cross(c0, c1)) / dot(c0, c12);
+}
@@ -0,0 +1,39 @@
+#version 120
+
+uniform sampler2D diffuseMap;
+// per page of the virtual map: top left of its atlas slot, pages per side and 1
+uniform sampler2D pageTable;
+uniform sampler2D atlas;
+
+uniform vec4 ambient;
+uniform vec4 lightColour;
+// x: page size over atlas size, y: depth bias
+uniform vec4 pageParams;
+
+varying vec4 lightClipPos;
+varying vec2 oUv;
+varying float diffuse;
+
+float shadow()
+{
+	vec3 pos = lightClipPos.xyz / lightClipPos.w;
+	// virtual map coordinates, origin at the top left
+	vec2 uv = vec2(pos.x, -pos.y) * 0.5 + 0.5;
+	if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0))))
+		return 1.0;
+
+	// level 0 holds the closest resident page for every page
+	vec4 page = texture2D(pageTable, uv);
+	if (page.w == 0.0)
+		return 1.0;
+
+	vec2 atlasUv = page.xy + fract(uv * page.z) * pageParams.x;
+	float depth = texture2D(atlas, atlasUv).x;
+	return (depth + pageParams.y >= pos.z) ? 1.0 : 0.0;
+}
+
+void main()
+{
+	vec4 light = ambient + lightColour * diffuse * shadow();
+	gl_FragColor = vec4(texture2D(diffuseMap, oUv).xyz * light.xyz, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 120
+
+uniform mat4 world;
+uniform mat4 worldViewProj;
+uniform mat4 lightViewProj;
+uniform vec4 lightPosition;
+
+attribute vec4 vertex;
+attribute vec3 normal;
+attribute vec4 uv0;
+
+varying vec4 lightClipPos;
+varying vec2 oUv;
+varying float diffuse;
+
+void main()
+{
+	gl_Position = worldViewProj * vertex;
+
+	vec4 worldPos = world * vertex;
+	lightClipPos = lightViewProj * worldPos;
+
+	// directional light, the position is the direction towards it
+	vec3 worldNorm = normalize(mat3(world) * normal);
+	diffuse = max(dot(worldNorm, lightPosition.xyz), 0.0);
+
+	oUv = uv0.xy;
+}
@@ -0,0 +1,11 @@
+#version 120
+
+uniform sampler2D diffuseMap;
+
+varying vec2 oUv;
+varying vec4 oColour;
+
+void main()
+{
+	gl_FragColor = texture2D(diffuseMap, oUv) * oColour;
+}
@@ -0,0 +1,32 @@
+#version 120
+
+// Expands billboards drawn by BillboardSet with instancing enabled.
+// Per vertex: corner (xy) and its parametric offset (zw), camera axes.
+attribute vec4 uv0;
+attribute vec3 uv3;
+attribute vec3 uv4;
+
+// Per instance: centre, colour, width/height/rotation, texture rectangle.
+attribute vec4 vertex;
+attribute vec4 colour;
+attribute vec3 uv1;
+attribute vec4 uv2;
+
+uniform mat4 worldViewProj;
+
+varying vec2 oUv;
+varying vec4 oColour;
+
+void main()
+{
+	vec2 off = uv0.zw * uv1.xy;
+	float c = cos(uv1.z);
+	float s = sin(uv1.z);
+	off = vec2(c * off.x - s * off.y, s * off.x + c * off.y);
+
+	vec3 pos = vertex.xyz + uv3 * off.x + uv4 * off.y;
+	gl_Position = worldViewProj * vec4(pos, 1.0);
+
+	oUv = mix(uv2.xy, uv2.zw, uv0.xy);
+	oColour = colour;
+}
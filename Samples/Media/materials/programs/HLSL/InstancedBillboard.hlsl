@@ -0,0 +1,47 @@
+// Expands billboards drawn by BillboardSet with instancing enabled.
+struct VS_INPUT
+{
+	// Per vertex: corner (xy) and its parametric offset (zw), camera axes
+	float4 corner	:	TEXCOORD0;
+	float3 camX		:	TEXCOORD3;
+	float3 camY		:	TEXCOORD4;
+
+	// Per instance: centre, colour, width/height/rotation, texture rectangle
+	float4 centre	:	POSITION;
+	float4 colour	:	COLOR0;
+	float3 sizeRot	:	TEXCOORD1;
+	float4 rect		:	TEXCOORD2;
+};
+
+struct VS_OUTPUT
+{
+	float4 Position	:	SV_POSITION;
+	float2 uv		:	TEXCOORD0;
+	float4 colour	:	COLOR0;
+};
+
+VS_OUTPUT main_vs( VS_INPUT input, uniform float4x4 worldViewProj )
+{
+	VS_OUTPUT output;
+
+	float2 off = input.corner.zw * input.sizeRot.xy;
+	float c = cos(input.sizeRot.z);
+	float s = sin(input.sizeRot.z);
+	off = float2(c * off.x - s * off.y, s * off.x + c * off.y);
+
+	float3 pos = input.centre.xyz + input.camX * off.x + input.camY * off.y;
+	output.Position = mul(worldViewProj, float4(pos, 1.0f));
+
+	output.uv = lerp(input.rect.xy, input.rect.zw, input.corner.xy);
+	output.colour = input.colour;
+
+	return output;
+}
+
+Texture2D diffuseMap : register(t0);
+SamplerState samplerState : register(s0);
+
+float4 main_ps( VS_OUTPUT input ) : SV_Target
+{
+	return diffuseMap.Sample(samplerState, input.uv) * input.colour;
+}
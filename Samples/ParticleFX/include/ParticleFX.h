@@ -78,6 +78,10 @@ protected:
         ps = mSceneMgr->createParticleSystem("Aureola", "Examples/Aureola");
         mSceneMgr->getRootSceneNode()->attachObject(ps);
 
+        // create a swarm of flares expanded on the GPU
+        ps = mSceneMgr->createParticleSystem("Swarm", "Examples/InstancedSwarm");
+        mSceneMgr->getRootSceneNode()->attachObject(ps);
+
         // create shared pivot node for spinning the fountains
         mFountainPivot = mSceneMgr->getRootSceneNode()->createChildSceneNode();
 
@@ -100,6 +104,7 @@ protected:
         mTrayMgr->createCheckBox(TL_TOPLEFT, "Aureola", "Aureola", 130)->setChecked(false);
         mTrayMgr->createCheckBox(TL_TOPLEFT, "Nimbus", "Nimbus", 130)->setChecked(false);
         mTrayMgr->createCheckBox(TL_TOPLEFT, "Rain", "Rain", 130)->setChecked(false);
+        mTrayMgr->createCheckBox(TL_TOPLEFT, "Swarm", "Swarm", 130)->setChecked(false);
     }
 
     SceneNode* mFountainPivot;
@@ -0,0 +1,197 @@
+#ifndef __VirtualShadowMap_H__
+#define __VirtualShadowMap_H__
+
+#include "SdkSample.h"
+#include "OgreVirtualShadowMap.h"
+
+using namespace Ogre;
+using namespace OgreBites;
+
+class _OgreSampleClassExport Sample_VirtualShadowMap : public SdkSample, public MaterialManager::Listener
+{
+public:
+
+    Sample_VirtualShadowMap() : mVsm(0), mAtlasViewport(0), mStatsPanel(0)
+    {
+        mInfo["Title"] = "Virtual Shadow Map";
+        mInfo["Description"] = "Shadows a large scene from a single virtual shadow map. Only the pages "
+            "seen by the camera are rendered, at the resolution they are seen at, into a small atlas.";
+        mInfo["Thumbnail"] = "thumb_shadows.png";
+        mInfo["Category"] = "Lighting";
+    }
+
+    void testCapabilities(const RenderSystemCapabilities* caps)
+    {
+        if (!GpuProgramManager::getSingleton().isSyntaxSupported("glsl"))
+        {
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED, "This sample needs GLSL shaders, "
+                        "so you cannot run this sample. Sorry!", "Sample_VirtualShadowMap::testCapabilities");
+        }
+        if (!caps->hasCapability(RSC_TEXTURE_FLOAT))
+        {
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED, "Your graphics card does not support floating "
+                        "point textures, so you cannot run this sample. Sorry!",
+                        "Sample_VirtualShadowMap::testCapabilities");
+        }
+    }
+
+    bool frameStarted(const FrameEvent& evt)
+    {
+        // request the pages of the receivers in view, at the resolution they are seen at
+        mVsm->beginFrame();
+        for (size_t i = 0; i < mReceivers.size(); ++i)
+        {
+            const AxisAlignedBox& bounds = mReceivers[i]->getWorldBoundingBox(true);
+            if (mCamera->isVisible(bounds))
+                mVsm->requestReceiver(bounds, mCamera, (Real)mViewport->getActualHeight());
+        }
+
+        // render what is missing into the atlas and point the page table at it
+        const VirtualShadowMap::PageRenderList& pages = mVsm->update();
+        size_t numRendered = pages.size();
+        mVsm->renderPages(mAtlasViewport);
+        mVsm->uploadPageTable();
+
+        mStatsPanel->setParamValue(0, StringConverter::toString(mVsm->getNumRequestedPages()));
+        mStatsPanel->setParamValue(1, StringConverter::toString(numRendered));
+        mStatsPanel->setParamValue(2, StringConverter::toString(mVsm->getNumResidentPages()) + " / " +
+                                   StringConverter::toString(mVsm->getNumSlots()));
+        mStatsPanel->setParamValue(3, StringConverter::toString(mVsm->getNumDroppedPages()));
+
+        return SdkSample::frameStarted(evt);
+    }
+
+    /** @copydoc MaterialManager::Listener::handleSchemeNotFound */
+    Technique* handleSchemeNotFound(unsigned short schemeIndex, const String& schemeName,
+                                    Material* originalMaterial, unsigned short lodIndex,
+                                    const Renderable* rend)
+    {
+        // everything casts into the atlas with the same depth material
+        MaterialPtr caster = MaterialManager::getSingleton().getByName(
+            "Ogre/DepthShadowmap/Caster/Float");
+        caster->load();
+        return caster->getBestTechnique();
+    }
+
+protected:
+
+    void setupContent()
+    {
+        mSceneMgr->setAmbientLight(ColourValue(0.3, 0.3, 0.3));
+
+        Vector3 dir(-1, -2, -1);
+        dir.normalise();
+        Light* light = mSceneMgr->createLight("Sun");
+        light->setType(Light::LT_DIRECTIONAL);
+        SceneNode* lightNode = mSceneMgr->getRootSceneNode()->createChildSceneNode();
+        lightNode->attachObject(light);
+        lightNode->setDirection(dir, Node::TS_WORLD);
+
+        // a ground far larger than a single shadow map would cover in detail
+        MeshManager::getSingleton().createPlane("VirtualShadowMap/GroundTile",
+            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, Plane(Vector3::UNIT_Y, 0), 125, 125,
+            1, 1, true, 1, 1, 1, Vector3::UNIT_Z);
+        for (int z = 0; z < 16; ++z)
+        {
+            for (int x = 0; x < 16; ++x)
+            {
+                Entity* tile = mSceneMgr->createEntity("VirtualShadowMap/GroundTile");
+                tile->setMaterialName("Examples/VirtualShadowMap/Ground");
+                mSceneMgr->getRootSceneNode()->createChildSceneNode(
+                    Vector3((x - 7.5f) * 125, 0, (z - 7.5f) * 125))->attachObject(tile);
+                mReceivers.push_back(tile);
+            }
+        }
+
+        for (int z = 0; z < 10; ++z)
+        {
+            for (int x = 0; x < 10; ++x)
+            {
+                Entity* knot = mSceneMgr->createEntity("knot.mesh");
+                knot->setMaterialName("Examples/VirtualShadowMap/Knot");
+                Vector3 pos((x - 4.5f) * 180 + Math::RangeRandom(-40, 40), 40,
+                            (z - 4.5f) * 180 + Math::RangeRandom(-40, 40));
+                SceneNode* node = mSceneMgr->getRootSceneNode()->createChildSceneNode(pos);
+                node->setScale(0.25, 0.25, 0.25);
+                node->yaw(Degree(Math::RangeRandom(0, 360)));
+                node->attachObject(knot);
+                mReceivers.push_back(knot);
+            }
+        }
+
+        // an orthographic light camera covering the whole scene, the virtual map crops it per page
+        Camera* lightCam = mSceneMgr->createCamera("VirtualShadowMap/Light");
+        lightCam->setProjectionType(PT_ORTHOGRAPHIC);
+        lightCam->setOrthoWindow(2900, 2900);
+        lightCam->setNearClipDistance(10);
+        lightCam->setFarClipDistance(3000);
+        SceneNode* lightCamNode = mSceneMgr->getRootSceneNode()->createChildSceneNode(-dir * 1500);
+        lightCamNode->attachObject(lightCam);
+        lightCamNode->setDirection(dir, Node::TS_WORLD);
+
+        mVsm = new VirtualShadowMap("VirtualShadowMap");
+        mVsm->setSizes(16384, 256, 2048);
+        mVsm->setLightMatrices(lightCam->getViewMatrix(true), lightCam->getProjectionMatrix());
+
+        mAtlas = TextureManager::getSingleton().createManual("VirtualShadowMap/Atlas",
+            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, TEX_TYPE_2D,
+            mVsm->getAtlasSize(), mVsm->getAtlasSize(), 0, PF_FLOAT32_R, TU_RENDERTARGET);
+        RenderTarget* atlasTarget = mAtlas->getBuffer()->getRenderTarget();
+        atlasTarget->setAutoUpdated(false);
+        mAtlasViewport = atlasTarget->addViewport(lightCam);
+        mAtlasViewport->setClearEveryFrame(true);
+        mAtlasViewport->setBackgroundColour(ColourValue::White);
+        mAtlasViewport->setOverlaysEnabled(false);
+        mAtlasViewport->setShadowsEnabled(false);
+        mAtlasViewport->setMaterialScheme("VirtualShadowMap/Caster");
+        MaterialManager::getSingleton().addListener(this, "VirtualShadowMap/Caster");
+
+        // the page table texture is created on the first upload
+        mVsm->uploadPageTable();
+        Matrix4 lightViewProj = mVsm->getLightProjectionMatrix() * mVsm->getLightViewMatrix();
+        const char* receivers[] = {"Examples/VirtualShadowMap/Ground", "Examples/VirtualShadowMap/Knot"};
+        for (size_t i = 0; i < 2; ++i)
+        {
+            Pass* pass = MaterialManager::getSingleton().getByName(receivers[i])
+                ->getTechnique(0)->getPass(0);
+            pass->getVertexProgramParameters()->setNamedConstant("lightViewProj", lightViewProj);
+            pass->getFragmentProgramParameters()->setNamedConstant(
+                "pageParams", Vector4((Real)mVsm->getPageSize() / mVsm->getAtlasSize(), 0.001, 0, 0));
+            pass->getTextureUnitState("PageTable")->setTexture(mVsm->getPageTableTexture());
+            pass->getTextureUnitState("Atlas")->setTexture(mAtlas);
+        }
+
+        StringVector items;
+        items.push_back("Requested pages");
+        items.push_back("Rendered pages");
+        items.push_back("Resident pages");
+        items.push_back("Dropped pages");
+        mStatsPanel = mTrayMgr->createParamsPanel(TL_TOPLEFT, "VirtualShadowMapStats", 250, items);
+
+        mCameraNode->setPosition(0, 300, 900);
+        mCameraNode->lookAt(Vector3(0, 0, 0), Node::TS_WORLD);
+        mCamera->setNearClipDistance(5);
+        mCamera->setFarClipDistance(5000);
+    }
+
+    void cleanupContent()
+    {
+        MaterialManager::getSingleton().removeListener(this, "VirtualShadowMap/Caster");
+        mReceivers.clear();
+        TextureManager::getSingleton().remove(mAtlas);
+        mAtlas.reset();
+        mAtlasViewport = 0;
+        delete mVsm;
+        mVsm = 0;
+        MeshManager::getSingleton().remove("VirtualShadowMap/GroundTile",
+                                            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+    }
+
+    VirtualShadowMap* mVsm;
+    TexturePtr mAtlas;
+    Viewport* mAtlasViewport;
+    ParamsPanel* mStatsPanel;
+    std::vector<Entity*> mReceivers;
+};
+
+#endif
@@ -0,0 +1,134 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <OgreBillboard.h>
+#include <OgreBillboardSet.h>
+#include <OgreGpuProgramManager.h>
+#include <OgreTimer.h>
+#include "RootWithStubRenderSystemFixture.h"
+
+using namespace Ogre;
+
+class BillboardSetBenchmarks : public RootWithStubRenderSystemFixture
+{
+public:
+    SceneManager* mSceneMgr;
+    Camera* mCamera;
+    MaterialPtr mInstancedMaterial;
+
+    void SetUp()
+    {
+        RootWithStubRenderSystemFixture::SetUp();
+        mSceneMgr = mRoot->createSceneManager();
+        mCamera = mSceneMgr->createCamera("BillboardSetBenchmarks");
+        mSceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(0, 0, 500))->attachObject(mCamera);
+
+        // the program is never run, but marks the pass as programmable
+        GpuProgramPtr vp = GpuProgramManager::getSingleton().createProgramFromString(
+            "BillboardSetBenchmarks/vp", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, "", GPT_VERTEX_PROGRAM,
+            "stub");
+        mInstancedMaterial = MaterialManager::getSingleton().create("BillboardSetBenchmarks/Instanced", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        mInstancedMaterial->getTechnique(0)->getPass(0)->setGpuProgram(GPT_VERTEX_PROGRAM, vp);
+    }
+
+    void TearDown()
+    {
+        mInstancedMaterial.reset();
+        RootWithStubRenderSystemFixture::TearDown();
+    }
+
+    BillboardSet* createSet(size_t count, bool instanced)
+    {
+        BillboardSet* bbs = mSceneMgr->createBillboardSet(count);
+        bbs->setInstancingEnabled(instanced);
+        if (instanced)
+            bbs->setMaterial(mInstancedMaterial);
+        mSceneMgr->getRootSceneNode()->attachObject(bbs);
+        bbs->_notifyCurrentCamera(mCamera);
+        return bbs;
+    }
+
+    /// Microseconds to pack the billboards the given number of times
+    unsigned long packFrames(BillboardSet* bbs, const std::vector<Billboard>& billboards, int frames)
+    {
+        Timer timer;
+        for (int f = 0; f < frames; ++f)
+        {
+            bbs->beginBillboards(billboards.size());
+            bbs->injectBillboards(&billboards[0], billboards.size());
+            bbs->endBillboards();
+        }
+        return timer.getMicroseconds();
+    }
+};
+
+TEST_F(BillboardSetBenchmarks, Packing)
+{
+    // The quad path uses 16 bit indices
+    const size_t count = 16000;
+    const int frames = 200;
+
+    BillboardSet* quads = createSet(count, false);
+    BillboardSet* instanced = createSet(count, true);
+
+    std::vector<Billboard> billboards;
+    billboards.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Real f = Real(i);
+        billboards.push_back(Billboard(Vector3(f, -f, 0.5f * f), quads, ColourValue(1, 0.5f, f / count)));
+        if (i % 3 == 0)
+            billboards.back().setDimensions(2, 3);
+    }
+    // The billboards are shared, both sets have to know some are resized
+    instanced->_notifyBillboardResized();
+
+    BillboardSet* sets[2] = {quads, instanced};
+    unsigned long times[2];
+    size_t bytes[2];
+    for (int s = 0; s < 2; ++s)
+    {
+        packFrames(sets[s], billboards, 1); // creates the buffers
+        times[s] = packFrames(sets[s], billboards, frames);
+
+        RenderOperation op;
+        sets[s]->getRenderOperation(op);
+        ushort source = op.vertexData->vertexDeclaration->getMaxSource();
+        bytes[s] = std::max<size_t>(op.vertexData->vertexCount, op.numberOfInstances) *
+            op.vertexData->vertexDeclaration->getVertexSize(source);
+    }
+
+    std::cout << "[ BENCH    ] " << count << " billboards x " << frames << " frames: quads "
+              << times[0] / 1000.0 << " ms, " << bytes[0] << " bytes/frame; instances "
+              << times[1] / 1000.0 << " ms, " << bytes[1] << " bytes/frame" << std::endl;
+
+    // one record per billboard instead of 4 vertices has to pay off
+    EXPECT_LT(bytes[1], bytes[0]);
+    EXPECT_LT(times[1], times[0]);
+}
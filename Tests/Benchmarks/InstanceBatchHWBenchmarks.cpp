@@ -0,0 +1,139 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <OgreInstancedEntity.h>
+#include <OgreInstanceBatchHW.h>
+#include <OgreInstanceManager.h>
+#include <OgreTimer.h>
+#include "RootWithStubRenderSystemFixture.h"
+
+using namespace Ogre;
+
+class InstanceBatchHWBenchmarks : public RootWithStubRenderSystemFixture
+{
+public:
+    SceneManager* mSceneMgr;
+    Camera* mCamera;
+    InstanceManager* mInstanceMgr;
+    std::vector<InstancedEntity*> mEntities;
+
+    void SetUp()
+    {
+        RootWithStubRenderSystemFixture::SetUp();
+        mSceneMgr = mRoot->createSceneManager();
+        mCamera = mSceneMgr->createCamera("InstanceBatchHWBenchmarks");
+        mCamera->setNearClipDistance(1);
+        mCamera->setFarClipDistance(3000);
+        mSceneMgr->getRootSceneNode()->createChildSceneNode()->attachObject(mCamera);
+
+        MaterialManager::getSingleton().getByName("BaseWhite")->load();
+        MeshManager::getSingleton().createPlane("InstanceBatchHWBenchmarks/Plane",
+            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, Plane(Vector3::UNIT_Z, 0), 10, 10);
+    }
+
+    void TearDown()
+    {
+        mEntities.clear();
+        mRoot->destroySceneManager(mSceneMgr);
+        RootWithStubRenderSystemFixture::TearDown();
+    }
+
+    InstanceBatchHW* createInstances(size_t count)
+    {
+        mInstanceMgr = mSceneMgr->createInstanceManager("InstanceBatchHWBenchmarks",
+            "InstanceBatchHWBenchmarks/Plane", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+            InstanceManager::HWInstancingBasic, count);
+
+        srand(5);
+        for (size_t i = 0; i < count; ++i)
+        {
+            InstancedEntity* entity = mInstanceMgr->createInstancedEntity("BaseWhite");
+            mSceneMgr->getRootSceneNode()->createChildSceneNode(
+                Vector3(Math::RangeRandom(-2000, 2000), Math::RangeRandom(-2000, 2000),
+                        Math::RangeRandom(-2000, 2000)))->attachObject(entity);
+            mEntities.push_back(entity);
+        }
+        mSceneMgr->_updateSceneGraph(mCamera);
+
+        InstanceManager::InstanceBatchIterator it = mInstanceMgr->getInstanceBatchIterator("BaseWhite");
+        return static_cast<InstanceBatchHW*>(it.getNext());
+    }
+
+    /// Microseconds to cull and upload the batch for the given number of frames
+    unsigned long updateFrames(InstanceBatchHW* batch, int frames, bool turn)
+    {
+        Timer timer;
+        for (int f = 0; f < frames; ++f)
+        {
+            if (turn)
+                mCamera->getParentSceneNode()->yaw(Degree(1));
+            batch->_notifyCurrentCamera(mCamera);
+            batch->_updateRenderQueue(mSceneMgr->getRenderQueue());
+            mSceneMgr->getRenderQueue()->clear();
+        }
+        return timer.getMicroseconds();
+    }
+};
+
+TEST_F(InstanceBatchHWBenchmarks, CullAndUpload)
+{
+    const size_t count = 20000;
+    const int frames = 200;
+
+    InstanceBatchHW* batch = createInstances(count);
+    updateFrames(batch, 1, false);
+
+    // What the per instance InstancedEntity::findVisible culling used to cost, without the upload
+    Timer timer;
+    size_t numVisible = 0;
+    for (int f = 0; f < frames; ++f)
+    {
+        mCamera->getParentSceneNode()->yaw(Degree(1));
+        for (size_t i = 0; i < count; ++i)
+        {
+            const InstancedEntity* entity = mEntities[i];
+            if (mCamera->isVisible(Sphere(entity->_getDerivedPosition(),
+                                          entity->getBoundingRadius() * entity->getMaxScaleCoef())))
+                ++numVisible;
+        }
+    }
+    unsigned long perInstance = timer.getMicroseconds();
+
+    unsigned long turning = updateFrames(batch, frames, true);
+    unsigned long still = updateFrames(batch, frames, false);
+
+    std::cout << "[ BENCH    ] " << count << " instances x " << frames << " frames: per instance culling "
+              << perInstance / 1000.0 << " ms (" << numVisible / frames << " visible); batched culling "
+              << "and upload " << turning / 1000.0 << " ms turning, " << still / 1000.0
+              << " ms still (upload skipped)" << std::endl;
+
+    // culling the batch at once has to beat the per instance tests even with the upload
+    EXPECT_LT(turning, perInstance);
+    EXPECT_LT(still, turning);
+}
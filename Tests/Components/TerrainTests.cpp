@@ -29,6 +29,8 @@ THE SOFTWARE.
 
 #include "OgreRoot.h"
 #include "OgreTerrain.h"
+#include "OgreTerrainLodManager.h"
+#include "OgreStreamSerialiser.h"
 #include "OgreFileSystemLayer.h"
 
 #include "OgreBuildSettings.h"
@@ -122,3 +124,262 @@ TEST_F(TerrainTests, create)
     OGRE_DELETE t;
 }
 //--------------------------------------------------------------------------
+namespace
+{
+    /// First hit of a ray with any triangle of the terrain, split as Terrain does
+    std::pair<bool, Vector3> rayIntersectsBruteForce(Terrain* terrain, const Ray& ray)
+    {
+        Real nearest = std::numeric_limits<Real>::max();
+        long size = terrain->getSize();
+        for (long y = 0; y < size - 1; ++y)
+        {
+            for (long x = 0; x < size - 1; ++x)
+            {
+                Vector3 v1, v2, v3, v4;
+                terrain->getPoint(x, y, &v1);
+                terrain->getPoint(x + 1, y, &v2);
+                terrain->getPoint(x, y + 1, &v3);
+                terrain->getPoint(x + 1, y + 1, &v4);
+                std::pair<bool, Real> hit1 = y % 2 ? Math::intersects(ray, v2, v4, v3, true, true)
+                                                   : Math::intersects(ray, v1, v2, v4, true, true);
+                std::pair<bool, Real> hit2 = y % 2 ? Math::intersects(ray, v1, v2, v3, true, true)
+                                                   : Math::intersects(ray, v1, v4, v3, true, true);
+                if (hit1.first)
+                    nearest = std::min(nearest, hit1.second);
+                if (hit2.first)
+                    nearest = std::min(nearest, hit2.second);
+            }
+        }
+        if (nearest == std::numeric_limits<Real>::max())
+            return std::pair<bool, Vector3>(false, Vector3::ZERO);
+        return std::pair<bool, Vector3>(true, ray.getPoint(nearest));
+    }
+}
+//--------------------------------------------------------------------------
+TEST(TerrainRayTests, HeightBoundsMatchBruteForce)
+{
+    Root root("");
+    SceneManager* sceneMgr = root.createSceneManager();
+    TerrainGlobalOptions options;
+
+    // Rolling hills with some noise, from 0 to about 600 units
+    const uint16 size = 513;
+    std::vector<float> heights(size * size);
+    for (uint16 y = 0; y < size; ++y)
+    {
+        for (uint16 x = 0; x < size; ++x)
+        {
+            heights[y * size + x] = 300 + 200 * Math::Sin(x * 0.031f) * Math::Cos(y * 0.047f) +
+                                    80 * Math::Sin((x + 2 * y) * 0.11f) + Math::RangeRandom(0, 20);
+        }
+    }
+
+    Terrain* terrain = OGRE_NEW Terrain(sceneMgr);
+    Terrain::ImportData imp;
+    imp.inputFloat = &heights[0];
+    imp.terrainSize = size;
+    imp.worldSize = 12000;
+    imp.minBatchSize = 33;
+    imp.maxBatchSize = 65;
+    ASSERT_TRUE(terrain->prepare(imp));
+
+    std::vector<Ray> rays;
+    for (int i = 0; i < 24; ++i)
+    {
+        // from far above, down with a slight tilt
+        Vector3 origin(Math::RangeRandom(-5500, 5500), Math::RangeRandom(4000, 20000),
+                       Math::RangeRandom(-5500, 5500));
+        Vector3 dir(Math::RangeRandom(-0.3f, 0.3f), -1, Math::RangeRandom(-0.3f, 0.3f));
+        rays.push_back(Ray(origin, dir.normalisedCopy()));
+    }
+    for (int i = 0; i < 24; ++i)
+    {
+        // from far beside it, almost level, some of them missing the hills
+        Radian angle(Math::RangeRandom(0, Math::TWO_PI));
+        Vector3 origin(Math::Cos(angle) * 15000, Math::RangeRandom(200, 800), Math::Sin(angle) * 15000);
+        Vector3 target(Math::RangeRandom(-3000, 3000), 0, Math::RangeRandom(-3000, 3000));
+        Vector3 dir = target - origin;
+        dir.y = Math::RangeRandom(-0.05f, 0.02f) * dir.length();
+        rays.push_back(Ray(origin, dir.normalisedCopy()));
+    }
+
+    int hits = 0;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        std::pair<bool, Vector3> expected = rayIntersectsBruteForce(terrain, rays[i]);
+        std::pair<bool, Vector3> result = terrain->rayIntersects(rays[i]);
+        ASSERT_EQ(expected.first, result.first) << i;
+        if (expected.first)
+        {
+            // Terrain accepts hits just outside a quad
+            EXPECT_LT(expected.second.distance(result.second), 1.0f) << i;
+            ++hits;
+        }
+    }
+    EXPECT_GE(hits, 24);
+
+    OGRE_DELETE terrain;
+}
+//--------------------------------------------------------------------------
+TEST(TerrainLightmapTests, SweepMatchesRayCast)
+{
+    Root root("");
+    SceneManager* sceneMgr = root.createSceneManager();
+    TerrainGlobalOptions options;
+    options.setLightMapDirection(Vector3(1, -0.5f, 0.3f).normalisedCopy());
+    options.setLightMapSize(128);
+
+    // Hills high enough to cast long shadows at this light angle
+    const uint16 size = 129;
+    std::vector<float> heights(size * size);
+    for (uint16 y = 0; y < size; ++y)
+    {
+        for (uint16 x = 0; x < size; ++x)
+        {
+            heights[y * size + x] = 150 + 120 * Math::Sin(x * 0.09f) * Math::Cos(y * 0.13f) +
+                                    40 * Math::Sin((2 * x + y) * 0.21f);
+        }
+    }
+
+    Terrain* terrain = OGRE_NEW Terrain(sceneMgr);
+    Terrain::ImportData imp;
+    imp.inputFloat = &heights[0];
+    imp.terrainSize = size;
+    imp.worldSize = 3000;
+    imp.minBatchSize = 17;
+    imp.maxBatchSize = 65;
+    ASSERT_TRUE(terrain->prepare(imp));
+
+    Rect finalRect;
+    PixelBox* lightmap = terrain->calculateLightmap(Rect(0, 0, size, size), Rect(), finalRect);
+    long lightmapSize = options.getLightMapSize();
+    ASSERT_EQ(0, finalRect.left);
+    ASSERT_EQ(0, finalRect.top);
+    ASSERT_EQ(lightmapSize, finalRect.right);
+    ASSERT_EQ(lightmapSize, finalRect.bottom);
+
+    // one ray per texel, as the lightmap was calculated before the sweep
+    const uint8* data = static_cast<const uint8*>(lightmap->data);
+    Real heightPad = (terrain->getMaxHeight() - terrain->getMinHeight()) * 1.0e-3f;
+    std::vector<bool> expectedLit(lightmapSize * lightmapSize);
+    long lit = 0;
+    for (long y = 0; y < lightmapSize; ++y)
+    {
+        for (long x = 0; x < lightmapSize; ++x)
+        {
+            float Tx = (float)x / (float)(lightmapSize - 1);
+            float Ty = (float)y / (float)(lightmapSize - 1);
+            Vector3 wpos;
+            terrain->getPosition(Tx, Ty, terrain->getHeightAtTerrainPosition(Tx, Ty) + heightPad, &wpos);
+            wpos += terrain->getPosition();
+            expectedLit[y * lightmapSize + x] = !terrain->rayIntersects(
+                Ray(wpos, -options.getLightMapDirection()), true, terrain->getWorldSize()).first;
+            if (expectedLit[y * lightmapSize + x])
+                ++lit;
+        }
+    }
+    EXPECT_GT(lit, lightmapSize * lightmapSize / 10);
+    EXPECT_LT(lit, lightmapSize * lightmapSize * 9 / 10);
+
+    // The sweep interpolates the heights between texels, so it may only differ
+    // next to a shadow border of the ray cast
+    long mismatches = 0, awayFromBorder = 0;
+    for (long y = 0; y < lightmapSize; ++y)
+    {
+        for (long x = 0; x < lightmapSize; ++x)
+        {
+            bool expected = expectedLit[y * lightmapSize + x];
+            bool resultLit = data[(lightmapSize - y - 1) * lightmapSize + x] != 0;
+            if (expected == resultLit)
+                continue;
+            ++mismatches;
+
+            bool border = false;
+            for (long ny = std::max(0L, y - 1); ny <= std::min(lightmapSize - 1, y + 1); ++ny)
+            {
+                for (long nx = std::max(0L, x - 1); nx <= std::min(lightmapSize - 1, x + 1); ++nx)
+                    border = border || expectedLit[ny * lightmapSize + nx] != expected;
+            }
+            if (!border)
+                ++awayFromBorder;
+        }
+    }
+    EXPECT_EQ(0, awayFromBorder);
+    EXPECT_LT(mismatches, lightmapSize * lightmapSize / 25);
+
+    OGRE_FREE(lightmap->data, MEMCATEGORY_GENERAL);
+    OGRE_DELETE lightmap;
+    OGRE_DELETE terrain;
+}
+//--------------------------------------------------------------------------
+#if OGRE_NO_ZIP_ARCHIVE == 0
+namespace
+{
+    /// Heights followed by deltas, gentle left of x = 64 and rugged right of it
+    std::vector<float> makeLodData(uint16 size)
+    {
+        size_t count = static_cast<size_t>(size) * size;
+        std::vector<float> data(2 * count);
+        for (uint16 y = 0; y < size; ++y)
+        {
+            for (uint16 x = 0; x < size; ++x)
+            {
+                float height = x < 64 ? 0.5f + 0.5f * Math::Sin(x * 0.3f) * Math::Cos(y * 0.2f)
+                                      : Math::RangeRandom(0, 1000);
+                data[y * size + x] = height;
+                data[count + y * size + x] = Math::Abs(height - 500) * 0.01f;
+            }
+        }
+        return data;
+    }
+}
+//--------------------------------------------------------------------------
+TEST(TerrainLodDataTests, QuantisedRoundTripErrorIsBoundPerTile)
+{
+    const uint16 size = 129;
+    std::vector<float> data = makeLodData(size);
+
+    DataStreamPtr stream(OGRE_NEW MemoryDataStream(1 << 20));
+    StreamSerialiser writer(stream);
+    TerrainLodManager::writeLodLevel(writer, &data[0], size, 1, 0, true);
+
+    stream->seek(0);
+    StreamSerialiser reader(stream);
+    std::vector<float> result(data.size());
+    TerrainLodManager::readLodLevel(reader, &result[0], size, 1, 0);
+
+    // Half a step over the range of the tile, far below one over the range of the level
+    for (uint16 y = 0; y < size; ++y)
+    {
+        for (uint16 x = 0; x < size; ++x)
+        {
+            size_t i = y * size + x;
+            float range = x < 64 ? 1.0f : 1000.0f;
+            EXPECT_NEAR(data[i], result[i], 0.51f * range / 65535) << x << ", " << y;
+        }
+    }
+    for (size_t i = size * size; i < data.size(); ++i)
+        EXPECT_NEAR(data[i], result[i], 0.51f * 10.0f / 65535);
+}
+//--------------------------------------------------------------------------
+TEST(TerrainLodDataTests, LoadsVersion1Chunks)
+{
+    const uint16 size = 129;
+    std::vector<float> data = makeLodData(size);
+
+    // As saved before quantisation, the plain floats
+    DataStreamPtr stream(OGRE_NEW MemoryDataStream(1 << 20));
+    StreamSerialiser writer(stream);
+    writer.writeChunkBegin(TerrainLodManager::TERRAINLODDATA_CHUNK_ID, 1);
+    writer.startDeflate();
+    writer.write(&data[0], data.size());
+    writer.stopDeflate();
+    writer.writeChunkEnd(TerrainLodManager::TERRAINLODDATA_CHUNK_ID);
+
+    stream->seek(0);
+    StreamSerialiser reader(stream);
+    std::vector<float> result(data.size());
+    TerrainLodManager::readLodLevel(reader, &result[0], size, 1, 0);
+    EXPECT_EQ(data, result);
+}
+#endif
@@ -0,0 +1,171 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef TESTS_OGREMAIN_INCLUDE_ROOTWITHSTUBRENDERSYSTEMFIXTURE_H_
+#define TESTS_OGREMAIN_INCLUDE_ROOTWITHSTUBRENDERSYSTEMFIXTURE_H_
+
+#include "RootWithoutRenderSystemFixture.h"
+#include <OgrePlugin.h>
+#include <OgreRenderSystem.h>
+
+/** A render system that draws nothing, for testing code that needs viewports,
+    render textures or render system capabilities without a GPU.
+    Clears and draws are recorded. Vertex and fragment programs of the "stub"
+    syntax can be created, they compile to nothing.
+*/
+class StubRenderSystem : public Ogre::RenderSystem
+{
+public:
+    StubRenderSystem();
+    ~StubRenderSystem();
+
+    struct Clear
+    {
+        unsigned int buffers;
+        Ogre::ColourValue colour;
+        Ogre::Real depth;
+    };
+    std::vector<Clear> mClears;
+
+    struct Draw
+    {
+        const Ogre::Renderable* renderable;
+        Ogre::CullingMode cullingMode;
+        size_t numberOfInstances;
+        /// contents of the global instance buffer, if one was bound
+        std::vector<float> instanceData;
+    };
+    std::vector<Draw> mDraws;
+
+    void _render(const Ogre::RenderOperation& op);
+
+    const Ogre::String& getName(void) const;
+    void setConfigOption(const Ogre::String &name, const Ogre::String &value) {}
+    Ogre::HardwareOcclusionQuery* createHardwareOcclusionQuery(void) { return 0; }
+    Ogre::String validateConfigOptions(void) { return ""; }
+    Ogre::RenderSystemCapabilities* createRenderSystemCapabilities() const;
+    void reinitialise(void) {}
+    Ogre::RenderWindow* _createRenderWindow(const Ogre::String &name, unsigned int width, unsigned int height,
+        bool fullScreen, const Ogre::NameValuePairList *miscParams = 0) { return 0; }
+    Ogre::MultiRenderTarget* createMultiRenderTarget(const Ogre::String & name) { return 0; }
+    void _setTexture(size_t unit, bool enabled, const Ogre::TexturePtr &texPtr) {}
+    void _setTextureUnitFiltering(size_t unit, Ogre::FilterType ftype, Ogre::FilterOptions filter) {}
+    void _setTextureUnitCompareEnabled(size_t unit, bool compare) {}
+    void _setTextureUnitCompareFunction(size_t unit, Ogre::CompareFunction function) {}
+    void _setTextureLayerAnisotropy(size_t unit, unsigned int maxAnisotropy) {}
+    void _setTextureAddressingMode(size_t unit, const Ogre::TextureUnitState::UVWAddressingMode& uvw) {}
+    void _setTextureBorderColour(size_t unit, const Ogre::ColourValue& colour) {}
+    void _setTextureMipmapBias(size_t unit, float bias) {}
+    void _setSceneBlending(Ogre::SceneBlendFactor sourceFactor, Ogre::SceneBlendFactor destFactor,
+        Ogre::SceneBlendOperation op = Ogre::SBO_ADD) {}
+    void _setSeparateSceneBlending(Ogre::SceneBlendFactor sourceFactor, Ogre::SceneBlendFactor destFactor,
+        Ogre::SceneBlendFactor sourceFactorAlpha, Ogre::SceneBlendFactor destFactorAlpha,
+        Ogre::SceneBlendOperation op = Ogre::SBO_ADD, Ogre::SceneBlendOperation alphaOp = Ogre::SBO_ADD) {}
+    void _setAlphaRejectSettings(Ogre::CompareFunction func, unsigned char value, bool alphaToCoverage) {}
+    Ogre::DepthBuffer* _createDepthBufferFor(Ogre::RenderTarget *renderTarget) { return 0; }
+    void _beginFrame(void) {}
+    void _endFrame(void) {}
+    void _setViewport(Ogre::Viewport *vp) { mActiveViewport = vp; }
+    void _setCullingMode(Ogre::CullingMode mode) { mCullingMode = mode; }
+    void _setDepthBufferParams(bool depthTest = true, bool depthWrite = true,
+        Ogre::CompareFunction depthFunction = Ogre::CMPF_LESS_EQUAL) {}
+    void _setDepthBufferCheckEnabled(bool enabled = true) {}
+    void _setDepthBufferWriteEnabled(bool enabled = true) {}
+    void _setDepthBufferFunction(Ogre::CompareFunction func = Ogre::CMPF_LESS_EQUAL) {}
+    void _setColourBufferWriteEnabled(bool red, bool green, bool blue, bool alpha) {}
+    void _setDepthBias(float constantBias, float slopeScaleBias = 0.0f) {}
+    Ogre::VertexElementType getColourVertexElementType(void) const { return Ogre::VET_COLOUR_ABGR; }
+    void _convertProjectionMatrix(const Ogre::Matrix4& matrix, Ogre::Matrix4& dest, bool forGpuProgram = false)
+    { dest = matrix; }
+    void _makeProjectionMatrix(const Ogre::Radian& fovy, Ogre::Real aspect, Ogre::Real nearPlane,
+        Ogre::Real farPlane, Ogre::Matrix4& dest, bool forGpuProgram = false) { dest = Ogre::Matrix4::IDENTITY; }
+    void _makeProjectionMatrix(Ogre::Real left, Ogre::Real right, Ogre::Real bottom, Ogre::Real top,
+        Ogre::Real nearPlane, Ogre::Real farPlane, Ogre::Matrix4& dest, bool forGpuProgram = false)
+    { dest = Ogre::Matrix4::IDENTITY; }
+    void _makeOrthoMatrix(const Ogre::Radian& fovy, Ogre::Real aspect, Ogre::Real nearPlane,
+        Ogre::Real farPlane, Ogre::Matrix4& dest, bool forGpuProgram = false) { dest = Ogre::Matrix4::IDENTITY; }
+    void _applyObliqueDepthProjection(Ogre::Matrix4& matrix, const Ogre::Plane& plane, bool forGpuProgram) {}
+    void _setPolygonMode(Ogre::PolygonMode level) {}
+    void setStencilCheckEnabled(bool enabled) {}
+    void setStencilBufferParams(Ogre::CompareFunction func = Ogre::CMPF_ALWAYS_PASS, Ogre::uint32 refValue = 0,
+        Ogre::uint32 compareMask = 0xFFFFFFFF, Ogre::uint32 writeMask = 0xFFFFFFFF,
+        Ogre::StencilOperation stencilFailOp = Ogre::SOP_KEEP, Ogre::StencilOperation depthFailOp = Ogre::SOP_KEEP,
+        Ogre::StencilOperation passOp = Ogre::SOP_KEEP, bool twoSidedOperation = false,
+        bool readBackAsTexture = false) {}
+    void bindGpuProgramParameters(Ogre::GpuProgramType gptype, Ogre::GpuProgramParametersSharedPtr params,
+        Ogre::uint16 variabilityMask) {}
+    void bindGpuProgramPassIterationParameters(Ogre::GpuProgramType gptype) {}
+    void setScissorTest(bool enabled, size_t left = 0, size_t top = 0, size_t right = 800, size_t bottom = 600) {}
+    void clearFrameBuffer(unsigned int buffers, const Ogre::ColourValue& colour = Ogre::ColourValue::Black,
+        Ogre::Real depth = 1.0f, unsigned short stencil = 0);
+    Ogre::Real getHorizontalTexelOffset(void) { return 0; }
+    Ogre::Real getVerticalTexelOffset(void) { return 0; }
+    Ogre::Real getMinimumDepthInputValue(void) { return -1; }
+    Ogre::Real getMaximumDepthInputValue(void) { return 1; }
+    void _setRenderTarget(Ogre::RenderTarget *target) { mActiveRenderTarget = target; }
+    void preExtraThreadsStarted() {}
+    void postExtraThreadsStarted() {}
+    void registerThread() {}
+    void unregisterThread() {}
+    unsigned int getDisplayMonitorCount() const { return 0; }
+    void beginProfileEvent(const Ogre::String &eventName) {}
+    void endProfileEvent(void) {}
+    void markProfileEvent(const Ogre::String &event) {}
+    bool hasAnisotropicMipMapFilter() const { return false; }
+    void setClipPlanesImpl(const Ogre::PlaneList& clipPlanes) {}
+    void initialiseFromRenderSystemCapabilities(Ogre::RenderSystemCapabilities* caps,
+        Ogre::RenderTarget* primary) {}
+
+private:
+    Ogre::TextureManager* mTextureManager;
+    Ogre::GpuProgramManager* mGpuProgramManager;
+};
+
+/// Installs a StubRenderSystem the way render system plugins do
+class StubRenderSystemPlugin : public Ogre::Plugin
+{
+public:
+    StubRenderSystemPlugin() : mRenderSystem(0) {}
+
+    const Ogre::String& getName() const;
+    void install();
+    void initialise() {}
+    void shutdown() {}
+    void uninstall();
+
+    StubRenderSystem* mRenderSystem;
+};
+
+class RootWithStubRenderSystemFixture : public RootWithoutRenderSystemFixture {
+public:
+    StubRenderSystemPlugin mPlugin;
+    StubRenderSystem* mRenderSystem;
+    void SetUp();
+};
+
+#endif /* TESTS_OGREMAIN_INCLUDE_ROOTWITHSTUBRENDERSYSTEMFIXTURE_H_ */
@@ -0,0 +1,229 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+#include <Ogre.h>
+#include <OgreGpuProgramManager.h>
+#include "RootWithStubRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    /// Counts the renderables the listeners hear of
+    struct RenderObjectCounter : public RenderObjectListener
+    {
+        std::map<const Renderable*, int> counts;
+        void notifyRenderSingleObject(Renderable* rend, const Pass* pass, const AutoParamDataSource* source,
+                                      const LightList* pLightList, bool suppressRenderStateChanges)
+        {
+            ++counts[rend];
+        }
+    };
+
+    typedef std::vector<Vector3> PositionList;
+
+    /// Orders positions lexicographically, Vector3::operator< is no strict weak ordering
+    bool lessPosition(const Vector3& a, const Vector3& b)
+    {
+        return std::lexicographical_compare(a.ptr(), a.ptr() + 3, b.ptr(), b.ptr() + 3);
+    }
+
+    /// The translations of the instance records of a draw, in order
+    PositionList getTranslations(const StubRenderSystem::Draw& draw)
+    {
+        PositionList positions;
+        for (size_t i = 0; i + 12 <= draw.instanceData.size(); i += 12)
+        {
+            const float* rows = &draw.instanceData[i];
+            positions.push_back(Vector3(rows[3], rows[7], rows[11]));
+        }
+        std::sort(positions.begin(), positions.end(), lessPosition);
+        return positions;
+    }
+}
+
+class AutoInstancingTests : public RootWithStubRenderSystemFixture
+{
+public:
+    SceneManager* mSceneMgr;
+    Camera* mCamera;
+    Viewport* mViewport;
+    RenderObjectCounter mCounter;
+
+    void SetUp()
+    {
+        RootWithStubRenderSystemFixture::SetUp();
+        mSceneMgr = mRoot->createSceneManager();
+        mSceneMgr->addRenderObjectListener(&mCounter);
+        mCamera = mSceneMgr->createCamera("AutoInstancingTests");
+        mCamera->setNearClipDistance(1);
+        mSceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(0, 0, 500))->attachObject(mCamera);
+
+        TexturePtr tex = TextureManager::getSingleton().createManual(
+            "AutoInstancingTests/Target", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, TEX_TYPE_2D, 64, 64, 0,
+            PF_A8R8G8B8, TU_RENDERTARGET);
+        RenderTarget* rt = tex->getBuffer()->getRenderTarget();
+        rt->setAutoUpdated(false);
+        mViewport = rt->addViewport(mCamera);
+        mViewport->setOverlaysEnabled(false);
+
+        MeshManager::getSingleton().createPlane("AutoInstancingTests/Plane",
+                                                ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                                                Plane(Vector3::UNIT_Z, 0), 10, 10);
+
+        GpuProgramPtr vp = GpuProgramManager::getSingleton().createProgramFromString(
+            "AutoInstancingTests/vp", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, "", GPT_VERTEX_PROGRAM,
+            "stub");
+        vp->setInstancingIncluded(true);
+
+        MaterialPtr mat = MaterialManager::getSingleton().create(
+            "AutoInstancingTests/Solid", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        mat->getTechnique(0)->getPass(0)->setVertexProgram(vp->getName());
+
+        mat = mat->clone("AutoInstancingTests/Transparent");
+        mat->getTechnique(0)->getPass(0)->setSceneBlending(SBT_TRANSPARENT_ALPHA);
+        mat->getTechnique(0)->getPass(0)->setDepthWriteEnabled(false);
+    }
+
+    void TearDown()
+    {
+        mSceneMgr->removeRenderObjectListener(&mCounter);
+        RootWithStubRenderSystemFixture::TearDown();
+    }
+
+    Entity* createEntity(const Vector3& pos, const Vector3& scale, const String& material)
+    {
+        Entity* ent = mSceneMgr->createEntity("AutoInstancingTests/Plane");
+        ent->setMaterialName(material);
+        SceneNode* node = mSceneMgr->getRootSceneNode()->createChildSceneNode(pos);
+        node->setScale(scale);
+        node->attachObject(ent);
+        return ent;
+    }
+
+    void render()
+    {
+        mRenderSystem->mDraws.clear();
+        mCounter.counts.clear();
+        mViewport->getTarget()->update();
+    }
+
+    const StubRenderSystem::Draw* findDraw(const Entity* ent)
+    {
+        for (size_t i = 0; i < mRenderSystem->mDraws.size(); ++i)
+        {
+            if (mRenderSystem->mDraws[i].renderable == ent->getSubEntity(0))
+                return &mRenderSystem->mDraws[i];
+        }
+        return 0;
+    }
+};
+
+TEST_F(AutoInstancingTests, RunsAndIdentityInstance)
+{
+    mSceneMgr->setAutoInstancingEnabled(true);
+
+    std::vector<Entity*> entities;
+    PositionList solid, mirrored;
+    for (int i = 0; i < 6; ++i)
+    {
+        Vector3 pos(i * 20 - 50, 0, 0);
+        // the mirrored ones get a run of their own, a non uniform scale does not need one
+        bool mirror = i % 3 == 1;
+        Vector3 scale = mirror ? Vector3(-1, 1, 1) : i == 2 ? Vector3(2, 1, 1) : Vector3::UNIT_SCALE;
+        entities.push_back(createEntity(pos, scale, "AutoInstancingTests/Solid"));
+        (mirror ? mirrored : solid).push_back(pos);
+    }
+    Entity* transparent = createEntity(Vector3(0, 30, 0), Vector3::UNIT_SCALE, "AutoInstancingTests/Transparent");
+
+    render();
+
+    // one draw per run, and one for the transparent entity
+    ASSERT_EQ(3u, mRenderSystem->mDraws.size());
+    std::sort(solid.begin(), solid.end(), lessPosition);
+    std::sort(mirrored.begin(), mirrored.end(), lessPosition);
+
+    bool foundSolid = false, foundMirrored = false;
+    for (size_t i = 0; i < mRenderSystem->mDraws.size(); ++i)
+    {
+        const StubRenderSystem::Draw& draw = mRenderSystem->mDraws[i];
+        if (draw.renderable == transparent->getSubEntity(0))
+            continue;
+
+        PositionList positions = getTranslations(draw);
+        if (draw.numberOfInstances == solid.size())
+        {
+            foundSolid = true;
+            EXPECT_EQ(solid, positions);
+            EXPECT_EQ(CULL_CLOCKWISE, draw.cullingMode);
+        }
+        else
+        {
+            foundMirrored = true;
+            EXPECT_EQ(mirrored.size(), draw.numberOfInstances);
+            EXPECT_EQ(mirrored, positions);
+            // the winding of mirrored geometry is reversed
+            EXPECT_EQ(CULL_ANTICLOCKWISE, draw.cullingMode);
+        }
+    }
+    EXPECT_TRUE(foundSolid);
+    EXPECT_TRUE(foundMirrored);
+
+    // the listeners hear of every renderable, not only of the ones issued
+    for (size_t i = 0; i < entities.size(); ++i)
+        EXPECT_EQ(1, mCounter.counts[entities[i]->getSubEntity(0)]);
+    EXPECT_EQ(1, mCounter.counts[transparent->getSubEntity(0)]);
+
+    // the draws outside a run read the identity from the instance stream
+    const StubRenderSystem::Draw* draw = findDraw(transparent);
+    ASSERT_TRUE(draw);
+    EXPECT_EQ(1u, draw->numberOfInstances);
+    const float identity[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+    EXPECT_EQ(std::vector<float>(identity, identity + 12), draw->instanceData);
+
+    // nothing is left bound for the draws of others
+    EXPECT_FALSE(mRenderSystem->getGlobalInstanceVertexBuffer());
+    EXPECT_EQ(1u, mRenderSystem->getGlobalNumberOfInstances());
+}
+
+TEST_F(AutoInstancingTests, DisabledDrawsSingly)
+{
+    for (int i = 0; i < 4; ++i)
+        createEntity(Vector3(i * 20 - 30, 0, 0), Vector3::UNIT_SCALE, "AutoInstancingTests/Solid");
+
+    render();
+
+    // the program still reads the instance stream, so each draw gets the identity
+    ASSERT_EQ(4u, mRenderSystem->mDraws.size());
+    const float identity[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+    for (size_t i = 0; i < mRenderSystem->mDraws.size(); ++i)
+    {
+        EXPECT_EQ(1u, mRenderSystem->mDraws[i].numberOfInstances);
+        EXPECT_EQ(std::vector<float>(identity, identity + 12), mRenderSystem->mDraws[i].instanceData);
+    }
+}
@@ -0,0 +1,202 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <Ogre.h>
+#include <OgreBillboard.h>
+#include <OgreBillboardSet.h>
+#include <OgreGpuProgramManager.h>
+#include "RootWithStubRenderSystemFixture.h"
+
+using namespace Ogre;
+
+class BillboardSetTests : public RootWithStubRenderSystemFixture
+{
+public:
+    SceneManager* mSceneMgr;
+    Camera* mCamera;
+    MaterialPtr mInstancedMaterial;
+
+    void SetUp()
+    {
+        RootWithStubRenderSystemFixture::SetUp();
+        mSceneMgr = mRoot->createSceneManager();
+        mCamera = mSceneMgr->createCamera("BillboardSetTests");
+        mSceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(0, 0, 500))->attachObject(mCamera);
+
+        // the program is never run, but marks the pass as programmable
+        GpuProgramPtr vp = GpuProgramManager::getSingleton().createProgramFromString(
+            "BillboardSetTests/vp", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, "", GPT_VERTEX_PROGRAM,
+            "stub");
+        mInstancedMaterial = MaterialManager::getSingleton().create("BillboardSetTests/Instanced", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        mInstancedMaterial->getTechnique(0)->getPass(0)->setGpuProgram(GPT_VERTEX_PROGRAM, vp);
+    }
+
+    void TearDown()
+    {
+        mInstancedMaterial.reset();
+        RootWithStubRenderSystemFixture::TearDown();
+    }
+
+    BillboardSet* createSet(size_t count, bool instanced)
+    {
+        BillboardSet* bbs = mSceneMgr->createBillboardSet(count);
+        bbs->setInstancingEnabled(instanced);
+        if (instanced)
+            bbs->setMaterial(mInstancedMaterial);
+        mSceneMgr->getRootSceneNode()->attachObject(bbs);
+        bbs->_notifyCurrentCamera(mCamera);
+        return bbs;
+    }
+
+    void inject(BillboardSet* bbs, const std::vector<Billboard>& billboards)
+    {
+        bbs->beginBillboards(billboards.size());
+        bbs->injectBillboards(&billboards[0], billboards.size());
+        bbs->endBillboards();
+    }
+
+    std::vector<Billboard> makeBillboards(size_t count, BillboardSet* owner)
+    {
+        std::vector<Billboard> ret;
+        ret.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            Real f = Real(i);
+            ret.push_back(Billboard(Vector3(f, -f, 0.5f * f), owner, ColourValue(1, 0.5f, f / count)));
+        }
+        return ret;
+    }
+};
+
+TEST_F(BillboardSetTests, InstanceRecords)
+{
+    const size_t count = 16;
+    BillboardSet* bbs = createSet(count, true);
+    std::vector<Billboard> billboards = makeBillboards(count, bbs);
+    billboards[3].setDimensions(7, 9);
+    billboards[3].setRotation(Radian(0.5f));
+    bbs->setTextureStacksAndSlices(2, 2);
+    for (size_t i = 0; i < count; ++i)
+        billboards[i].setTexcoordIndex(uint16(i % 4));
+    billboards[5].setTexcoordRect(0.1f, 0.2f, 0.3f, 0.4f);
+    inject(bbs, billboards);
+
+    RenderOperation op;
+    bbs->getRenderOperation(op);
+    EXPECT_EQ(op.numberOfInstances, count);
+    EXPECT_EQ(op.vertexData->vertexCount, 4u);
+    EXPECT_EQ(op.indexData->indexCount, 6u);
+
+    const HardwareVertexBufferSharedPtr& instances = op.vertexData->vertexBufferBinding->getBuffer(1);
+    EXPECT_EQ(instances->getInstanceDataStepRate(), 1u);
+    EXPECT_TRUE(instances->isInstanceData());
+
+    const VertexDeclaration* decl = op.vertexData->vertexDeclaration;
+    const VertexElement* posElem = decl->findElementBySemantic(VES_POSITION);
+    const VertexElement* colourElem = decl->findElementBySemantic(VES_DIFFUSE);
+    const VertexElement* sizeElem = decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 1);
+    const VertexElement* rectElem = decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 2);
+    ASSERT_TRUE(posElem && colourElem && sizeElem && rectElem);
+    EXPECT_EQ(rectElem->getType(), VET_USHORT4_NORM);
+
+    uint16 numCoords;
+    const FloatRect* coords = bbs->getTextureCoords(&numCoords);
+    ASSERT_EQ(numCoords, 4u);
+
+    HardwareBufferLockGuard<HardwareVertexBufferSharedPtr> lock(instances, HardwareBuffer::HBL_READ_ONLY);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uchar* rec = static_cast<const uchar*>(lock.pData) + i * instances->getVertexSize();
+        float* pos;
+        RGBA* colour;
+        float* size;
+        uint16* rect;
+        posElem->baseVertexPointerToElement(const_cast<uchar*>(rec), &pos);
+        colourElem->baseVertexPointerToElement(const_cast<uchar*>(rec), &colour);
+        sizeElem->baseVertexPointerToElement(const_cast<uchar*>(rec), &size);
+        rectElem->baseVertexPointerToElement(const_cast<uchar*>(rec), &rect);
+
+        EXPECT_EQ(Vector3(pos[0], pos[1], pos[2]), billboards[i].getPosition());
+        EXPECT_EQ(*colour, VertexElement::convertColourValue(
+            billboards[i].getColour(), VertexElement::getBestColourVertexElementType()));
+
+        const FloatRect& r = billboards[i].isUseTexcoordRect() ?
+            billboards[i].getTexcoordRect() : coords[billboards[i].getTexcoordIndex()];
+        EXPECT_EQ(rect[0], uint16(r.left * 65535 + 0.5f));
+        EXPECT_EQ(rect[1], uint16(r.top * 65535 + 0.5f));
+        EXPECT_EQ(rect[2], uint16(r.right * 65535 + 0.5f));
+        EXPECT_EQ(rect[3], uint16(r.bottom * 65535 + 0.5f));
+        if (i == 3)
+        {
+            EXPECT_EQ(size[0], 7);
+            EXPECT_EQ(size[1], 9);
+            EXPECT_FLOAT_EQ(size[2], 0.5f);
+        }
+        else
+        {
+            EXPECT_EQ(size[0], bbs->getDefaultWidth());
+            EXPECT_EQ(size[1], bbs->getDefaultHeight());
+            EXPECT_EQ(size[2], 0);
+        }
+    }
+}
+
+TEST_F(BillboardSetTests, FallbackWithoutVertexProgram)
+{
+    const size_t count = 16;
+    BillboardSet* bbs = createSet(count, true);
+    bbs->setMaterialName("BaseWhiteNoLighting");
+    inject(bbs, makeBillboards(count, bbs));
+
+    RenderOperation op;
+    bbs->getRenderOperation(op);
+    EXPECT_EQ(op.numberOfInstances, 1u);
+    EXPECT_EQ(op.vertexData->vertexCount, count * 4);
+}
+
+TEST_F(BillboardSetTests, InstanceRecordsAreSmallerThanQuads)
+{
+    // The quad path uses 16 bit indices
+    const size_t count = 16000;
+
+    BillboardSet* quads = createSet(count, false);
+    BillboardSet* instanced = createSet(count, true);
+    std::vector<Billboard> billboards = makeBillboards(count, quads);
+    inject(quads, billboards);
+    inject(instanced, billboards);
+
+    RenderOperation quadOp, instancedOp;
+    quads->getRenderOperation(quadOp);
+    instanced->getRenderOperation(instancedOp);
+    EXPECT_EQ(quadOp.numberOfInstances, 1u);
+    EXPECT_EQ(instancedOp.numberOfInstances, count);
+
+    size_t quadBytes = quadOp.vertexData->vertexCount * quadOp.vertexData->vertexDeclaration->getVertexSize(0);
+    size_t instanceBytes = instancedOp.numberOfInstances * instancedOp.vertexData->vertexDeclaration->getVertexSize(1);
+    EXPECT_LT(instanceBytes * 2, quadBytes);
+}
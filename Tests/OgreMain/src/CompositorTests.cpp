@@ -0,0 +1,222 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include "RootWithStubRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    /// Counts compiles of a chain, as each one sets up the materials of its quad passes again
+    struct MaterialSetupCounter : public CompositorInstance::Listener
+    {
+        size_t count;
+        MaterialSetupCounter() : count(0) {}
+        void notifyMaterialSetup(uint32 pass_id, MaterialPtr& mat) { ++count; }
+    };
+
+    /// Records the viewport settings the scene is rendered with, outside the main viewport
+    struct SceneViewportRecorder : public SceneManager::Listener
+    {
+        Viewport* mainViewport;
+        std::vector<std::pair<uint32, bool> > settings;
+        SceneViewportRecorder(Viewport* vp) : mainViewport(vp) {}
+        void preFindVisibleObjects(SceneManager* source, SceneManager::IlluminationRenderStage irs, Viewport* v)
+        {
+            if (v != mainViewport)
+                settings.push_back(std::make_pair(v->getVisibilityMask(), v->getShadowsEnabled()));
+        }
+    };
+}
+
+class CompositorTests : public RootWithStubRenderSystemFixture
+{
+public:
+    SceneManager* mSceneMgr;
+    Camera* mCamera;
+
+    void SetUp()
+    {
+        RootWithStubRenderSystemFixture::SetUp();
+        mSceneMgr = mRoot->createSceneManager();
+        mCamera = mSceneMgr->createCamera("CompositorTests");
+        mSceneMgr->getRootSceneNode()->createChildSceneNode()->attachObject(mCamera);
+
+        MaterialPtr quad = MaterialManager::getSingleton().create(
+            "CompositorTests/Quad", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        quad->getTechnique(0)->getPass(0)->createTextureUnitState();
+
+        // rt0 <- scene, rt1 <- rt0, rt2 <- rt1, output <- rt2, unused is never read
+        CompositorPtr comp = CompositorManager::getSingleton().create(
+            "CompositorTests/Chain", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        CompositionTechnique* tech = comp->createTechnique();
+        const char* textures[] = {"rt0", "unused", "rt1", "rt2"};
+        for (int i = 0; i < 4; ++i)
+            tech->createTextureDefinition(textures[i])->formatList.push_back(PF_A8R8G8B8);
+
+        CompositionTargetPass* target = tech->createTargetPass();
+        target->setOutputName("rt0");
+        target->setInputMode(CompositionTargetPass::IM_PREVIOUS);
+
+        target = tech->createTargetPass();
+        target->setOutputName("unused");
+        target->createPass()->setType(CompositionPass::PT_CLEAR);
+        target->createPass()->setType(CompositionPass::PT_RENDERSCENE);
+
+        addQuadTarget(tech->createTargetPass(), "rt0")->setOutputName("rt1");
+        addQuadTarget(tech->createTargetPass(), "rt1")->setOutputName("rt2");
+        addQuadTarget(tech->getOutputTargetPass(), "rt2");
+    }
+
+    CompositionTargetPass* addQuadTarget(CompositionTargetPass* target, const String& input)
+    {
+        target->setInputMode(CompositionTargetPass::IM_NONE);
+        CompositionPass* pass = target->createPass();
+        pass->setType(CompositionPass::PT_RENDERQUAD);
+        pass->setMaterialName("CompositorTests/Quad");
+        pass->setInput(0, input);
+        return target;
+    }
+
+    Viewport* createViewport(const String& name)
+    {
+        TexturePtr tex = TextureManager::getSingleton().createManual(
+            name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, TEX_TYPE_2D, 256, 256, 0,
+            PF_A8R8G8B8, TU_RENDERTARGET);
+        RenderTarget* rt = tex->getBuffer()->getRenderTarget();
+        rt->setAutoUpdated(false);
+        return rt->addViewport(mCamera);
+    }
+
+    CompositorInstance* addChain(Viewport* vp)
+    {
+        CompositorInstance* inst = CompositorManager::getSingleton().addCompositor(vp, "CompositorTests/Chain");
+        inst->setEnabled(true);
+        return inst;
+    }
+};
+
+TEST_F(CompositorTests, TextureAliasing)
+{
+    CompositorManager::getSingleton().setTextureAliasing(true);
+
+    Viewport* vp = createViewport("CompositorTests/Target");
+    CompositorInstance* inst = addChain(vp);
+    vp->getTarget()->update();
+
+    // the pass writing unused is not compiled
+    CompositorInstance::CompiledState ops;
+    inst->_compileTargetOperations(ops);
+    EXPECT_EQ(3u, ops.size());
+
+    // rt0 is dead once rt1 is written, so rt2 takes its render texture
+    TexturePtr rt0 = inst->getTextureInstance("rt0", 0);
+    TexturePtr rt1 = inst->getTextureInstance("rt1", 0);
+    TexturePtr rt2 = inst->getTextureInstance("rt2", 0);
+    ASSERT_TRUE(rt0 && rt1 && rt2);
+    EXPECT_EQ(rt0, rt2);
+    EXPECT_NE(rt0, rt1);
+    EXPECT_FALSE(inst->getTextureInstance("unused", 0));
+
+    // rt1 is not used by the output operation, so other chains share its render texture,
+    // the ones in use at the output are private
+    Viewport* otherVp = createViewport("CompositorTests/OtherTarget");
+    CompositorInstance* other = addChain(otherVp);
+    otherVp->getTarget()->update();
+    EXPECT_EQ(rt1, other->getTextureInstance("rt1", 0));
+    EXPECT_NE(rt2, other->getTextureInstance("rt2", 0));
+    EXPECT_EQ(other->getTextureInstance("rt0", 0), other->getTextureInstance("rt2", 0));
+}
+
+TEST_F(CompositorTests, NoTextureAliasing)
+{
+    Viewport* vp = createViewport("CompositorTests/Target");
+    CompositorInstance* inst = addChain(vp);
+    vp->getTarget()->update();
+
+    CompositorInstance::CompiledState ops;
+    inst->_compileTargetOperations(ops);
+    EXPECT_EQ(4u, ops.size());
+
+    std::set<Texture*> textures;
+    const char* names[] = {"rt0", "unused", "rt1", "rt2"};
+    for (int i = 0; i < 4; ++i)
+        textures.insert(inst->getTextureInstance(names[i], 0).get());
+    EXPECT_EQ(4u, textures.size());
+    EXPECT_FALSE(textures.count(0));
+}
+
+TEST_F(CompositorTests, ViewportSettingsWithoutRecompile)
+{
+    Viewport* vp = createViewport("CompositorTests/Target");
+    CompositorInstance* inst = addChain(vp);
+    MaterialSetupCounter counter;
+    inst->addListener(&counter);
+    SceneViewportRecorder recorder(vp);
+    mSceneMgr->addListener(&recorder);
+
+    vp->setBackgroundColour(ColourValue::Red);
+    vp->getTarget()->update();
+    size_t compiles = counter.count;
+    EXPECT_GT(compiles, 0u);
+
+    vp->setBackgroundColour(ColourValue::Blue);
+    vp->setClearEveryFrame(true, FBT_COLOUR | FBT_DEPTH);
+    vp->setVisibilityMask(0x2);
+    vp->setShadowsEnabled(false);
+    recorder.settings.clear();
+    mRenderSystem->mClears.clear();
+
+    vp->getTarget()->update();
+    EXPECT_EQ(compiles, counter.count);
+
+    // the original scene is rendered into rt0 first, cleared like the viewport
+    ASSERT_FALSE(mRenderSystem->mClears.empty());
+    EXPECT_EQ(unsigned(FBT_COLOUR | FBT_DEPTH), mRenderSystem->mClears[0].buffers);
+    EXPECT_EQ(ColourValue::Blue, mRenderSystem->mClears[0].colour);
+
+    // the scene of rt0 and of unused: the original scene follows the viewport,
+    // the scene pass of the compositor keeps its own settings
+    ASSERT_EQ(2u, recorder.settings.size());
+    EXPECT_EQ(0x2u, recorder.settings[0].first);
+    EXPECT_FALSE(recorder.settings[0].second);
+    EXPECT_EQ(0xFFFFFFFFu, recorder.settings[1].first);
+    EXPECT_TRUE(recorder.settings[1].second);
+
+    // restored after the frame
+    EXPECT_EQ(0x2u, vp->getVisibilityMask());
+    EXPECT_FALSE(vp->getShadowsEnabled());
+
+    // a different scheme means different materials, so that still recompiles
+    vp->setMaterialScheme("CompositorTests");
+    vp->getTarget()->update();
+    EXPECT_GT(counter.count, compiles);
+
+    mSceneMgr->removeListener(&recorder);
+    inst->removeListener(&counter);
+}
@@ -283,3 +283,144 @@ TEST_F(EdgeBuilderTests,MultiIndexBufMultiVertexBuf)
     delete edgeData;
 }
 //--------------------------------------------------------------------------
+static void fillGeometry(VertexData& vd, IndexData& id, const float* positions, size_t vertexCount,
+                         const unsigned short* indices, size_t indexCount)
+{
+    vd.vertexCount = vertexCount;
+    vd.vertexStart = 0;
+    vd.vertexDeclaration = HardwareBufferManager::getSingleton().createVertexDeclaration();
+    vd.vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+    HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+        sizeof(float)*3, vertexCount, HardwareBuffer::HBU_STATIC, true);
+    vd.vertexBufferBinding->setBinding(0, vbuf);
+    vbuf->writeData(0, vbuf->getSizeInBytes(), positions);
+
+    id.indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+        HardwareIndexBuffer::IT_16BIT, indexCount, HardwareBuffer::HBU_STATIC, true);
+    id.indexCount = indexCount;
+    id.indexStart = 0;
+    id.indexBuffer->writeData(0, id.indexBuffer->getSizeInBytes(), indices);
+}
+//--------------------------------------------------------------------------
+TEST_F(EdgeBuilderTests,SharedEdgeAcrossDuplicateVertices)
+{
+    /* Two triangles of a quad which do not share vertices, as happens along
+    texture seams. The edge between them must still be found by position.
+    */
+    const float positions[] = {
+        0, 0, 0,   1, 0, 0,   0, 1, 0,
+        1, 0, 0,   1, 1, 0,   0, 1, 0 };
+    const unsigned short indices[] = { 0, 1, 2,   3, 4, 5 };
+
+    VertexData vd;
+    IndexData id;
+    fillGeometry(vd, id, positions, 6, indices, 6);
+
+    EdgeListBuilder edgeBuilder;
+    edgeBuilder.addVertexData(&vd);
+    edgeBuilder.addIndexData(&id);
+    EdgeData* edgeData = edgeBuilder.build();
+
+    EXPECT_EQ(edgeData->triangles.size(), 2u);
+    EdgeData::EdgeList& edges = edgeData->edgeGroups[0].edges;
+    // 4 outline edges and the diagonal
+    EXPECT_EQ(edges.size(), 5u);
+    size_t shared = 0;
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        if (edges[i].degenerate)
+            continue;
+        ++shared;
+        // Created by the first triangle, closed by the second
+        EXPECT_EQ(edges[i].triIndex[0], 0u);
+        EXPECT_EQ(edges[i].triIndex[1], 1u);
+        EXPECT_EQ(edges[i].vertIndex[0], 1u);
+        EXPECT_EQ(edges[i].vertIndex[1], 2u);
+    }
+    EXPECT_EQ(shared, 1u);
+    EXPECT_FALSE(edgeData->isClosed);
+
+    delete edgeData;
+}
+//--------------------------------------------------------------------------
+TEST_F(EdgeBuilderTests,OpenEdges)
+{
+    /* A fan of 3 triangles around a centre vertex. The inner edges are shared,
+    the rim is open.
+    */
+    const float positions[] = {
+        0, 0, 0,   1, 0, 0,   1, 1, 0,   0, 1, 0,   -1, 1, 0 };
+    const unsigned short indices[] = { 0, 1, 2,   0, 2, 3,   0, 3, 4 };
+
+    VertexData vd;
+    IndexData id;
+    fillGeometry(vd, id, positions, 5, indices, 9);
+
+    EdgeListBuilder edgeBuilder;
+    edgeBuilder.addVertexData(&vd);
+    edgeBuilder.addIndexData(&id);
+    EdgeData* edgeData = edgeBuilder.build();
+
+    EdgeData::EdgeList& edges = edgeData->edgeGroups[0].edges;
+    EXPECT_EQ(edges.size(), 7u);
+    size_t open = 0;
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        if (edges[i].degenerate)
+        {
+            ++open;
+            // Open edges have no second triangle
+            EXPECT_EQ(edges[i].triIndex[1], static_cast<size_t>(~0));
+        }
+    }
+    // 2 inner edges shared, the 5 others open
+    EXPECT_EQ(open, 5u);
+    EXPECT_FALSE(edgeData->isClosed);
+
+    delete edgeData;
+}
+//--------------------------------------------------------------------------
+TEST_F(EdgeBuilderTests,DegenerateTrianglesAndEdges)
+{
+    /* A zero area triangle, whose corners weld to the same position, is
+    dropped. A non manifold edge used twice in each direction pairs the
+    triangles in the order they were added.
+    */
+    const float positions[] = {
+        0, 0, 0,   1, 0, 0,   0, 1, 0,   0, -1, 0,   0, 0, 1,   0, 0, -1,
+        1, 0, 0 };
+    const unsigned short indices[] = {
+        0, 1, 6,   // zero area, vertex 6 welds to vertex 1
+        0, 1, 2,   0, 1, 4,   // two triangles running 0 -> 1
+        1, 0, 3,   1, 0, 5 }; // two running 1 -> 0
+
+    VertexData vd;
+    IndexData id;
+    fillGeometry(vd, id, positions, 7, indices, 15);
+
+    EdgeListBuilder edgeBuilder;
+    edgeBuilder.addVertexData(&vd);
+    edgeBuilder.addIndexData(&id);
+    EdgeData* edgeData = edgeBuilder.build();
+
+    EXPECT_EQ(edgeData->triangles.size(), 4u);
+    EdgeData::EdgeList& edges = edgeData->edgeGroups[0].edges;
+    // The 0-1 edges are paired, the others are all different
+    EXPECT_EQ(edges.size(), 10u);
+
+    size_t paired = 0;
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        if (edges[i].degenerate)
+            continue;
+        EXPECT_EQ(edges[i].vertIndex[0], 0u);
+        EXPECT_EQ(edges[i].vertIndex[1], 1u);
+        // First come, first served: 0 with 2, 1 with 3
+        EXPECT_EQ(edges[i].triIndex[1], edges[i].triIndex[0] + 2);
+        ++paired;
+    }
+    EXPECT_EQ(paired, 2u);
+
+    delete edgeData;
+}
+//--------------------------------------------------------------------------
@@ -29,7 +29,10 @@ THE SOFTWARE.
 #include <Ogre.h>
 #include <OgreInstancedEntity.h>
 #include <OgreInstanceBatchShader.h>
+#include <OgreInstanceBatchHW.h>
+#include <OgreInstanceManager.h>
 #include "RootWithoutRenderSystemFixture.h"
+#include "RootWithStubRenderSystemFixture.h"
 
 using namespace Ogre;
 
@@ -55,3 +58,234 @@ TEST_F(Instancing, Bounds) {
 
 
 
+
+namespace
+{
+    /// Orders positions lexicographically, Vector3::operator< is no strict weak ordering
+    bool lessPosition(const Vector3& a, const Vector3& b)
+    {
+        return std::lexicographical_compare(a.ptr(), a.ptr() + 3, b.ptr(), b.ptr() + 3);
+    }
+}
+
+class InstanceBatchHWTests : public RootWithStubRenderSystemFixture
+{
+public:
+    SceneManager* mSceneMgr;
+    Camera* mCamera;
+    InstanceManager* mInstanceMgr;
+    std::vector<InstancedEntity*> mEntities;
+
+    void SetUp()
+    {
+        RootWithStubRenderSystemFixture::SetUp();
+        mSceneMgr = mRoot->createSceneManager();
+        mCamera = mSceneMgr->createCamera("InstanceBatchHWTests");
+        mCamera->setNearClipDistance(1);
+        mCamera->setFarClipDistance(1000);
+        mSceneMgr->getRootSceneNode()->createChildSceneNode()->attachObject(mCamera);
+
+        MaterialManager::getSingleton().getByName("BaseWhite")->load();
+        MeshManager::getSingleton().createPlane("InstanceBatchHWTests/Plane",
+            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, Plane(Vector3::UNIT_Z, 0), 10, 10);
+    }
+
+    void TearDown()
+    {
+        mEntities.clear();
+        mRoot->destroySceneManager(mSceneMgr);
+        RootWithStubRenderSystemFixture::TearDown();
+    }
+
+    /// Scatters instances with random positions and scales, a few hidden or left at the origin
+    void createInstances(size_t count, unsigned char numCustomParams)
+    {
+        mInstanceMgr = mSceneMgr->createInstanceManager("InstanceBatchHWTests",
+            "InstanceBatchHWTests/Plane", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+            InstanceManager::HWInstancingBasic, count);
+        mInstanceMgr->setNumCustomParams(numCustomParams);
+
+        srand(5);
+        for (size_t i = 0; i < count; ++i)
+        {
+            InstancedEntity* entity = mInstanceMgr->createInstancedEntity("BaseWhite");
+            mEntities.push_back(entity);
+            if (i % 17 == 3)
+                continue;
+
+            SceneNode* node = mSceneMgr->getRootSceneNode()->createChildSceneNode(
+                Vector3(Math::RangeRandom(-2000, 2000), Math::RangeRandom(-2000, 2000),
+                        Math::RangeRandom(-2000, 2000)));
+            node->setScale(Vector3(Math::RangeRandom(0.5f, 3), 1, Math::RangeRandom(0.5f, 3)));
+            node->attachObject(entity);
+            entity->setVisible(i % 13 != 5);
+        }
+    }
+
+    InstanceBatchHW* getBatch()
+    {
+        InstanceManager::InstanceBatchIterator it = mInstanceMgr->getInstanceBatchIterator("BaseWhite");
+        EXPECT_TRUE(it.hasMoreElements());
+        return static_cast<InstanceBatchHW*>(it.getNext());
+    }
+
+    /// Updates the scene and the instance buffer as a frame seen from camera would
+    size_t update(Camera* camera)
+    {
+        mSceneMgr->_updateSceneGraph(camera);
+        InstanceBatchHW* batch = getBatch();
+        batch->_notifyCurrentCamera(camera);
+        batch->_updateRenderQueue(mSceneMgr->getRenderQueue());
+        mSceneMgr->getRenderQueue()->clear();
+
+        RenderOperation op;
+        batch->getRenderOperation(op);
+        return op.numberOfInstances;
+    }
+
+    HardwareVertexBufferSharedPtr getInstanceBuffer()
+    {
+        RenderOperation op;
+        getBatch()->getRenderOperation(op);
+        // The instance data is bound last
+        return op.vertexData->vertexBufferBinding->getBuffer(op.vertexData->vertexDeclaration->getMaxSource());
+    }
+
+    /// Overwrites the instance buffer, so that a later upload can be told apart from a skipped one
+    void poisonInstanceBuffer()
+    {
+        HardwareVertexBufferSharedPtr buffer = getInstanceBuffer();
+        HardwareBufferLockGuard<HardwareVertexBufferSharedPtr> lock(buffer, HardwareBuffer::HBL_NORMAL);
+        std::fill(static_cast<float*>(lock.pData),
+                  static_cast<float*>(lock.pData) + buffer->getSizeInBytes() / sizeof(float), -1.0f);
+    }
+
+    bool isInstanceBufferPoisoned()
+    {
+        HardwareVertexBufferSharedPtr buffer = getInstanceBuffer();
+        HardwareBufferLockGuard<HardwareVertexBufferSharedPtr> lock(buffer, HardwareBuffer::HBL_READ_ONLY);
+        return static_cast<float*>(lock.pData)[0] == -1.0f;
+    }
+
+    /// The instances the buffer holds transforms for, identified by their translation, sorted
+    std::vector<Vector3> readTranslations(size_t numInstances)
+    {
+        HardwareVertexBufferSharedPtr buffer = getInstanceBuffer();
+        HardwareBufferLockGuard<HardwareVertexBufferSharedPtr> lock(buffer, HardwareBuffer::HBL_READ_ONLY);
+        std::vector<Vector3> ret;
+        for (size_t i = 0; i < numInstances; ++i)
+        {
+            const float* xform = reinterpret_cast<const float*>(
+                static_cast<const uchar*>(lock.pData) + i * buffer->getVertexSize());
+            ret.push_back(Vector3(xform[3], xform[7], xform[11]));
+        }
+        std::sort(ret.begin(), ret.end(), lessPosition);
+        return ret;
+    }
+
+    /// Same check as InstancedEntity::findVisible, one instance at a time
+    static bool isVisible(const InstancedEntity* entity, const Camera* camera)
+    {
+        if (!entity->isInScene() || !entity->isVisible())
+            return false;
+        return !camera || camera->isVisible(Sphere(entity->_getDerivedPosition(),
+                                                   entity->getBoundingRadius() * entity->getMaxScaleCoef()));
+    }
+
+    std::vector<Vector3> findVisible(const Camera* camera)
+    {
+        std::vector<Vector3> ret;
+        for (size_t i = 0; i < mEntities.size(); ++i)
+        {
+            if (isVisible(mEntities[i], camera))
+                ret.push_back(mEntities[i]->_getDerivedPosition());
+        }
+        std::sort(ret.begin(), ret.end(), lessPosition);
+        return ret;
+    }
+};
+
+TEST_F(InstanceBatchHWTests, CullingMatchesFindVisible)
+{
+    createInstances(1000, 0);
+
+    Camera* cullCamera = mSceneMgr->createCamera("InstanceBatchHWTests/Cull");
+    cullCamera->setNearClipDistance(10);
+    cullCamera->setFarClipDistance(500);
+    cullCamera->setFOVy(Degree(30));
+    mSceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(100, 0, 0))->attachObject(cullCamera);
+
+    size_t totalVisible = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        mCamera->getParentSceneNode()->setOrientation(
+            Quaternion(Degree(i * 45.0f), Vector3::UNIT_Y) * Quaternion(Degree(i * 20.0f), Vector3::UNIT_X));
+        // infinite far plane, then a separate culling frustum
+        mCamera->setFarClipDistance(i % 4 == 1 ? 0 : 1000);
+        mCamera->setCullingFrustum(i % 4 == 2 ? cullCamera : NULL);
+
+        size_t numInstances = update(mCamera);
+        std::vector<Vector3> expected = findVisible(mCamera);
+        ASSERT_EQ(numInstances, expected.size());
+        EXPECT_EQ(readTranslations(numInstances), expected);
+        totalVisible += numInstances;
+    }
+    EXPECT_GT(totalVisible, 0u);
+
+    // A static batch is updated without a camera, every in-scene, visible instance is drawn
+    getBatch()->setStaticAndUpdate(true);
+    RenderOperation op;
+    getBatch()->getRenderOperation(op);
+    std::vector<Vector3> expected = findVisible(NULL);
+    ASSERT_EQ(op.numberOfInstances, expected.size());
+    EXPECT_EQ(readTranslations(op.numberOfInstances), expected);
+}
+
+TEST_F(InstanceBatchHWTests, UploadSkippedWhenUnchanged)
+{
+    createInstances(200, 1);
+    mCamera->setFarClipDistance(0);
+
+    size_t numInstances = update(mCamera);
+    ASSERT_GT(numInstances, 1u);
+    EXPECT_EQ(readTranslations(numInstances), findVisible(mCamera));
+
+    // Same camera, nothing changed
+    poisonInstanceBuffer();
+    EXPECT_EQ(update(mCamera), numInstances);
+    EXPECT_TRUE(isInstanceBufferPoisoned());
+
+    // An instance moved
+    InstancedEntity* moved = NULL;
+    for (size_t i = 0; i < mEntities.size() && !moved; ++i)
+    {
+        if (isVisible(mEntities[i], mCamera) && mEntities[i]->getParentSceneNode())
+            moved = mEntities[i];
+    }
+    moved->getParentSceneNode()->translate(Vector3(0, 0, -1));
+    EXPECT_EQ(update(mCamera), numInstances);
+    EXPECT_FALSE(isInstanceBufferPoisoned());
+    EXPECT_EQ(readTranslations(numInstances), findVisible(mCamera));
+
+    // A custom parameter changed
+    poisonInstanceBuffer();
+    moved->setCustomParam(0, Vector4(1, 2, 3, 4));
+    EXPECT_EQ(update(mCamera), numInstances);
+    EXPECT_FALSE(isInstanceBufferPoisoned());
+
+    poisonInstanceBuffer();
+    EXPECT_EQ(update(mCamera), numInstances);
+    EXPECT_TRUE(isInstanceBufferPoisoned());
+
+    // The camera turned, other instances are visible
+    mCamera->getParentSceneNode()->yaw(Degree(180));
+    size_t turned = update(mCamera);
+    EXPECT_FALSE(isInstanceBufferPoisoned());
+    EXPECT_EQ(readTranslations(turned), findVisible(mCamera));
+
+    // Camera relative rendering depends on the camera position, it is always written
+    mSceneMgr->setCameraRelativeRendering(true);
+    poisonInstanceBuffer();
+    update(mCamera);
+    EXPECT_FALSE(isInstanceBufferPoisoned());
+}
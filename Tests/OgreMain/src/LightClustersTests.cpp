@@ -0,0 +1,158 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include <OgreLightClusters.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+class LightClustersTests : public RootWithoutRenderSystemFixture
+{
+public:
+    SceneManager* mSceneMgr;
+    Camera* mCamera;
+    LightList mLights;
+
+    void SetUp()
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+        mSceneMgr = mRoot->createSceneManager();
+
+        // Looking down -z with a 90 degree square frustum, so the tiles at depth d
+        // span [-d, d] in x and y
+        mCamera = mSceneMgr->createCamera("LightClustersTests");
+        mCamera->setNearClipDistance(1);
+        mCamera->setFarClipDistance(1000);
+        mCamera->setFOVy(Degree(90));
+        mCamera->setAspectRatio(1);
+        mSceneMgr->getRootSceneNode()->createChildSceneNode()->attachObject(mCamera);
+    }
+
+    void TearDown()
+    {
+        mLights.clear();
+        RootWithoutRenderSystemFixture::TearDown();
+    }
+
+    Light* addLight(Light::LightTypes type, const Vector3& position, Real range)
+    {
+        Light* light = mSceneMgr->createLight();
+        light->setType(type);
+        light->setAttenuation(range, 1, 0, 0);
+        mSceneMgr->getRootSceneNode()->createChildSceneNode(position)->attachObject(light);
+        mLights.push_back(light);
+        return light;
+    }
+
+    /// Light indices binned into a cluster
+    std::vector<uint32> getClusterLights(const LightClusters& clusters, size_t x, size_t y, size_t slice)
+    {
+        size_t c = clusters.getClusterIndex(x, y, slice);
+        uint32 offset = clusters.getClusters()[c * 2];
+        uint32 count = clusters.getClusters()[c * 2 + 1];
+        return std::vector<uint32>(clusters.getLightIndices().begin() + offset,
+                                   clusters.getLightIndices().begin() + offset + count);
+    }
+};
+
+TEST_F(LightClustersTests, BinsPointLightsByTileAndSlice)
+{
+    LightClusters clusters;
+    clusters.setDimensions(4, 4, 8);
+
+    addLight(Light::LT_DIRECTIONAL, Vector3::ZERO, 0);
+    // at depth 10 the slice is floor(log(10) / log(1000) * 8) = 2 and the light
+    // covers the centre of the screen, i.e. tiles 1 and 2
+    addLight(Light::LT_POINT, Vector3(0, 0, -10), 1);
+    // behind the camera
+    addLight(Light::LT_POINT, Vector3(0, 0, 50), 5);
+
+    clusters.build(mCamera, mLights);
+
+    EXPECT_EQ(3u, clusters.getNumLights());
+    EXPECT_EQ(1u, clusters.getNumDirectionalLights());
+    ASSERT_EQ(4u * 4 * 8 * 2, clusters.getClusters().size());
+
+    // directional lights come first, the first point light is index 1
+    std::vector<uint32> expected(1, 1);
+    for (size_t y = 0; y < 4; ++y)
+    {
+        for (size_t x = 0; x < 4; ++x)
+        {
+            for (size_t slice = 0; slice < 8; ++slice)
+            {
+                bool inside = slice == 2 && (x == 1 || x == 2) && (y == 1 || y == 2);
+                EXPECT_EQ(inside ? expected : std::vector<uint32>(), getClusterLights(clusters, x, y, slice))
+                    << x << " " << y << " " << slice;
+            }
+        }
+    }
+}
+
+TEST_F(LightClustersTests, MaxLightsPerCluster)
+{
+    LightClusters clusters;
+    clusters.setDimensions(4, 4, 8);
+    clusters.setMaxLightsPerCluster(4);
+
+    for (int i = 0; i < 10; ++i)
+        addLight(Light::LT_POINT, Vector3(0, 0, -10), 1);
+
+    clusters.build(mCamera, mLights);
+
+    std::vector<uint32> lights = getClusterLights(clusters, 1, 1, 2);
+    ASSERT_EQ(4u, lights.size());
+    // the first lights are kept
+    for (uint32 i = 0; i < 4; ++i)
+        EXPECT_EQ(i, lights[i]);
+}
+
+TEST_F(LightClustersTests, ResultsIndependentOfThreadCount)
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        Vector3 pos(Math::RangeRandom(-200, 200), Math::RangeRandom(-200, 200), Math::RangeRandom(-400, 10));
+        addLight(i % 5 ? Light::LT_POINT : Light::LT_SPOTLIGHT, pos, Math::RangeRandom(1, 30));
+    }
+
+    // Root's queue is not started yet, so this runs on the calling thread
+    LightClusters single;
+    single.build(mCamera, mLights);
+
+    DefaultWorkQueueBase* queue = static_cast<DefaultWorkQueueBase*>(mRoot->getWorkQueue());
+    queue->setWorkerThreadCount(4);
+    queue->startup();
+
+    LightClusters multi;
+    multi.build(mCamera, mLights);
+
+    EXPECT_FALSE(single.getLightIndices().empty());
+    EXPECT_EQ(single.getClusters(), multi.getClusters());
+    EXPECT_EQ(single.getLightIndices(), multi.getLightIndices());
+    EXPECT_EQ(single.getLightData(), multi.getLightData());
+}
@@ -0,0 +1,98 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    class LightGridSceneManager : public DefaultSceneManager
+    {
+    public:
+        LightGridSceneManager() : DefaultSceneManager("LightGrid") {}
+
+        void findLights(Camera* camera)
+        {
+            _updateSceneGraph(camera);
+            findLightsAffectingFrustum(camera);
+        }
+    };
+}
+
+typedef RootWithoutRenderSystemFixture LightGridTests;
+
+TEST_F(LightGridTests, MatchesBruteForce)
+{
+    LightGridSceneManager sceneMgr;
+    Camera* camera = sceneMgr.createCamera("LightGridTests");
+    camera->setNearClipDistance(1);
+    camera->setFarClipDistance(1000);
+    sceneMgr.getRootSceneNode()->createChildSceneNode()->attachObject(camera);
+
+    std::vector<SceneNode*> nodes;
+    for (int i = 0; i < 500; ++i)
+    {
+        Light* light = sceneMgr.createLight();
+        light->setType(i % 50 == 0 ? Light::LT_DIRECTIONAL
+                                   : i % 5 ? Light::LT_POINT : Light::LT_SPOTLIGHT);
+        // a few lights cover most of the scene
+        light->setAttenuation(i % 97 == 0 ? 800 : Math::RangeRandom(1, 40), 1, 0, 0);
+        light->setLightMask(i % 3 ? 0xFFFFFFFF : 0x1);
+        Vector3 pos(Math::RangeRandom(-400, 400), Math::RangeRandom(-400, 400), Math::RangeRandom(-800, 10));
+        SceneNode* node = sceneMgr.getRootSceneNode()->createChildSceneNode(pos);
+        node->attachObject(light);
+        nodes.push_back(node);
+    }
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        sceneMgr.findLights(camera);
+        ASSERT_GE(sceneMgr._getLightsAffectingFrustum().size(), 16u);
+
+        for (int q = 0; q < 300; ++q)
+        {
+            Vector3 pos(Math::RangeRandom(-450, 450), Math::RangeRandom(-450, 450), Math::RangeRandom(-850, 50));
+            Real radius = q % 10 ? Math::RangeRandom(0, 30) : Math::RangeRandom(100, 500);
+            uint32 mask = q % 4 ? 0xFFFFFFFF : 0x2;
+
+            LightList expected, actual;
+            sceneMgr.setLightGridThreshold(0);
+            sceneMgr._populateLightList(pos, radius, expected, mask);
+            sceneMgr.setLightGridThreshold(1);
+            sceneMgr._populateLightList(pos, radius, actual, mask);
+            ASSERT_EQ(std::vector<Light*>(expected.begin(), expected.end()),
+                      std::vector<Light*>(actual.begin(), actual.end()))
+                << "frame " << frame << " query " << q;
+        }
+
+        // moving lights changes the lights affecting the frustum, the grid has to follow
+        for (size_t i = 0; i < nodes.size(); i += 7)
+            nodes[i]->translate(Math::RangeRandom(-50, 50), 0, Math::RangeRandom(-50, 50));
+    }
+}
@@ -0,0 +1,193 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    /// Position, normal and texture coordinates, as ManualObject lays them out
+    struct Vertex
+    {
+        float position[3];
+        float normal[3];
+        float uv[2];
+    };
+
+    std::vector<Vertex> makeGrid(size_t size)
+    {
+        std::vector<Vertex> vertices;
+        for (size_t y = 0; y < size; ++y)
+        {
+            for (size_t x = 0; x < size; ++x)
+            {
+                Vertex v = {{float(x) * 10, Math::RangeRandom(-5, 5), float(y) * 10},
+                            {0, 1, 0}, {float(x) / size, float(y) / size}};
+                vertices.push_back(v);
+            }
+        }
+        return vertices;
+    }
+
+    std::vector<uint32> makeGridIndices(size_t size)
+    {
+        std::vector<uint32> indices;
+        for (uint32 y = 0; y + 1 < size; ++y)
+        {
+            for (uint32 x = 0; x + 1 < size; ++x)
+            {
+                uint32 i = y * size + x;
+                uint32 quad[] = {i, i + size, i + 1, i + 1, i + size, i + size + 1};
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+        return indices;
+    }
+
+    void addVertex(ManualObject& manual, const Vertex& v)
+    {
+        manual.position(v.position[0], v.position[1], v.position[2]);
+        manual.normal(v.normal[0], v.normal[1], v.normal[2]);
+        manual.textureCoord(v.uv[0], v.uv[1]);
+    }
+
+    template<class T> std::vector<char> readBuffer(const SharedPtr<T>& buffer)
+    {
+        std::vector<char> data(buffer->getSizeInBytes());
+        buffer->readData(0, data.size(), &data[0]);
+        return data;
+    }
+}
+
+typedef RootWithoutRenderSystemFixture ManualObjectTests;
+
+TEST_F(ManualObjectTests, AppendMatchesSingleElements)
+{
+    const size_t size = 20;
+    std::vector<Vertex> vertices = makeGrid(size);
+    std::vector<uint32> indices = makeGridIndices(size);
+
+    ManualObject single("single");
+    single.begin("BaseWhite");
+    for (size_t v = 0; v < vertices.size(); ++v)
+        addVertex(single, vertices[v]);
+    for (size_t i = 0; i < indices.size(); ++i)
+        single.index(indices[i]);
+    single.end();
+
+    // The first vertex defines the declaration
+    ManualObject appended("appended");
+    appended.begin("BaseWhite");
+    addVertex(appended, vertices[0]);
+    appended.appendVertices(&vertices[1], vertices.size() - 1);
+    EXPECT_EQ(vertices.size(), appended.getCurrentVertexCount());
+    appended.appendIndices(&indices[0], 6);
+    appended.appendIndices(&indices[6], indices.size() - 6);
+    EXPECT_EQ(indices.size(), appended.getCurrentIndexCount());
+    appended.end();
+
+    RenderOperation* singleOp = single.getSection(0)->getRenderOperation();
+    RenderOperation* appendedOp = appended.getSection(0)->getRenderOperation();
+    ASSERT_EQ(sizeof(Vertex), appendedOp->vertexData->vertexDeclaration->getVertexSize(0));
+    EXPECT_EQ(singleOp->vertexData->vertexCount, appendedOp->vertexData->vertexCount);
+    EXPECT_EQ(singleOp->indexData->indexCount, appendedOp->indexData->indexCount);
+    EXPECT_EQ(readBuffer(singleOp->vertexData->vertexBufferBinding->getBuffer(0)),
+              readBuffer(appendedOp->vertexData->vertexBufferBinding->getBuffer(0)));
+    EXPECT_EQ(HardwareIndexBuffer::IT_16BIT, appendedOp->indexData->indexBuffer->getType());
+    EXPECT_EQ(readBuffer(singleOp->indexData->indexBuffer),
+              readBuffer(appendedOp->indexData->indexBuffer));
+    EXPECT_EQ(single.getBoundingBox(), appended.getBoundingBox());
+    EXPECT_FLOAT_EQ(single.getBoundingRadius(), appended.getBoundingRadius());
+}
+
+TEST_F(ManualObjectTests, AppendAfterBeginUpdate)
+{
+    const size_t size = 8;
+    std::vector<Vertex> vertices = makeGrid(size);
+    std::vector<uint32> indices = makeGridIndices(size);
+
+    ManualObject manual("manual");
+    manual.setDynamic(true);
+    manual.begin("BaseWhite");
+    for (size_t v = 0; v < vertices.size(); ++v)
+        addVertex(manual, vertices[v]);
+    manual.appendIndices(&indices[0], indices.size());
+    manual.end();
+    std::vector<char> before = readBuffer(
+        manual.getSection(0)->getRenderOperation()->vertexData->vertexBufferBinding->getBuffer(0));
+
+    // The declaration is kept, so whole blocks can go in right away
+    manual.beginUpdate(0);
+    manual.appendVertices(&vertices[0], vertices.size());
+    manual.appendIndices(&indices[0], indices.size());
+    manual.end();
+
+    RenderOperation* op = manual.getSection(0)->getRenderOperation();
+    EXPECT_EQ(vertices.size(), op->vertexData->vertexCount);
+    EXPECT_EQ(indices.size(), op->indexData->indexCount);
+    EXPECT_EQ(before, readBuffer(op->vertexData->vertexBufferBinding->getBuffer(0)));
+}
+
+TEST_F(ManualObjectTests, AppendIndicesSwitchesTo32Bit)
+{
+    ManualObject manual("manual");
+    manual.begin("BaseWhite");
+    manual.position(0, 0, 0);
+    manual.position(1, 0, 0);
+    manual.position(0, 1, 0);
+    uint32 indices[] = {0, 1, 2, 70000};
+    manual.appendIndices(indices, 3);
+    manual.end();
+    EXPECT_FALSE(manual.getSection(0)->get32BitIndices());
+
+    // enough vertices for the last index to be valid
+    manual.beginUpdate(0);
+    for (int i = 0; i <= 70000; ++i)
+        manual.position(Real(i), 0, 0);
+    manual.appendIndices(indices, 3);
+    manual.appendIndices(indices + 1, 3);
+    EXPECT_EQ(6u, manual.getCurrentIndexCount());
+    manual.end();
+    EXPECT_TRUE(manual.getSection(0)->get32BitIndices());
+    EXPECT_EQ(HardwareIndexBuffer::IT_32BIT,
+              manual.getSection(0)->getRenderOperation()->indexData->indexBuffer->getType());
+}
+
+TEST_F(ManualObjectTests, AppendVerticesNeedsDeclaration)
+{
+    Vertex v = {{0, 0, 0}, {0, 1, 0}, {0, 0}};
+    ManualObject manual("manual");
+    EXPECT_THROW(manual.appendVertices(&v, 1), InvalidParametersException);
+    uint32 index = 0;
+    EXPECT_THROW(manual.appendIndices(&index, 1), InvalidParametersException);
+
+    // Nothing tells the layout before the first vertex
+    manual.begin("BaseWhite");
+    EXPECT_THROW(manual.appendVertices(&v, 1), InvalidParametersException);
+}
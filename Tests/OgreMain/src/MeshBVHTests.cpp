@@ -0,0 +1,170 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include <OgreMeshBVH.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+class MeshBVHTests : public RootWithoutRenderSystemFixture
+{
+public:
+    /// Triangles of each submesh, three corners each
+    std::vector<std::vector<Vector3> > mTriangles;
+    MeshPtr mMesh;
+
+    void SetUp()
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+
+        // Two submeshes of small triangles scattered through a box
+        ManualObject manual("soup");
+        mTriangles.resize(2);
+        for (size_t s = 0; s < mTriangles.size(); ++s)
+        {
+            manual.begin("BaseWhite");
+            for (int t = 0; t < 500; ++t)
+            {
+                Vector3 centre(Math::RangeRandom(-100, 100), Math::RangeRandom(-100, 100),
+                               Math::RangeRandom(-100, 100));
+                for (int v = 0; v < 3; ++v)
+                {
+                    Vector3 pos = centre + Vector3(Math::RangeRandom(-10, 10), Math::RangeRandom(-10, 10),
+                                                   Math::RangeRandom(-10, 10));
+                    manual.position(pos);
+                    mTriangles[s].push_back(pos);
+                }
+                manual.triangle(t * 3, t * 3 + 1, t * 3 + 2);
+            }
+            manual.end();
+        }
+        mMesh = manual.convertToMesh("soup.mesh");
+    }
+
+    void TearDown()
+    {
+        mMesh.reset();
+        MeshManager::getSingleton().remove("soup.mesh", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        RootWithoutRenderSystemFixture::TearDown();
+    }
+};
+
+TEST_F(MeshBVHTests, RaycastFindsNearestTriangle)
+{
+    MeshBVH* bvh = mMesh->getTriangleBVH();
+    ASSERT_EQ(1000u, bvh->getTriangleCount());
+
+    int hits = 0;
+    for (int r = 0; r < 200; ++r)
+    {
+        Vector3 origin(Math::RangeRandom(-200, 200), Math::RangeRandom(-200, 200), Math::RangeRandom(-200, 200));
+        Vector3 target(Math::RangeRandom(-100, 100), Math::RangeRandom(-100, 100), Math::RangeRandom(-100, 100));
+        // not normalised, distances are in units of the direction
+        Ray ray(origin, (target - origin) * 0.5f);
+
+        MeshBVH::TriangleHit expected = {std::numeric_limits<Real>::max(), 0, 0};
+        for (unsigned short s = 0; s < mTriangles.size(); ++s)
+        {
+            const std::vector<Vector3>& corners = mTriangles[s];
+            for (uint32 t = 0; t < corners.size() / 3; ++t)
+            {
+                std::pair<bool, Real> hit = Math::intersects(ray, corners[t * 3], corners[t * 3 + 1],
+                                                             corners[t * 3 + 2], true, true);
+                if (hit.first && hit.second < expected.distance)
+                {
+                    MeshBVH::TriangleHit nearest = {hit.second, s, t};
+                    expected = nearest;
+                }
+            }
+        }
+
+        MeshBVH::TriangleHit hit;
+        bool found = bvh->raycast(ray, hit);
+        ASSERT_EQ(expected.distance != std::numeric_limits<Real>::max(), found) << r;
+        if (!found)
+            continue;
+        ++hits;
+        EXPECT_NEAR(expected.distance, hit.distance, 1e-4f) << r;
+        EXPECT_EQ(expected.subMesh, hit.subMesh) << r;
+        EXPECT_EQ(expected.triangle, hit.triangle) << r;
+    }
+    EXPECT_GT(hits, 50);
+}
+
+TEST_F(MeshBVHTests, SphereQueryFindsTouchedTriangles)
+{
+    MeshBVH* bvh = mMesh->getTriangleBVH();
+
+    for (int q = 0; q < 50; ++q)
+    {
+        Sphere sphere(Vector3(Math::RangeRandom(-100, 100), Math::RangeRandom(-100, 100),
+                              Math::RangeRandom(-100, 100)), Math::RangeRandom(5, 40));
+        MeshBVH::TriangleHitList hits;
+        bvh->sphereQuery(sphere, hits);
+
+        std::set<std::pair<unsigned short, uint32> > found;
+        for (size_t h = 0; h < hits.size(); ++h)
+            EXPECT_TRUE(found.insert(std::make_pair(hits[h].subMesh, hits[h].triangle)).second);
+
+        for (unsigned short s = 0; s < mTriangles.size(); ++s)
+        {
+            const std::vector<Vector3>& corners = mTriangles[s];
+            for (uint32 t = 0; t < corners.size() / 3; ++t)
+            {
+                AxisAlignedBox box;
+                bool cornerInside = false;
+                for (int v = 0; v < 3; ++v)
+                {
+                    box.merge(corners[t * 3 + v]);
+                    cornerInside |= sphere.intersects(corners[t * 3 + v]);
+                }
+                bool isFound = found.count(std::make_pair(s, t)) != 0;
+                // a corner inside means touching, and touching means the bounds touch
+                if (cornerInside)
+                    EXPECT_TRUE(isFound) << q << ": " << s << ", " << t;
+                if (isFound)
+                    EXPECT_TRUE(sphere.intersects(box)) << q << ": " << s << ", " << t;
+            }
+        }
+    }
+}
+
+TEST_F(MeshBVHTests, BuiltOnceForConcurrentQueries)
+{
+    // Root's queue is not started in this fixture, start it so the queries overlap
+    DefaultWorkQueueBase* queue = static_cast<DefaultWorkQueueBase*>(mRoot->getWorkQueue());
+    queue->setWorkerThreadCount(4);
+    queue->startup();
+
+    std::vector<MeshBVH*> bvhs(16);
+    WorkQueue::parallelForDefault(bvhs.size(), [this, &bvhs](size_t i) { bvhs[i] = mMesh->getTriangleBVH(); });
+
+    for (size_t i = 0; i < bvhs.size(); ++i)
+        EXPECT_EQ(bvhs[0], bvhs[i]);
+    EXPECT_EQ(1000u, bvhs[0]->getTriangleCount());
+}
@@ -248,6 +248,7 @@ TEST_F(MeshSerializerTests,Mesh_Version_1_2)
             }
             mOrigMesh = mMesh->clone(mMesh->getName() + ".orig.mesh", mMesh->getGroup());
             testMesh_XML();
+            testMesh(MESH_VERSION_1_11);
             testMesh(MESH_VERSION_1_10);
             testMesh(MESH_VERSION_1_8);
             testMesh(MESH_VERSION_1_7);
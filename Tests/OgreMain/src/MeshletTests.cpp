@@ -0,0 +1,291 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+#include <Ogre.h>
+#include <OgreMeshSerializer.h>
+#include "RootWithStubRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    typedef std::set<std::vector<uint32> > TriangleSet;
+
+    /// Reads the triangles of an index range, each rotated to start at its smallest index
+    TriangleSet readTriangles(const IndexData* indexData)
+    {
+        std::vector<uint32> indices(indexData->indexCount);
+        HardwareIndexBufferSharedPtr ibuf = indexData->indexBuffer;
+        HardwareBufferLockGuard<HardwareIndexBufferSharedPtr> lock(ibuf, HardwareBuffer::HBL_READ_ONLY);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            size_t index = indexData->indexStart + i;
+            indices[i] = ibuf->getType() == HardwareIndexBuffer::IT_32BIT
+                             ? static_cast<const uint32*>(lock.pData)[index]
+                             : static_cast<const uint16*>(lock.pData)[index];
+        }
+
+        TriangleSet triangles;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            std::vector<uint32> tri(indices.begin() + i, indices.begin() + i + 3);
+            std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+            triangles.insert(tri);
+        }
+        return triangles;
+    }
+
+    struct QueuedCounter : public RenderQueue::RenderableListener
+    {
+        int count;
+        QueuedCounter() : count(0) {}
+        bool renderableQueued(Renderable* rend, uint8 groupID, ushort priority, Technique** ppTech,
+                              RenderQueue* pQueue)
+        {
+            ++count;
+            return true;
+        }
+    };
+}
+
+class MeshletTests : public RootWithStubRenderSystemFixture
+{
+public:
+    SceneManager* mSceneMgr;
+    Camera* mCamera;
+    SceneNode* mCameraNode;
+    MeshPtr mMesh;
+    Entity* mEntity;
+    std::vector<Vector3> mPositions;
+
+    void SetUp()
+    {
+        RootWithStubRenderSystemFixture::SetUp();
+        mSceneMgr = mRoot->createSceneManager();
+        mCamera = mSceneMgr->createCamera("MeshletTests");
+        mCamera->setNearClipDistance(1);
+        mCameraNode = mSceneMgr->getRootSceneNode()->createChildSceneNode();
+        mCameraNode->attachObject(mCamera);
+
+        // A cube of 100 units, each face a grid of 16 x 16 quads facing outwards
+        ManualObject manual("cube");
+        manual.begin("BaseWhite");
+        const Vector3 normals[] = {Vector3::UNIT_X, Vector3::NEGATIVE_UNIT_X, Vector3::UNIT_Y,
+                                   Vector3::NEGATIVE_UNIT_Y, Vector3::UNIT_Z, Vector3::NEGATIVE_UNIT_Z};
+        const int n = 16;
+        for (int f = 0; f < 6; ++f)
+        {
+            Vector3 u = normals[f].perpendicular();
+            Vector3 v = normals[f].crossProduct(u);
+            uint32 base = uint32(f * (n + 1) * (n + 1));
+            for (int j = 0; j <= n; ++j)
+            {
+                for (int i = 0; i <= n; ++i)
+                {
+                    Vector3 pos = normals[f] * 50 + u * (i * 100.0f / n - 50) + v * (j * 100.0f / n - 50);
+                    manual.position(pos);
+                    manual.normal(normals[f]);
+                    mPositions.push_back(pos);
+                }
+            }
+            for (int j = 0; j < n; ++j)
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    uint32 a = base + j * (n + 1) + i;
+                    manual.quad(a, a + 1, a + n + 2, a + n + 1);
+                }
+            }
+        }
+        manual.end();
+        mMesh = manual.convertToMesh("MeshletTests/Cube");
+        mMesh->buildMeshlets(16);
+
+        mEntity = mSceneMgr->createEntity(mMesh);
+        mEntity->setMeshletCullingEnabled(true);
+        mSceneMgr->getRootSceneNode()->createChildSceneNode()->attachObject(mEntity);
+    }
+
+    void TearDown()
+    {
+        mSceneMgr->destroyEntity(mEntity);
+        mMesh.reset();
+        MeshManager::getSingleton().remove("MeshletTests/Cube", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        RootWithStubRenderSystemFixture::TearDown();
+    }
+
+    /// Culls the meshlets for a camera at eye looking at target, as a frame would
+    const IndexData* cull(const Vector3& eye, const Vector3& target)
+    {
+        mCameraNode->setPosition(eye);
+        mCameraNode->lookAt(target, Node::TS_WORLD);
+        mSceneMgr->getRootSceneNode()->_update(true, false);
+        mEntity->_notifyCurrentCamera(mCamera);
+        mEntity->_updateRenderQueue(mSceneMgr->getRenderQueue());
+        mSceneMgr->getRenderQueue()->clear();
+
+        RenderOperation op;
+        mEntity->getSubEntity(0)->getRenderOperation(op);
+        return op.indexData;
+    }
+
+    /// The triangles facing the camera with a corner or the centre in view
+    TriangleSet findVisibleTriangles(const TriangleSet& triangles)
+    {
+        TriangleSet visible;
+        Vector3 eye = mCamera->getDerivedPosition();
+        for (TriangleSet::const_iterator t = triangles.begin(); t != triangles.end(); ++t)
+        {
+            const Vector3& a = mPositions[(*t)[0]];
+            const Vector3& b = mPositions[(*t)[1]];
+            const Vector3& c = mPositions[(*t)[2]];
+            Vector3 normal = (b - a).crossProduct(c - a);
+            if (normal.dotProduct(eye - a) <= 0)
+                continue;
+            if (mCamera->isVisible(a) || mCamera->isVisible(b) || mCamera->isVisible(c) ||
+                mCamera->isVisible((a + b + c) / 3))
+                visible.insert(*t);
+        }
+        return visible;
+    }
+};
+
+TEST_F(MeshletTests, CullingKeepsVisibleTriangles)
+{
+    const IndexData* meshIndexData = mMesh->getSubMesh(0)->indexData;
+    const TriangleSet all = readTriangles(meshIndexData);
+    ASSERT_EQ(6u * 16 * 16 * 2, all.size());
+
+    // facing the +z side, then zoomed into its middle, then looking away from the cube.
+    // The bounds of the meshlets are spheres, so the frustum keeps a margin around what is seen.
+    const Vector3 eyes[] = {Vector3(0, 0, 300), Vector3(0, 0, 300), Vector3(0, 0, 300)};
+    const Vector3 targets[] = {Vector3::ZERO, Vector3::ZERO, Vector3(0, 0, 600)};
+    const Degree fovs[] = {Degree(45), Degree(2), Degree(45)};
+    const size_t maxDrawn[] = {16 * 16 * 2, 16 * 16, 0};
+    for (int i = 0; i < 3; ++i)
+    {
+        mCamera->setFOVy(fovs[i]);
+        const IndexData* drawn = cull(eyes[i], targets[i]);
+        TriangleSet drawnTriangles = readTriangles(drawn);
+        TriangleSet visible = findVisibleTriangles(all);
+
+        EXPECT_TRUE(std::includes(all.begin(), all.end(), drawnTriangles.begin(), drawnTriangles.end()));
+        EXPECT_TRUE(std::includes(drawnTriangles.begin(), drawnTriangles.end(), visible.begin(), visible.end()))
+            << "camera " << i;
+        EXPECT_LE(drawnTriangles.size(), maxDrawn[i]) << "camera " << i;
+    }
+
+    // the sub entity is not queued when nothing is left
+    QueuedCounter counter;
+    RenderQueue* queue = mSceneMgr->getRenderQueue();
+    queue->setRenderableListener(&counter);
+    mEntity->_updateRenderQueue(queue);
+    queue->setRenderableListener(0);
+    queue->clear();
+    EXPECT_EQ(0, counter.count);
+
+    // everything is drawn again once culling is turned off
+    mEntity->setMeshletCullingEnabled(false);
+    RenderOperation op;
+    mEntity->getSubEntity(0)->getRenderOperation(op);
+    EXPECT_EQ(meshIndexData, op.indexData);
+}
+
+TEST_F(MeshletTests, CopiedOnlyWhenChanged)
+{
+    mCamera->setFOVy(Degree(2));
+    const IndexData* drawn = cull(Vector3(0, 0, 300), Vector3::ZERO);
+    const TriangleSet expected = readTriangles(drawn);
+
+    // the visible meshlets are not contiguous, so they are compacted into a buffer of the sub entity
+    HardwareIndexBufferSharedPtr compacted = drawn->indexBuffer;
+    ASSERT_NE(mMesh->getSubMesh(0)->indexData->indexBuffer, compacted);
+    std::vector<uchar> zeros(compacted->getSizeInBytes());
+    compacted->writeData(0, zeros.size(), &zeros[0]);
+
+    // the same meshlets are visible, the buffer is not written again
+    drawn = cull(Vector3(0, 0, 301), Vector3::ZERO);
+    EXPECT_EQ(compacted, drawn->indexBuffer);
+    EXPECT_EQ(expected.size(), drawn->indexCount / 3);
+    TriangleSet stale = readTriangles(drawn);
+    EXPECT_EQ(1u, stale.size());
+
+    // others are, so it is
+    cull(Vector3(0, 300, 0), Vector3::ZERO);
+    drawn = cull(Vector3(0, 0, 300), Vector3::ZERO);
+    EXPECT_EQ(expected, readTriangles(drawn));
+}
+
+TEST_F(MeshletTests, SerializerRoundTrip)
+{
+    const SubMesh* orig = mMesh->getSubMesh(0);
+    ASSERT_FALSE(orig->meshlets.empty());
+
+    MeshSerializer serializer;
+    const Serializer::Endian endians[] = {Serializer::ENDIAN_NATIVE,
+#if OGRE_ENDIAN == OGRE_ENDIAN_LITTLE
+                                          Serializer::ENDIAN_BIG};
+#else
+                                          Serializer::ENDIAN_LITTLE};
+#endif
+    for (int e = 0; e < 2; ++e)
+    {
+        DataStreamPtr stream(new MemoryDataStream(1 << 20));
+        serializer.exportMesh(mMesh.get(), stream, endians[e]);
+        stream->seek(0);
+
+        MeshPtr copy = MeshManager::getSingleton().createManual(
+            "MeshletTests/Copy", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        serializer.importMesh(stream, copy.get());
+
+        const SubMesh* read = copy->getSubMesh(0);
+        ASSERT_EQ(orig->meshlets.size(), read->meshlets.size());
+        for (size_t i = 0; i < orig->meshlets.size(); ++i)
+        {
+            const SubMesh::Meshlet& a = orig->meshlets[i];
+            const SubMesh::Meshlet& b = read->meshlets[i];
+            EXPECT_EQ(a.indexStart, b.indexStart);
+            EXPECT_EQ(a.indexCount, b.indexCount);
+            EXPECT_EQ(a.centre, b.centre);
+            EXPECT_EQ(a.radius, b.radius);
+            EXPECT_EQ(a.coneAxis, b.coneAxis);
+            EXPECT_EQ(a.coneCutoff, b.coneCutoff);
+        }
+        // and the indices they refer to
+        HardwareIndexBufferSharedPtr origIndices = orig->indexData->indexBuffer;
+        HardwareIndexBufferSharedPtr readIndices = read->indexData->indexBuffer;
+        ASSERT_EQ(origIndices->getSizeInBytes(), readIndices->getSizeInBytes());
+        std::vector<uchar> origBytes(origIndices->getSizeInBytes()), readBytes(readIndices->getSizeInBytes());
+        origIndices->readData(0, origBytes.size(), &origBytes[0]);
+        readIndices->readData(0, readBytes.size(), &readBytes[0]);
+        EXPECT_TRUE(origBytes == readBytes);
+
+        copy.reset();
+        MeshManager::getSingleton().remove("MeshletTests/Copy", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+    }
+}
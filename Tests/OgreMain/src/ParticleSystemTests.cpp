@@ -0,0 +1,151 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include "OgreParticleEmitterFactory.h"
+#include "RootWithStubRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    /// Emits at a constant rate from the emitter position, like the point emitter of ParticleFX
+    class ConstantEmitter : public ParticleEmitter
+    {
+    public:
+        ConstantEmitter(ParticleSystem* psys) : ParticleEmitter(psys) { mType = "Constant"; }
+
+        unsigned short _getEmissionCount(Real timeElapsed) { return genConstantEmissionCount(timeElapsed); }
+
+        void _initParticle(Particle* pParticle)
+        {
+            ParticleEmitter::_initParticle(pParticle);
+            pParticle->mPosition = mPosition;
+            pParticle->mDirection = Vector3::ZERO;
+            pParticle->mTimeToLive = pParticle->mTotalTimeToLive = genEmissionTTL();
+        }
+    };
+
+    class ConstantEmitterFactory : public ParticleEmitterFactory
+    {
+    public:
+        String getName() const { return "Constant"; }
+
+        ParticleEmitter* createEmitter(ParticleSystem* psys)
+        {
+            ParticleEmitter* emitter = OGRE_NEW ConstantEmitter(psys);
+            mEmitters.push_back(emitter);
+            return emitter;
+        }
+    };
+}
+
+class ParticleSystemTests : public RootWithStubRenderSystemFixture
+{
+public:
+    ConstantEmitterFactory mEmitterFactory;
+    SceneManager* mSceneMgr;
+    std::vector<ParticleSystem*> mSystems;
+
+    void SetUp()
+    {
+        RootWithStubRenderSystemFixture::SetUp();
+        // the renderer factories are otherwise added along with the first window
+        ParticleSystemManager::getSingleton()._initialise();
+        ParticleSystemManager::getSingleton().addEmitterFactory(&mEmitterFactory);
+        mSceneMgr = mRoot->createSceneManager();
+    }
+
+    void TearDown()
+    {
+        // the emitters have to go before their factory
+        mRoot->destroySceneManager(mSceneMgr);
+        mSystems.clear();
+        RootWithStubRenderSystemFixture::TearDown();
+    }
+
+    void addSystem(Real rate, Real ttl, size_t quota)
+    {
+        ParticleSystem* psys = mSceneMgr->createParticleSystem(quota);
+        ParticleEmitter* emitter = psys->addEmitter("Constant");
+        emitter->setEmissionRate(rate);
+        emitter->setTimeToLive(ttl);
+        mSceneMgr->getRootSceneNode()->createChildSceneNode()->attachObject(psys);
+        mSystems.push_back(psys);
+    }
+
+    /// Updates every system once per frame, as their controllers would
+    size_t runFrames(int count, Real timeElapsed)
+    {
+        size_t numParticles = 0;
+        for (int frame = 0; frame < count; ++frame)
+        {
+            mRoot->_fireFrameRenderingQueued();
+            numParticles = 0;
+            for (size_t i = 0; i < mSystems.size(); ++i)
+            {
+                mSystems[i]->_update(timeElapsed);
+                numParticles += mSystems[i]->getNumParticles();
+            }
+        }
+        return numParticles;
+    }
+};
+
+TEST_F(ParticleSystemTests, ParticleBudgetCapsParticleCount)
+{
+    ParticleSystemManager& psm = ParticleSystemManager::getSingleton();
+    for (int i = 0; i < 4; ++i)
+        addSystem(500, 8, 10000);
+
+    // without a budget every system fills up to rate * ttl
+    EXPECT_EQ(16000u, runFrames(200, 0.05));
+    EXPECT_EQ(1.0f, psm.getBudgetFactor());
+    for (size_t i = 0; i < mSystems.size(); ++i)
+        mSystems[i]->clear();
+
+    psm.setParticleBudget(2000);
+    runFrames(600, 0.05);
+    EXPECT_LT(psm.getBudgetFactor(), 0.25f);
+    EXPECT_GT(psm.getBudgetFactor(), 0.05f);
+
+    // settled close to the budget, without collapsing to nothing
+    size_t lowest = std::numeric_limits<size_t>::max(), highest = 0;
+    for (int frame = 0; frame < 100; ++frame)
+    {
+        size_t numParticles = runFrames(1, 0.05);
+        lowest = std::min(lowest, numParticles);
+        highest = std::max(highest, numParticles);
+    }
+    EXPECT_LE(highest, 2000u * 11 / 10);
+    EXPECT_GE(lowest, 2000u * 8 / 10);
+
+    // full detail again once the budget is lifted
+    psm.setParticleBudget(0);
+    EXPECT_EQ(16000u, runFrames(600, 0.05));
+    EXPECT_NEAR(1.0f, psm.getBudgetFactor(), 1e-3f);
+}
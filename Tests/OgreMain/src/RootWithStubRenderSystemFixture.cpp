@@ -0,0 +1,289 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "RootWithStubRenderSystemFixture.h"
+
+#include <Ogre.h>
+
+using namespace Ogre;
+
+namespace
+{
+    class StubRenderTexture : public RenderTexture
+    {
+    public:
+        StubRenderTexture(HardwarePixelBuffer* buffer, const String& name) : RenderTexture(buffer, 0)
+        {
+            mName = name;
+            mWidth = buffer->getWidth();
+            mHeight = buffer->getHeight();
+            mColourDepth = static_cast<unsigned int>(PixelUtil::getNumElemBits(buffer->getFormat()));
+        }
+
+        bool requiresTextureFlipping() const { return false; }
+    };
+
+    /// Keeps the pixels in system memory, so blits and reads work
+    class StubPixelBuffer : public HardwarePixelBuffer
+    {
+    public:
+        StubPixelBuffer(const String& name, uint32 width, uint32 height, PixelFormat format, int usage)
+            : HardwarePixelBuffer(width, height, 1, format, (HardwareBuffer::Usage)usage, true, false),
+              mData(PixelUtil::getMemorySize(width, height, 1, format)), mTarget(0)
+        {
+            if (usage & TU_RENDERTARGET)
+                mTarget = new StubRenderTexture(this, name);
+        }
+
+        ~StubPixelBuffer() { delete mTarget; }
+
+        RenderTexture* getRenderTarget(size_t slice = 0) { return mTarget; }
+
+        void blitFromMemory(const PixelBox& src, const Box& dstBox)
+        {
+            PixelUtil::bulkPixelConversion(src, getPixels().getSubVolume(dstBox));
+        }
+
+        void blitToMemory(const Box& srcBox, const PixelBox& dst)
+        {
+            PixelUtil::bulkPixelConversion(getPixels().getSubVolume(srcBox), dst);
+        }
+
+    protected:
+        PixelBox lockImpl(const Box& lockBox, LockOptions options) { return getPixels().getSubVolume(lockBox); }
+        void unlockImpl(void) {}
+        void _clearSliceRTT(size_t zoffset) { mTarget = 0; }
+
+        PixelBox getPixels() { return PixelBox(mWidth, mHeight, mDepth, mFormat, mData.empty() ? 0 : &mData[0]); }
+
+        std::vector<uchar> mData;
+        RenderTexture* mTarget;
+    };
+
+    class StubTexture : public Texture
+    {
+    public:
+        StubTexture(ResourceManager* creator, const String& name, ResourceHandle handle,
+                    const String& group, bool isManual, ManualResourceLoader* loader)
+            : Texture(creator, name, handle, group, isManual, loader)
+        {
+        }
+
+        ~StubTexture() { unload(); }
+
+        HardwarePixelBufferSharedPtr getBuffer(size_t face = 0, size_t mipmap = 0)
+        {
+            if (face != 0 || mipmap != 0)
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Only the first surface is kept", "StubTexture::getBuffer");
+            return mSurface;
+        }
+
+    protected:
+        void loadImpl(void)
+        {
+            // no image is read, but the texture can be bound
+            if (!mWidth || !mHeight)
+            {
+                mWidth = mHeight = mDepth = 1;
+                mSrcWidth = mSrcHeight = mSrcDepth = 1;
+                mFormat = PF_A8R8G8B8;
+            }
+            createInternalResources();
+        }
+
+        void createInternalResourcesImpl(void)
+        {
+            mSurface.reset(new StubPixelBuffer(mName, mWidth, mHeight, mFormat, mUsage));
+        }
+
+        void freeInternalResourcesImpl(void) { mSurface.reset(); }
+
+        HardwarePixelBufferSharedPtr mSurface;
+    };
+
+    class StubTextureManager : public TextureManager
+    {
+    public:
+        StubTextureManager() { ResourceGroupManager::getSingleton()._registerResourceManager(mResourceType, this); }
+        ~StubTextureManager() { ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType); }
+
+        PixelFormat getNativeFormat(TextureType ttype, PixelFormat format, int usage) { return format; }
+        bool isHardwareFilteringSupported(TextureType ttype, PixelFormat format, int usage,
+                                          bool preciseFormatOnly = false)
+        {
+            return true;
+        }
+
+    protected:
+        Resource* createImpl(const String& name, ResourceHandle handle, const String& group, bool isManual,
+                             ManualResourceLoader* loader, const NameValuePairList* createParams)
+        {
+            return new StubTexture(this, name, handle, group, isManual, loader);
+        }
+    };
+
+    class StubGpuProgram : public GpuProgram
+    {
+    public:
+        StubGpuProgram(ResourceManager* creator, const String& name, ResourceHandle handle,
+                       const String& group, bool isManual, ManualResourceLoader* loader)
+            : GpuProgram(creator, name, handle, group, isManual, loader)
+        {
+        }
+
+        ~StubGpuProgram() { unload(); }
+
+    protected:
+        void loadFromSource(void) {}
+        void unloadImpl(void) {}
+    };
+
+    class StubGpuProgramManager : public GpuProgramManager
+    {
+    public:
+        StubGpuProgramManager() { ResourceGroupManager::getSingleton()._registerResourceManager(mResourceType, this); }
+        ~StubGpuProgramManager() { ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType); }
+
+    protected:
+        Resource* createImpl(const String& name, ResourceHandle handle, const String& group, bool isManual,
+                             ManualResourceLoader* loader, const NameValuePairList* createParams)
+        {
+            StubGpuProgram* prog = new StubGpuProgram(this, name, handle, group, isManual, loader);
+            NameValuePairList::const_iterator type;
+            if (createParams && (type = createParams->find("type")) != createParams->end())
+                prog->setType(type->second == "vertex_program" ? GPT_VERTEX_PROGRAM : GPT_FRAGMENT_PROGRAM);
+            return prog;
+        }
+
+        Resource* createImpl(const String& name, ResourceHandle handle, const String& group, bool isManual,
+                             ManualResourceLoader* loader, GpuProgramType gptype, const String& syntaxCode)
+        {
+            StubGpuProgram* prog = new StubGpuProgram(this, name, handle, group, isManual, loader);
+            prog->setType(gptype);
+            prog->setSyntaxCode(syntaxCode);
+            return prog;
+        }
+    };
+}
+
+StubRenderSystem::StubRenderSystem()
+{
+    mRealCapabilities = createRenderSystemCapabilities();
+    mCurrentCapabilities = mRealCapabilities;
+    mTextureManager = new StubTextureManager();
+    mGpuProgramManager = new StubGpuProgramManager();
+}
+
+StubRenderSystem::~StubRenderSystem()
+{
+    shutdown();
+    delete mGpuProgramManager;
+    delete mTextureManager;
+}
+
+const String& StubRenderSystem::getName(void) const
+{
+    static String name = "Stub Rendering Subsystem";
+    return name;
+}
+
+RenderSystemCapabilities* StubRenderSystem::createRenderSystemCapabilities() const
+{
+    RenderSystemCapabilities* caps = OGRE_NEW RenderSystemCapabilities();
+    caps->setRenderSystemName(getName());
+    caps->setDeviceName("Stub");
+    caps->setNumTextureUnits(16);
+    caps->setNumVertexAttributes(16);
+    caps->setNumMultiRenderTargets(1);
+    caps->setCapability(RSC_FIXED_FUNCTION);
+    caps->setCapability(RSC_HWRENDER_TO_TEXTURE);
+    caps->setCapability(RSC_TEXTURE_FLOAT);
+    caps->setCapability(RSC_NON_POWER_OF_2_TEXTURES);
+    caps->setCapability(RSC_TEXTURE_3D);
+    caps->setCapability(RSC_HWSTENCIL);
+    caps->setCapability(RSC_32BIT_INDEX);
+    caps->setCapability(RSC_VERTEX_PROGRAM);
+    caps->setCapability(RSC_FRAGMENT_PROGRAM);
+    caps->setCapability(RSC_VERTEX_FORMAT_UBYTE4);
+    caps->setCapability(RSC_VERTEX_BUFFER_INSTANCE_DATA);
+    caps->setCapability(RSC_ADVANCED_BLEND_OPERATIONS);
+    caps->addShaderProfile("stub");
+    caps->setMaxPointSize(1);
+    return caps;
+}
+
+void StubRenderSystem::clearFrameBuffer(unsigned int buffers, const ColourValue& colour, Real depth,
+                                        unsigned short stencil)
+{
+    Clear clear = {buffers, colour, depth};
+    mClears.push_back(clear);
+}
+
+void StubRenderSystem::_render(const RenderOperation& op)
+{
+    RenderSystem::_render(op);
+
+    Draw draw = {op.srcRenderable, mCullingMode, mGlobalNumberOfInstances};
+    if (mGlobalInstanceVertexBuffer)
+    {
+        draw.instanceData.resize(mGlobalNumberOfInstances * mGlobalInstanceVertexBuffer->getVertexSize() /
+                                 sizeof(float));
+        mGlobalInstanceVertexBuffer->readData(0, draw.instanceData.size() * sizeof(float),
+                                              &draw.instanceData[0]);
+    }
+    mDraws.push_back(draw);
+}
+
+const String& StubRenderSystemPlugin::getName() const
+{
+    static String name = "Stub RenderSystem";
+    return name;
+}
+
+void StubRenderSystemPlugin::install()
+{
+    mRenderSystem = new StubRenderSystem();
+    Root::getSingleton().addRenderSystem(mRenderSystem);
+    Root::getSingleton().setRenderSystem(mRenderSystem);
+}
+
+void StubRenderSystemPlugin::uninstall()
+{
+    delete mRenderSystem;
+    mRenderSystem = 0;
+}
+
+void RootWithStubRenderSystemFixture::SetUp()
+{
+    RootWithoutRenderSystemFixture::SetUp();
+    // uninstalled by Root, before its resource managers go
+    mRoot->installPlugin(&mPlugin);
+    mRenderSystem = mPlugin.mRenderSystem;
+    // no window, but rendering needs the controller manager this creates
+    mRoot->initialise(false);
+}
@@ -0,0 +1,145 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include "RootWithStubRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    /// Runs the caster culling and cache checks of a shadow texture without rendering it
+    class ShadowCacheSceneManager : public DefaultSceneManager
+    {
+    public:
+        ShadowCacheSceneManager() : DefaultSceneManager("ShadowCache") {}
+
+        bool checkCache(Camera* texCam, bool& dynamicCasters)
+        {
+            _updateSceneGraph(texCam);
+            mShadowRenderer.cullShadowCasters(std::vector<Camera*>(1, texCam));
+            mShadowRenderer.mShadowTextureCaches.resize(1);
+            VisibleObjectsBoundsInfo bounds;
+            return mShadowRenderer.checkShadowTextureCache(mShadowRenderer.mShadowTextureCaches[0],
+                                                           texCam, 0, bounds, dynamicCasters);
+        }
+
+        bool checkCache(Camera* texCam)
+        {
+            bool dynamicCasters;
+            return checkCache(texCam, dynamicCasters);
+        }
+
+        void setCachedShadowColour(const ColourValue& colour) { mShadowRenderer.mShadowColour = colour; }
+    };
+
+    ManualObject* createBox(SceneManager* sceneMgr, const String& material, const Vector3& pos)
+    {
+        ManualObject* box = sceneMgr->createManualObject();
+        box->begin(material);
+        for (int i = 0; i < 8; ++i)
+            box->position(i & 1 ? 5 : -5, i & 2 ? 5 : -5, i & 4 ? 5 : -5);
+        box->quad(0, 1, 3, 2);
+        box->quad(4, 6, 7, 5);
+        box->end();
+        sceneMgr->getRootSceneNode()->createChildSceneNode(pos)->attachObject(box);
+        return box;
+    }
+}
+
+typedef RootWithStubRenderSystemFixture ShadowTextureCacheTests;
+
+TEST_F(ShadowTextureCacheTests, Invalidation)
+{
+    MaterialPtr other = MaterialManager::getSingleton().getByName("BaseWhite")->clone("ShadowCacheOther");
+    MaterialManager::getSingleton().load("BaseWhite", ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME);
+    other->load();
+
+    ShadowCacheSceneManager sceneMgr;
+    Camera* texCam = sceneMgr.createCamera("ShadowCache");
+    texCam->setNearClipDistance(1);
+    texCam->setFarClipDistance(500);
+    SceneNode* camNode = sceneMgr.getRootSceneNode()->createChildSceneNode(Vector3(0, 200, 0));
+    camNode->attachObject(texCam);
+    camNode->pitch(Degree(-90));
+
+    // lower than the dynamic one, so the depth range leaves it some room
+    ManualObject* staticCaster = createBox(&sceneMgr, "BaseWhite", Vector3(-20, -30, 0));
+    staticCaster->setStaticShadowCaster(true);
+    ManualObject* dynamicCaster = createBox(&sceneMgr, "BaseWhite", Vector3(20, 0, 0));
+
+    bool dynamicCasters = false;
+    EXPECT_FALSE(sceneMgr.checkCache(texCam, dynamicCasters));
+    EXPECT_TRUE(dynamicCasters);
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+
+    // dynamic casters do not matter while they stay within the depth range
+    dynamicCaster->getParentSceneNode()->translate(0, -10, 0);
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+    dynamicCaster->getParentSceneNode()->translate(0, -100, 0);
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+
+    staticCaster->getParentSceneNode()->translate(0, 0, 1);
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+
+    staticCaster->setMaterialName(0, "ShadowCacheOther");
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+
+    staticCaster->setVisible(false);
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+    staticCaster->setVisible(true);
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+
+    ManualObject* added = createBox(&sceneMgr, "BaseWhite", Vector3(0, 0, 20));
+    added->setStaticShadowCaster(true);
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+
+    sceneMgr.setCachedShadowColour(ColourValue(0.5, 0.5, 0.5));
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+
+    camNode->translate(1, 0, 0);
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+
+    texCam->setFOVy(Degree(60));
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+
+    sceneMgr.invalidateShadowTextureCache();
+    EXPECT_FALSE(sceneMgr.checkCache(texCam));
+    EXPECT_TRUE(sceneMgr.checkCache(texCam));
+
+    // without dynamic casters nothing has to be rendered over the cache
+    sceneMgr.destroyManualObject(dynamicCaster);
+    EXPECT_TRUE(sceneMgr.checkCache(texCam, dynamicCasters));
+    EXPECT_FALSE(dynamicCasters);
+}
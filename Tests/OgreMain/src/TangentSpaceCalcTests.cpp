@@ -0,0 +1,120 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    /// A bumpy grid with some mirrored texture coordinates
+    MeshPtr createGridMesh(const String& name, size_t size)
+    {
+        ManualObject manual(name);
+        manual.begin("BaseWhite");
+        for (size_t y = 0; y < size; ++y)
+        {
+            for (size_t x = 0; x < size; ++x)
+            {
+                Real u = Real(x) / size, v = Real(y) / size;
+                manual.position(x * 10, Math::Sin(u * 20) * Math::Cos(v * 15) * 10, y * 10);
+                Vector3 normal(Math::Sin(Real(x * 7 + y * 13)) * 0.3f, 1, Math::Cos(Real(x * 11 + y * 5)) * 0.3f);
+                manual.normal(normal.normalisedCopy());
+                manual.textureCoord(x < size / 2 ? u : 1 - u, v);
+            }
+        }
+        for (uint32 y = 0; y + 1 < size; ++y)
+        {
+            for (uint32 x = 0; x + 1 < size; ++x)
+            {
+                uint32 i = y * size + x;
+                manual.quad(i, i + size, i + size + 1, i + 1);
+            }
+        }
+        manual.end();
+        return manual.convertToMesh(name);
+    }
+
+    std::vector<char> readVertices(const MeshPtr& mesh)
+    {
+        VertexData* vertexData = mesh->getSubMesh(0)->vertexData;
+        std::vector<char> data;
+        // bindings may have gaps once the tangents are added
+        const VertexBufferBinding::VertexBufferBindingMap& bindings =
+            vertexData->vertexBufferBinding->getBindings();
+        VertexBufferBinding::VertexBufferBindingMap::const_iterator b;
+        for (b = bindings.begin(); b != bindings.end(); ++b)
+        {
+            const HardwareVertexBufferSharedPtr& buffer = b->second;
+            size_t offset = data.size();
+            data.resize(offset + buffer->getSizeInBytes());
+            buffer->readData(0, buffer->getSizeInBytes(), &data[offset]);
+        }
+        return data;
+    }
+
+    std::vector<char> readIndices(const MeshPtr& mesh)
+    {
+        const HardwareIndexBufferSharedPtr& buffer = mesh->getSubMesh(0)->indexData->indexBuffer;
+        std::vector<char> data(buffer->getSizeInBytes());
+        buffer->readData(0, data.size(), &data[0]);
+        return data;
+    }
+}
+
+typedef RootWithoutRenderSystemFixture TangentSpaceCalcTests;
+
+TEST_F(TangentSpaceCalcTests, ThreadedMatchesSerial)
+{
+    // with and without splitting mirrored and rotated faces
+    MeshPtr serial[2], threaded[2];
+    for (int split = 0; split < 2; ++split)
+    {
+        String suffix = StringConverter::toString(split);
+        serial[split] = createGridMesh("serial" + suffix, 96);
+        threaded[split] = createGridMesh("threaded" + suffix, 96);
+        ASSERT_EQ(readVertices(serial[split]), readVertices(threaded[split]));
+
+        // Root's queue is not started yet, so this runs on the calling thread
+        serial[split]->buildTangentVectors(VES_TANGENT, 0, 0, split != 0, split != 0, true);
+    }
+
+    DefaultWorkQueueBase* queue = static_cast<DefaultWorkQueueBase*>(mRoot->getWorkQueue());
+    queue->setWorkerThreadCount(4);
+    queue->startup();
+
+    for (int split = 0; split < 2; ++split)
+    {
+        threaded[split]->buildTangentVectors(VES_TANGENT, 0, 0, split != 0, split != 0, true);
+
+        EXPECT_EQ(serial[split]->getSubMesh(0)->vertexData->vertexCount,
+                  threaded[split]->getSubMesh(0)->vertexData->vertexCount);
+        EXPECT_EQ(readVertices(serial[split]), readVertices(threaded[split]));
+        EXPECT_EQ(readIndices(serial[split]), readIndices(threaded[split]));
+    }
+}
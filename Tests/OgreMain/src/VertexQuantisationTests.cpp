@@ -0,0 +1,262 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+#include <Ogre.h>
+#include <OgreMeshSerializer.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    /// The source data, one entry per vertex
+    struct Vertex
+    {
+        Vector3 position;
+        Vector3 normal;
+        Vector4 tangent;
+        Vector2 uv01;  // within [0, 1]
+        Vector2 uvSigned; // within [-1, 1]
+        Vector2 uvTiled; // outside [-1, 1], stays float
+    };
+
+    Vector3 randomDirection()
+    {
+        Vector3 dir(Math::RangeRandom(-1, 1), Math::RangeRandom(-1, 1), Math::RangeRandom(-1, 1));
+        return dir.normalisedCopy();
+    }
+
+    /// Decodes a normalised short the way the vertex fetch does
+    Real decodeSnorm(short v) { return std::max<Real>(v / 32767.0f, -1); }
+
+    /// Angle between two directions, precise for small angles unlike Vector3::angleBetween
+    Real angleBetween(const Vector3& a, const Vector3& b)
+    {
+        return Math::ATan2(a.crossProduct(b).length(), a.dotProduct(b)).valueRadians();
+    }
+}
+
+class VertexQuantisationTests : public RootWithoutRenderSystemFixture
+{
+public:
+    std::vector<Vertex> mVertices;
+    MeshPtr mMesh;
+
+    void SetUp()
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+
+        srand(3);
+        mVertices.resize(300);
+        for (size_t i = 0; i < mVertices.size(); ++i)
+        {
+            Vertex& v = mVertices[i];
+            v.position = Vector3(Math::RangeRandom(-20, 60), Math::RangeRandom(0, 5), Math::RangeRandom(-1, 1));
+            v.normal = randomDirection();
+            v.tangent = Vector4(randomDirection());
+            v.tangent.w = i % 3 ? 1 : -1;
+            v.uv01 = Vector2(Math::UnitRandom(), Math::UnitRandom());
+            v.uvSigned = Vector2(Math::SymmetricRandom(), Math::SymmetricRandom());
+            v.uvTiled = Vector2(Math::RangeRandom(0, 4), Math::RangeRandom(0, 4));
+        }
+
+        mMesh = MeshManager::getSingleton().createManual("VertexQuantisationTests",
+                                                         ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        mMesh->sharedVertexData = new VertexData();
+        mMesh->sharedVertexData->vertexCount = mVertices.size();
+        VertexDeclaration* decl = mMesh->sharedVertexData->vertexDeclaration;
+        size_t offset = 0;
+        offset += decl->addElement(0, offset, VET_FLOAT3, VES_POSITION).getSize();
+        offset += decl->addElement(0, offset, VET_FLOAT3, VES_NORMAL).getSize();
+        decl->addElement(0, offset, VET_FLOAT4, VES_TANGENT);
+        offset = 0;
+        for (unsigned short i = 0; i < 3; ++i)
+            offset += decl->addElement(1, offset, VET_FLOAT2, VES_TEXTURE_COORDINATES, i).getSize();
+
+        HardwareVertexBufferSharedPtr buf0 = HardwareBufferManager::getSingleton().createVertexBuffer(
+            decl->getVertexSize(0), mVertices.size(), HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        HardwareVertexBufferSharedPtr buf1 = HardwareBufferManager::getSingleton().createVertexBuffer(
+            decl->getVertexSize(1), mVertices.size(), HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        std::vector<float> data0, data1;
+        for (size_t i = 0; i < mVertices.size(); ++i)
+        {
+            const Vertex& v = mVertices[i];
+            data0.insert(data0.end(), v.position.ptr(), v.position.ptr() + 3);
+            data0.insert(data0.end(), v.normal.ptr(), v.normal.ptr() + 3);
+            data0.insert(data0.end(), v.tangent.ptr(), v.tangent.ptr() + 4);
+            data1.insert(data1.end(), v.uv01.ptr(), v.uv01.ptr() + 2);
+            data1.insert(data1.end(), v.uvSigned.ptr(), v.uvSigned.ptr() + 2);
+            data1.insert(data1.end(), v.uvTiled.ptr(), v.uvTiled.ptr() + 2);
+        }
+        buf0->writeData(0, buf0->getSizeInBytes(), &data0[0]);
+        buf1->writeData(0, buf1->getSizeInBytes(), &data1[0]);
+        mMesh->sharedVertexData->vertexBufferBinding->setBinding(0, buf0);
+        mMesh->sharedVertexData->vertexBufferBinding->setBinding(1, buf1);
+
+        SubMesh* sub = mMesh->createSubMesh();
+        sub->useSharedVertices = true;
+        sub->indexData->indexCount = mVertices.size();
+        sub->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+            HardwareIndexBuffer::IT_16BIT, mVertices.size(), HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        std::vector<uint16> indices(mVertices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+            indices[i] = uint16(i);
+        sub->indexData->indexBuffer->writeData(0, indices.size() * sizeof(uint16), &indices[0]);
+
+        mMesh->_setBounds(AxisAlignedBox(Vector3(-20, 0, -1), Vector3(60, 5, 1)));
+        mMesh->load();
+    }
+
+    void TearDown()
+    {
+        mMesh.reset();
+        MeshManager::getSingleton().remove("VertexQuantisationTests",
+                                           ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        RootWithoutRenderSystemFixture::TearDown();
+    }
+};
+
+TEST_F(VertexQuantisationTests, ErrorsWithinBounds)
+{
+    mMesh->buildEdgeList();
+    VertexData::QuantisationReport report = mMesh->quantiseVertexData();
+    VertexData* vertexData = mMesh->sharedVertexData;
+    VertexDeclaration* decl = vertexData->vertexDeclaration;
+
+    // the tiled coordinates keep their floats
+    EXPECT_EQ(VET_SHORT4_NORM, decl->findElementBySemantic(VES_POSITION)->getType());
+    EXPECT_EQ(VET_SHORT4_NORM, decl->findElementBySemantic(VES_NORMAL)->getType());
+    EXPECT_EQ(VET_SHORT4_NORM, decl->findElementBySemantic(VES_TANGENT)->getType());
+    EXPECT_EQ(VET_USHORT2_NORM, decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 0)->getType());
+    EXPECT_EQ(VET_SHORT2_NORM, decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 1)->getType());
+    EXPECT_EQ(VET_FLOAT2, decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 2)->getType());
+    EXPECT_EQ(mVertices.size() * (40 + 24), report.bytesBefore);
+    EXPECT_EQ(mVertices.size() * (24 + 16), report.bytesAfter);
+
+    // stencil shadows need the float positions
+    EXPECT_FALSE(mMesh->isEdgeListBuilt());
+    EXPECT_FALSE(mMesh->getAutoBuildEdgeLists());
+
+    // half a step of the quantisation grid in each component
+    const Real posScale = 40; // the largest half extent
+    EXPECT_LE(report.maxPositionError, Math::Sqrt(3) * 0.5f * posScale / 32767 * 1.01f);
+    EXPECT_LE(report.maxDirectionError.valueRadians(), Math::Sqrt(3) * 0.5f / 32767 * 1.01f);
+    EXPECT_LE(report.maxTexCoordError, 0.5f / 32767 * 1.01f);
+    EXPECT_GT(report.maxPositionError, 0);
+    EXPECT_GT(report.maxTexCoordError, 0);
+
+    // decode everything as the hardware would, the report holds the worst errors
+    std::vector<Vector3> positions;
+    vertexData->readPositions(positions);
+    ASSERT_EQ(mVertices.size(), positions.size());
+
+    HardwareVertexBufferSharedPtr buf0 = vertexData->vertexBufferBinding->getBuffer(0);
+    HardwareVertexBufferSharedPtr buf1 = vertexData->vertexBufferBinding->getBuffer(1);
+    HardwareBufferLockGuard<HardwareVertexBufferSharedPtr> lock0(buf0, HardwareBuffer::HBL_READ_ONLY);
+    HardwareBufferLockGuard<HardwareVertexBufferSharedPtr> lock1(buf1, HardwareBuffer::HBL_READ_ONLY);
+    const Real tolerance = 1e-5f;
+    for (size_t i = 0; i < mVertices.size(); ++i)
+    {
+        const Vertex& v = mVertices[i];
+        EXPECT_LE(v.position.distance(positions[i]), report.maxPositionError + tolerance);
+
+        const unsigned char* pBase0 = static_cast<unsigned char*>(lock0.pData) + i * buf0->getVertexSize();
+        const unsigned char* pBase1 = static_cast<unsigned char*>(lock1.pData) + i * buf1->getVertexSize();
+        const short* pNormal = reinterpret_cast<const short*>(
+            pBase0 + decl->findElementBySemantic(VES_NORMAL)->getOffset());
+        const short* pTangent = reinterpret_cast<const short*>(
+            pBase0 + decl->findElementBySemantic(VES_TANGENT)->getOffset());
+        Vector3 normal(decodeSnorm(pNormal[0]), decodeSnorm(pNormal[1]), decodeSnorm(pNormal[2]));
+        Vector3 tangent(decodeSnorm(pTangent[0]), decodeSnorm(pTangent[1]), decodeSnorm(pTangent[2]));
+        EXPECT_LE(angleBetween(v.normal, normal),
+                  report.maxDirectionError.valueRadians() + tolerance);
+        EXPECT_LE(angleBetween(v.tangent.xyz(), tangent),
+                  report.maxDirectionError.valueRadians() + tolerance);
+        EXPECT_EQ(v.tangent.w, decodeSnorm(pTangent[3]));
+
+        const uint16* pUV = reinterpret_cast<const uint16*>(
+            pBase1 + decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 0)->getOffset());
+        const short* pSigned = reinterpret_cast<const short*>(
+            pBase1 + decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 1)->getOffset());
+        const float* pTiled = reinterpret_cast<const float*>(
+            pBase1 + decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 2)->getOffset());
+        for (int c = 0; c < 2; ++c)
+        {
+            EXPECT_LE(Math::Abs(pUV[c] / 65535.0f - v.uv01[c]), 0.5f / 65535 * 1.01f);
+            EXPECT_LE(Math::Abs(decodeSnorm(pSigned[c]) - v.uvSigned[c]), report.maxTexCoordError + tolerance);
+            EXPECT_EQ(v.uvTiled[c], pTiled[c]);
+        }
+    }
+}
+
+TEST_F(VertexQuantisationTests, SerializerRoundTrip)
+{
+    mMesh->quantiseVertexData();
+    const VertexData* orig = mMesh->sharedVertexData;
+
+    MeshSerializer serializer;
+    const Serializer::Endian endians[] = {Serializer::ENDIAN_NATIVE,
+#if OGRE_ENDIAN == OGRE_ENDIAN_LITTLE
+                                          Serializer::ENDIAN_BIG};
+#else
+                                          Serializer::ENDIAN_LITTLE};
+#endif
+    for (int e = 0; e < 2; ++e)
+    {
+        DataStreamPtr stream(new MemoryDataStream(1 << 20));
+        serializer.exportMesh(mMesh.get(), stream, endians[e]);
+        stream->seek(0);
+
+        MeshPtr copy = MeshManager::getSingleton().createManual(
+            "VertexQuantisationTests/Copy", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        serializer.importMesh(stream, copy.get());
+
+        const VertexData* read = copy->sharedVertexData;
+        ASSERT_TRUE(read);
+        EXPECT_EQ(orig->positionDecode, read->positionDecode);
+        ASSERT_EQ(orig->vertexDeclaration->getElementCount(), read->vertexDeclaration->getElementCount());
+        for (unsigned short i = 0; i < orig->vertexDeclaration->getElementCount(); ++i)
+            EXPECT_EQ(*orig->vertexDeclaration->getElement(i), *read->vertexDeclaration->getElement(i));
+
+        // byte for byte, whatever the endianness of the file
+        for (unsigned short source = 0; source < 2; ++source)
+        {
+            HardwareVertexBufferSharedPtr a = orig->vertexBufferBinding->getBuffer(source);
+            HardwareVertexBufferSharedPtr b = read->vertexBufferBinding->getBuffer(source);
+            ASSERT_EQ(a->getSizeInBytes(), b->getSizeInBytes());
+            std::vector<unsigned char> bytesA(a->getSizeInBytes()), bytesB(b->getSizeInBytes());
+            a->readData(0, bytesA.size(), &bytesA[0]);
+            b->readData(0, bytesB.size(), &bytesB[0]);
+            EXPECT_TRUE(bytesA == bytesB) << "source " << source << ", endian " << e;
+        }
+
+        copy.reset();
+        MeshManager::getSingleton().remove("VertexQuantisationTests/Copy",
+                                           ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+    }
+}
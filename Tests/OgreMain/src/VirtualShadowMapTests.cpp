@@ -0,0 +1,194 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+#include <Ogre.h>
+#include <OgreVirtualShadowMap.h>
+
+using namespace Ogre;
+
+namespace
+{
+    VirtualShadowMap::PageId page(uint16 level, uint16 x, uint16 y)
+    {
+        VirtualShadowMap::PageId p = {level, x, y};
+        return p;
+    }
+
+    /// Number of pages of a level in a render list
+    size_t countLevel(const VirtualShadowMap::PageRenderList& renders, uint16 level)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < renders.size(); ++i)
+            count += renders[i].page.level == level;
+        return count;
+    }
+}
+
+// 8 pages per side at level 0, so 4 levels; with the identity light matrices the
+// virtual map spans [-1, 1] in x and y, top left at (-1, 1)
+TEST(VirtualShadowMap, RequestsAncestors)
+{
+    VirtualShadowMap vsm("VirtualShadowMapTest");
+    vsm.setSizes(1024, 128, 1024);
+    ASSERT_EQ(vsm.getNumLevels(), 4);
+    ASSERT_EQ(vsm.getNumSlots(), 64u);
+
+    vsm.beginFrame();
+    vsm.requestPage(page(0, 5, 3));
+    EXPECT_EQ(vsm.getNumRequestedPages(), 4u);
+
+    // Coarsest first, so that lookups always have a fallback
+    const VirtualShadowMap::PageRenderList& renders = vsm.update();
+    ASSERT_EQ(renders.size(), 4u);
+    EXPECT_EQ(renders[0].page.level, 3);
+    EXPECT_EQ(renders[3].page.level, 0);
+    EXPECT_EQ(renders[3].page.x, 5);
+    EXPECT_EQ(renders[3].page.y, 3);
+    EXPECT_EQ(vsm.getSlot(page(0, 5, 3)), int32(renders[3].slot));
+    EXPECT_EQ(vsm.getNumResidentPages(), 4u);
+
+    // Clean resident pages are not rendered again
+    vsm.beginFrame();
+    vsm.requestPage(page(0, 5, 3));
+    EXPECT_TRUE(vsm.update().empty());
+}
+
+TEST(VirtualShadowMap, FallsBackToAncestors)
+{
+    VirtualShadowMap vsm("VirtualShadowMapTest");
+    vsm.setSizes(1024, 128, 1024);
+
+    vsm.beginFrame();
+    vsm.requestPage(page(1, 2, 1));
+    vsm.update();
+
+    uint16 level = 0;
+    EXPECT_EQ(vsm.getSlot(page(0, 4, 2)), -1);
+    EXPECT_EQ(vsm.getSlot(page(0, 4, 2), true, &level), vsm.getSlot(page(1, 2, 1)));
+    EXPECT_EQ(level, 1);
+    EXPECT_EQ(vsm.getSlot(page(0, 7, 7), true, &level), vsm.getSlot(page(3, 0, 0)));
+    EXPECT_EQ(level, 3);
+}
+
+TEST(VirtualShadowMap, InvalidateRendersOverlappingPages)
+{
+    VirtualShadowMap vsm("VirtualShadowMapTest");
+    vsm.setSizes(1024, 128, 1024);
+
+    vsm.beginFrame();
+    vsm.requestPage(page(0, 6, 6));
+    vsm.requestPage(page(0, 1, 1));
+    EXPECT_EQ(vsm.update().size(), 7u);
+
+    // Only covers page (6, 6) of level 0, and the ancestors of it
+    vsm.invalidate(AxisAlignedBox(0.6, -0.7, 0, 0.7, -0.6, 0));
+    vsm.beginFrame();
+    vsm.requestPage(page(0, 6, 6));
+    vsm.requestPage(page(0, 1, 1));
+    const VirtualShadowMap::PageRenderList& renders = vsm.update();
+    ASSERT_EQ(renders.size(), 4u);
+    for (size_t i = 0; i < renders.size(); ++i)
+    {
+        EXPECT_EQ(renders[i].page.x, 6 >> renders[i].page.level);
+        EXPECT_EQ(renders[i].page.y, 6 >> renders[i].page.level);
+    }
+
+    // New light matrices make all pages dirty
+    Matrix4 projection = Matrix4::IDENTITY;
+    projection[0][0] = 0.5;
+    vsm.setLightMatrices(Affine3::IDENTITY, projection);
+    vsm.beginFrame();
+    vsm.requestPage(page(0, 6, 6));
+    vsm.requestPage(page(0, 1, 1));
+    EXPECT_EQ(vsm.update().size(), 7u);
+}
+
+TEST(VirtualShadowMap, EvictsLeastRecentlyUsed)
+{
+    // An atlas of 4 pages
+    VirtualShadowMap vsm("VirtualShadowMapTest");
+    vsm.setSizes(1024, 128, 256);
+    ASSERT_EQ(vsm.getNumSlots(), 4u);
+
+    vsm.beginFrame();
+    vsm.requestPage(page(0, 0, 0));
+    EXPECT_EQ(vsm.update().size(), 4u);
+
+    // Shares the root page only, the other three make room
+    vsm.beginFrame();
+    vsm.requestPage(page(0, 7, 7));
+    const VirtualShadowMap::PageRenderList& renders = vsm.update();
+    EXPECT_EQ(renders.size(), 3u);
+    EXPECT_EQ(vsm.getNumDroppedPages(), 0u);
+    EXPECT_EQ(vsm.getNumResidentPages(), 4u);
+    EXPECT_NE(vsm.getSlot(page(0, 7, 7)), -1);
+    EXPECT_EQ(vsm.getSlot(page(0, 0, 0)), -1);
+    EXPECT_EQ(vsm.getSlot(page(1, 0, 0)), -1);
+
+    uint16 level = 0;
+    vsm.getSlot(page(0, 0, 0), true, &level);
+    EXPECT_EQ(level, 3);
+}
+
+TEST(VirtualShadowMap, DropsPagesWhenFull)
+{
+    VirtualShadowMap vsm("VirtualShadowMapTest");
+    vsm.setSizes(1024, 128, 256);
+
+    // 7 pages for 4 slots, the finest ones miss out
+    vsm.beginFrame();
+    vsm.requestPage(page(0, 0, 0));
+    vsm.requestPage(page(0, 7, 7));
+    const VirtualShadowMap::PageRenderList& renders = vsm.update();
+    EXPECT_EQ(renders.size(), 4u);
+    EXPECT_EQ(vsm.getNumDroppedPages(), 3u);
+    EXPECT_EQ(countLevel(renders, 3), 1u);
+    EXPECT_EQ(countLevel(renders, 2), 2u);
+    EXPECT_EQ(countLevel(renders, 1), 1u);
+    EXPECT_EQ(countLevel(renders, 0), 0u);
+}
+
+TEST(VirtualShadowMap, RequestBoundsPicksLevel)
+{
+    VirtualShadowMap vsm("VirtualShadowMapTest");
+    vsm.setSizes(1024, 128, 1024);
+
+    // Level 0 texels are 2 / 1024 wide, ask for 4 times that
+    vsm.beginFrame();
+    vsm.requestBounds(AxisAlignedBox(-0.9, 0.8, 0, -0.8, 0.9, 0), 8.0f / 1024);
+    const VirtualShadowMap::PageRenderList& renders = vsm.update();
+    ASSERT_EQ(renders.size(), 2u);
+    EXPECT_EQ(renders[1].page.level, 2);
+    EXPECT_EQ(renders[1].page.x, 0);
+    EXPECT_EQ(renders[1].page.y, 0);
+
+    // Finer texels than level 0 clamp to it
+    vsm.beginFrame();
+    vsm.requestBounds(AxisAlignedBox(-0.9, 0.8, 0, -0.8, 0.9, 0), 0.1f / 1024);
+    EXPECT_EQ(countLevel(vsm.update(), 0), 1u);
+}
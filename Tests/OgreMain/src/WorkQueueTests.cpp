@@ -0,0 +1,82 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include <OgreWorkQueue.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+class WorkQueueTests : public RootWithoutRenderSystemFixture
+{
+public:
+    void SetUp()
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+
+        // Without a render window the queue of Root is never started
+        DefaultWorkQueueBase* queue = static_cast<DefaultWorkQueueBase*>(mRoot->getWorkQueue());
+        queue->setWorkerThreadCount(3);
+        queue->startup();
+    }
+};
+
+TEST_F(WorkQueueTests, ParallelForCallsEveryIndexOnce)
+{
+    std::vector<int> calls(1000, 0);
+    mRoot->getWorkQueue()->parallelFor(calls.size(), [&calls](size_t i) { ++calls[i]; });
+
+    EXPECT_EQ(calls, std::vector<int>(1000, 1));
+}
+
+TEST_F(WorkQueueTests, ParallelForNested)
+{
+    // The inner calls run inside the helper requests of the outer one
+    std::vector<size_t> sums(16, 0);
+    WorkQueue::parallelForDefault(sums.size(), [&sums](size_t i) {
+        std::vector<size_t> values(100, 0);
+        WorkQueue::parallelForDefault(values.size(), [&values, i](size_t j) { values[j] = i * j; });
+        for (size_t j = 0; j < values.size(); ++j)
+            sums[i] += values[j];
+    });
+
+    for (size_t i = 0; i < sums.size(); ++i)
+        EXPECT_EQ(sums[i], i * 4950);
+}
+
+TEST_F(WorkQueueTests, ParallelForRethrows)
+{
+    std::vector<int> calls(100, 0);
+    EXPECT_THROW(mRoot->getWorkQueue()->parallelFor(calls.size(), [&calls](size_t i) {
+        ++calls[i];
+        if (i == 42)
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "index 42", "ParallelForRethrows");
+    }), InvalidParametersException);
+
+    // The other calls still happen
+    EXPECT_EQ(calls, std::vector<int>(100, 1));
+}
@@ -0,0 +1,165 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <Ogre.h>
+#include <OgreOctreeSceneManager.h>
+#include "RootWithoutRenderSystemFixture.h"
+
+using namespace Ogre;
+
+namespace
+{
+    /// Runs the shared shadow caster culling pass of a scene manager
+    template<class Base> class CasterCullingSceneManager : public Base
+    {
+    public:
+        CasterCullingSceneManager() : Base("CasterCulling") {}
+
+        /// The objects seen by each camera
+        std::vector<std::set<MovableObject*> > cull(const std::vector<Camera*>& cameras)
+        {
+            this->_updateSceneGraph(cameras[0]);
+            this->mShadowRenderer.cullShadowCasters(cameras);
+
+            std::vector<std::set<MovableObject*> > seen(cameras.size());
+            for (size_t i = 0; i < this->mShadowRenderer.mCulledCasters.size(); ++i)
+            {
+                const SceneManager::ShadowRenderer::CulledShadowCaster& caster =
+                    this->mShadowRenderer.mCulledCasters[i];
+                for (size_t c = 0; c < cameras.size(); ++c)
+                {
+                    if (caster.object && (caster.cameraMask & (uint64(1) << c)))
+                        seen[c].insert(caster.object);
+                }
+            }
+            return seen;
+        }
+    };
+
+    /// The objects of a subtree a camera sees, traversing the nodes as SceneNode::_findVisibleObjects
+    void cullNodes(SceneNode* node, Camera* cam, bool cullChildrenByParent, std::set<MovableObject*>& seen)
+    {
+        const AxisAlignedBox& box = node->_getWorldAABB();
+        bool visible = cam->isVisible(box);
+        if (visible)
+        {
+            const SceneNode::ObjectMap& objects = node->getAttachedObjects();
+            seen.insert(objects.begin(), objects.end());
+        }
+        if (cullChildrenByParent && !box.isNull() && !visible)
+            return;
+
+        const Node::ChildNodeMap& children = node->getChildren();
+        for (size_t i = 0; i < children.size(); ++i)
+            cullNodes(static_cast<SceneNode*>(children[i]), cam, cullChildrenByParent, seen);
+    }
+
+    /// The objects each camera sees when culled on its own
+    std::vector<std::set<MovableObject*> > cullEach(SceneManager* sceneMgr,
+                                                    const std::vector<Camera*>& cameras)
+    {
+        bool cullChildrenByParent =
+            sceneMgr->getTypeName() == DefaultSceneManagerFactory::FACTORY_TYPE_NAME;
+        std::vector<std::set<MovableObject*> > seen(cameras.size());
+        for (size_t c = 0; c < cameras.size(); ++c)
+            cullNodes(sceneMgr->getRootSceneNode(), cameras[c], cullChildrenByParent, seen[c]);
+        return seen;
+    }
+
+    /** Nodes with and without objects, some of them holding an object far from
+        their children.
+    */
+    void createScene(SceneManager* sceneMgr, SceneNode* parent, int depth)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            SceneNode* node = parent->createChildSceneNode(Vector3(Math::RangeRandom(-300, 300),
+                Math::RangeRandom(-300, 300), Math::RangeRandom(-300, 300)));
+            if (Math::UnitRandom() < 0.6)
+            {
+                BillboardSet* object = sceneMgr->createBillboardSet();
+                object->setBounds(AxisAlignedBox(-10, -10, -10, 10, 10, 10), 18);
+                node->attachObject(object);
+            }
+            if (depth > 0)
+                createScene(sceneMgr, node, depth - 1);
+        }
+    }
+
+    template<class Base> void testCasterCulling()
+    {
+        CasterCullingSceneManager<Base> sceneMgr;
+        createScene(&sceneMgr, sceneMgr.getRootSceneNode(), 3);
+
+        std::vector<Camera*> cameras;
+        Vector3 directions[] = {Vector3::NEGATIVE_UNIT_Z, Vector3::UNIT_X, Vector3::NEGATIVE_UNIT_Y};
+        for (int i = 0; i < 3; ++i)
+        {
+            Camera* cam = sceneMgr.createCamera("Shadow" + StringConverter::toString(i));
+            cam->setNearClipDistance(1);
+            cam->setFarClipDistance(i == 2 ? 0 : 400);
+            SceneNode* node = sceneMgr.getRootSceneNode()->createChildSceneNode();
+            node->attachObject(cam);
+            node->setDirection(directions[i], Node::TS_WORLD);
+            cameras.push_back(cam);
+        }
+
+        // this updates the node bounds as well
+        std::vector<std::set<MovableObject*> > seen = sceneMgr.cull(cameras);
+        std::vector<std::set<MovableObject*> > expected = cullEach(&sceneMgr, cameras);
+        for (size_t c = 0; c < cameras.size(); ++c)
+        {
+            EXPECT_FALSE(expected[c].empty());
+            EXPECT_EQ(expected[c], seen[c]);
+        }
+
+        // node bounds are conservative, no object in view may be missing
+        SceneManager::MovableObjectIterator it = sceneMgr.getMovableObjectIterator("BillboardSet");
+        while (it.hasMoreElements())
+        {
+            MovableObject* object = it.getNext();
+            for (size_t c = 0; c < cameras.size(); ++c)
+            {
+                if (cameras[c]->isVisible(object->getWorldBoundingBox(true)))
+                    EXPECT_TRUE(seen[c].count(object));
+            }
+        }
+    }
+}
+
+typedef RootWithoutRenderSystemFixture CasterCullingTests;
+
+TEST_F(CasterCullingTests, DefaultSceneManager)
+{
+    testCasterCulling<DefaultSceneManager>();
+}
+
+TEST_F(CasterCullingTests, OctreeSceneManager)
+{
+    // Octree nodes only bound their own objects, empty ones are null
+    testCasterCulling<OctreeSceneManager>();
+}
@@ -66,6 +66,13 @@ void help(void)
     cout << "-tm            = Split tangent vertices at UV mirror points" << endl;
     cout << "-tr            = Split tangent vertices where basis is rotated > 90 degrees" << endl;
     cout << "-r         = DON'T reorganise buffers to recommended format" << endl;
+    cout << "-O         = Optimise triangle order for the vertex cache, then vertex order" << endl;
+    cout << "             for fetching" << endl;
+    cout << "-od threshold" << endl;
+    cout << "           = With -O, also reorder triangle clusters against overdraw, letting" << endl;
+    cout << "             the vertex cache misses grow by at most threshold (e.g. 1.05)" << endl;
+    cout << "-M         = Split submeshes into meshlets (for per meshlet culling)" << endl;
+    cout << "-Q         = Quantise vertex data to compact formats (disables stencil shadows)" << endl;
     cout << "-d3d       = Convert to D3D colour formats" << endl;
     cout << "-gl        = Convert to GL colour formats" << endl;
     cout << "-srcd3d    = Interpret ambiguous colours as D3D style" << endl;
@@ -73,7 +80,7 @@ void help(void)
     cout << "-E endian  = Set endian mode 'big' 'little' or 'native' (default)" << endl;
     cout << "-b         = Recalculate bounding box (static meshes only)" << endl;
     cout << "-V version = Specify OGRE version format to write instead of latest" << endl;
-    cout << "             Options are: 1.10, 1.8, 1.7, 1.4, 1.0" << endl;
+    cout << "             Options are: 1.11, 1.10, 1.8, 1.7, 1.4, 1.0" << endl;
     cout << "sourcefile = name of file to convert" << endl;
     cout << "destfile   = optional name of file to write to. If you don't" << endl;
     cout << "             specify this OGRE overwrites the existing file." << endl;
@@ -90,6 +97,10 @@ struct UpgradeOptions {
     bool tangentSplitMirrored;
     bool tangentSplitRotated;
     bool dontReorganise;
+    bool optimiseVertexOrder;
+    Real overdrawThreshold;
+    bool buildMeshlets;
+    bool quantiseVertexData;
     bool destColourFormatSet;
     VertexElementType destColourFormat;
     bool srcColourFormatSet;
@@ -132,6 +143,10 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.tangentSplitMirrored = false;
     opts.tangentSplitRotated = false;
     opts.dontReorganise = false;
+    opts.optimiseVertexOrder = false;
+    opts.overdrawThreshold = 0;
+    opts.buildMeshlets = false;
+    opts.quantiseVertexData = false;
     opts.endian = Serializer::ENDIAN_NATIVE;
     opts.destColourFormatSet = false;
     opts.srcColourFormatSet = false;
@@ -162,6 +177,12 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.interactive = ui->second;
     ui = unOpts.find("-r");
     opts.dontReorganise = ui->second;
+    ui = unOpts.find("-O");
+    opts.optimiseVertexOrder = ui->second;
+    ui = unOpts.find("-M");
+    opts.buildMeshlets = ui->second;
+    ui = unOpts.find("-Q");
+    opts.quantiseVertexData = ui->second;
     ui = unOpts.find("-d3d");
     if (ui->second) {
         opts.destColourFormatSet = true;
@@ -229,6 +250,10 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
             opts.tangentSemantic = VES_TANGENT;
     }
     }
+    bi = binOpts.find("-od");
+    if (!bi->second.empty()) {
+        opts.overdrawThreshold = StringConverter::parseReal(bi->second);
+    }
     bi = binOpts.find("-ts");
     if (!bi->second.empty()) {
         if (bi->second == "4") {
@@ -238,7 +263,9 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     
     bi = binOpts.find("-V");
     if (!bi->second.empty()) {
-        if (bi->second == "1.10") {
+        if (bi->second == "1.11") {
+            opts.targetVersion = MESH_VERSION_1_11;
+        } else if (bi->second == "1.10") {
             opts.targetVersion = MESH_VERSION_1_10;
         } else if (bi->second == "1.8") {
             opts.targetVersion = MESH_VERSION_1_8;
@@ -597,6 +624,24 @@ void recalcBounds(Mesh* mesh)
     mesh->_setBoundingSphereRadius(radius);
 }
 
+// Average cache miss ratio (transformed vertices per triangle) of the full detail
+// triangle lists, as seen by a 16 entry FIFO cache
+Real calcACMR(Mesh* mesh)
+{
+    VertexCacheProfiler profiler;
+    size_t triangles = 0;
+    for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i) {
+        SubMesh* sm = mesh->getSubMesh(i);
+        if (sm->operationType != RenderOperation::OT_TRIANGLE_LIST || !sm->indexData->indexCount) {
+            continue;
+        }
+        profiler.flush();
+        profiler.profile(sm->indexData->indexBuffer, sm->indexData->indexStart, sm->indexData->indexCount);
+        triangles += sm->indexData->indexCount / 3;
+    }
+    return triangles ? Real(profiler.getMisses()) / triangles : 0;
+}
+
 void printLodConfig(const LodConfig& lodConfig)
 {
     cout << "\n\nLOD config summary:";
@@ -1016,6 +1061,9 @@ int main(int numargs, char** args)
         unOptList["-tm"] = false;
         unOptList["-tr"] = false;
         unOptList["-r"] = false;
+        unOptList["-O"] = false;
+        unOptList["-M"] = false;
+        unOptList["-Q"] = false;
         unOptList["-gl"] = false;
         unOptList["-d3d"] = false;
         unOptList["-srcgl"] = false;
@@ -1030,6 +1078,7 @@ int main(int numargs, char** args)
         binOptList["-td"] = "";
         binOptList["-ts"] = "";
         binOptList["-V"] = "";
+        binOptList["-od"] = "";
 
         int startIdx = findCommandLineOpts(numargs, args, unOptList, binOptList);
         parseOpts(unOptList, binOptList);
@@ -1077,6 +1126,21 @@ int main(int numargs, char** args)
         
         buildLod(meshPtr);
 
+        if (opts.optimiseVertexOrder) {
+            cout << "\nOptimising vertex order, ACMR " << calcACMR(mesh);
+            mesh->optimiseVertexCache();
+            if (opts.overdrawThreshold > 0)
+                mesh->optimiseOverdraw(opts.overdrawThreshold);
+            mesh->optimiseVertexFetch();
+            cout << " -> " << calcACMR(mesh) << endl;
+        }
+
+        if (opts.buildMeshlets) {
+            cout << "\nBuilding meshlets...";
+            mesh->buildMeshlets();
+            cout << "success\n";
+        }
+
         if (opts.interactive) {
             do {
                 std::cout << "\nWould you like to (b)uild/(r)emove/(k)eep Edge lists? (b/r/k) ";
@@ -1162,6 +1226,17 @@ int main(int numargs, char** args)
             recalcBounds(mesh);
         }
 
+        // Last, everything above reads float positions
+        if (opts.quantiseVertexData) {
+            cout << "\nQuantising vertex data...";
+            VertexData::QuantisationReport report = mesh->quantiseVertexData();
+            cout << "success\n";
+            cout << "Vertex buffers: " << report.bytesBefore << " -> " << report.bytesAfter << " bytes\n";
+            cout << "Max error: position " << report.maxPositionError << ", direction "
+                 << report.maxDirectionError.valueDegrees() << " degrees, texture coordinate "
+                 << report.maxTexCoordError << endl;
+        }
+
         meshSerializer->exportMesh(mesh, dest, opts.targetVersion, opts.endian);
     
     }